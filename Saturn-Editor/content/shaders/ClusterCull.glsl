@@ -0,0 +1,254 @@
+// Cluster culling shader
+// Every workgroup culls the meshlets of one draw for the camera, after instance culling and the HiZ build.
+// A meshlet is kept if any visible instance can see it, tested against the frustum, its normal cone and the HiZ pyramid.
+// The indices of the kept meshlets are compacted into the output index buffer and the draw's indirect command is patched to read them.
+
+#type compute
+#version 450 core
+
+struct Transform
+{
+	vec4 Rows[4];
+};
+
+// Must match with "Meshlet" in Meshlet.h.
+struct Meshlet
+{
+	vec4 BoundingSphere;
+	vec4 Cone;
+
+	uint FirstIndex;
+	uint IndexCount;
+
+	uint Padding[2];
+};
+
+// Must match with "ClusterDraw" in ClusterCulling.h.
+struct ClusterDraw
+{
+	uint MeshletOffset;
+	uint MeshletCount;
+
+	uint InstanceOffset;
+	uint CommandIndex;
+
+	uint OutputOffset;
+	uint SourceFirstIndex;
+
+	uint Padding[2];
+};
+
+// Must match with VkDrawIndexedIndirectCommand.
+struct DrawIndexedCommand
+{
+	uint IndexCount;
+	uint InstanceCount;
+	uint FirstIndex;
+	int VertexOffset;
+	uint FirstInstance;
+};
+
+// Geometry pool meshlets.
+layout(std430, set = 0, binding = 0) readonly buffer MeshletBuffer
+{
+	Meshlet Meshlets[];
+} s_Meshlets;
+
+layout(std430, set = 0, binding = 1) readonly buffer ClusterDrawBuffer
+{
+	ClusterDraw Draws[];
+} s_Draws;
+
+// Instance culling output.
+layout(std430, set = 0, binding = 2) readonly buffer CulledInstanceBuffer
+{
+	Transform Instances[];
+} s_Instances;
+
+// Geometry pool indices.
+layout(std430, set = 0, binding = 3) readonly buffer SourceIndexBuffer
+{
+	uint Indices[];
+} s_SourceIndices;
+
+// Written by instance culling, the index range is replaced here.
+layout(std430, set = 0, binding = 4) buffer IndirectBuffer
+{
+	DrawIndexedCommand Commands[];
+} s_Commands;
+
+layout(std430, set = 0, binding = 5) writeonly buffer OutputIndexBuffer
+{
+	uint Indices[];
+} s_OutputIndices;
+
+layout(set = 0, binding = 6) uniform sampler2D u_HiZ;
+
+layout(push_constant) uniform pc_ClusterCull
+{
+	mat4 ViewProjection;
+	vec4 CameraPosition;
+
+	// x, y = depth buffer size, z = HiZ mip count (zero disables the occlusion test), w = draw count
+	uvec4 Params;
+} u_Cull;
+
+#define THREAD_COUNT 64
+
+shared vec4 frustumPlanes[6];
+shared uint visibleIndexCount;
+
+// Same as the CPU side test in HiZPyramid::IsOccluded, but for the box around a sphere.
+bool IsOccluded( vec3 center, float radius )
+{
+	uvec2 depthSize = u_Cull.Params.xy;
+	uint mipCount = u_Cull.Params.z;
+
+	vec2 screenMin = vec2( 1e30 );
+	vec2 screenMax = vec2( -1e30 );
+	float nearestDepth = 1e30;
+
+	for( int i = 0; i < 8; i++ )
+	{
+		vec3 corner = center + vec3( ( i & 1 ) != 0 ? radius : -radius, ( i & 2 ) != 0 ? radius : -radius, ( i & 4 ) != 0 ? radius : -radius );
+		vec4 clip = u_Cull.ViewProjection * vec4( corner, 1.0 );
+
+		// Crosses the near plane.
+		if( clip.w <= 1e-5 || clip.z < 0.0 )
+			return false;
+
+		vec3 ndc = clip.xyz / clip.w;
+
+		screenMin = min( screenMin, ndc.xy );
+		screenMax = max( screenMax, ndc.xy );
+		nearestDepth = min( nearestDepth, ndc.z );
+	}
+
+	screenMin = clamp( screenMin * 0.5 + 0.5, 0.0, 1.0 );
+	screenMax = clamp( screenMax * 0.5 + 0.5, 0.0, 1.0 );
+
+	// In depth buffer pixels, a pixel "p" is in texel "p >> ( mip + 1 )" of a level.
+	uvec2 pixelMin = min( uvec2( screenMin * vec2( depthSize ) ), depthSize - 1 );
+	uvec2 pixelMax = min( uvec2( screenMax * vec2( depthSize ) ), depthSize - 1 );
+
+	// Smallest level where the sphere covers at most 2x2 texels.
+	uint mip = 0;
+
+	while( mip + 1 < mipCount && 
+		( ( pixelMax.x >> ( mip + 1 ) ) - ( pixelMin.x >> ( mip + 1 ) ) > 1 || ( pixelMax.y >> ( mip + 1 ) ) - ( pixelMin.y >> ( mip + 1 ) ) > 1 ) )
+	{
+		mip++;
+	}
+
+	ivec2 levelSize = textureSize( u_HiZ, int( mip ) );
+
+	ivec2 texelMin = min( ivec2( pixelMin >> ( mip + 1 ) ), levelSize - 1 );
+	ivec2 texelMax = min( ivec2( pixelMax >> ( mip + 1 ) ), levelSize - 1 );
+
+	float farthestDepth = 0.0;
+
+	for( int y = texelMin.y; y <= texelMax.y; y++ )
+	{
+		for( int x = texelMin.x; x <= texelMax.x; x++ )
+			farthestDepth = max( farthestDepth, texelFetch( u_HiZ, ivec2( x, y ), int( mip ) ).r );
+	}
+
+	return nearestDepth > farthestDepth;
+}
+
+bool IsVisible( Transform transform, Meshlet meshlet )
+{
+	vec3 center = meshlet.BoundingSphere.xyz;
+
+	// The bottom row of the transform is always ( 0, 0, 0, 1 ).
+	vec3 worldCenter = vec3(
+		dot( transform.Rows[ 0 ], vec4( center, 1.0 ) ),
+		dot( transform.Rows[ 1 ], vec4( center, 1.0 ) ),
+		dot( transform.Rows[ 2 ], vec4( center, 1.0 ) ) );
+
+	mat3 linear = transpose( mat3( transform.Rows[ 0 ].xyz, transform.Rows[ 1 ].xyz, transform.Rows[ 2 ].xyz ) );
+	vec3 scale = vec3( length( linear[ 0 ] ), length( linear[ 1 ] ), length( linear[ 2 ] ) );
+
+	float maxScale = max( scale.x, max( scale.y, scale.z ) );
+	float minScale = min( scale.x, min( scale.y, scale.z ) );
+	float radius = meshlet.BoundingSphere.w * maxScale;
+
+	// Frustum
+	for( int i = 0; i < 6; i++ )
+	{
+		if( dot( frustumPlanes[ i ].xyz, worldCenter ) + frustumPlanes[ i ].w < -radius )
+			return false;
+	}
+
+	// Backfacing cone, angles are only kept by uniform scale. Mirrored transforms flip the winding, so they are left alone.
+	if( minScale > maxScale * 0.99 && determinant( linear ) > 0.0 )
+	{
+		vec3 axis = normalize( linear * meshlet.Cone.xyz );
+		vec3 toCenter = worldCenter - u_Cull.CameraPosition.xyz;
+
+		if( dot( toCenter, axis ) >= meshlet.Cone.w * length( toCenter ) + radius )
+			return false;
+	}
+
+	// Occlusion
+	if( u_Cull.Params.z > 0 && IsOccluded( worldCenter, radius ) )
+		return false;
+
+	return true;
+}
+
+layout( local_size_x = THREAD_COUNT, local_size_y = 1, local_size_z = 1 ) in;
+void main()
+{
+	ClusterDraw draw = s_Draws.Draws[ gl_WorkGroupID.x ];
+	uint instanceCount = s_Commands.Commands[ draw.CommandIndex ].InstanceCount;
+
+	if( gl_LocalInvocationIndex == 0 )
+	{
+		// Gribb & Hartmann, planes point inwards. Depth is zero to one.
+		mat4 m = transpose( u_Cull.ViewProjection );
+
+		frustumPlanes[ 0 ] = m[ 3 ] + m[ 0 ]; // Left
+		frustumPlanes[ 1 ] = m[ 3 ] - m[ 0 ]; // Right
+		frustumPlanes[ 2 ] = m[ 3 ] + m[ 1 ]; // Bottom
+		frustumPlanes[ 3 ] = m[ 3 ] - m[ 1 ]; // Top
+		frustumPlanes[ 4 ] = m[ 2 ];          // Near
+		frustumPlanes[ 5 ] = m[ 3 ] - m[ 2 ]; // Far
+
+		for( int i = 0; i < 6; i++ )
+			frustumPlanes[ i ] /= max( length( frustumPlanes[ i ].xyz ), 1e-6 );
+
+		visibleIndexCount = 0;
+	}
+
+	barrier();
+
+	for( uint i = gl_LocalInvocationIndex; i < draw.MeshletCount; i += THREAD_COUNT )
+	{
+		Meshlet meshlet = s_Meshlets.Meshlets[ draw.MeshletOffset + i ];
+
+		bool visible = false;
+
+		for( uint instance = 0; instance < instanceCount && !visible; instance++ )
+			visible = IsVisible( s_Instances.Instances[ draw.InstanceOffset + instance ], meshlet );
+
+		if( !visible )
+			continue;
+
+		uint offset = atomicAdd( visibleIndexCount, meshlet.IndexCount );
+		uint source = draw.SourceFirstIndex + meshlet.FirstIndex;
+		uint destination = draw.OutputOffset + offset;
+
+		for( uint index = 0; index < meshlet.IndexCount; index++ )
+			s_OutputIndices.Indices[ destination + index ] = s_SourceIndices.Indices[ source + index ];
+	}
+
+	barrier();
+
+	// Instance count and vertex offset are left as instance culling wrote them.
+	if( gl_LocalInvocationIndex == 0 )
+	{
+		s_Commands.Commands[ draw.CommandIndex ].IndexCount = visibleIndexCount;
+		s_Commands.Commands[ draw.CommandIndex ].FirstIndex = draw.OutputOffset;
+	}
+}
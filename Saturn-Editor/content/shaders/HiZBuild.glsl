@@ -0,0 +1,60 @@
+// Hierarchical Z build shader
+// Every level holds the farthest depth of the 2x2 texels below it, level 0 is half the resolution of the pre depth buffer.
+// An object whose nearest depth is behind every texel that its screen bounds touch is hidden.
+
+#type compute
+#version 450 core
+
+// Only read for level 0.
+layout(set = 0, binding = 0) uniform sampler2D u_Depth;
+
+layout(set = 0, binding = 1, r32f) uniform readonly image2D u_Source;
+layout(set = 0, binding = 2, r32f) uniform writeonly image2D o_HiZ;
+
+// Coarse levels are also written here so the CPU can test against them.
+layout(std430, set = 0, binding = 3) writeonly buffer HiZReadback
+{
+	float Texels[];
+} s_Readback;
+
+layout(push_constant) uniform pc_HiZ
+{
+	ivec2 SourceSize;
+	ivec2 DestSize;
+
+	uint FromDepth;
+
+	// 0xFFFFFFFF when this level is not read back.
+	uint ReadbackOffset;
+} u_HiZ;
+
+float LoadSource( ivec2 texel )
+{
+	texel = min( texel, u_HiZ.SourceSize - 1 );
+
+	if( u_HiZ.FromDepth != 0 )
+		return texelFetch( u_Depth, texel, 0 ).r;
+	
+	return imageLoad( u_Source, texel ).r;
+}
+
+layout( local_size_x = 8, local_size_y = 8, local_size_z = 1 ) in;
+void main()
+{
+	ivec2 texel = ivec2( gl_GlobalInvocationID.xy );
+
+	if( any( greaterThanEqual( texel, u_HiZ.DestSize ) ) )
+		return;
+
+	// The destination is rounded up so the last row and column can read past the edge, they are clamped.
+	ivec2 source = texel * 2;
+
+	float depth = max( 
+		max( LoadSource( source ), LoadSource( source + ivec2( 1, 0 ) ) ),
+		max( LoadSource( source + ivec2( 0, 1 ) ), LoadSource( source + ivec2( 1, 1 ) ) ) );
+
+	imageStore( o_HiZ, texel, vec4( depth ) );
+
+	if( u_HiZ.ReadbackOffset != 0xFFFFFFFFu )
+		s_Readback.Texels[ u_HiZ.ReadbackOffset + texel.y * u_HiZ.DestSize.x + texel.x ] = depth;
+}
@@ -0,0 +1,200 @@
+// Instance culling shader
+// Every workgroup culls the instances of one draw against one view (the camera or a shadow cascade).
+// Visible transforms are compacted into the culled instance buffer and the draw's indirect command is written with the visible count.
+// Layered views (shadow cascades) share one command per draw, an instance is written once for every layer it overlaps.
+
+#type compute
+#version 450 core
+
+struct Transform
+{
+	vec4 Rows[4];
+};
+
+// Must match with "CullDraw" in InstanceCulling.cpp.
+struct CullDraw
+{
+	vec4 BoundsMin;
+	vec4 BoundsMax;
+
+	uint InstanceOffset;
+	uint InstanceCount;
+	uint OutputOffset;
+
+	uint IndexCount;
+	uint FirstIndex;
+	int VertexOffset;
+
+	// Bit per view.
+	uint ViewMask;
+
+	// Index range for the views in "ShadowViewMask".
+	uint ShadowIndexCount;
+	uint ShadowFirstIndex;
+
+	uint Padding[3];
+};
+
+struct CullView
+{
+	vec4 Planes[6];
+};
+
+// Must match with VkDrawIndexedIndirectCommand.
+struct DrawIndexedCommand
+{
+	uint IndexCount;
+	uint InstanceCount;
+	uint FirstIndex;
+	int VertexOffset;
+	uint FirstInstance;
+};
+
+// GPUScene instance buffer.
+layout(std430, set = 0, binding = 0) readonly buffer InstanceBuffer
+{
+	Transform Instances[];
+} s_Instances;
+
+layout(std430, set = 0, binding = 1) readonly buffer CullDrawBuffer
+{
+	CullDraw Draws[];
+} s_Draws;
+
+layout(std430, set = 0, binding = 2) readonly buffer CullViewBuffer
+{
+	CullView Views[];
+} s_Views;
+
+layout(std430, set = 0, binding = 3) writeonly buffer IndirectBuffer
+{
+	DrawIndexedCommand Commands[];
+} s_Commands;
+
+layout(std430, set = 0, binding = 4) writeonly buffer CulledInstanceBuffer
+{
+	Transform Instances[];
+} s_CulledInstances;
+
+layout(push_constant) uniform pc_Cull
+{
+	uint DrawCount;
+	uint ViewCount;
+
+	// Consecutive views, the first one owns the command and output of all of them.
+	uint LayeredViewMask;
+
+	// Views that draw the shadow LOD.
+	uint ShadowViewMask;
+} u_Cull;
+
+#define THREAD_COUNT 64
+
+shared uint visibleCount;
+
+bool IsVisible( Transform transform, CullView view, vec3 center, vec3 extents )
+{
+	// Transform the box into world space, the bottom row is always ( 0, 0, 0, 1 ).
+	vec3 worldCenter = vec3(
+		dot( transform.Rows[ 0 ], vec4( center, 1.0 ) ),
+		dot( transform.Rows[ 1 ], vec4( center, 1.0 ) ),
+		dot( transform.Rows[ 2 ], vec4( center, 1.0 ) ) );
+
+	vec3 worldExtents = vec3(
+		dot( abs( transform.Rows[ 0 ].xyz ), extents ),
+		dot( abs( transform.Rows[ 1 ].xyz ), extents ),
+		dot( abs( transform.Rows[ 2 ].xyz ), extents ) );
+
+	for( int i = 0; i < 6; i++ )
+	{
+		vec4 plane = view.Planes[ i ];
+
+		if( dot( plane.xyz, worldCenter ) + plane.w + dot( abs( plane.xyz ), worldExtents ) < 0.0 )
+			return false;
+	}
+
+	return true;
+}
+
+layout( local_size_x = THREAD_COUNT, local_size_y = 1, local_size_z = 1 ) in;
+void main()
+{
+	uint drawIndex = gl_WorkGroupID.x;
+	uint viewIndex = gl_WorkGroupID.y;
+
+	CullDraw draw = s_Draws.Draws[ drawIndex ];
+	CullView view = s_Views.Views[ viewIndex ];
+
+	uint firstLayer = findLSB( u_Cull.LayeredViewMask );
+	bool layered = ( u_Cull.LayeredViewMask & ( 1u << viewIndex ) ) != 0;
+
+	// The whole workgroup leaves, the first layered view does the work for the others.
+	if( layered && viewIndex != firstLayer )
+		return;
+
+	if( gl_LocalInvocationIndex == 0 )
+		visibleCount = 0;
+
+	barrier();
+
+	// Every draw owns "ViewCount * InstanceCount" output slots, one block per view.
+	uint outputBase = draw.OutputOffset * u_Cull.ViewCount + viewIndex * draw.InstanceCount;
+
+	vec3 center = ( draw.BoundsMin.xyz + draw.BoundsMax.xyz ) * 0.5;
+	vec3 extents = ( draw.BoundsMax.xyz - draw.BoundsMin.xyz ) * 0.5;
+
+	if( layered )
+	{
+		uint layerMask = u_Cull.LayeredViewMask & draw.ViewMask;
+
+		for( uint i = gl_LocalInvocationIndex; i < draw.InstanceCount; i += THREAD_COUNT )
+		{
+			Transform transform = s_Instances.Instances[ draw.InstanceOffset + i ];
+
+			for( uint layer = firstLayer; layer < u_Cull.ViewCount; layer++ )
+			{
+				if( ( layerMask & ( 1u << layer ) ) == 0 || !IsVisible( transform, s_Views.Views[ layer ], center, extents ) )
+					continue;
+
+				uint id = atomicAdd( visibleCount, 1 );
+
+				// The bottom row of the transform is always ( 0, 0, 0, 1 ), x holds the layer instead.
+				Transform layeredTransform = transform;
+				layeredTransform.Rows[ 3 ].x = float( layer - firstLayer );
+
+				s_CulledInstances.Instances[ outputBase + id ] = layeredTransform;
+			}
+		}
+	}
+	else if( ( draw.ViewMask & ( 1u << viewIndex ) ) != 0 )
+	{
+		for( uint i = gl_LocalInvocationIndex; i < draw.InstanceCount; i += THREAD_COUNT )
+		{
+			Transform transform = s_Instances.Instances[ draw.InstanceOffset + i ];
+
+			if( IsVisible( transform, view, center, extents ) )
+			{
+				uint id = atomicAdd( visibleCount, 1 );
+
+				s_CulledInstances.Instances[ outputBase + id ] = transform;
+			}
+		}
+	}
+
+	barrier();
+
+	// The whole command is written every frame, so nothing has to be reset on the CPU.
+	if( gl_LocalInvocationIndex == 0 )
+	{
+		bool shadow = ( u_Cull.ShadowViewMask & ( 1u << viewIndex ) ) != 0;
+
+		DrawIndexedCommand command;
+		command.IndexCount = shadow ? draw.ShadowIndexCount : draw.IndexCount;
+		command.InstanceCount = visibleCount;
+		command.FirstIndex = shadow ? draw.ShadowFirstIndex : draw.FirstIndex;
+		command.VertexOffset = draw.VertexOffset;
+		command.FirstInstance = 0;
+
+		s_Commands.Commands[ viewIndex * u_Cull.DrawCount + drawIndex ] = command;
+	}
+}
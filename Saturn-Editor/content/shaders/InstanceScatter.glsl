@@ -0,0 +1,41 @@
+// Instance scatter shader
+// Copies the transforms that changed this frame into their slot in the persistent instance buffer.
+
+#type compute
+#version 450 core
+
+// Must match with TransformBufferData, 4 rows per instance.
+layout(std430, set = 0, binding = 0) writeonly buffer InstanceBuffer
+{
+	vec4 Rows[];
+} s_Instances;
+
+struct InstanceDelta
+{
+	vec4 Rows[4];
+	uint Slot;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer InstanceDeltaBuffer
+{
+	InstanceDelta Deltas[];
+} s_Deltas;
+
+layout(push_constant) uniform pc_Scatter
+{
+	uint DeltaCount;
+} u_Scatter;
+
+layout( local_size_x = 64, local_size_y = 1, local_size_z = 1 ) in;
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+
+	if( index >= u_Scatter.DeltaCount )
+		return;
+
+	uint base = s_Deltas.Deltas[ index ].Slot * 4;
+
+	for( uint i = 0; i < 4; i++ )
+		s_Instances.Rows[ base + i ] = s_Deltas.Deltas[ index ].Rows[ i ];
+}
@@ -1,6 +1,7 @@
-// Light Culling shader
-// Based from https://github.com/bcrusco/Forward-Plus-Renderer/blob/master/Forward-Plus/Forward-Plus/source/shaders/light_culling.comp.glsl
-//			  https://github.com/WindyDarian/Vulkan-Forward-Plus-Renderer/blob/master/src/shaders/light_culling.comp.glsl
+// Clustered light culling shader
+// The view frustum is split into a 3D grid of clusters (screen tiles * exponential depth slices), every workgroup builds the light list for one cluster.
+// Based from http://www.aortiz.me/2018/12/21/CG.html
+//			  https://www.humus.name/Articles/PracticalClusteredShading.pdf
 
 #type compute
 #version 450 core
@@ -17,157 +18,151 @@ struct PointLight
 	float Falloff;
 };
 
-layout(set = 0, binding = 0) uniform PointLightData
+// Must match with static meshes shader.
+layout(std430, set = 0, binding = 0) readonly buffer PointLightBuffer
 {
 	uint nbLights;
-	PointLight Lights[1024];
-} u_Lights;
+	PointLight Lights[];
+} s_PointLights;
 
-// Must match with static meshes shader.
-layout(std430, set = 0, binding = 14) buffer VisiblePointLightIndicesBuffer
+// x = offset into the index list, y = light count.
+layout(std430, set = 0, binding = 1) writeonly buffer LightClusterBuffer
+{
+	uvec2 Clusters[];
+} s_LightClusters;
+
+layout(std430, set = 0, binding = 2) writeonly buffer LightIndexBuffer
 {
-	int Indices[];
-} s_VisiblePointLightIndicesBuffer;
+	uint Indices[];
+} s_LightIndices;
 
-layout(std140, binding = 3) uniform ScreenData
+// Reset by the CPU every frame, also read back to know how large the index list needs to be.
+layout(std430, set = 0, binding = 3) buffer LightIndexCounter
 {
-	vec2 FullResolution;
-} u_ScreenInfo;
+	uint Count;
+} s_LightIndexCounter;
 
-layout(set = 0, binding = 4) uniform Matrices 
+layout(push_constant) uniform pc_ClusterData
 {
-	mat4 ViewProjection;
-	mat4 Projection;
 	mat4 View;
-	mat4 InvP;
-} u_Matrices;
 
-layout(set = 0, binding = 6) uniform sampler2D u_PreDepth;
+	// x, y = 1 / Projection[0][0], 1 / Projection[1][1], z = Near, w = Far
+	vec4 ProjectionParams;
 
-#define MAX_LIGHT_COUNT 1024
-#define TILE_SIZE 16
+	// xy = tile size / resolution, the last row and column of tiles can go past the edge of the screen.
+	vec4 TileScale;
 
-// Shared values between all the threads in the group
-shared uint minDepthInt;
-shared uint maxDepthInt;
-shared uint visibleLightCount;
-shared vec4 frustumPlanes[6];
+	// xyz = cluster count, w = index list capacity
+	uvec4 ClusterCount;
+} u_ClusterData;
 
-shared int visibleLightIndices[MAX_LIGHT_COUNT];
+#define THREAD_COUNT 128
 
-layout( local_size_x = TILE_SIZE, local_size_y = TILE_SIZE, local_size_z = 1 ) in;
-void main() 
+shared vec3 clusterMin;
+shared vec3 clusterMax;
+shared uint clusterLightCount;
+shared uint clusterOffset;
+shared uint clusterWriteIndex;
+
+// Position of a point on the view ray through "ndc" at the linear depth "z".
+vec3 ViewRayAtDepth( vec2 ndc, float z )
 {
-	ivec2 location = ivec2(gl_GlobalInvocationID.xy);
-	ivec2 itemID = ivec2(gl_LocalInvocationID.xy);
-	ivec2 tileID = ivec2(gl_WorkGroupID.xy);
-	ivec2 tileNumber = ivec2(gl_NumWorkGroups.xy);
+	return vec3( ndc * u_ClusterData.ProjectionParams.xy, -1.0 ) * z;
+}
 
-	uint index = tileID.y * tileNumber.x + tileID.x;
+bool LightIntersectsCluster( uint lightIndex )
+{
+	PointLight light = s_PointLights.Lights[ lightIndex ];
 
-	if (gl_LocalInvocationIndex == 0) 
-	{
-		minDepthInt = 0xFFFFFFFF;
-		maxDepthInt = 0;
-		visibleLightCount = 0;
-
-		uint index = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
-		uint offset = index * 1024;
-		for (uint i = 0; i < 1024; i++) {
-			s_VisiblePointLightIndicesBuffer.Indices[offset + i] = -1;
-		}
-	}
+	vec3 center = ( u_ClusterData.View * vec4( light.Position, 1.0 ) ).xyz;
 
-	barrier();
+	// Attenuation in the static mesh shader reaches zero at sqrt( 10 ) * Radius.
+	float range = light.Radius * 3.1623;
 
-	// Step 1: Calculate the minimum and maximum depth values (from the depth buffer) for this group's tile.
+	vec3 closest = clamp( center, clusterMin, clusterMax );
+	vec3 delta = closest - center;
 
-	float minDepth, maxDepth;
+	return dot( delta, delta ) <= range * range;
+}
 
-	vec2 tc = gl_GlobalInvocationID.xy / u_ScreenInfo.FullResolution;
-	float depth = texture(u_PreDepth, tc).r;
+layout( local_size_x = THREAD_COUNT, local_size_y = 1, local_size_z = 1 ) in;
+void main()
+{
+	uvec3 clusterID = gl_WorkGroupID;
+	uvec3 clusterCount = u_ClusterData.ClusterCount.xyz;
+	uint clusterIndex = clusterID.x + clusterID.y * clusterCount.x + clusterID.z * clusterCount.x * clusterCount.y;
 
-	//depth = 2.0f * ( 0.5 * u_Matrices.Projection[3][2] ) / ( depth + 0.5 * u_Matrices.Projection[2][2] - 0.5 );
+	uint lightCount = s_PointLights.nbLights;
 
-	// Convert depth to uint so we can do atomic min and max comparisons between the threads
-	uint depthInt = floatBitsToUint(depth);
-	atomicMin(minDepthInt, depthInt);
-	atomicMax(maxDepthInt, depthInt);
+	// Step 1: Build the view space AABB for this cluster.
+	if( gl_LocalInvocationIndex == 0 )
+	{
+		float near = u_ClusterData.ProjectionParams.z;
+		float far = u_ClusterData.ProjectionParams.w;
 
-	barrier();
+		// Exponential depth slices.
+		float sliceNear = near * pow( far / near, float( clusterID.z ) / float( clusterCount.z ) );
+		float sliceFar = near * pow( far / near, float( clusterID.z + 1 ) / float( clusterCount.z ) );
 
-	// Step 2: One thread should calculate the frustum planes to be used for this tile
-	if (gl_LocalInvocationIndex == 0) 
-	{
-		// Convert the min and max across the entire tile back to float
-		minDepth = uintBitsToFloat(minDepthInt);
-		maxDepth = uintBitsToFloat(maxDepthInt);
-
-		// Steps based on tile sale
-		vec2 negativeStep = (2.0 * vec2(tileID)) / vec2(tileNumber);
-		vec2 positiveStep = (2.0 * vec2(tileID + ivec2(1, 1))) / vec2(tileNumber);
-
-		// Set up starting values for planes using steps and min and max z values
-		frustumPlanes[0] = vec4(1.0, 0.0, 0.0, 1.0 - negativeStep.x); // Left
-		frustumPlanes[1] = vec4(-1.0, 0.0, 0.0, -1.0 + positiveStep.x); // Right
-		frustumPlanes[2] = vec4(0.0, 1.0, 0.0, 1.0 - negativeStep.y); // Bottom
-		frustumPlanes[3] = vec4(0.0, -1.0, 0.0, -1.0 + positiveStep.y); // Top
-		frustumPlanes[4] = vec4(0.0, 0.0, -1.0, -minDepth); // Near
-		frustumPlanes[5] = vec4(0.0, 0.0, 1.0, maxDepth); // Far
-
-		// Transform the first four planes
-		for (uint i = 0; i < 4; i++) {
-			frustumPlanes[i] *= u_Matrices.ViewProjection;
-			frustumPlanes[i] /= length(frustumPlanes[i].xyz);
-		}
+		vec2 ndcMin = vec2( clusterID.xy ) * u_ClusterData.TileScale.xy * 2.0 - 1.0;
+		vec2 ndcMax = vec2( clusterID.xy + 1 ) * u_ClusterData.TileScale.xy * 2.0 - 1.0;
+
+		vec3 p0 = ViewRayAtDepth( ndcMin, sliceNear );
+		vec3 p1 = ViewRayAtDepth( ndcMax, sliceNear );
+		vec3 p2 = ViewRayAtDepth( ndcMin, sliceFar );
+		vec3 p3 = ViewRayAtDepth( ndcMax, sliceFar );
 
-		// Transform the depth planes
-		frustumPlanes[4] *= u_Matrices.View;
-		frustumPlanes[4] /= length(frustumPlanes[4].xyz);
-		frustumPlanes[5] *= u_Matrices.View;
-		frustumPlanes[5] /= length(frustumPlanes[5].xyz);
+		clusterMin = min( min( p0, p1 ), min( p2, p3 ) );
+		clusterMax = max( max( p0, p1 ), max( p2, p3 ) );
+
+		clusterLightCount = 0;
+		clusterWriteIndex = 0;
 	}
 
 	barrier();
 
-	// Step 3: Cull lights.
+	// Step 2: Count the lights touching this cluster, the index list is compacted so we need to know how much space to reserve.
+	uint localCount = 0;
+	for( uint i = gl_LocalInvocationIndex; i < lightCount; i += THREAD_COUNT )
+	{
+		if( LightIntersectsCluster( i ) )
+			localCount++;
+	}
+
+	if( localCount > 0 )
+		atomicAdd( clusterLightCount, localCount );
 
-	uint threadCount = TILE_SIZE * TILE_SIZE;
-	uint passCount = (u_Lights.nbLights + threadCount - 1) / threadCount;
+	barrier();
 
-	for( uint i = gl_LocalInvocationIndex; i < u_Lights.nbLights; i += threadCount )
+	// Step 3: Reserve our range in the global index list.
+	if( gl_LocalInvocationIndex == 0 )
 	{
-		PointLight light = u_Lights.Lights[i];
+		uint offset = clusterLightCount > 0 ? atomicAdd( s_LightIndexCounter.Count, clusterLightCount ) : 0;
+		uint capacity = u_ClusterData.ClusterCount.w;
 
-		vec4 pos = u_Matrices.View * vec4( light.Position, 1.0 );
+		// The list is grown on the CPU when the count is read back, until then drop what does not fit.
+		uint count = offset < capacity ? min( clusterLightCount, capacity - offset ) : 0;
 
-		if( visibleLightCount < MAX_LIGHT_COUNT ) 
-		{
-			bool IntersectsFrustum = true;
-
-			for( uint j = 0; j < 6 && IntersectsFrustum; j++ ) 
-			{
-				float x = dot( frustumPlanes[j], pos );
-				float r = light.Radius + light.Radius * 4.0f;
-
-				IntersectsFrustum = (x >= -r);
-			}
-			if( IntersectsFrustum )
-			{
-				uint id = atomicAdd( visibleLightCount, 1 );
-				visibleLightIndices[id] = int(i);
-			}
-		}
+		clusterOffset = offset;
+		clusterLightCount = count;
+
+		s_LightClusters.Clusters[ clusterIndex ] = uvec2( offset, count );
 	}
 
 	barrier();
 
-	// One thread should fill the global light buffer
-	if (gl_LocalInvocationIndex == 0)
+	if( clusterLightCount == 0 )
+		return;
+
+	// Step 4: Write the light indices.
+	for( uint i = gl_LocalInvocationIndex; i < lightCount; i += THREAD_COUNT )
 	{
-		uint offset = index * MAX_LIGHT_COUNT; // Determine bosition in global buffer
-		for (uint i = 0; i < visibleLightCount; i++) {
-			s_VisiblePointLightIndicesBuffer.Indices[offset + i] = visibleLightIndices[i];
+		if( LightIntersectsCluster( i ) )
+		{
+			uint id = atomicAdd( clusterWriteIndex, 1 );
+
+			if( id < clusterLightCount )
+				s_LightIndices.Indices[ clusterOffset + id ] = i;
 		}
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,67 @@
+#type vertex
+#version 450
+
+// Inputs
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec4 a_Color;
+layout(location = 2) in vec2 a_TexCoord;
+layout(location = 3) in float a_TextureIndex;
+
+layout(set = 0, binding = 0) uniform Matrices
+{
+	mat4 ViewProjection;
+} u_Matrices;
+
+layout(push_constant) uniform pc_Transform
+{
+	mat4 Transform;
+} u_Transform; 
+
+struct VertOut 
+{
+	vec2 TexCoord;
+	vec4 Color;
+};
+
+layout( location = 0 ) out VertOut o_OutputData;
+layout( location = 2 ) out flat float o_TexIndex;
+
+void main() 
+{
+	o_OutputData.Color = a_Color;
+	o_OutputData.TexCoord = a_TexCoord;
+	o_TexIndex = a_TextureIndex;
+
+	gl_Position = u_Matrices.ViewProjection * u_Transform.Transform * vec4( a_Position, 1.0 );
+}
+
+#type fragment
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+struct VertOut 
+{
+	vec2 TexCoord;
+	vec4 Color;
+};
+
+layout( location = 0 ) in VertOut o_InputData;
+layout( location = 2 ) in flat float o_TexIndex;
+
+layout( location = 0 ) out vec4 FinalColor;
+
+layout(set = 0, binding = 0) uniform Matrices
+{
+	mat4 ViewProjection;
+} u_Matrices;
+
+// Global texture array, see BindlessResources.
+layout( set = 1, binding = 0 ) uniform sampler2D u_Textures[];
+
+void main() 
+{
+	FinalColor = texture( u_Textures[ nonuniformEXT( int(o_TexIndex) ) ], o_InputData.TexCoord ) * o_InputData.Color;
+
+	if( FinalColor.a == 0.0 )
+		discard;
+}
\ No newline at end of file
@@ -4,15 +4,14 @@
 #version 430
 
 layout(location = 0) in vec3 a_Position;
-layout(location = 1) in vec3 a_Normal;
-layout(location = 2) in vec3 a_Tangent;
-layout(location = 3) in vec3 a_Bitangent;
-layout(location = 4) in vec2 a_TexCoord;
-
-layout(location = 5) in vec4 a_TransformBufferR1;
-layout(location = 6) in vec4 a_TransformBufferR2;
-layout(location = 7) in vec4 a_TransformBufferR3;
-layout(location = 8) in vec4 a_TransformBufferR4;
+layout(location = 1) in vec2 a_Normal;
+layout(location = 2) in vec4 a_Tangent;
+layout(location = 3) in vec2 a_TexCoord;
+
+layout(location = 4) in vec4 a_TransformBufferR1;
+layout(location = 5) in vec4 a_TransformBufferR2;
+layout(location = 6) in vec4 a_TransformBufferR3;
+layout(location = 7) in vec4 a_TransformBufferR4;
 
 layout(set = 0, binding = 0) uniform Matrices
 {
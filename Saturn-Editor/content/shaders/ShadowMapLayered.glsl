@@ -0,0 +1,49 @@
+// Layered Shadow Map shader
+// Renders every cascade in one pass, the cascade is the push constant plus the layer that instance culling stored in the transform.
+// Needs VK_EXT_shader_viewport_index_layer.
+
+#type vertex
+#version 450
+#extension GL_ARB_shader_viewport_layer_array : require
+
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec2 a_Normal;
+layout(location = 2) in vec4 a_Tangent;
+layout(location = 3) in vec2 a_TexCoord;
+
+layout(location = 4) in vec4 a_TransformBufferR1;
+layout(location = 5) in vec4 a_TransformBufferR2;
+layout(location = 6) in vec4 a_TransformBufferR3;
+layout(location = 7) in vec4 a_TransformBufferR4;
+
+layout(set = 0, binding = 0) uniform Matrices
+{
+	mat4 ViewProjection[4];
+} u_Matrices;
+
+layout(push_constant) uniform u_Transform
+{
+	uint CascadeIndex;
+};
+
+void main()
+{
+	// The bottom row is not read, x is the layer for culled instances and 0 otherwise.
+	mat4 transform = mat4(
+		a_TransformBufferR1.x, a_TransformBufferR2.x, a_TransformBufferR3.x, 0.0,
+		a_TransformBufferR1.y, a_TransformBufferR2.y, a_TransformBufferR3.y, 0.0,
+		a_TransformBufferR1.z, a_TransformBufferR2.z, a_TransformBufferR3.z, 0.0,
+		a_TransformBufferR1.w, a_TransformBufferR2.w, a_TransformBufferR3.w, 1.0  );
+
+	uint cascade = CascadeIndex + uint( a_TransformBufferR4.x + 0.5 );
+
+	gl_Layer = int( cascade );
+	gl_Position = u_Matrices.ViewProjection[ cascade ] * transform * vec4( a_Position, 1.0 );
+}
+
+#type fragment
+#version 450
+
+void main()
+{
+}
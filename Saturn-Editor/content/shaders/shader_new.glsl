@@ -11,17 +11,17 @@
 #type vertex
 #version 450
 
+// Must match with "CompactStaticVertex", see VertexCompression.cpp for the encoding.
 layout(location = 0) in vec3 a_Position;
-layout(location = 1) in vec3 a_Normal;
-layout(location = 2) in vec3 a_Tangent;
-layout(location = 3) in vec3 a_Binormal;
-layout(location = 4) in vec2 a_TexCoord;
+layout(location = 1) in vec2 a_Normal;  // Octahedral
+layout(location = 2) in vec4 a_Tangent; // Octahedral in xy (0 - 1), w = binormal sign (0 or 1)
+layout(location = 3) in vec2 a_TexCoord;
 
 // I don't really know if we need the last colunm as it's always 0.0, 0.0, 0.0, 1.0. Meaning we could use a mat3
-layout(location = 5) in vec4 a_TransformBufferR1;
-layout(location = 6) in vec4 a_TransformBufferR2;
-layout(location = 7) in vec4 a_TransformBufferR3;
-layout(location = 8) in vec4 a_TransformBufferR4;
+layout(location = 4) in vec4 a_TransformBufferR1;
+layout(location = 5) in vec4 a_TransformBufferR2;
+layout(location = 6) in vec4 a_TransformBufferR3;
+layout(location = 7) in vec4 a_TransformBufferR4;
 
 layout(binding = 0) uniform Matrices 
 {
@@ -51,6 +51,17 @@ struct VertexOutput
 
 layout( location = 1 ) out VertexOutput vs_Output;
 
+vec3 OctahedralDecode( vec2 e )
+{
+	vec3 v = vec3( e.x, e.y, 1.0 - abs( e.x ) - abs( e.y ) );
+
+	float fold = max( -v.z, 0.0 );
+	v.x += v.x >= 0.0 ? -fold : fold;
+	v.y += v.y >= 0.0 ? -fold : fold;
+
+	return normalize( v );
+}
+
 void main()
 {
 	mat4 transform = mat4( 
@@ -63,11 +74,16 @@ void main()
 
 	vs_Output.Position   = WorldPos.xyz;
 	vs_Output.TexCoord   = vec2( a_TexCoord.x, 1.0 - a_TexCoord.y );
-	vs_Output.Normal = mat3( transform ) * a_Normal;
 
-	vs_Output.WorldNormals = mat3( transform ) * mat3( a_Tangent, a_Binormal, a_Normal );
+	vec3 normal = OctahedralDecode( a_Normal );
+	vec3 tangent = OctahedralDecode( a_Tangent.xy * 2.0 - 1.0 );
+	vec3 binormal = cross( normal, tangent ) * ( a_Tangent.w > 0.5 ? 1.0 : -1.0 );
+
+	vs_Output.Normal = mat3( transform ) * normal;
+
+	vs_Output.WorldNormals = mat3( transform ) * mat3( tangent, binormal, normal );
 
-	vs_Output.Bionormal = a_Binormal;
+	vs_Output.Bionormal = binormal;
 
 	vs_Output.CameraView = mat3( u_Matrices.View );
 
@@ -136,23 +152,13 @@ layout(set = 0, binding = 3) uniform ShadowData
 	vec4 CascadeSplits;
 };
 
-layout(set = 0, binding = 12) uniform DebugData 
+layout(set = 0, binding = 12) uniform ClusterData 
 {
-	// Very temp.
-	int TilesCountX;
-} u_DebugData;
-
-// TODO: Change number of lights...
-layout(set = 0, binding = 13) uniform Lights 
-{
-	uint nbLights;
-	PointLight Lights[1024];
-} u_Lights;
-
-layout(std430, set = 0, binding = 14) buffer VisiblePointLightIndicesBuffer
-{
-	int Indices[];
-} s_VisiblePointLightIndicesBuffer;
+	// xyz = cluster count, w = tile size in pixels
+	uvec4 ClusterCount;
+	// x = slice scale, y = slice bias
+	vec2 ClusterZParams;
+} u_ClusterData;
 
 // Textures
 layout (set = 0, binding = 4) uniform sampler2D u_AlbedoTexture;
@@ -166,6 +172,24 @@ layout (set = 1, binding = 9) uniform samplerCube u_EnvRadianceTex;
 layout (set = 1, binding = 10) uniform samplerCube u_EnvIrradianceTex;
 layout (set = 1, binding = 11) uniform sampler2D u_BRDFLUTTexture;
 
+// Set 1, clustered lighting, see LightCulling.glsl.
+layout(std430, set = 1, binding = 13) readonly buffer PointLightBuffer
+{
+	uint nbLights;
+	PointLight Lights[];
+} s_PointLights;
+
+// x = offset into the index list, y = light count.
+layout(std430, set = 1, binding = 14) readonly buffer LightClusterBuffer
+{
+	uvec2 Clusters[];
+} s_LightClusters;
+
+layout(std430, set = 1, binding = 15) readonly buffer LightIndexBuffer
+{
+	uint Indices[];
+} s_LightIndices;
+
 layout (location = 0) out vec4 FinalColor;
 layout (location = 1) out vec4 OutViewNormals;
 layout (location = 2) out vec4 OutAlbedo;
@@ -350,45 +374,42 @@ vec3 IBL(vec3 F0, vec3 Lr)
 }
 
 //////////////////////////////////////////////////////////////////////////
-// Forward+
-int GetPointLightBufferIndex(int i)
+// Clustered Forward
+uint GetClusterIndex()
 {
-	ivec2 tileID = ivec2(gl_FragCoord) / ivec2(16, 16);
-	uint index = tileID.y * u_DebugData.TilesCountX + tileID.x;
+	uvec3 clusterCount = u_ClusterData.ClusterCount.xyz;
 
-	uint offset = index * 1024;
-	return s_VisiblePointLightIndicesBuffer.Indices[offset + i];
-}
+	uvec2 tileID = uvec2( gl_FragCoord.xy ) / u_ClusterData.ClusterCount.w;
 
-int GetPointLightCount()
-{
-	int result = 0;
-	for (int i = 0; i < u_Lights.nbLights; i++)
-	{
-		uint lightIndex = GetPointLightBufferIndex(i);
-		if (lightIndex == -1)
-			break;
+	// Exponential depth slices, must match LightCulling.glsl.
+	float viewDepth = max( -vs_Input.ViewPosition.z, 0.0001 );
+	uint slice = uint( max( log( viewDepth ) * u_ClusterData.ClusterZParams.x - u_ClusterData.ClusterZParams.y, 0.0 ) );
+	slice = min( slice, clusterCount.z - 1 );
 
-		result++;
-	}
+	tileID = min( tileID, clusterCount.xy - 1 );
 
-	return result;
+	return tileID.x + tileID.y * clusterCount.x + slice * clusterCount.x * clusterCount.y;
 }
 
+uint GetPointLightCount()
+{
+	return s_LightClusters.Clusters[ GetClusterIndex() ].y;
+}
 
 //////////////////////////////////////////////////////////////////////////
-// Forward+, Point Lights
+// Clustered Forward, Point Lights
 
 vec3 CalculatePointLights(in vec3 F0, vec3 worldPos)
 {
 	vec3 result = vec3(0.0);
-	for (int i = 0; i < u_Lights.nbLights; i++)
+
+	uvec2 cluster = s_LightClusters.Clusters[ GetClusterIndex() ];
+
+	for (uint i = 0; i < cluster.y; i++)
 	{
-		uint lightIndex = GetPointLightBufferIndex(i);
-		if (lightIndex == -1)
-			break;
+		uint lightIndex = s_LightIndices.Indices[ cluster.x + i ];
 
-		PointLight light = u_Lights.Lights[lightIndex];
+		PointLight light = s_PointLights.Lights[lightIndex];
 		vec3 Li = normalize(light.Position - worldPos);
 		float lightDistance = length(light.Position - worldPos);
 		vec3 Lh = normalize(Li + m_Params.View);
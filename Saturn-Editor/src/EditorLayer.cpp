@@ -48,6 +48,8 @@
 #include <Saturn/Serialisation/AssetBundle.h>
 
 #include <Saturn/Physics/PhysicsFoundation.h>
+#include <Saturn/Core/WorkerPool.h>
+#include <Saturn/Physics/PhysicsScene.h>
 
 #include <Saturn/Vulkan/MaterialInstance.h>
 #include <Saturn/Vulkan/ShaderBundle.h>
@@ -239,10 +241,6 @@ namespace Saturn {
 		EditorIcons::AddIcon( m_PointLightTexture );
 		EditorIcons::AddIcon( m_ExclamationTexture );
 
-		// Init Physics
-		PhysicsFoundation* pPhysicsFoundation = new PhysicsFoundation();
-		pPhysicsFoundation->Init();
-
 		Ref<ContentBrowserPanel> contentBrowserPanel = m_PanelManager->GetPanel<ContentBrowserPanel>();
 
 		auto& rUserSettings = EngineSettings::Get();
@@ -252,6 +250,10 @@ namespace Saturn {
 
 		SAT_CORE_ASSERT( Project::GetActiveProject(), "No project was given." );
 		
+		// Init Physics, after the project as the tolerance scale comes from the project's physics settings.
+		PhysicsFoundation* pPhysicsFoundation = new PhysicsFoundation();
+		pPhysicsFoundation->Init();
+
 		VirtualFS::Get().MountBase( Project::GetActiveConfig().Name, rUserSettings.StartupProject );
 
 		AssetManager* pAssetManager = new AssetManager();
@@ -454,6 +456,45 @@ namespace Saturn {
 
 		ImGui::Text( "Frame Time: %.2f ms", Application::Get().Time().Milliseconds() );
 
+		if( PhysicsScene* pPhysicsScene = m_RuntimeScene ? m_RuntimeScene->GetPhysicsScene() : nullptr )
+		{
+			const PhysicsStepStats& rStats = pPhysicsScene->GetStats();
+
+			ImGui::Text( "Physics: %u steps, %.2f ms overlapped, %.2f ms waiting", rStats.Steps, rStats.OverlapTime, rStats.WaitTime );
+			ImGui::Text( "Physics: %u active bodies", rStats.ActiveBodies );
+		}
+
+		// Takes effect the next time the runtime starts, flip it to compare step times against PhysX's own threads.
+		bool UseEngineWorkers = PhysicsFoundation::Get().IsUsingEngineWorkers();
+		if( ImGui::Checkbox( "Physics on engine workers", &UseEngineWorkers ) )
+			PhysicsFoundation::Get().SetUseEngineWorkers( UseEngineWorkers );
+
+		int WorkerBudget = ( int ) PhysicsFoundation::Get().GetWorkerBudget();
+		if( ImGui::SliderInt( "Physics worker budget", &WorkerBudget, 1, ( int ) WorkerPool::Get().GetWorkerCount() ) )
+			PhysicsFoundation::Get().SetWorkerBudget( ( uint32_t ) WorkerBudget );
+
+		// PhysX only builds the visualization while one of these is on.
+		uint32_t DebugDrawFlags = PhysicsFoundation::Get().GetDebugDrawFlags();
+
+		auto DebugDrawCheckbox = [&]( const char* pLabel, PhysicsDebugDrawFlags Flag )
+			{
+				bool Enabled = ( DebugDrawFlags & Flag ) != 0;
+
+				if( ImGui::Checkbox( pLabel, &Enabled ) )
+					DebugDrawFlags = Enabled ? ( DebugDrawFlags | Flag ) : ( DebugDrawFlags & ~Flag );
+			};
+
+		ImGui::Text( "Physics debug draw:" );
+		DebugDrawCheckbox( "Shapes", PhysicsDebugDraw_Shapes );
+		ImGui::SameLine();
+		DebugDrawCheckbox( "Contacts", PhysicsDebugDraw_Contacts );
+		ImGui::SameLine();
+		DebugDrawCheckbox( "AABBs", PhysicsDebugDraw_AABBs );
+		ImGui::SameLine();
+		DebugDrawCheckbox( "Joints", PhysicsDebugDraw_Joints );
+
+		PhysicsFoundation::Get().SetDebugDrawFlags( DebugDrawFlags );
+
 		for( const auto& devices : VulkanContext::Get().GetPhysicalDeviceProperties() )
 		{
 			ImGui::Text( "Device Name: %s", devices.DeviceProps.deviceName );
@@ -904,6 +945,86 @@ namespace Saturn {
 			ShouldSaveProject = true;
 		}
 
+		ImGui::PushFont( boldFont );
+		ImGui::Text( "Physics" );
+		ImGui::Separator();
+
+		ImGui::PopFont();
+
+		// Applied when the physics scene is created, so the next time the runtime starts.
+		PhysicsSettings& rPhysics = ActiveProject->GetPhysicsSettings();
+
+		constexpr const char* BroadphaseTypes[] = { "SAP", "MBP", "ABP" };
+		constexpr const char* SolverTypes[] = { "PGS", "TGS" };
+
+		int Broadphase = ( int ) rPhysics.BroadphaseType;
+		ImGui::SetNextItemWidth( 130.0f );
+		if( ImGui::Combo( "Broadphase", &Broadphase, BroadphaseTypes, IM_ARRAYSIZE( BroadphaseTypes ) ) )
+		{
+			rPhysics.BroadphaseType = ( PhysicsBroadphaseType ) Broadphase;
+			ShouldSaveProject = true;
+		}
+
+		if( rPhysics.BroadphaseType == PhysicsBroadphaseType::MBP )
+		{
+			ShouldSaveProject |= ImGui::DragFloat3( "World Bounds Min", glm::value_ptr( rPhysics.WorldBoundsMin ), 1.0f );
+			ShouldSaveProject |= ImGui::DragFloat3( "World Bounds Max", glm::value_ptr( rPhysics.WorldBoundsMax ), 1.0f );
+
+			int Subdivisions = ( int ) rPhysics.WorldSubdivisions;
+			ImGui::SetNextItemWidth( 130.0f );
+			if( ImGui::SliderInt( "World Subdivisions", &Subdivisions, 1, 16 ) )
+			{
+				rPhysics.WorldSubdivisions = ( uint32_t ) Subdivisions;
+				ShouldSaveProject = true;
+			}
+		}
+
+		int Solver = ( int ) rPhysics.SolverType;
+		ImGui::SetNextItemWidth( 130.0f );
+		if( ImGui::Combo( "Solver", &Solver, SolverTypes, IM_ARRAYSIZE( SolverTypes ) ) )
+		{
+			rPhysics.SolverType = ( PhysicsSolverType ) Solver;
+			ShouldSaveProject = true;
+		}
+
+		int PositionIterations = ( int ) rPhysics.PositionIterations;
+		ImGui::SetNextItemWidth( 130.0f );
+		if( ImGui::SliderInt( "Position Iterations", &PositionIterations, 1, 32 ) )
+		{
+			rPhysics.PositionIterations = ( uint32_t ) PositionIterations;
+			ShouldSaveProject = true;
+		}
+
+		int VelocityIterations = ( int ) rPhysics.VelocityIterations;
+		ImGui::SetNextItemWidth( 130.0f );
+		if( ImGui::SliderInt( "Velocity Iterations", &VelocityIterations, 0, 32 ) )
+		{
+			rPhysics.VelocityIterations = ( uint32_t ) VelocityIterations;
+			ShouldSaveProject = true;
+		}
+
+		ShouldSaveProject |= ImGui::Checkbox( "Enable CCD", &rPhysics.EnableCCD );
+
+		ImGui::SetNextItemWidth( 130.0f );
+		ShouldSaveProject |= ImGui::DragFloat( "Sleep Threshold", &rPhysics.SleepThreshold, 0.01f, -1.0f, 100.0f );
+
+		if( ImGui::IsItemHovered() )
+			ImGui::SetTooltip( "Negative values keep the PhysX default." );
+
+		ImGui::SetNextItemWidth( 130.0f );
+		ShouldSaveProject |= ImGui::DragFloat( "Bounce Threshold", &rPhysics.BounceThresholdVelocity, 0.01f, 0.0f, 100.0f );
+
+		ImGui::SetNextItemWidth( 130.0f );
+		ShouldSaveProject |= ImGui::DragFloat( "Friction Offset Threshold", &rPhysics.FrictionOffsetThreshold, 0.01f, 0.0f, 100.0f );
+
+		ImGui::SetNextItemWidth( 130.0f );
+		ShouldSaveProject |= ImGui::DragFloat( "Tolerance Length", &rPhysics.ToleranceLength, 0.1f, 0.01f, 1000.0f );
+
+		ImGui::SetNextItemWidth( 130.0f );
+		ShouldSaveProject |= ImGui::DragFloat( "Tolerance Speed", &rPhysics.ToleranceSpeed, 0.1f, 0.01f, 1000.0f );
+
+		ImGui::TextDisabled( "The tolerance scale is applied when the editor restarts." );
+
 
 		// This does not matter because the editor is not designed to run in Dist, however, right now I want to keep this in release builds.
 #if !defined(SAT_DIST)
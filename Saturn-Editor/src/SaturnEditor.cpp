@@ -32,6 +32,7 @@
 #include "Saturn/Core/EngineSettings.h"
 
 #include "Saturn/Runtime/RuntimeLayer.h"
+#include "Saturn/Runtime/HeadlessLayer.h"
 
 #include "EditorLayer.h"
 
@@ -42,8 +43,8 @@
 class EditorApplication : public Saturn::Application
 {
 public:
-	explicit EditorApplication( const Saturn::ApplicationSpecification& spec, const std::string& rProjectPath )
-		: Application( spec ), m_ProjectPath( rProjectPath )
+	explicit EditorApplication( const Saturn::ApplicationSpecification& spec, const std::string& rProjectPath, const Saturn::HeadlessSpecification& rHeadlessSpec = {} )
+		: Application( spec ), m_ProjectPath( rProjectPath ), m_HeadlessSpec( rHeadlessSpec )
 	{
 		// Setup user settings and find the project path.
 		Saturn::EngineSettingsSerialiser uss;
@@ -74,6 +75,14 @@ public:
 
 	virtual void OnInit() override
 	{
+		if( HasFlag( Saturn::ApplicationFlag_Headless ) )
+		{
+			m_HeadlessLayer = new Saturn::HeadlessLayer( m_HeadlessSpec );
+
+			PushLayer( m_HeadlessLayer );
+			return;
+		}
+
 		m_EditorLayer = new Saturn::EditorLayer();
 
 		PushLayer( m_EditorLayer );
@@ -81,6 +90,14 @@ public:
 
 	virtual void OnShutdown() override
 	{
+		if( m_HeadlessLayer )
+		{
+			PopLayer( m_HeadlessLayer );
+			delete m_HeadlessLayer;
+
+			return;
+		}
+
 		Saturn::EngineSettingsSerialiser uss;
 		uss.Serialise();
 
@@ -90,6 +107,8 @@ public:
 
 private:
 	Saturn::EditorLayer* m_EditorLayer = nullptr;
+	Saturn::HeadlessLayer* m_HeadlessLayer = nullptr;
+	Saturn::HeadlessSpecification m_HeadlessSpec;
 
 	std::string m_ProjectPath = "";
 };
@@ -109,5 +128,34 @@ Saturn::Application* Saturn::CreateApplication( int argc, char** argv )
 	ApplicationSpecification spec;
 	spec.Flags = ApplicationFlag_CreateSceneRenderer;
 
-	return new EditorApplication( spec, projectPath );
+	// Headless: <project> --headless [--scene <path or name>] [--frames N] [--warmup N] [--stats <file>] [--png <file>] [--width W] [--height H] [--physics-checks]
+	HeadlessSpecification headlessSpec;
+
+	for( int i = 2; i < argc; i++ )
+	{
+		const bool hasValue = i + 1 < argc;
+
+		if( strcmp( argv[ i ], "--bindless" ) == 0 )
+			spec.Flags |= ApplicationFlag_BindlessTextures;
+		else if( strcmp( argv[ i ], "--headless" ) == 0 )
+			spec.Flags |= ApplicationFlag_Headless;
+		else if( strcmp( argv[ i ], "--scene" ) == 0 && hasValue )
+			headlessSpec.Scene = argv[ ++i ];
+		else if( strcmp( argv[ i ], "--frames" ) == 0 && hasValue )
+			headlessSpec.FrameCount = ( uint32_t ) std::stoul( argv[ ++i ] );
+		else if( strcmp( argv[ i ], "--warmup" ) == 0 && hasValue )
+			headlessSpec.WarmupFrames = ( uint32_t ) std::stoul( argv[ ++i ] );
+		else if( strcmp( argv[ i ], "--stats" ) == 0 && hasValue )
+			headlessSpec.StatsPath = argv[ ++i ];
+		else if( strcmp( argv[ i ], "--png" ) == 0 && hasValue )
+			headlessSpec.ImagePath = argv[ ++i ];
+		else if( strcmp( argv[ i ], "--physics-checks" ) == 0 )
+			headlessSpec.PhysicsChecks = true;
+		else if( strcmp( argv[ i ], "--width" ) == 0 && hasValue )
+			spec.WindowWidth = ( uint32_t ) std::stoul( argv[ ++i ] );
+		else if( strcmp( argv[ i ], "--height" ) == 0 && hasValue )
+			spec.WindowHeight = ( uint32_t ) std::stoul( argv[ ++i ] );
+	}
+
+	return new EditorApplication( spec, projectPath, headlessSpec );
 }
\ No newline at end of file
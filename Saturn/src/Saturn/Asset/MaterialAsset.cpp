@@ -32,6 +32,7 @@
 #include "AssetManager.h"
 
 #include "Saturn/Vulkan/Renderer.h"
+#include "Saturn/Vulkan/BindlessResources.h"
 #include "Saturn/Serialisation/AssetSerialisers.h"
 
 #include "TextureSourceAsset.h"
@@ -49,10 +50,15 @@ namespace Saturn {
 		}
 		else
 			m_Material->Copy( material );
+
+		if( VulkanContext::Get().IsBindlessEnabled() )
+			m_BindlessIndex = VulkanContext::Get().GetBindlessResources()->AllocateMaterial();
 	}
 
 	MaterialAsset::~MaterialAsset()
 	{
+		if( VulkanContext::Get().IsBindlessEnabled() )
+			VulkanContext::Get().GetBindlessResources()->FreeMaterial( m_BindlessIndex );
 	}
 
 	void MaterialAsset::Default()
@@ -157,7 +163,7 @@ namespace Saturn {
 		// We don't want to default the texture because what if the user has only changed the normal map. And we'd be reseting all of the textures.
 	}
 
-	void MaterialAsset::Bind( const Ref< StaticMesh >& rMesh, Submesh& rSubmsh, Ref< Shader >& Shader, const VkWriteDescriptorSet& rStorageBufferWDS )
+	void MaterialAsset::ApplyPendingChanges()
 	{
 		if( m_PendingMaterialChange )
 		{
@@ -182,64 +188,29 @@ namespace Saturn {
 
 		if( m_PendingTextureChanges.size() )
 			m_PendingTextureChanges.clear();
+	}
+
+	void MaterialAsset::Bind( const Ref< StaticMesh >& rMesh, Submesh& rSubmsh, Ref< Shader >& Shader, const VkWriteDescriptorSet& rStorageBufferWDS )
+	{
+		ApplyPendingChanges();
 
+		// Only re-hashes/writes the set if a texture was changed.
 		m_Material->RN_Update();
 
 		uint32_t frame = Renderer::Get().GetCurrentFrame();
 
-		VkDescriptorSet CurrentSet = m_Material->GetDescriptorSet( frame );
-
-		// Update material textures.
-		auto& textures = m_Material->GetTextures();
-		for( auto& [name, texture] : textures )
+		if( rStorageBufferWDS.dstBinding != 0 )
 		{
-			// Check if the texture even exists in the cache.
-			if( m_TextureCache.find( name ) == m_TextureCache.end() )
-			{
-				m_TextureCache[ name ] = texture->GetDescriptorInfo();
-			}
-			else
-			{
-				VkDescriptorImageInfo ImageInfo = m_TextureCache.at( name );
-
-				if( m_TextureCache.at( name ).imageView == ImageInfo.imageView || m_TextureCache.at( name ).sampler == ImageInfo.sampler )
-				{
-					// No need to update the descriptor set -- its the same.
-					continue;
-				}
-				else // If the image view has changed, update the cache.
-				{
-					m_TextureCache[ name ] = texture->GetDescriptorInfo();
-					Shader->WriteDescriptor( name, ImageInfo, m_Material->m_DescriptorSets[ frame ] );
-
-					continue;
-				}
-			}
+			// Sets can be shared between materials, only write the storage buffer when the buffer has been re-created.
+			VkBuffer& rBoundBuffer = Renderer::Get().GetDescriptorSetCache()->BoundStorageBuffer( m_Material->m_SetHashes[ frame ] );
 
-			// Fallback, just write the descriptor.
-			VkDescriptorImageInfo ImageInfo = {};
-			ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-			if( textures[ name ] )
-			{
-				ImageInfo.imageView = textures[ name ]->GetImageView();
-				ImageInfo.sampler = textures[ name ]->GetSampler();
-			}
-			else
+			if( rBoundBuffer != rStorageBufferWDS.pBufferInfo->buffer )
 			{
-				auto PinkTexture = Renderer::Get().GetPinkTexture();
+				auto wds = rStorageBufferWDS;
+				m_Material->WriteDescriptor( wds );
 
-				ImageInfo.imageView = PinkTexture->GetImageView();
-				ImageInfo.sampler = PinkTexture->GetSampler();
+				rBoundBuffer = rStorageBufferWDS.pBufferInfo->buffer;
 			}
-
-			Shader->WriteDescriptor( name, ImageInfo, m_Material->m_DescriptorSets[ frame ] );
-		}
-
-		if( rStorageBufferWDS.dstBinding != 0 )
-		{
-			auto wds = rStorageBufferWDS;
-			m_Material->WriteDescriptor( wds );
 		}
 		
 		if( m_ValuesChanged ) 
@@ -248,6 +219,30 @@ namespace Saturn {
 		}
 	}
 
+	void MaterialAsset::BindBindless()
+	{
+		ApplyPendingChanges();
+
+		BindlessMaterial Data = {};
+		Data.AlbedoColor = GetAlbeoColor();
+		Data.Roughness = GetRoughness();
+		Data.Metalness = GetMetalness();
+		Data.Emissive = GetEmissive();
+		Data.UseNormalMap = IsUsingNormalMap();
+
+		auto IndexOf = []( const Ref<Texture2D>& rTexture ) { return rTexture ? rTexture->GetBindlessIndex() : 0u; };
+
+		Data.AlbedoTexture = IndexOf( GetAlbeoMap() );
+		Data.NormalTexture = IndexOf( GetNormalMap() );
+		Data.MetallicTexture = IndexOf( GetMetallicMap() );
+		Data.RoughnessTexture = IndexOf( GetRoughnessMap() );
+
+		// Only marks the buffer as dirty if something changed.
+		VulkanContext::Get().GetBindlessResources()->UpdateMaterial( m_BindlessIndex, Data );
+
+		m_ValuesChanged = false;
+	}
+
 	void MaterialAsset::Clean()
 	{
 		m_Material->RN_Clean();
@@ -273,6 +268,8 @@ namespace Saturn {
 
 			m_Material->SetResource( IndexToTextureIndex[ index ], texture );
 		}
+
+		m_Material->MarkDirty();
 	}
 
 	void MaterialAsset::SetMaterial( const Ref<Material>& rMaterial )
@@ -92,6 +92,10 @@ namespace Saturn {
 
 		void RT_Bind( const std::vector<std::vector<VkWriteDescriptorSet>>& rStorageBufferWDS = std::vector<std::vector<VkWriteDescriptorSet>>() );
 
+		// Bindless mode, updates our slot in the material buffer instead of a descriptor set.
+		void BindBindless();
+		uint32_t GetBindlessIndex() const { return m_BindlessIndex; }
+
 		void Clean();
 
 		Buffer GetPushConstantData() { return m_Material->m_PushConstantData; }
@@ -122,6 +126,8 @@ namespace Saturn {
 
 		void ForceUpdate();
 
+		void ApplyPendingChanges();
+
 	private:
 		Ref<Material> m_Material = nullptr;
 
@@ -133,6 +139,8 @@ namespace Saturn {
 
 		std::unordered_map< std::string, Ref<Texture2D> > m_PendingTextureChanges;
 		std::unordered_map< uint32_t, std::filesystem::path > m_VPendingTextureChanges;
+
+		uint32_t m_BindlessIndex = 0;
 	private:
 		friend class MaterialAssetViewer;
 		friend class MaterialAssetSerialiser;
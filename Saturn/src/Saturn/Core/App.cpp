@@ -38,6 +38,7 @@
 
 #include "Saturn/GameFramework/Core/GameThread.h"
 #include "Renderer/RenderThread.h"
+#include "WorkerPool.h"
 
 #include "Saturn/Audio/AudioSystem.h"
 
@@ -64,17 +65,29 @@ namespace Saturn {
 	{
 		SingletonStorage::AddSingleton( this );
 
-		const RubyMonitor& rPrimaryMonitor = RubyGetPrimaryMonitor();
-		uint32_t width = 0, height = 0;
+		if( HasFlag( ApplicationFlag_Headless ) )
+		{
+			// Nothing to take the size from.
+			if( m_Specification.WindowWidth == 0 || m_Specification.WindowHeight == 0 )
+			{
+				m_Specification.WindowWidth = 1280;
+				m_Specification.WindowHeight = 720;
+			}
+		}
+		else
+		{
+			const RubyMonitor& rPrimaryMonitor = RubyGetPrimaryMonitor();
+			uint32_t width = 0, height = 0;
 
-		width = 3 * rPrimaryMonitor.MonitorSize.x / 4;
-		height = 3 * rPrimaryMonitor.MonitorSize.y / 4;
+			width = 3 * rPrimaryMonitor.MonitorSize.x / 4;
+			height = 3 * rPrimaryMonitor.MonitorSize.y / 4;
 
-		RubyStyle WindowStyle = HasFlag( ApplicationFlag_Titlebar ) ? RubyStyle::Default : RubyStyle::Borderless;
+			RubyStyle WindowStyle = HasFlag( ApplicationFlag_Titlebar ) ? RubyStyle::Default : RubyStyle::Borderless;
 
-		RubyWindowSpecification windowSpec { .Name = "Saturn", .Width = width, .Height = height, .GraphicsAPI = RubyGraphicsAPI::Vulkan, .Style = WindowStyle, .ShowNow = false };
-		m_Window = new RubyWindow( windowSpec );
-		m_Window->SetEventTarget( this );
+			RubyWindowSpecification windowSpec { .Name = "Saturn", .Width = width, .Height = height, .GraphicsAPI = RubyGraphicsAPI::Vulkan, .Style = WindowStyle, .ShowNow = false };
+			m_Window = new RubyWindow( windowSpec );
+			m_Window->SetEventTarget( this );
+		}
 
 		// This may not be the best way... but it's better than lazy loading.
 		m_VulkanContext = new VulkanContext();
@@ -84,12 +97,15 @@ namespace Saturn {
 		// If we are in Dist we don't want to create the Scene Renderer now because it does not know where the shaders are. 
 		// So we want to first the shader bundle however that requires the project to be loaded.
 #if !defined( SAT_DIST )
-		SceneRendererFlags flags = SceneRendererFlag_MasterInstance | SceneRendererFlag_RenderGrid;
+		SceneRendererFlags flags = SceneRendererFlag_MasterInstance;
+
+		if( !HasFlag( ApplicationFlag_Headless ) )
+			flags |= SceneRendererFlag_RenderGrid;
 
 		m_SceneRenderer = new SceneRenderer( flags );
 #endif
 
-		if( m_Specification.WindowWidth != 0 && m_Specification.WindowHeight != 0 )
+		if( m_Window && m_Specification.WindowWidth != 0 && m_Specification.WindowHeight != 0 )
 			m_Window->Resize( m_Specification.WindowWidth, m_Specification.WindowHeight );
 
 		// Right before we create any threads, lets get the main thread id and handle.
@@ -103,9 +119,12 @@ namespace Saturn {
 		// ImGui is only used if we have the editor, and ImGui should not be used when building the game.
 		m_ImGuiLayer = new ImGuiLayer();
 
-		if( !HasFlag( ApplicationFlag_GameDistribution ) )
+		if( UseImGui() )
 			m_ImGuiLayer->OnAttach();
 
+		if( !m_Window )
+			return;
+
 #if defined( SAT_DIST )
 		m_Window->Show( RubyWindowShowCmd::Fullscreen );
 #else
@@ -125,14 +144,15 @@ namespace Saturn {
 
 		while( m_Running )
 		{
-			m_Window->PollEvents();
+			if( m_Window )
+				m_Window->PollEvents();
 
 			for( auto&& fn : m_MainThreadQueue )
 				fn();
 
 			m_MainThreadQueue.clear();
 
-			if( !m_Window->Minimized() )
+			if( !m_Window || !m_Window->Minimized() )
 			{
 				Renderer::Get().BeginFrame();
 				{
@@ -151,7 +171,7 @@ namespace Saturn {
 			// Execute render thread (last frame).
 			RenderThread::Get().WaitAll();
 
-			float time = ( float ) m_Window->GetTime();
+			float time = m_Window ? ( float ) m_Window->GetTime() : m_HeadlessTimer.Elapsed() / 1000.0f;
 
 			float frametime = time - m_LastFrameTime;
 
@@ -174,7 +194,7 @@ namespace Saturn {
 				delete layer;
 			}
 
-			if( !HasFlag( ApplicationFlag_GameDistribution ) )
+			if( UseImGui() )
 				m_ImGuiLayer->OnDetach();
 			
 			delete m_ImGuiLayer;
@@ -189,6 +209,9 @@ namespace Saturn {
 		delete m_SceneRenderer;
 		delete m_VulkanContext;
 
+		// Layers are gone, nothing can submit work anymore.
+		WorkerPool::Get().Terminate();
+
 		delete m_Window;
 	}
 
@@ -202,7 +225,7 @@ namespace Saturn {
 		SAT_PF_EVENT();
 
 		// Begin on main thread.
-		if( !HasFlag( ApplicationFlag_GameDistribution ) )
+		if( UseImGui() )
 			m_ImGuiLayer->Begin();
 
 		// Update on the main thread.
@@ -211,7 +234,7 @@ namespace Saturn {
 			layer->OnUpdate( m_Timestep );
 		}
 
-		if( !HasFlag( ApplicationFlag_GameDistribution ) )
+		if( UseImGui() )
 		{
 			RenderThread::Get().Queue( [=]
 				{
@@ -228,6 +251,16 @@ namespace Saturn {
 		}
 	}
 
+	uint32_t Application::GetWidth() const
+	{
+		return m_Window ? m_Window->GetWidth() : m_Specification.WindowWidth;
+	}
+
+	uint32_t Application::GetHeight() const
+	{
+		return m_Window ? m_Window->GetHeight() : m_Specification.WindowHeight;
+	}
+
 	std::filesystem::path Application::GetAppDataFolder()
 	{
 		std::filesystem::path path = L"";
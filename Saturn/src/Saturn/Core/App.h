@@ -38,6 +38,7 @@
 #include "EngineSettings.h"
 
 #include "SingletonStorage.h"
+#include "Timer.h"
 
 #include <vector>
 #include <functional>
@@ -55,7 +56,10 @@ namespace Saturn {
 		ApplicationFlag_CreateSceneRenderer = BIT( 2 ),
 		ApplicationFlag_UseGameThread = BIT( 3 ),
 		ApplicationFlag_Titlebar = BIT( 4 ),
-		ApplicationFlag_UseVFS = BIT( 5 )
+		ApplicationFlag_UseVFS = BIT( 5 ),
+		ApplicationFlag_BindlessTextures = BIT( 6 ),
+		// No window, surface or swapchain. The scene renderer only draws to its offscreen framebuffers.
+		ApplicationFlag_Headless = BIT( 7 )
 	};
 
 	// enum ApplicationFlags_
@@ -67,6 +71,7 @@ namespace Saturn {
 
 		bool Titlebar = false;
 		
+		// When running headless this is the size of the offscreen target.
 		uint32_t WindowWidth = 0;
 		uint32_t WindowHeight = 0;
 	};
@@ -87,6 +92,10 @@ namespace Saturn {
 		void Run();
 		void Close();
 
+		// Returned from main once the application closes, e.g. headless runs report failures with it.
+		void SetExitCode( int ExitCode ) { m_ExitCode = ExitCode; }
+		int GetExitCode() const { return m_ExitCode; }
+
 		bool Running() const { return m_Running; }
 
 		Timestep& Time() { return m_Timestep; }
@@ -108,6 +117,10 @@ namespace Saturn {
 		SceneRenderer& PrimarySceneRenderer() { return *m_SceneRenderer; }
 		RubyWindow* GetWindow() { return m_Window; }
 
+		// Size of the window, or of the offscreen target when running headless.
+		uint32_t GetWidth() const;
+		uint32_t GetHeight() const;
+
 		void SubmitOnMainThread( std::function<void()>&& rrFunction )
 		{
 			m_MainThreadQueue.push_back( std::move( rrFunction ) );
@@ -133,6 +146,8 @@ namespace Saturn {
 
 		void RenderImGui();
 
+		bool UseImGui() const { return !HasFlag( ApplicationFlag_GameDistribution ) && !HasFlag( ApplicationFlag_Headless ); }
+
 		std::string OpenFileInternal( const char* pFilter ) const;
 		std::string SaveFileInternal( const char* pFilter ) const;
 		std::string OpenFolderInternal() const;
@@ -146,11 +161,15 @@ namespace Saturn {
 
 	private:
 		bool m_Running = true;
+		int m_ExitCode = 0;
 		
 		ImGuiLayer* m_ImGuiLayer = nullptr;
 
 		Timestep m_Timestep;
 		float m_LastFrameTime = 0.0f;
+
+		// Used for the frame time when there is no window.
+		Timer m_HeadlessTimer;
 		
 		ApplicationSpecification m_Specification;
 
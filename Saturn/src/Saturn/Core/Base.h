@@ -96,6 +96,20 @@ namespace Saturn::Core {
 
 constexpr int MAX_FRAMES_IN_FLIGHT = 3;
 
+//////////////////////////////////////////////////////////////////////////
+// HASH
+#include <functional>
+
+namespace Saturn {
+
+	// Mixes the hash of "rValue" into "rSeed", same idea as boost::hash_combine.
+	template<typename Ty>
+	inline void HashCombine( size_t& rSeed, const Ty& rValue )
+	{
+		rSeed ^= std::hash<Ty>{}( rValue ) + 0x9e3779b97f4a7c15ull + ( rSeed << 6 ) + ( rSeed >> 2 );
+	}
+}
+
 // Inject asserts
 #define __CORE_INCLUDED__
 #include "Asserts.h"
@@ -37,11 +37,13 @@
 
 #define SAT_PF_EVENT()       ZoneScoped
 #define SAT_PF_EVENT_N(x)    ZoneScopedN(x)
+#define SAT_PF_ZONE_NAME(x)  ZoneName(x, strlen(x))
 #define SAT_PF_FRAME(x)		 FrameMarkNamed(x)
 #define SAT_PF_SCOPE(x, ...) //OPTICK_EVENT_DYNAMIC(x, __VA_ARGS__)
 #define SAT_PF_THRD(...)     //OPTICK_THREAD(__VA_ARGS__)
 #else 
 #define SAT_PF_EVENT(...)
+#define SAT_PF_ZONE_NAME(x)
 #define SAT_PF_FRAME(...)
 #define SAT_PF_SCOPE(x, ...)
 #define SAT_PF_THRD(x, ...)
@@ -31,6 +31,7 @@
 #include "Base.h"
 #include <string>
 #include <locale>
+#include <format>
 
 namespace Saturn {
 
@@ -57,5 +58,35 @@ namespace Saturn {
 
 			return result;
 		}
+
+		// Escapes a string so it can be written between quotes in a JSON file.
+		inline std::string EscapeJson( const std::string& rString )
+		{
+			std::string Result;
+			Result.reserve( rString.size() );
+
+			for( char c : rString )
+			{
+				switch( c )
+				{
+					case '"':  Result += "\\\""; break;
+					case '\\': Result += "\\\\"; break;
+					case '\n': Result += "\\n"; break;
+					case '\r': Result += "\\r"; break;
+					case '\t': Result += "\\t"; break;
+
+					default:
+					{
+						// Other control characters must be written as unicode escapes.
+						if( ( unsigned char ) c < 0x20 )
+							Result += std::format( "\\u{:04x}", ( unsigned int ) c );
+						else
+							Result += c;
+					} break;
+				}
+			}
+
+			return Result;
+		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "WorkerPool.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
+namespace Saturn {
+
+	WorkerPool::WorkerPool()
+	{
+		// Leave a core for the main thread and one for the render thread.
+		uint32_t HardwareThreads = std::thread::hardware_concurrency();
+		uint32_t WorkerCount = HardwareThreads > 3 ? HardwareThreads - 2 : 1;
+
+		m_Running = true;
+
+		for( uint32_t i = 0; i < WorkerCount; i++ )
+			m_Workers.emplace_back( &WorkerPool::WorkerRun, this, i );
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		Terminate();
+	}
+
+	void WorkerPool::Submit( std::function<void()>&& rrJob, WorkerPriority Priority )
+	{
+		{
+			std::lock_guard<std::mutex> Lock( m_Mutex );
+
+			if( m_Running )
+			{
+				if( Priority == WorkerPriority::High )
+					m_HighJobs.push_back( std::move( rrJob ) );
+				else
+					m_NormalJobs.push_back( std::move( rrJob ) );
+
+				m_Cond.notify_one();
+				return;
+			}
+		}
+
+		rrJob();
+	}
+
+	void WorkerPool::Terminate()
+	{
+		{
+			std::lock_guard<std::mutex> Lock( m_Mutex );
+
+			if( !m_Running )
+				return;
+
+			m_Running = false;
+			m_Cond.notify_all();
+		}
+
+		for( auto& rWorker : m_Workers )
+		{
+			if( rWorker.joinable() )
+				rWorker.join();
+		}
+
+		m_Workers.clear();
+	}
+
+	void WorkerPool::WorkerRun( uint32_t Index )
+	{
+		std::wstring Name = L"Worker " + std::to_wstring( Index );
+		SetThreadDescription( GetCurrentThread(), Name.c_str() );
+
+		while( true )
+		{
+			std::function<void()> Job;
+
+			{
+				std::unique_lock<std::mutex> Lock( m_Mutex );
+				m_Cond.wait( Lock, 
+					[this] 
+					{ 
+						return !m_Running || !m_HighJobs.empty() || !m_NormalJobs.empty();
+					} );
+
+				// Drain the queues before leaving, someone might be waiting on those jobs.
+				std::deque<std::function<void()>>& rQueue = !m_HighJobs.empty() ? m_HighJobs : m_NormalJobs;
+
+				if( rQueue.empty() )
+					break;
+
+				Job = std::move( rQueue.front() );
+				rQueue.pop_front();
+			}
+
+			Job();
+		}
+	}
+
+}
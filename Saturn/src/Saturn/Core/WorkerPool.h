@@ -0,0 +1,76 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+namespace Saturn {
+
+	enum class WorkerPriority
+	{
+		// Work the current frame is waiting on, always taken before normal jobs.
+		High,
+		Normal
+	};
+
+	// Shared worker threads for engine systems, so every system does not need to spin up threads of its own.
+	// Jobs are run in the order they were submitted within a priority.
+	class WorkerPool
+	{
+	public:
+		static inline WorkerPool& Get() { return *SingletonStorage::GetOrCreateSingleton<WorkerPool>(); }
+	public:
+		WorkerPool();
+		~WorkerPool();
+
+		void Submit( std::function<void()>&& rrJob, WorkerPriority Priority = WorkerPriority::Normal );
+
+		uint32_t GetWorkerCount() const { return ( uint32_t ) m_Workers.size(); }
+
+		// Finishes every queued job and joins the workers, jobs submitted after this run on the calling thread.
+		void Terminate();
+
+	private:
+		void WorkerRun( uint32_t Index );
+	private:
+		std::vector<std::thread> m_Workers;
+		std::mutex m_Mutex;
+		std::condition_variable m_Cond;
+
+		std::deque<std::function<void()>> m_HighJobs;
+		std::deque<std::function<void()>> m_NormalJobs;
+
+		bool m_Running = false;
+	};
+}
@@ -45,9 +45,11 @@ namespace Saturn {
 			return 1;
 
 		pApp->Run();
+
+		int ExitCode = pApp->GetExitCode();
 		
 		delete pApp;
 
-		return 0;
+		return ExitCode;
 	}
 }
\ No newline at end of file
@@ -725,6 +725,8 @@ namespace Saturn {
 		{
 			static std::filesystem::path s_GLTFBinPath = "";
 			static bool s_UseBinFile = true;
+			static bool s_CompactVertices = false;
+			static bool s_GenerateLods = true;
 
 			bool PopupModified = false;
 
@@ -775,6 +777,12 @@ namespace Saturn {
 				ImGui::EndVertical();
 			}
 
+			// Positions are quantized against the submesh bounds in the cooked data, smaller but slightly lossy.
+			ImGui::Checkbox( "Compact Vertices", &s_CompactVertices );
+
+			// Simplified index ranges for every submesh, picked by screen size when rendering.
+			ImGui::Checkbox( "Generate LODs", &s_GenerateLods );
+
 			ImGui::BeginHorizontal( "##actionsH" );
 
 			if( ImGui::Button( "Create" ) )
@@ -806,6 +814,10 @@ namespace Saturn {
 
 				auto& meshPath = assetPath.replace_extension( m_ImportMeshPath.extension() );
 				staticMesh->SetFilepath( meshPath.string() );
+				staticMesh->SetCompactVertices( s_CompactVertices );
+
+				if( !s_GenerateLods )
+					staticMesh->SetLodRatios( {} );
 
 				// Save the mesh asset
 				StaticMeshAssetSerialiser sma;
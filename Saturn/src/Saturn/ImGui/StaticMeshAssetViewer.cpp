@@ -181,6 +181,44 @@ namespace Saturn {
 			Auxiliary::EndTreeNode();
 		}
 
+		if( Auxiliary::TreeNode( "Optimization" ) )
+		{
+			const MeshOptimizationStats& rStats = m_Mesh->GetOptimizationStats();
+
+			if( rStats.Available )
+			{
+				ImGui::Text( "Post-transform cache: %u entries (FIFO)", MeshOptimizer::CacheSize );
+				ImGui::Text( "ACMR: %.3f -> %.3f", rStats.Before.GetACMR(), rStats.After.GetACMR() );
+				ImGui::Text( "ATVR: %.3f -> %.3f", rStats.Before.GetATVR(), rStats.After.GetATVR() );
+				ImGui::Text( "Vertices transformed: %u -> %u", rStats.Before.Transformed, rStats.After.Transformed );
+			}
+			else
+			{
+				ImGui::Text( "No stats, the mesh was loaded from cooked data." );
+			}
+
+			Auxiliary::EndTreeNode();
+		}
+
+		if( Auxiliary::TreeNode( "LODs" ) )
+		{
+			bool GenerateLods = !m_Mesh->GetLodRatios().empty();
+
+			// Regenerates from the source file, the ratios are saved with the asset.
+			if( m_Mesh->CanGenerateLods() && ImGui::Checkbox( "Generate LODs", &GenerateLods ) )
+				m_Mesh->SetLodRatios( GenerateLods ? StaticMesh::GetDefaultLodRatios() : std::vector<float>() );
+
+			for( const Submesh& rSubmesh : m_Mesh->Submeshes() )
+			{
+				ImGui::Text( "%s", rSubmesh.MeshName.c_str() );
+
+				for( uint32_t i = 0; i < rSubmesh.GetLodCount(); i++ )
+					ImGui::Text( "  LOD %u: %u triangles", i, rSubmesh.GetLod( i ).IndexCount / 3 );
+			}
+
+			Auxiliary::EndTreeNode();
+		}
+
 		ImGui::End();
 
 		ImGui::Begin( "##Toolbar" );
@@ -0,0 +1,384 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "PhysicsChecks.h"
+
+#include "PhysicsScene.h"
+#include "PhysicsRigidBody.h"
+#include "PhysicsQueryBatch.h"
+#include "PhysicsFoundation.h"
+
+#include "Saturn/Scene/Scene.h"
+#include "Saturn/Scene/Entity.h"
+#include "Saturn/Scene/Components.h"
+
+#include <map>
+
+namespace Saturn {
+
+	// Equal game time for both frame rates, through the same loop as the runtime.
+	static constexpr float s_DeterminismSeconds = 10.0f;
+
+	// Does not divide the run length, so rounding in the summed frame times can not change the step count.
+	static constexpr float s_DeterminismTimestep = 0.012f;
+	static constexpr float s_QueryDistanceEpsilon = 0.0001f;
+
+	// Plenty for a box dropped 1m to land.
+	static constexpr uint32_t s_ContactSteps = 200;
+
+	// Colliders take their physics material from the mesh, an empty mesh gives them the default one.
+	static void AddBox( Entity* pEntity, const Ref<StaticMesh>& rMesh, const std::string& rName, const glm::vec3& Position, const glm::vec3& Extents, bool Kinematic )
+	{
+		pEntity->SetName( rName );
+		pEntity->GetComponent<TransformComponent>().Position = Position;
+
+		pEntity->AddComponent<StaticMeshComponent>().Mesh = rMesh;
+		pEntity->AddComponent<BoxColliderComponent>( Extents );
+		pEntity->AddComponent<RigidbodyComponent>( Kinematic );
+	}
+
+	static Ref<Entity> CreateBox( Scene* pScene, const Ref<StaticMesh>& rMesh, const std::string& rName, const glm::vec3& Position, const glm::vec3& Extents, bool Kinematic )
+	{
+		Ref<Entity> Box = Ref<Entity>::Create( pScene );
+		AddBox( Box.Get(), rMesh, rName, Position, Extents, Kinematic );
+
+		return Box;
+	}
+
+	// Pushes its body towards a height every fixed step. The force comes from the pose it reads, so it only matches between frame rates
+	// when every physics update runs after the previous step was fetched.
+	class HoverEntity : public Entity
+	{
+	public:
+		HoverEntity( Scene* pScene ) : Entity( pScene ) {}
+
+		void OnPhysicsUpdate( Timestep ts ) override
+		{
+			PhysicsRigidBody* pBody = GetComponent<RigidbodyComponent>().Rigidbody;
+
+			float Height = pBody->GetPosition().y;
+			pBody->ApplyForce( glm::vec3( 0.0f, ( 4.0f - Height ) * 40.0f, 0.0f ), ForceMode::Force );
+		}
+	};
+
+	// A kinematic floor with a stack of boxes falling onto it, built the same way every time.
+	static Ref<Scene> CreateStackScene( const Ref<StaticMesh>& rMesh )
+	{
+		Ref<Scene> StackScene = Ref<Scene>::Create();
+
+		CreateBox( StackScene.Get(), rMesh, "Floor", glm::vec3( 0.0f ), glm::vec3( 40.0f, 1.0f, 40.0f ), true );
+
+		// Every box is offset a little so the stack topples instead of settling straight away.
+		for( uint32_t i = 0; i < 8; i++ )
+			CreateBox( StackScene.Get(), rMesh, std::format( "Box {0}", i ), glm::vec3( 0.15f * i, 2.0f + 1.1f * i, -0.1f * i ), glm::vec3( 1.0f ), false );
+
+		Ref<HoverEntity> Hover = Ref<HoverEntity>::Create( StackScene.Get() );
+		AddBox( Hover.Get(), rMesh, "Hover", glm::vec3( 6.0f, 1.0f, 6.0f ), glm::vec3( 1.0f ), false );
+
+		return StackScene;
+	}
+
+	// A kinematic floor with a row of kinematic boxes along the x axis, "Box 0" is the one furthest towards -x.
+	static Ref<Scene> CreateRowScene( const Ref<StaticMesh>& rMesh )
+	{
+		Ref<Scene> RowScene = Ref<Scene>::Create();
+
+		CreateBox( RowScene.Get(), rMesh, "Floor", glm::vec3( 0.0f ), glm::vec3( 40.0f, 1.0f, 40.0f ), true );
+
+		for( uint32_t i = 0; i < 6; i++ )
+			CreateBox( RowScene.Get(), rMesh, std::format( "Box {0}", i ), glm::vec3( -5.0f + 2.0f * i, 1.0f, 0.0f ), glm::vec3( 1.0f ), true );
+
+		return RowScene;
+	}
+
+	struct SimulationResult
+	{
+		uint64_t Steps = 0;
+		std::map<std::string, physx::PxTransform> Poses;
+	};
+
+	// Runs the scene through Scene::OnUpdate with frames of "FrameTime" seconds, like the runtime does, and returns the pose of every body by name.
+	static SimulationResult Simulate( Ref<Scene> SimulatedScene, float FrameTime, float Seconds )
+	{
+		SimulationResult Result;
+
+		SimulatedScene->OnRuntimeStart();
+
+		PhysicsScene* pPhysicsScene = SimulatedScene->GetPhysicsScene();
+		pPhysicsScene->SetFixedTimestep( s_DeterminismTimestep );
+
+		uint32_t Frames = ( uint32_t ) std::round( Seconds / FrameTime );
+
+		for( uint32_t i = 0; i < Frames; i++ )
+		{
+			SimulatedScene->OnUpdate( FrameTime );
+
+			Result.Steps += pPhysicsScene->GetStats().Steps;
+		}
+
+		// The last step of the last frame is still running.
+		pPhysicsScene->FetchResults();
+
+		for( auto& rEntity : SimulatedScene->GetAllEntitiesWith<RigidbodyComponent>() )
+			Result.Poses[ rEntity->GetName() ] = rEntity->GetComponent<RigidbodyComponent>().Rigidbody->GetActor().getGlobalPose();
+
+		SimulatedScene->OnRuntimeEnd();
+
+		return Result;
+	}
+
+	std::vector<PhysicsCheckResult> PhysicsChecks::RunAll()
+	{
+		std::vector<PhysicsCheckResult> Results;
+
+		Results.push_back( FrameRateDeterminism() );
+		Results.push_back( QueryBatchMatchesRaycast() );
+		Results.push_back( MultiShapeContactEvents() );
+
+		for( const PhysicsCheckResult& rResult : Results )
+		{
+			if( rResult.Passed )
+				SAT_CORE_INFO( "Physics check {0} passed", rResult.Name );
+			else
+				SAT_CORE_ERROR( "Physics check {0} failed: {1}", rResult.Name, rResult.Message );
+		}
+
+		return Results;
+	}
+
+	PhysicsCheckResult PhysicsChecks::FrameRateDeterminism()
+	{
+		PhysicsCheckResult Result;
+		Result.Name = "FrameRateDeterminism";
+
+		Ref<StaticMesh> Mesh = Ref<StaticMesh>::Create();
+
+		// The scenes are stepped one after the other, they share the foundation's contact callback.
+		SimulationResult Slow = Simulate( CreateStackScene( Mesh ), 1.0f / 30.0f, s_DeterminismSeconds );
+		SimulationResult Fast = Simulate( CreateStackScene( Mesh ), 1.0f / 240.0f, s_DeterminismSeconds );
+
+		if( Slow.Steps != Fast.Steps )
+		{
+			Result.Message = std::format( "{0} seconds took {1} steps at 30 fps but {2} steps at 240 fps.", s_DeterminismSeconds, Slow.Steps, Fast.Steps );
+			return Result;
+		}
+
+		const auto& SlowPoses = Slow.Poses;
+		const auto& FastPoses = Fast.Poses;
+
+		if( SlowPoses.empty() || SlowPoses.size() != FastPoses.size() )
+		{
+			Result.Message = "The scenes did not create the same bodies.";
+			return Result;
+		}
+
+		for( const auto& [Name, Pose] : SlowPoses )
+		{
+			auto Itr = FastPoses.find( Name );
+
+			// Bitwise, "close enough" would hide the drift this is meant to catch.
+			if( Itr == FastPoses.end() || memcmp( &Pose, &Itr->second, sizeof( physx::PxTransform ) ) != 0 )
+			{
+				Result.Message = std::format( "\"{0}\" has a different pose after {1} seconds at 30 and 240 fps.", Name, s_DeterminismSeconds );
+				return Result;
+			}
+		}
+
+		Result.Passed = true;
+
+		return Result;
+	}
+
+	PhysicsCheckResult PhysicsChecks::QueryBatchMatchesRaycast()
+	{
+		PhysicsCheckResult Result;
+		Result.Name = "QueryBatchMatchesRaycast";
+
+		Ref<StaticMesh> Mesh = Ref<StaticMesh>::Create();
+		Ref<Scene> RowScene = CreateRowScene( Mesh );
+
+		RowScene->OnRuntimeStart();
+
+		PhysicsScene* pPhysicsScene = RowScene->GetPhysicsScene();
+
+		// Leave a step running, so Execute has to wait for it.
+		pPhysicsScene->SetAsyncStep( true );
+		pPhysicsScene->BeginStep();
+
+		PhysicsQueryBatch Batch;
+
+		// Rays straight down over the floor and the boxes, a few of them miss the floor.
+		std::vector<glm::vec3> Origins;
+
+		for( float x = -23.75f; x <= 24.0f; x += 1.5f )
+		{
+			for( float z = -2.75f; z <= 3.0f; z += 1.5f )
+				Origins.push_back( glm::vec3( x, 10.0f, z ) );
+		}
+
+		for( const glm::vec3& rOrigin : Origins )
+			Batch.AddRaycast( rOrigin, glm::vec3( 0.0f, -1.0f, 0.0f ), 20.0f );
+
+		// Passes through every box, but only the two closest may be returned.
+		const glm::vec3 RowOrigin = glm::vec3( -10.0f, 1.0f, 0.0f );
+		uint32_t RowQuery = Batch.AddRaycast( RowOrigin, glm::vec3( 1.0f, 0.0f, 0.0f ), 30.0f, PHYSICS_ALL_LAYERS, 2 );
+
+		Batch.Execute( *pPhysicsScene );
+
+		auto Check = [&]()
+		{
+			for( uint32_t i = 0; i < ( uint32_t ) Origins.size(); i++ )
+			{
+				RaycastHitResult Single = {};
+				bool SingleHit = pPhysicsScene->Raycast( Origins[ i ], glm::vec3( 0.0f, -1.0f, 0.0f ), 20.0f, &Single );
+
+				if( SingleHit != ( Batch.GetHitCount( i ) == 1 ) )
+				{
+					Result.Message = std::format( "Ray {0} hit in one query but not the other.", i );
+					return false;
+				}
+
+				if( !SingleHit )
+					continue;
+
+				const PhysicsQueryHit& rHit = Batch.GetHits( i )[ 0 ];
+				Ref<Entity> BatchEntity = rHit.Hit;
+
+				if( BatchEntity.Get() != Single.Hit.Get() || std::abs( rHit.Distance - Single.Distance ) > s_QueryDistanceEpsilon )
+				{
+					Result.Message = std::format( "Ray {0} hit \"{1}\" at {2} in the batch but \"{3}\" at {4} on its own.", i, BatchEntity ? BatchEntity->GetName() : "nothing", rHit.Distance, Single.Hit->GetName(), Single.Distance );
+					return false;
+				}
+			}
+
+			if( Batch.GetHitCount( RowQuery ) != 2 )
+			{
+				Result.Message = std::format( "The ray along the row returned {0} hits instead of 2.", Batch.GetHitCount( RowQuery ) );
+				return false;
+			}
+
+			const PhysicsQueryHit* pRowHits = Batch.GetHits( RowQuery );
+
+			for( uint32_t i = 0; i < 2; i++ )
+			{
+				std::string Expected = std::format( "Box {0}", i );
+				Ref<Entity> BatchEntity = pRowHits[ i ].Hit;
+
+				if( !BatchEntity || BatchEntity->GetName() != Expected )
+				{
+					Result.Message = std::format( "Hit {0} of the ray along the row is not \"{1}\".", i, Expected );
+					return false;
+				}
+			}
+
+			RaycastHitResult Single = {};
+
+			if( !pPhysicsScene->Raycast( RowOrigin, glm::vec3( 1.0f, 0.0f, 0.0f ), 30.0f, &Single ) || std::abs( pRowHits[ 0 ].Distance - Single.Distance ) > s_QueryDistanceEpsilon )
+			{
+				Result.Message = "The closest hit of the ray along the row does not match a single raycast.";
+				return false;
+			}
+
+			return true;
+		};
+
+		Result.Passed = Check();
+
+		RowScene->OnRuntimeEnd();
+
+		return Result;
+	}
+
+	PhysicsCheckResult PhysicsChecks::MultiShapeContactEvents()
+	{
+		PhysicsCheckResult Result;
+		Result.Name = "MultiShapeContactEvents";
+
+		Ref<StaticMesh> Mesh = Ref<StaticMesh>::Create();
+		Ref<Scene> DropScene = Ref<Scene>::Create();
+
+		Ref<Entity> Floor = CreateBox( DropScene.Get(), Mesh, "Floor", glm::vec3( 0.0f ), glm::vec3( 40.0f, 1.0f, 40.0f ), true );
+		Ref<Entity> Body = CreateBox( DropScene.Get(), Mesh, "Body", glm::vec3( 0.0f, 2.0f, 0.0f ), glm::vec3( 1.0f ), false );
+
+		DropScene->OnRuntimeStart();
+
+		PhysicsScene* pPhysicsScene = DropScene->GetPhysicsScene();
+		pPhysicsScene->SetAsyncStep( false );
+
+		// Colliders only give a body one shape, add a second one next to it with the same material and filter data.
+		physx::PxRigidActor& rActor = Body->GetComponent<RigidbodyComponent>().Rigidbody->GetActor();
+
+		physx::PxShape* pShape = nullptr;
+		rActor.getShapes( &pShape, 1 );
+
+		physx::PxMaterial* pMaterial = nullptr;
+		pShape->getMaterials( &pMaterial, 1 );
+
+		physx::PxShape* pSecondShape = physx::PxRigidActorExt::createExclusiveShape( rActor, physx::PxBoxGeometry( 0.5f, 0.5f, 0.5f ), *pMaterial );
+		pSecondShape->setLocalPose( physx::PxTransform( physx::PxVec3( 1.5f, 0.0f, 0.0f ) ) );
+		pSecondShape->setSimulationFilterData( pShape->getSimulationFilterData() );
+		pSecondShape->setQueryFilterData( pShape->getQueryFilterData() );
+
+		const uint64_t FloorID = Floor->GetUUID();
+		const uint64_t BodyID = Body->GetUUID();
+
+		// Both shapes are at the same height, so they land in the same step.
+		uint32_t Begins = 0;
+
+		for( uint32_t Step = 0; Step < s_ContactSteps && Begins == 0 && Result.Message.empty(); Step++ )
+		{
+			pPhysicsScene->ClearEvents();
+			pPhysicsScene->BeginStep();
+
+			for( const PhysicsContactEvent& rEvent : pPhysicsScene->GetContactEvents() )
+			{
+				if( rEvent.EntityA > rEvent.EntityB )
+				{
+					Result.Message = "A contact event has the higher entity ID as \"A\".";
+					break;
+				}
+
+				if( rEvent.Type == PhysicsEventType::ContactBegin && std::min( FloorID, BodyID ) == rEvent.EntityA && std::max( FloorID, BodyID ) == rEvent.EntityB )
+					Begins++;
+			}
+		}
+
+		if( Result.Message.empty() )
+		{
+			if( Begins == 2 )
+				Result.Passed = true;
+			else
+				Result.Message = std::format( "Landing reported {0} contact begins instead of one for each of the 2 shapes.", Begins );
+		}
+
+		DropScene->OnRuntimeEnd();
+
+		return Result;
+	}
+}
@@ -0,0 +1,62 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Saturn {
+
+	struct PhysicsCheckResult
+	{
+		std::string Name;
+		bool Passed = false;
+
+		// Why the check failed, empty when it passed.
+		std::string Message;
+	};
+
+	// Small physics scenes built in code that check behaviour which is easy to break without noticing.
+	// Run by the headless layer with --physics-checks, the results are written to the stats file.
+	class PhysicsChecks
+	{
+	public:
+		static std::vector<PhysicsCheckResult> RunAll();
+
+		// The same scene updated for the same time at 30 fps and 240 fps must run the same number of fixed steps and reach the exact same poses.
+		// An entity applies forces from its physics update, so the order of gameplay updates and steps is covered too.
+		static PhysicsCheckResult FrameRateDeterminism();
+
+		// Raycasts run by a PhysicsQueryBatch must hit the same entities at the same distances as PhysicsScene::Raycast, multi-hit rays must return the closest hits.
+		static PhysicsCheckResult QueryBatchMatchesRaycast();
+
+		// A body with two shapes landing on the floor must report a contact begin for each shape pair, with the lower entity ID as "A".
+		static PhysicsCheckResult MultiShapeContactEvents();
+	};
+}
@@ -31,21 +31,63 @@
 
 #include "PhysicsAuxiliary.h"
 #include "PhysicsFoundation.h"
+#include "PhysicsShapeTypes.h"
 
 #include "Saturn/Asset/PhysicsMaterialAsset.h"
 #include "Saturn/Asset/AssetManager.h"
 
 #include "Saturn/Core/Math.h"
+#include "Saturn/Core/WorkerPool.h"
+#include "Saturn/Core/Timer.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#include <chrono>
 
 namespace Saturn {
 
 //	static AssetID s_DefaultPhysicsMaterial = 13151293699070629621;
 	static AssetID s_DefaultPhysicsMaterial = 1421817985369887560;
 
+	// Bump when the layout of the cache file or the way keys are made changes.
+	static constexpr uint32_t s_ColliderCacheVersion = 2;
+
+	// Cooked data of meshes that were changed or deleted is never asked for again, without a limit the cache would only grow.
+	static constexpr uint64_t s_MaxColliderCacheSize = 256ull * 1024 * 1024;
+
+	static uint64_t GetTimestamp()
+	{
+		return ( uint64_t ) std::chrono::duration_cast< std::chrono::seconds >( std::chrono::system_clock::now().time_since_epoch() ).count();
+	}
+
+	static std::filesystem::path GetColliderCachePath()
+	{
+		return Project::GetActiveProject()->GetFullCachePath() / "Colliders.smcc";
+	}
+
+	// FNV-1a
+	static uint64_t HashBytes( const void* pData, size_t Size, uint64_t Hash )
+	{
+		const uint8_t* pBytes = ( const uint8_t* ) pData;
+
+		for( size_t i = 0; i < Size; i++ )
+		{
+			Hash ^= pBytes[ i ];
+			Hash *= 1099511628211ull;
+		}
+
+		return Hash;
+	}
+
+	template<typename Ty>
+	static uint64_t HashValue( const Ty& rValue, uint64_t Hash )
+	{
+		return HashBytes( &rValue, sizeof( Ty ), Hash );
+	}
+
 	PhysicsCooking::PhysicsCooking()
+		: m_Params( PhysicsFoundation::Get().m_Physics->getTolerancesScale() )
 	{
-		physx::PxCookingParams Params( PhysicsFoundation::Get().m_Physics->getTolerancesScale() );
-		m_Cooking = PxCreateCooking( PX_PHYSICS_VERSION, *PhysicsFoundation::Get().m_Foundation, Params );
+		m_Cooking = PxCreateCooking( PX_PHYSICS_VERSION, *PhysicsFoundation::Get().m_Foundation, m_Params );
 	}
 
 	PhysicsCooking::~PhysicsCooking()
@@ -55,48 +97,193 @@ namespace Saturn {
 
 	void PhysicsCooking::Terminate()
 	{
+		for( auto& [ Key, rCollider ] : m_CookedData )
+			rCollider.Data.Free();
+
+		m_CookedData.clear();
+
 		PHYSX_TERMINATE_ITEM( m_Cooking );
 	}
 
+	uint64_t PhysicsCooking::GetColliderKey( const Ref<StaticMesh>& rMesh, const Submesh& rSubmesh, ShapeType Type ) const
+	{
+		uint64_t Hash = 14695981039346656037ull;
+
+		Hash = HashValue( ( uint32_t ) PX_PHYSICS_VERSION, Hash );
+		Hash = HashValue( Type, Hash );
+
+		// Only the params that change the cooked data, the struct itself has padding.
+		Hash = HashValue( m_Params.areaTestEpsilon, Hash );
+		Hash = HashValue( m_Params.planeTolerance, Hash );
+		Hash = HashValue( m_Params.convexMeshCookingType, Hash );
+		Hash = HashValue( m_Params.suppressTriangleMeshRemapTable, Hash );
+		Hash = HashValue( m_Params.buildTriangleAdjacencies, Hash );
+		Hash = HashValue( m_Params.buildGPUData, Hash );
+		Hash = HashValue( m_Params.scale.length, Hash );
+		Hash = HashValue( m_Params.scale.speed, Hash );
+		Hash = HashValue( ( uint32_t ) m_Params.meshPreprocessParams, Hash );
+		Hash = HashValue( m_Params.meshWeldTolerance, Hash );
+		Hash = HashValue( m_Params.midphaseDesc.getType(), Hash );
+		Hash = HashValue( m_Params.gaussMapLimit, Hash );
+
+		// Cooking only reads the positions.
+		const StaticVertex* pVertices = &rMesh->Vertices()[ rSubmesh.BaseVertex ];
+
+		for( uint32_t i = 0; i < rSubmesh.VertexCount; i++ )
+			Hash = HashValue( pVertices[ i ].Position, Hash );
+
+		Hash = HashBytes( &rMesh->Indices()[ rSubmesh.BaseIndex / 3 ], ( rSubmesh.IndexCount / 3 ) * sizeof( Index ), Hash );
+
+		return Hash;
+	}
+
+	std::vector<uint64_t> PhysicsCooking::GetColliderKeys( const Ref<StaticMesh>& rMesh, ShapeType Type )
+	{
+		auto Itr = m_ColliderKeys.find( { rMesh.Get(), Type } );
+
+		if( Itr != m_ColliderKeys.end() )
+			return Itr->second.second;
+
+		std::vector<uint64_t> Keys;
+		Keys.reserve( rMesh->Submeshes().size() );
+
+		for( const auto& rSubmesh : rMesh->Submeshes() )
+			Keys.push_back( GetColliderKey( rMesh, rSubmesh, Type ) );
+
+		m_ColliderKeys[ { rMesh.Get(), Type } ] = { rMesh, Keys };
+
+		return Keys;
+	}
+
+	const Buffer* PhysicsCooking::FindCookedData( uint64_t Key )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		auto Itr = m_CookedData.find( Key );
+
+		if( Itr == m_CookedData.end() )
+			return nullptr;
+
+		Itr->second.LastUsed = GetTimestamp();
+
+		return &Itr->second.Data;
+	}
+
 	bool PhysicsCooking::CookMeshCollider( const Ref<StaticMesh>& rMesh, ShapeType Type )
 	{
 		if( Type <= ShapeType::Capusle )
 			return false;
 
-		bool Result = false;
+		return CookMeshColliders( { { rMesh, Type } } );
+	}
+
+	bool PhysicsCooking::CookMeshColliders( const std::vector<MeshColliderRequest>& rRequests )
+	{
+		SAT_PF_EVENT();
+
+		LoadCache();
 
-		switch( Type )
+		struct CookJob
 		{
-			case Saturn::ShapeType::ConvexMesh: 
+			Ref<StaticMesh> Mesh;
+			const Submesh* pSubmesh;
+			ShapeType Type;
+			uint64_t Key;
+			Buffer Result;
+			bool Success;
+		};
+
+		std::vector<CookJob> Jobs;
+		std::unordered_set<uint64_t> QueuedKeys;
+
+		for( const auto& rRequest : rRequests )
+		{
+			if( !rRequest.Mesh || rRequest.Type <= ShapeType::Capusle )
+				continue;
+
+			std::vector<uint64_t> Keys = GetColliderKeys( rRequest.Mesh, rRequest.Type );
+
+			for( size_t i = 0; i < Keys.size(); i++ )
 			{
-				Result = TryCookConvexMesh( rMesh );
-			} break;
+				// Identical submeshes share their cooked data.
+				if( FindCookedData( Keys[ i ] ) || !QueuedKeys.insert( Keys[ i ] ).second )
+					continue;
+
+				Jobs.push_back( { rRequest.Mesh, &rRequest.Mesh->Submeshes()[ i ], rRequest.Type, Keys[ i ], Buffer(), false } );
+			}
+		}
+
+		if( Jobs.empty() )
+			return true;
+
+		Timer CookTimer;
+
+		struct JobState
+		{
+			std::atomic<uint32_t> NextJob = 0;
+			std::atomic<uint32_t> FinishedJobs = 0;
+		};
+
+		uint32_t JobCount = ( uint32_t ) Jobs.size();
 
-			case Saturn::ShapeType::TriangleMesh:
+		// Workers that start after every job was taken only touch the state, so it has to outlive this function.
+		std::shared_ptr<JobState> State = std::make_shared<JobState>();
+
+		auto RunJobs = [this, &Jobs, State, JobCount]()
+		{
+			while( true )
 			{
-				Result = TryCookTriangleMesh( rMesh );
-			} break;
-
-			case Saturn::ShapeType::Unknown:
-			case Saturn::ShapeType::Box:
-			case Saturn::ShapeType::Sphere:
-			case Saturn::ShapeType::Capusle:
-			default:
-				break;
+				uint32_t Index = State->NextJob.fetch_add( 1 );
+
+				if( Index >= JobCount )
+					break;
+
+				CookJob& rJob = Jobs[ Index ];
+				rJob.Success = CookSubmesh( rJob.Mesh, *rJob.pSubmesh, rJob.Type, rJob.Result );
+
+				State->FinishedJobs.fetch_add( 1 );
+			}
+		};
+
+		// The calling thread cooks too.
+		uint32_t WorkerJobs = std::min( JobCount - 1, WorkerPool::Get().GetWorkerCount() );
+
+		for( uint32_t i = 0; i < WorkerJobs; i++ )
+			WorkerPool::Get().Submit( RunJobs );
+
+		RunJobs();
+
+		while( State->FinishedJobs.load() < JobCount )
+			std::this_thread::yield();
+
+		bool Result = true;
+
+		{
+			std::lock_guard<std::mutex> Lock( m_Mutex );
+
+			uint64_t Now = GetTimestamp();
+
+			for( auto& rJob : Jobs )
+			{
+				if( rJob.Success )
+					m_CookedData[ rJob.Key ] = { rJob.Result, Now };
+				else
+					Result = false;
+			}
 		}
 
-		WriteCache( rMesh, Type );
-		ClearCache();
+		SAT_CORE_INFO( "Cooked {0} mesh colliders in {1} ms", JobCount, CookTimer.ElapsedMilliseconds() );
+
+		WriteCache();
 
 		return Result;
 	}
 
-	bool PhysicsCooking::TryCookTriangleMesh( const Ref<StaticMesh>& rMesh )
+	bool PhysicsCooking::CookSubmesh( const Ref<StaticMesh>& rMesh, const Submesh& rSubmesh, ShapeType Type, Buffer& rOut ) const
 	{
-		bool Result = false;
+		physx::PxDefaultMemoryOutputStream stream;
 
-		int i = 0;
-		for( auto& rSubmesh : rMesh->Submeshes() )
+		if( Type == ShapeType::TriangleMesh )
 		{
 			physx::PxTriangleMeshDesc MeshDesc;
 			MeshDesc.points.data = &rMesh->Vertices()[ rSubmesh.BaseVertex ];
@@ -107,34 +294,17 @@ namespace Saturn {
 			MeshDesc.triangles.count = rSubmesh.IndexCount / 3;
 			MeshDesc.triangles.stride = sizeof( Index );
 
-			physx::PxDefaultMemoryOutputStream stream;
 			physx::PxTriangleMeshCookingResult::Enum errorCode;
 
-			if( Result = m_Cooking->cookTriangleMesh( MeshDesc, stream, &errorCode ) )
+			if( !m_Cooking->cookTriangleMesh( MeshDesc, stream, &errorCode ) )
 			{
-				SubmeshColliderData data{};
-				data.Index = i;
-				data.Stream = Buffer::Copy( stream.getData(), stream.getSize() );
-
-				m_SubmeshData.push_back( data );
-			}
-			else
-			{ 
 				SAT_CORE_ERROR( "PhysX Cooking error code was: {0}", errorCode );
-				SAT_CORE_INFO( "Please check the log for more info.", errorCode );
-			}
+				SAT_CORE_INFO( "Please check the log for more info." );
 
-			i++;
+				return false;
+			}
 		}
-
-		return Result;
-	}
-
-	bool PhysicsCooking::TryCookConvexMesh( const Ref<StaticMesh>& rMesh )
-	{
-		bool Result = false;
-
-		for( auto& rSubmesh : rMesh->Submeshes() )
+		else
 		{
 			physx::PxConvexMeshDesc MeshDesc;
 			MeshDesc.points.data = &rMesh->Vertices()[ rSubmesh.BaseVertex ];
@@ -147,94 +317,192 @@ namespace Saturn {
 
 			MeshDesc.flags = physx::PxConvexFlag::Enum::eCOMPUTE_CONVEX | physx::PxConvexFlag::eSHIFT_VERTICES;
 
-			physx::PxDefaultMemoryOutputStream stream;
 			physx::PxConvexMeshCookingResult::Enum errorCode;
 
-			if( Result = m_Cooking->cookConvexMesh( MeshDesc, stream, &errorCode ) )
-			{
-				SubmeshColliderData data{};
-				data.Index = 0;
-				data.Stream = Buffer::Copy( stream.getData(), stream.getSize() );
-
-				m_SubmeshData.push_back( data );
-			}
-			else
+			if( !m_Cooking->cookConvexMesh( MeshDesc, stream, &errorCode ) )
 			{
 				SAT_CORE_ERROR( "PhysX Cooking error code was: {0}", errorCode );
-				SAT_CORE_INFO( "Please check the log for more info.", errorCode );
+				SAT_CORE_INFO( "Please check the log for more info." );
+
+				return false;
 			}
 		}
 
-		return Result;
+		rOut = Buffer::Copy( stream.getData(), stream.getSize() );
+
+		return true;
 	}
 
-	bool PhysicsCooking::LoadColliderFile( const std::filesystem::path& rPath )
+	void PhysicsCooking::LoadCache()
 	{
-		if( !std::filesystem::exists( rPath ) )
-			return false;
+		std::lock_guard<std::mutex> Lock( m_Mutex );
 
-		Buffer fileBuffer;
-		std::ifstream stream( rPath, std::ios::binary | std::ios::ate );
+		if( m_CacheLoaded )
+			return;
 
-		auto end = stream.tellg();
-		stream.seekg( 0, std::ios::beg );
-		auto size = end - stream.tellg();
+		m_CacheLoaded = true;
 
-		fileBuffer.Allocate( ( size_t ) size );
-		stream.read( reinterpret_cast< char* >( fileBuffer.Data ), fileBuffer.Size );
+		std::filesystem::path cachePath = GetColliderCachePath();
 
-		stream.close();
+		if( !std::filesystem::exists( cachePath ) )
+			return;
+
+		std::error_code ErrorCode;
+		uint64_t FileSize = std::filesystem::file_size( cachePath, ErrorCode );
+
+		std::ifstream stream( cachePath, std::ios::binary );
 
-		MeshCacheHeader hd = *( MeshCacheHeader* ) fileBuffer.Data;
+		ColliderCacheHeader hd{};
+		stream.read( reinterpret_cast< char* >( &hd ), sizeof( ColliderCacheHeader ) );
 
-		if( strcmp( hd.pHeader, "SMC\0" ) )
+		if( ErrorCode || !stream || memcmp( hd.Magic, "SMCC", 4 ) || hd.Version != s_ColliderCacheVersion )
 		{
-			SAT_CORE_ASSERT( false, "Invalid file header!" );
-			return false;
+			SAT_CORE_WARN( "Collider cache '{0}' is invalid or out of date, colliders will be cooked again.", cachePath.string() );
+			return;
 		}
 
-		if( hd.Type <= ShapeType::Capusle )
+		// The counts and offsets come from disk, check them against the file before allocating or seeking anything.
+		if( hd.Entries > ( FileSize - sizeof( ColliderCacheHeader ) ) / sizeof( ColliderCacheEntry ) )
 		{
-			SAT_CORE_ASSERT( false, "Invalid mesh collider type! Must be TriangleMesh or ConvexMesh." );
-			return false;
+			SAT_CORE_WARN( "Collider cache '{0}' is corrupt, colliders will be cooked again.", cachePath.string() );
+			return;
 		}
 
-		uint8_t* colliderData = fileBuffer.As<uint8_t>() + sizeof( MeshCacheHeader );
+		std::vector<ColliderCacheEntry> Entries( hd.Entries );
+		stream.read( reinterpret_cast< char* >( Entries.data() ), Entries.size() * sizeof( ColliderCacheEntry ) );
 
-		for( uint32_t i = 0; i < hd.Submeshes; i++ )
+		const uint64_t DataStart = sizeof( ColliderCacheHeader ) + hd.Entries * sizeof( ColliderCacheEntry );
+
+		for( const auto& rEntry : Entries )
 		{
-			SubmeshColliderData submesh{};
+			if( rEntry.Offset < DataStart || rEntry.Size > FileSize || rEntry.Offset > FileSize - rEntry.Size )
+			{
+				SAT_CORE_WARN( "Collider cache '{0}' is corrupt, colliders will be cooked again.", cachePath.string() );
+				return;
+			}
+		}
 
-			uint32_t index = *( uint32_t* ) colliderData;
+		for( const auto& rEntry : Entries )
+		{
+			Buffer Data;
+			Data.Allocate( rEntry.Size );
 
-			colliderData += sizeof( uint32_t );
+			stream.seekg( rEntry.Offset );
+			stream.read( reinterpret_cast< char* >( Data.Data ), Data.Size );
 
-			size_t size = *( size_t* ) colliderData;
+			if( !stream )
+			{
+				SAT_CORE_WARN( "Collider cache '{0}' is truncated.", cachePath.string() );
 
-			colliderData += sizeof( size_t );
+				Data.Free();
+				break;
+			}
 
-			submesh.Index = index;
-			submesh.Stream = Buffer::Copy( colliderData, size );
+			m_CookedData[ rEntry.Key ] = { Data, rEntry.LastUsed };
+		}
+	}
 
-			m_SubmeshData.push_back( submesh );
+	void PhysicsCooking::WriteCache()
+	{
+		SAT_PF_EVENT();
 
-			colliderData += size;
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		std::filesystem::path cachePath = GetColliderCachePath();
+
+		std::error_code ErrorCode;
+		std::filesystem::create_directories( cachePath.parent_path(), ErrorCode );
+
+		// Most recently used first, everything past the size limit is left out.
+		std::vector<std::pair<uint64_t, const CookedCollider*>> Colliders;
+		Colliders.reserve( m_CookedData.size() );
+
+		for( const auto& [ Key, rCollider ] : m_CookedData )
+			Colliders.push_back( { Key, &rCollider } );
+
+		std::sort( Colliders.begin(), Colliders.end(), []( const auto& a, const auto& b )
+			{
+				if( a.second->LastUsed != b.second->LastUsed )
+					return a.second->LastUsed > b.second->LastUsed;
+
+				return a.first < b.first;
+			} );
+
+		uint64_t DataSize = 0;
+		size_t KeptColliders = 0;
+
+		for( ; KeptColliders < Colliders.size(); KeptColliders++ )
+		{
+			uint64_t Size = Colliders[ KeptColliders ].second->Data.Size;
+
+			if( DataSize + Size > s_MaxColliderCacheSize )
+				break;
+
+			DataSize += Size;
 		}
 
-		fileBuffer.Free();
+		if( KeptColliders < Colliders.size() )
+			SAT_CORE_INFO( "Collider cache is over {0} MB, dropped {1} least recently used entries.", s_MaxColliderCacheSize / ( 1024 * 1024 ), Colliders.size() - KeptColliders );
 
-		return true;
+		Colliders.resize( KeptColliders );
+
+		ColliderCacheHeader hd{};
+		memcpy( hd.Magic, "SMCC", 4 );
+		hd.Version = s_ColliderCacheVersion;
+		hd.Entries = Colliders.size();
+
+		std::vector<ColliderCacheEntry> Entries;
+		Entries.reserve( Colliders.size() );
+
+		uint64_t Offset = sizeof( ColliderCacheHeader ) + Colliders.size() * sizeof( ColliderCacheEntry );
+
+		for( const auto& [ Key, pCollider ] : Colliders )
+		{
+			Entries.push_back( { Key, Offset, pCollider->Data.Size, pCollider->LastUsed } );
+			Offset += pCollider->Data.Size;
+		}
+
+		// Written next to the cache and swapped in, so a crash never leaves half a file behind.
+		std::filesystem::path tempPath = cachePath;
+		tempPath.replace_extension( ".tmp" );
+
+		{
+			std::ofstream fout( tempPath, std::ios::binary | std::ios::trunc );
+
+			fout.write( reinterpret_cast< char* >( &hd ), sizeof( ColliderCacheHeader ) );
+			fout.write( reinterpret_cast< char* >( Entries.data() ), Entries.size() * sizeof( ColliderCacheEntry ) );
+
+			for( const auto& [ Key, pCollider ] : Colliders )
+				fout.write( reinterpret_cast< const char* >( pCollider->Data.Data ), pCollider->Data.Size );
+
+			if( !fout )
+			{
+				SAT_CORE_WARN( "Failed to write collider cache '{0}'.", tempPath.string() );
+
+				fout.close();
+				std::filesystem::remove( tempPath, ErrorCode );
+
+				return;
+			}
+		}
+
+		std::filesystem::rename( tempPath, cachePath, ErrorCode );
+
+		// E.g. the cache is open in another editor instance, the cooked data is still used for this session.
+		if( ErrorCode )
+		{
+			SAT_CORE_WARN( "Failed to replace collider cache '{0}': {1}", cachePath.string(), ErrorCode.message() );
+
+			std::filesystem::remove( tempPath, ErrorCode );
+		}
 	}
 
 	std::vector<physx::PxShape*> PhysicsCooking::CreateTriangleMesh( const Ref<StaticMesh>& rMesh, physx::PxRigidActor& rActor, glm::vec3 Scale )
 	{
 		std::vector<physx::PxShape*> Shapes;
 
-		std::filesystem::path cachePath = Project::GetActiveProject()->GetFullCachePath();
-		cachePath /= rMesh->GetName();
-		cachePath.replace_extension( ".smcs" );
-
-		if( !LoadColliderFile( cachePath ) )
+		// Only cooks when the scene did not cook its colliders up front, or the mesh changed.
+		if( !CookMeshCollider( rMesh, ShapeType::TriangleMesh ) )
 			return Shapes;
 
 		auto& materialID = rMesh->GetPhysicsMaterial();
@@ -255,16 +523,21 @@ namespace Saturn {
 
 		// TEMP: We might want to change the filter data.
 		physx::PxFilterData data;
-		data.word0 = BIT( 0 );
-		data.word1 = BIT( 0 );
+		data.word0 = PHYSICS_DEFAULT_LAYER;
+		data.word1 = PHYSICS_DEFAULT_LAYER;
 
-		int i = 0;
-		for( const auto& rCookedData : m_SubmeshData )
+		std::vector<uint64_t> Keys = GetColliderKeys( rMesh, ShapeType::TriangleMesh );
+
+		for( size_t i = 0; i < Keys.size(); i++ )
 		{
 			const Submesh& rSubmesh = rMesh->Submeshes()[ i ];
+			const Buffer* pCookedData = FindCookedData( Keys[ i ] );
+
+			if( !pCookedData )
+				continue;
 
 			// Read the cooked data.
-			physx::PxDefaultMemoryInputData readBuffer( rCookedData.Stream.Data, static_cast< physx::PxU32 >( rCookedData.Stream.Size ) );
+			physx::PxDefaultMemoryInputData readBuffer( pCookedData->Data, static_cast< physx::PxU32 >( pCookedData->Size ) );
 			physx::PxTriangleMesh* mesh = PhysicsFoundation::Get().GetPhysics().createTriangleMesh( readBuffer );
 
 			// Create the shape.
@@ -283,18 +556,15 @@ namespace Saturn {
 			pShape->setFlag( physx::PxShapeFlag::eTRIGGER_SHAPE, false );
 			pShape->setLocalPose( Auxiliary::GLMTransformToPx( submeshPosition, submeshRotation ) );
 			pShape->setSimulationFilterData( data );
+			pShape->setQueryFilterData( data );
 
 			mesh->release();
 
 			rActor.attachShape( *pShape );
 
 			Shapes.push_back( pShape );
-
-			i++;
 		}
 
-		ClearCache();
-
 		return Shapes;
 	}
 
@@ -302,12 +572,8 @@ namespace Saturn {
 	{
 		std::vector<physx::PxShape*> Shapes;
 
-		// Load the cache.
-		std::filesystem::path cachePath = Project::GetActiveProject()->GetFullCachePath();
-		cachePath /= rMesh->GetName();
-		cachePath.replace_extension( ".smcs" );
-
-		if( !LoadColliderFile( cachePath ) )
+		// Only cooks when the scene did not cook its colliders up front, or the mesh changed.
+		if( !CookMeshCollider( rMesh, ShapeType::ConvexMesh ) )
 			return Shapes;
 
 		auto& materialID = rMesh->GetPhysicsMaterial();
@@ -328,15 +594,20 @@ namespace Saturn {
 
 		// TEMP: We might want to change the filter data.
 		physx::PxFilterData data;
-		data.word0 = BIT( 0 );
-		data.word1 = BIT( 0 );
+		data.word0 = PHYSICS_DEFAULT_LAYER;
+		data.word1 = PHYSICS_DEFAULT_LAYER;
 
-		int i = 0;
-		for( const auto& rCookedData : m_SubmeshData )
+		std::vector<uint64_t> Keys = GetColliderKeys( rMesh, ShapeType::ConvexMesh );
+
+		for( size_t i = 0; i < Keys.size(); i++ )
 		{
 			const Submesh& rSubmesh = rMesh->Submeshes()[ i ];
+			const Buffer* pCookedData = FindCookedData( Keys[ i ] );
+
+			if( !pCookedData )
+				continue;
 
-			physx::PxDefaultMemoryInputData InputBuffer( rCookedData.Stream.Data, static_cast< physx::PxU32 >( rCookedData.Stream.Size ) );
+			physx::PxDefaultMemoryInputData InputBuffer( pCookedData->Data, static_cast< physx::PxU32 >( pCookedData->Size ) );
 			physx::PxConvexMesh* pMesh = PhysicsFoundation::Get().GetPhysics().createConvexMesh( InputBuffer );
 
 			glm::vec3 submeshPosition, submeshRotation, submeshScale;
@@ -355,52 +626,15 @@ namespace Saturn {
 			pShape->setFlag( physx::PxShapeFlag::eTRIGGER_SHAPE, false );
 			pShape->setLocalPose( Auxiliary::GLMTransformToPx( submeshPosition, submeshRotation ) );
 			pShape->setSimulationFilterData( data );
+			pShape->setQueryFilterData( data );
 
 			pMesh->release();
 
 			rActor.attachShape( *pShape );
 
 			Shapes.push_back( pShape );
-
-			i++;
 		}
 
-		ClearCache();
-
 		return Shapes;
 	}
-
-	void PhysicsCooking::WriteCache( const Ref<StaticMesh>& rMesh, ShapeType Type )
-	{
-		std::filesystem::path cachePath = Project::GetActiveProject()->GetFullCachePath();
-
-		if( !std::filesystem::exists( cachePath ) )
-			std::filesystem::create_directories( cachePath );
-
-		cachePath /= rMesh->GetName();
-		cachePath.replace_extension(".smcs" );
-
-		MeshCacheHeader hd{};
-		hd.ID = rMesh->ID;
-		hd.Submeshes = rMesh->Submeshes().size();
-		hd.Type = Type;
-
-		std::ofstream fout( cachePath, std::ios::binary | std::ios::trunc );
-
-		fout.write( reinterpret_cast< char* >( &hd ), sizeof( MeshCacheHeader ) );
-
-		for( auto& rMeshData : m_SubmeshData )
-		{
-			fout.write( reinterpret_cast<char*>( &rMeshData.Index ), sizeof( uint32_t ) );
-
-			fout.write( reinterpret_cast< char* >( &rMeshData.Stream.Size ), sizeof( size_t ) );
-
-			fout.write( reinterpret_cast< char* >( rMeshData.Stream.Data ), rMeshData.Stream.Size );
-		}
-	}
-
-	void PhysicsCooking::ClearCache()
-	{
-		m_SubmeshData.clear();
-	}
 }
\ No newline at end of file
@@ -32,22 +32,38 @@
 
 #include "PxPhysicsAPI.h"
 
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
 namespace Saturn {
 
-	// File header
-	struct MeshCacheHeader
+	// Collider cache file, every project has one with the cooked data of all mesh colliders.
+	// Layout: header, table of contents (one entry per cooked submesh), then the cooked data.
+	struct ColliderCacheHeader
 	{
-		const char pHeader[ 5 ] = "SMC\0";
-		uint64_t ID = 0;
-		size_t Submeshes = 0;
-		ShapeType Type;
+		char Magic[ 4 ];
+		uint32_t Version;
+		uint64_t Entries;
 	};
 
-	// Data for each submesh
-	struct SubmeshColliderData
+	struct ColliderCacheEntry
 	{
-		uint32_t Index;
-		Buffer Stream;
+		// Hash of the submesh's vertex and index data, the shape type and the cooking params.
+		uint64_t Key;
+
+		// From the start of the file.
+		uint64_t Offset;
+		uint64_t Size;
+
+		// Seconds since the epoch, the least recently used entries are dropped first when the cache gets too big.
+		uint64_t LastUsed;
+	};
+
+	struct MeshColliderRequest
+	{
+		Ref<StaticMesh> Mesh;
+		ShapeType Type;
 	};
 
 	class PhysicsCooking
@@ -58,28 +74,55 @@ namespace Saturn {
 		PhysicsCooking();
 		~PhysicsCooking();
 
-		// Cook mesh collider to a triangle mesh, if the collider cache does not exist we will create it if it does exist we will not override it and we will not cook the mesh.
+		// Cook mesh collider to a triangle mesh or convex mesh, submeshes that are already in the cache are not cooked again.
 		// For Static meshes only!
 		bool CookMeshCollider( const Ref<StaticMesh>& rMesh, ShapeType Type );
 
+		// Cooks every submesh of every request that is not in the cache on the engine workers, and writes the cache once at the end.
+		bool CookMeshColliders( const std::vector<MeshColliderRequest>& rRequests );
+
 		std::vector<physx::PxShape*> CreateTriangleMesh( const Ref<StaticMesh>& rMesh, physx::PxRigidActor& rActor, glm::vec3 Scale );
 
 		std::vector<physx::PxShape*> CreateConvexMesh( const Ref<StaticMesh>& rMesh, physx::PxRigidActor& rActor, glm::vec3 Scale );
 
+		// Keys are remembered per mesh so every instance of a mesh does not hash it again, call this once a batch of shapes was created.
+		void ClearColliderKeys() { m_ColliderKeys.clear(); }
+
 	private:
 		void Terminate();
-		void ClearCache();
-		void WriteCache( const Ref<StaticMesh>& rMesh, ShapeType Type );
-		bool LoadColliderFile( const std::filesystem::path& rPath );
 
-		bool TryCookTriangleMesh( const Ref<StaticMesh>& rMesh );
-		bool TryCookConvexMesh( const Ref<StaticMesh>& rMesh );
+		// Scale is applied to the shape with a PxMeshScale, it is not part of the cooked data or the key.
+		uint64_t GetColliderKey( const Ref<StaticMesh>& rMesh, const Submesh& rSubmesh, ShapeType Type ) const;
 
-	private:
+		// Key of every submesh in order.
+		std::vector<uint64_t> GetColliderKeys( const Ref<StaticMesh>& rMesh, ShapeType Type );
+
+		// Null when the submesh has not been cooked, marks the data as used.
+		const Buffer* FindCookedData( uint64_t Key );
+
+		bool CookSubmesh( const Ref<StaticMesh>& rMesh, const Submesh& rSubmesh, ShapeType Type, Buffer& rOut ) const;
+
+		void LoadCache();
 
-		std::vector<SubmeshColliderData> m_SubmeshData;
+		// The least recently used entries are left out of the file once it would get too big, they stay in memory until the cooking is terminated.
+		void WriteCache();
+
+	private:
+		struct CookedCollider
+		{
+			Buffer Data;
+			uint64_t LastUsed = 0;
+		};
 
 	private:
 		physx::PxCooking* m_Cooking = nullptr;
+		physx::PxCookingParams m_Params;
+
+		std::mutex m_Mutex;
+		std::unordered_map<uint64_t, CookedCollider> m_CookedData;
+		bool m_CacheLoaded = false;
+
+		// The mesh is kept alive so the pointer can not be reused by another mesh.
+		std::map<std::pair<const StaticMesh*, ShapeType>, std::pair<Ref<StaticMesh>, std::vector<uint64_t>>> m_ColliderKeys;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,102 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "PhysicsDispatcher.h"
+
+#include "Saturn/Core/WorkerPool.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+namespace Saturn {
+
+	PhysicsDispatcher::PhysicsDispatcher( uint32_t WorkerBudget )
+	{
+		SetWorkerBudget( WorkerBudget );
+	}
+
+	PhysicsDispatcher::~PhysicsDispatcher()
+	{
+		// PhysX only releases the dispatcher once every scene using it is gone.
+		SAT_CORE_ASSERT( m_Tasks.empty() && m_ActiveWorkers == 0, "PhysX tasks are still running!" );
+	}
+
+	void PhysicsDispatcher::SetWorkerBudget( uint32_t WorkerBudget )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		m_WorkerBudget = std::clamp<uint32_t>( WorkerBudget, 1, std::max<uint32_t>( WorkerPool::Get().GetWorkerCount(), 1 ) );
+	}
+
+	void PhysicsDispatcher::submitTask( physx::PxBaseTask& rTask )
+	{
+		{
+			std::lock_guard<std::mutex> Lock( m_Mutex );
+
+			m_Tasks.push_back( &rTask );
+
+			if( m_ActiveWorkers >= m_WorkerBudget )
+				return;
+
+			m_ActiveWorkers++;
+		}
+
+		// The step is on the frame's critical path.
+		WorkerPool::Get().Submit( [this]() { RunTasks(); }, WorkerPriority::High );
+	}
+
+	void PhysicsDispatcher::RunTasks()
+	{
+		while( true )
+		{
+			physx::PxBaseTask* pTask = nullptr;
+
+			{
+				std::lock_guard<std::mutex> Lock( m_Mutex );
+
+				if( m_Tasks.empty() )
+				{
+					m_ActiveWorkers--;
+					return;
+				}
+
+				pTask = m_Tasks.front();
+				m_Tasks.pop_front();
+			}
+
+			{
+				SAT_PF_EVENT();
+				SAT_PF_ZONE_NAME( pTask->getName() );
+
+				pTask->run();
+			}
+
+			pTask->release();
+		}
+	}
+
+}
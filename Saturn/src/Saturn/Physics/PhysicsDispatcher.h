@@ -0,0 +1,65 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Base.h"
+
+#include "PxPhysicsAPI.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace Saturn {
+
+	// Runs PhysX tasks on the engine's WorkerPool instead of a second set of threads owned by PhysX.
+	// At most "WorkerBudget" tasks run at the same time, the rest of the pool stays free for other systems.
+	class PhysicsDispatcher : public physx::PxCpuDispatcher
+	{
+	public:
+		PhysicsDispatcher( uint32_t WorkerBudget );
+		~PhysicsDispatcher() override;
+
+		void submitTask( physx::PxBaseTask& rTask ) override;
+		uint32_t getWorkerCount() const override { return m_WorkerBudget; }
+
+		void SetWorkerBudget( uint32_t WorkerBudget );
+
+	private:
+		void RunTasks();
+	private:
+		uint32_t m_WorkerBudget = 1;
+
+		std::mutex m_Mutex;
+		std::deque<physx::PxBaseTask*> m_Tasks;
+
+		// Pool jobs that are currently draining "m_Tasks".
+		uint32_t m_ActiveWorkers = 0;
+	};
+}
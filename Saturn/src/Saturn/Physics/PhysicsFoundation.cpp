@@ -32,8 +32,22 @@
 #include "PhysicsAuxiliary.h"
 #include "PhysicsRigidBody.h"
 
+#include "Saturn/Project/Project.h"
+
+#include "Saturn/Core/OptickProfiler.h"
+
 namespace Saturn {
 
+	// Reserved up front so a busy step does not allocate in the middle of fetchResults.
+	static constexpr size_t s_ReservedEvents = 1024;
+	static constexpr size_t s_MaxContactPoints = 64;
+
+	PhysicsContact::PhysicsContact()
+	{
+		m_Events.reserve( s_ReservedEvents );
+		m_ContactPoints.resize( s_MaxContactPoints );
+	}
+
 	void PhysicsContact::onConstraintBreak( physx::PxConstraintInfo* pConstraints, physx::PxU32 Count )
 	{
 	}
@@ -48,6 +62,27 @@ namespace Saturn {
 
 	void PhysicsContact::onTrigger( physx::PxTriggerPair* pPairs, physx::PxU32 Count )
 	{
+		for( physx::PxU32 i = 0; i < Count; i++ )
+		{
+			const physx::PxTriggerPair& rPair = pPairs[ i ];
+
+			// One of the shapes was removed during the step, its body might not exist anymore.
+			if( rPair.flags & ( physx::PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER | physx::PxTriggerPairFlag::eREMOVED_SHAPE_OTHER ) )
+				continue;
+
+			PhysicsRigidBody* pTrigger = ( PhysicsRigidBody* ) rPair.triggerActor->userData;
+			PhysicsRigidBody* pOther = ( PhysicsRigidBody* ) rPair.otherActor->userData;
+
+			if( !pTrigger || !pOther )
+				continue;
+
+			glm::vec3 Zero = glm::vec3( 0.0f );
+
+			if( rPair.status == physx::PxPairFlag::eNOTIFY_TOUCH_FOUND )
+				AddEvent( PhysicsEventType::TriggerEnter, pTrigger, pOther, Zero, Zero, Zero );
+			else if( rPair.status == physx::PxPairFlag::eNOTIFY_TOUCH_LOST )
+				AddEvent( PhysicsEventType::TriggerExit, pTrigger, pOther, Zero, Zero, Zero );
+		}
 	}
 
 	void PhysicsContact::onAdvance( const physx::PxRigidBody* const* pBodyBuffer, const physx::PxTransform* PoseBuffer, const physx::PxU32 Count )
@@ -56,38 +91,138 @@ namespace Saturn {
 
 	void PhysicsContact::onContact( const physx::PxContactPairHeader& rPairHeader, const physx::PxContactPair* pPairs, physx::PxU32 Pairs )
 	{
+		if( rPairHeader.flags & ( physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_0 | physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_1 ) )
+			return;
+
 		PhysicsRigidBody* A = ( PhysicsRigidBody* ) rPairHeader.actors[ 0 ]->userData;
 		PhysicsRigidBody* B = ( PhysicsRigidBody* ) rPairHeader.actors[ 1 ]->userData;
 
 		if( !A || !B )
 			return;
 
-		auto callCollisonBeginMethod = []( PhysicsRigidBody* A, PhysicsRigidBody* B )
+		// PhysX can report the same pair either way round, always put the lower entity ID first so sorting and dispatching do not depend on it.
+		// The normal and impulse point from B to A, so they flip with the pair.
+		float Direction = 1.0f;
+
+		if( A->GetEntity()->GetUUID() > B->GetEntity()->GetUUID() )
 		{
-			if( A->m_OnMeshHit )
-				A->OnCollisionHit( B->GetEntity() );
-			
-			if( B->m_OnMeshHit )
-				B->OnCollisionHit( A->GetEntity() );
-		};
+			std::swap( A, B );
+			Direction = -1.0f;
+		}
 
-		auto callCollisonExitMethod = []( PhysicsRigidBody* A, PhysicsRigidBody* B )
+		for( physx::PxU32 i = 0; i < Pairs; i++ )
 		{
-			if( A->m_OnMeshExit )
-				A->OnCollisionExit( B->GetEntity() );
+			const physx::PxContactPair& rPair = pPairs[ i ];
 
-			if( B->m_OnMeshExit )
-				B->OnCollisionExit( A->GetEntity() );
-		};
+			glm::vec3 Point = glm::vec3( 0.0f );
+			glm::vec3 Normal = glm::vec3( 0.0f );
+			glm::vec3 Impulse = glm::vec3( 0.0f );
+
+			physx::PxU32 PointCount = rPair.contactCount > 0 ? rPair.extractContacts( m_ContactPoints.data(), ( physx::PxU32 ) m_ContactPoints.size() ) : 0;
+
+			for( physx::PxU32 j = 0; j < PointCount; j++ )
+			{
+				Point += Auxiliary::PxToGLM( m_ContactPoints[ j ].position );
+				Impulse += Auxiliary::PxToGLM( m_ContactPoints[ j ].impulse );
+			}
+
+			if( PointCount > 0 )
+			{
+				Point /= ( float ) PointCount;
+				Normal = Auxiliary::PxToGLM( m_ContactPoints[ 0 ].normal ) * Direction;
+				Impulse *= Direction;
+			}
+
+			// A pair can report several of these at once, e.g. found and lost in the same step.
+			// CCD touches are not a begin, they are reported again for pairs that already touch and have no matching lost event.
+			if( rPair.events & physx::PxPairFlag::eNOTIFY_TOUCH_FOUND )
+				AddEvent( PhysicsEventType::ContactBegin, A, B, Point, Normal, Impulse );
+
+			if( rPair.events & physx::PxPairFlag::eNOTIFY_TOUCH_PERSISTS )
+				AddEvent( PhysicsEventType::ContactPersist, A, B, Point, Normal, Impulse );
+
+			if( rPair.events & physx::PxPairFlag::eNOTIFY_TOUCH_LOST )
+				AddEvent( PhysicsEventType::ContactEnd, A, B, Point, Normal, Impulse );
+		}
+	}
+
+	void PhysicsContact::AddEvent( PhysicsEventType Type, PhysicsRigidBody* pA, PhysicsRigidBody* pB, const glm::vec3& Point, const glm::vec3& Normal, const glm::vec3& Impulse )
+	{
+		PhysicsContactEvent Event = {};
+		Event.Type = Type;
+		Event.pA = pA;
+		Event.pB = pB;
+		Event.EntityA = pA->GetEntity()->GetUUID();
+		Event.EntityB = pB->GetEntity()->GetUUID();
+		Event.Point = Point;
+		Event.Normal = Normal;
+		Event.Impulse = Impulse;
+
+		m_Events.push_back( Event );
+	}
 
-		if( pPairs->flags == physx::PxContactPairFlag::eACTOR_PAIR_HAS_FIRST_TOUCH ) 
+	void PhysicsContact::DispatchEvents()
+	{
+		SAT_PF_EVENT();
+
+		// PhysX does not promise an order for the pairs, sort them so callbacks always run the same way.
+		auto First = m_Events.begin() + m_DispatchedEvents;
+
+		std::stable_sort( First, m_Events.end(), []( const PhysicsContactEvent& a, const PhysicsContactEvent& b )
+			{
+				if( a.EntityA != b.EntityA ) return a.EntityA < b.EntityA;
+				if( a.EntityB != b.EntityB ) return a.EntityB < b.EntityB;
+
+				return a.Type < b.Type;
+			} );
+
+		auto Call = []( const std::function<void( Ref<Entity> )>& rFunc, PhysicsRigidBody* pOther )
 		{
-			callCollisonBeginMethod( A, B );
-		} 
-		else if( pPairs->flags == physx::PxContactPairFlag::eACTOR_PAIR_LOST_TOUCH ) 
+			if( rFunc )
+				rFunc( pOther->GetEntity() );
+		};
+
+		for( size_t i = m_DispatchedEvents; i < m_Events.size(); i++ )
 		{
-			callCollisonExitMethod( A, B );
+			const PhysicsContactEvent& Event = m_Events[ i ];
+
+			switch( Event.Type )
+			{
+				case PhysicsEventType::ContactBegin:
+					Call( Event.pA->m_OnMeshHit, Event.pB );
+					Call( Event.pB->m_OnMeshHit, Event.pA );
+					break;
+
+				case PhysicsEventType::ContactPersist:
+					Call( Event.pA->m_OnMeshStay, Event.pB );
+					Call( Event.pB->m_OnMeshStay, Event.pA );
+					break;
+
+				case PhysicsEventType::ContactEnd:
+					Call( Event.pA->m_OnMeshExit, Event.pB );
+					Call( Event.pB->m_OnMeshExit, Event.pA );
+					break;
+
+				case PhysicsEventType::TriggerEnter:
+					Call( Event.pA->m_OnTriggerEnter, Event.pB );
+					Call( Event.pB->m_OnTriggerEnter, Event.pA );
+					break;
+
+				case PhysicsEventType::TriggerExit:
+					Call( Event.pA->m_OnTriggerExit, Event.pB );
+					Call( Event.pB->m_OnTriggerExit, Event.pA );
+					break;
+			}
 		}
+
+		m_DispatchedEvents = m_Events.size();
+	}
+
+	void PhysicsContact::ClearEvents()
+	{
+		// Keeps the capacity, and the events of a step that was waited on but has not been dispatched yet.
+		m_Events.erase( m_Events.begin(), m_Events.begin() + m_DispatchedEvents );
+		m_DispatchedEvents = 0;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -104,12 +239,19 @@ namespace Saturn {
 
 	void PhysicsFoundation::Init()
 	{
+		// Projects without physics settings (or no project at all) use the defaults.
+		PhysicsSettings Settings{};
+
+		if( Project::GetActiveProject() )
+			Settings = Project::GetActiveProject()->GetPhysicsSettings();
+
 		physx::PxTolerancesScale Scale;
-		Scale.length = 10.0f;
+		Scale.length = Settings.ToleranceLength;
+		Scale.speed = Settings.ToleranceSpeed;
 
 		m_Foundation = PxCreateFoundation( PX_PHYSICS_VERSION, m_AllocatorCallback, m_ErrorCallback );
 
-#if defined( SAT_DEBUG ) || defined( SAT_RELEASE )
+#if defined( SAT_PHYSX_PVD )
 		m_Pvd = PxCreatePvd( *m_Foundation );
 		m_Physics = PxCreatePhysics( PX_PHYSICS_VERSION, *m_Foundation, Scale, true, m_Pvd );
 #else
@@ -117,37 +259,61 @@ namespace Saturn {
 #endif
 		m_Cooking = PxCreateCooking( PX_PHYSICS_VERSION, *m_Foundation, Scale );
 
-		m_Dispatcher = physx::PxDefaultCpuDispatcherCreate( std::thread::hardware_concurrency() / 2 );
+		m_Dispatcher = new PhysicsDispatcher( std::thread::hardware_concurrency() / 2 );
 
 		physx::PxSetAssertHandler( m_AssertCallback );
 	}
 
 	void PhysicsFoundation::Terminate()
 	{
-#if defined( SAT_DEBUG ) || defined( SAT_RELEASE )
-		m_Pvd->disconnect();
-#endif
+		DisconnectPVD();
 
-		PHYSX_TERMINATE_ITEM( m_Dispatcher );
+		delete m_Dispatcher;
+		m_Dispatcher = nullptr;
+
+		PHYSX_TERMINATE_ITEM( m_DefaultDispatcher );
 		PHYSX_TERMINATE_ITEM( m_Cooking );
 		PHYSX_TERMINATE_ITEM( m_Physics );
 		PHYSX_TERMINATE_ITEM( m_Pvd );
+		PHYSX_TERMINATE_ITEM( m_PvdTransport );
 		PHYSX_TERMINATE_ITEM( m_Foundation );
 	}
 
+	physx::PxCpuDispatcher* PhysicsFoundation::GetDispatcher()
+	{
+		if( m_UseEngineWorkers )
+			return m_Dispatcher;
+
+		// Same thread count the engine workers get by default.
+		if( !m_DefaultDispatcher )
+			m_DefaultDispatcher = physx::PxDefaultCpuDispatcherCreate( std::thread::hardware_concurrency() / 2 );
+
+		return m_DefaultDispatcher;
+	}
+
+	void PhysicsFoundation::SetWorkerBudget( uint32_t WorkerBudget )
+	{
+		if( m_Dispatcher )
+			m_Dispatcher->SetWorkerBudget( WorkerBudget );
+	}
+
 	bool PhysicsFoundation::ConnectPVD()
 	{
-#if defined( SAT_DEBUG ) || defined( SAT_RELEASE )
-		physx::PxPvdTransport* transport = physx::PxDefaultPvdSocketTransportCreate( "127.0.0.1", 5425, 1 );
-		return m_Pvd->connect( *transport, physx::PxPvdInstrumentationFlag::eALL );
+#if defined( SAT_PHYSX_PVD )
+		if( !m_PvdTransport )
+			m_PvdTransport = physx::PxDefaultPvdSocketTransportCreate( "127.0.0.1", 5425, 1 );
+
+		return m_Pvd->connect( *m_PvdTransport, physx::PxPvdInstrumentationFlag::eALL );
+#else
+		return false;
 #endif
-		return true;
 	}
 
 	void PhysicsFoundation::DisconnectPVD()
 	{
-#if defined( SAT_DEBUG ) || defined( SAT_RELEASE )
-		m_Pvd->disconnect();
+#if defined( SAT_PHYSX_PVD )
+		if( m_Pvd )
+			m_Pvd->disconnect();
 #endif
 	}
 
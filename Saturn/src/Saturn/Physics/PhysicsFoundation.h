@@ -29,20 +29,85 @@
 #pragma once
 
 #include "PhysicsErrorCallbacks.h"
+#include "PhysicsDispatcher.h"
 
 #include "PxPhysicsAPI.h"
 
+#include <glm/glm.hpp>
+
 namespace Saturn {
 
+	class PhysicsRigidBody;
+
+	// What the physics scene draws through the Renderer2D, none of this is computed by PhysX while no flag is set.
+	enum PhysicsDebugDrawFlags : uint32_t
+	{
+		PhysicsDebugDraw_None = 0,
+		PhysicsDebugDraw_Shapes = BIT( 0 ),
+		PhysicsDebugDraw_Contacts = BIT( 1 ),
+		PhysicsDebugDraw_AABBs = BIT( 2 ),
+		PhysicsDebugDraw_Joints = BIT( 3 )
+	};
+
+	enum class PhysicsEventType : uint8_t
+	{
+		ContactBegin,
+		ContactPersist,
+		ContactEnd,
+		TriggerEnter,
+		TriggerExit
+	};
+
+	// One event per shape pair, an actor pair touching with several shapes reports an event for each of them.
+	struct PhysicsContactEvent
+	{
+		PhysicsEventType Type;
+
+		// For contacts "pA" is the body with the lower entity ID, for triggers it owns the trigger shape.
+		PhysicsRigidBody* pA;
+		PhysicsRigidBody* pB;
+
+		// Entity IDs, used to dispatch in the same order every run.
+		uint64_t EntityA;
+		uint64_t EntityB;
+
+		// Contacts only, the average of the contact points and the total impulse. Zero when PhysX reported no points (ContactEnd).
+		// The normal points from B to A.
+		glm::vec3 Point;
+		glm::vec3 Normal;
+		glm::vec3 Impulse;
+	};
+
+	// PhysX calls this from inside fetchResults, when gameplay code must not touch the scene.
+	// Every pair is copied into a buffer instead, which the physics scene dispatches to the bodies once the results are fetched.
 	class PhysicsContact : public physx::PxSimulationEventCallback, public RefTarget
 	{
 	public:
+		PhysicsContact();
+
+		// Calls the callbacks of every event since the last dispatch.
+		void DispatchEvents();
+
+		// Events stay in the buffer until this is called, once per frame. Events that were not dispatched yet are kept.
+		void ClearEvents();
+
+		const std::vector<PhysicsContactEvent>& GetEvents() const { return m_Events; }
+
 		void onConstraintBreak( physx::PxConstraintInfo* pConstraints, physx::PxU32 Count ) override;
 		void onWake( physx::PxActor** ppActors, physx::PxU32 Count ) override;
 		void onSleep( physx::PxActor** ppActors, physx::PxU32 Count ) override;
 		void onContact( const physx::PxContactPairHeader& rPairHeader, const physx::PxContactPair* pPairs, physx::PxU32 Pairs ) override;
 		void onTrigger( physx::PxTriggerPair* pPairs, physx::PxU32 Count ) override;
 		void onAdvance( const physx::PxRigidBody* const* pBodyBuffer, const physx::PxTransform* PoseBuffer, const physx::PxU32 Count ) override;
+
+	private:
+		void AddEvent( PhysicsEventType Type, PhysicsRigidBody* pA, PhysicsRigidBody* pB, const glm::vec3& Point, const glm::vec3& Normal, const glm::vec3& Impulse );
+	private:
+		std::vector<PhysicsContactEvent> m_Events;
+		std::vector<physx::PxContactPairPoint> m_ContactPoints;
+
+		// Events before this have been dispatched.
+		size_t m_DispatchedEvents = 0;
 	};
 
 	class PhysicsFoundation
@@ -56,6 +121,8 @@ namespace Saturn {
 		void Init();
 		void Terminate();
 
+		// Only connects when built with SAT_PHYSX_PVD, otherwise these do nothing.
+		// The connection needs the PhysX Visual Debugger listening on localhost and waits for it, use the debug draw flags for in-engine visualization instead.
 		bool ConnectPVD();
 		void DisconnectPVD();
 
@@ -68,12 +135,32 @@ namespace Saturn {
 		physx::PxDefaultAllocator& GetAllocator() { return m_AllocatorCallback; }
 		const physx::PxDefaultAllocator& GetAllocator() const { return m_AllocatorCallback; }
 
+		// The dispatcher new scenes are created with.
+		physx::PxCpuDispatcher* GetDispatcher();
+
+		// When off new scenes use PhysX's own worker threads, only kept around to compare against.
+		void SetUseEngineWorkers( bool Enabled ) { m_UseEngineWorkers = Enabled; }
+		bool IsUsingEngineWorkers() const { return m_UseEngineWorkers; }
+
+		// How many engine workers PhysX tasks may occupy at the same time.
+		void SetWorkerBudget( uint32_t WorkerBudget );
+		uint32_t GetWorkerBudget() const { return m_Dispatcher ? m_Dispatcher->getWorkerCount() : 0; }
+
+		// PhysicsDebugDrawFlags, running scenes pick them up on their next step.
+		void SetDebugDrawFlags( uint32_t Flags ) { m_DebugDrawFlags = Flags; }
+		uint32_t GetDebugDrawFlags() const { return m_DebugDrawFlags; }
+
 	private:
 		physx::PxFoundation*		   m_Foundation = nullptr;
 		physx::PxPhysics*			   m_Physics = nullptr;
 		physx::PxCooking*			   m_Cooking = nullptr;
 		physx::PxPvd*				   m_Pvd = nullptr;
-		physx::PxDefaultCpuDispatcher* m_Dispatcher = nullptr;
+		physx::PxPvdTransport*		   m_PvdTransport = nullptr;
+		PhysicsDispatcher*			   m_Dispatcher = nullptr;
+		physx::PxDefaultCpuDispatcher* m_DefaultDispatcher = nullptr;
+
+		bool m_UseEngineWorkers = true;
+		uint32_t m_DebugDrawFlags = PhysicsDebugDraw_None;
 
 		physx::PxDefaultAllocator m_AllocatorCallback;
 
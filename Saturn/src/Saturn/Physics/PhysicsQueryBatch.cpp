@@ -0,0 +1,340 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "PhysicsQueryBatch.h"
+
+#include "Saturn/Core/WorkerPool.h"
+#include "Saturn/Core/OptickProfiler.h"
+
+#include "PhysicsScene.h"
+#include "PhysicsRigidBody.h"
+#include "PhysicsAuxiliary.h"
+
+namespace Saturn {
+
+	// Small enough that a few hundred rays are spread across the workers, large enough that the job overhead does not matter.
+	static constexpr uint32_t s_QueriesPerJob = 32;
+
+	static physx::PxGeometryHolder ToPxGeometry( const PhysicsQueryGeometry& rGeometry )
+	{
+		switch( rGeometry.Type )
+		{
+			case ShapeType::Box:
+				return physx::PxBoxGeometry( Auxiliary::GLMToPx( rGeometry.HalfExtents ) );
+
+			case ShapeType::Capusle:
+				return physx::PxCapsuleGeometry( rGeometry.Radius, rGeometry.HalfHeight );
+
+			case ShapeType::Sphere:
+				return physx::PxSphereGeometry( rGeometry.Radius );
+
+			default:
+				SAT_CORE_ASSERT( false, "Query geometry must be a box, sphere or capsule!" );
+				return physx::PxSphereGeometry( rGeometry.Radius );
+		}
+	}
+
+	// Touch buffers for multi-hit queries, one per worker.
+	template<typename Ty>
+	static Ty* GetTouchBuffer( uint32_t Count )
+	{
+		thread_local std::vector<Ty> s_Buffer;
+
+		if( s_Buffer.size() < Count )
+			s_Buffer.resize( Count );
+
+		return s_Buffer.data();
+	}
+
+	// PhysX keeps an arbitrary subset of the touches when the buffer overflows, not the closest ones.
+	// Query into a larger buffer until every touch fits, then keep the closest "MaxHits".
+	template<typename Ty, typename Func>
+	static uint32_t GatherClosestTouches( uint32_t MaxHits, Func&& QueryFunction, Ty*& rpTouches )
+	{
+		uint32_t Capacity = MaxHits * 2;
+
+		while( true )
+		{
+			Ty* pTouches = GetTouchBuffer<Ty>( Capacity );
+			physx::PxHitBuffer<Ty> Buffer( pTouches, Capacity );
+
+			QueryFunction( Buffer );
+
+			uint32_t Count = Buffer.getNbTouches();
+
+			// A full buffer might have dropped touches.
+			if( Count < Capacity )
+			{
+				std::sort( pTouches, pTouches + Count, []( const Ty& a, const Ty& b ) { return a.distance < b.distance; } );
+
+				rpTouches = pTouches;
+				return std::min( Count, MaxHits );
+			}
+
+			Capacity *= 2;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	uint32_t PhysicsQueryBatch::AddRaycast( const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, uint32_t LayerMask, uint32_t MaxHits )
+	{
+		Query NewQuery = {};
+		NewQuery.Type = QueryType::Raycast;
+		NewQuery.Pose = physx::PxTransform( Auxiliary::GLMToPx( Origin ) );
+		NewQuery.Direction = Auxiliary::GLMToPx( glm::normalize( Direction ) );
+		NewQuery.MaxDistance = MaxDistance;
+		NewQuery.LayerMask = LayerMask;
+		NewQuery.MaxHits = MaxHits;
+
+		return AddQuery( NewQuery );
+	}
+
+	uint32_t PhysicsQueryBatch::AddSweep( const PhysicsQueryGeometry& rGeometry, const glm::vec3& Origin, const glm::quat& Rotation, const glm::vec3& Direction, float MaxDistance, uint32_t LayerMask, uint32_t MaxHits )
+	{
+		Query NewQuery = {};
+		NewQuery.Type = QueryType::Sweep;
+		NewQuery.Geometry = ToPxGeometry( rGeometry );
+		NewQuery.Pose = physx::PxTransform( Auxiliary::GLMToPx( Origin ), Auxiliary::QGLMToPx( Rotation ) );
+		NewQuery.Direction = Auxiliary::GLMToPx( glm::normalize( Direction ) );
+		NewQuery.MaxDistance = MaxDistance;
+		NewQuery.LayerMask = LayerMask;
+		NewQuery.MaxHits = MaxHits;
+
+		return AddQuery( NewQuery );
+	}
+
+	uint32_t PhysicsQueryBatch::AddOverlap( const PhysicsQueryGeometry& rGeometry, const glm::vec3& Position, const glm::quat& Rotation, uint32_t LayerMask, uint32_t MaxHits )
+	{
+		Query NewQuery = {};
+		NewQuery.Type = QueryType::Overlap;
+		NewQuery.Geometry = ToPxGeometry( rGeometry );
+		NewQuery.Pose = physx::PxTransform( Auxiliary::GLMToPx( Position ), Auxiliary::QGLMToPx( Rotation ) );
+		NewQuery.Direction = physx::PxVec3( 0.0f );
+		NewQuery.MaxDistance = 0.0f;
+		NewQuery.LayerMask = LayerMask;
+		NewQuery.MaxHits = MaxHits;
+
+		return AddQuery( NewQuery );
+	}
+
+	uint32_t PhysicsQueryBatch::AddQuery( const Query& rQuery )
+	{
+		uint32_t Index = ( uint32_t ) m_Queries.size();
+
+		m_Queries.push_back( rQuery );
+		m_Queries.back().MaxHits = std::max<uint32_t>( rQuery.MaxHits, 1 );
+
+		// Every query owns a fixed range of hits, so the workers never write to the same place.
+		PhysicsQueryResult Result = {};
+		Result.HitOffset = ( uint32_t ) m_Hits.size();
+		Result.HitCount = 0;
+
+		m_Results.push_back( Result );
+
+		m_Hits.resize( m_Hits.size() + m_Queries.back().MaxHits );
+		m_HitBodies.resize( m_Hits.size() );
+
+		return Index;
+	}
+
+	void PhysicsQueryBatch::Clear()
+	{
+		m_Queries.clear();
+		m_Results.clear();
+		m_Hits.clear();
+		m_HitBodies.clear();
+	}
+
+	void PhysicsQueryBatch::Execute( PhysicsScene& rScene )
+	{
+		SAT_PF_EVENT();
+
+		uint32_t QueryCount = ( uint32_t ) m_Queries.size();
+
+		if( QueryCount == 0 )
+			return;
+
+		// The scene must not be written to while the workers read it.
+		// Only wait for the step, dispatching its events here would run gameplay callbacks in the middle of whatever called Execute.
+		rScene.WaitForStep();
+
+		physx::PxScene* pPxScene = rScene.m_PhysicsScene;
+
+		std::fill( m_Hits.begin(), m_Hits.end(), PhysicsQueryHit() );
+		std::fill( m_HitBodies.begin(), m_HitBodies.end(), nullptr );
+
+		struct JobState
+		{
+			std::atomic<uint32_t> NextJob = 0;
+			std::atomic<uint32_t> FinishedJobs = 0;
+		};
+
+		uint32_t JobCount = ( QueryCount + s_QueriesPerJob - 1 ) / s_QueriesPerJob;
+
+		// Workers that start after every job was taken only touch the state, so it has to outlive this function.
+		std::shared_ptr<JobState> State = std::make_shared<JobState>();
+
+		auto RunJobs = [this, pPxScene, State, JobCount, QueryCount]()
+		{
+			while( true )
+			{
+				uint32_t Job = State->NextJob.fetch_add( 1 );
+
+				if( Job >= JobCount )
+					break;
+
+				uint32_t Last = std::min( ( Job + 1 ) * s_QueriesPerJob, QueryCount );
+
+				for( uint32_t i = Job * s_QueriesPerJob; i < Last; i++ )
+					RunQuery( *pPxScene, i );
+
+				State->FinishedJobs.fetch_add( 1 );
+			}
+		};
+
+		// The calling thread takes jobs too.
+		uint32_t WorkerJobs = std::min( JobCount - 1, WorkerPool::Get().GetWorkerCount() );
+
+		for( uint32_t i = 0; i < WorkerJobs; i++ )
+			WorkerPool::Get().Submit( RunJobs, WorkerPriority::High );
+
+		RunJobs();
+
+		while( State->FinishedJobs.load() < JobCount )
+			std::this_thread::yield();
+
+		for( uint32_t i = 0; i < QueryCount; i++ )
+		{
+			const PhysicsQueryResult& rResult = m_Results[ i ];
+
+			for( uint32_t j = rResult.HitOffset; j < rResult.HitOffset + rResult.HitCount; j++ )
+				m_Hits[ j ].Hit = m_HitBodies[ j ] ? m_HitBodies[ j ]->GetEntity() : nullptr;
+		}
+	}
+
+	void PhysicsQueryBatch::RunQuery( physx::PxScene& rScene, uint32_t Index )
+	{
+		const Query& rQuery = m_Queries[ Index ];
+		PhysicsQueryResult& rResult = m_Results[ Index ];
+
+		physx::PxQueryFilterData FilterData;
+		FilterData.data.word0 = rQuery.LayerMask;
+		FilterData.flags = physx::PxQueryFlag::eSTATIC | physx::PxQueryFlag::eDYNAMIC;
+
+		// Without blocking hits every hit is reported as a touch.
+		bool MultiHit = rQuery.MaxHits > 1 || rQuery.Type == QueryType::Overlap;
+
+		if( MultiHit )
+			FilterData.flags |= physx::PxQueryFlag::eNO_BLOCK;
+
+		auto StoreLocationHit = [&]( uint32_t Slot, const physx::PxLocationHit& rHit )
+		{
+			PhysicsQueryHit& rOut = m_Hits[ rResult.HitOffset + Slot ];
+			rOut.Position = Auxiliary::PxToGLM( rHit.position );
+			rOut.Normal = Auxiliary::PxToGLM( rHit.normal );
+			rOut.Distance = rHit.distance;
+
+			m_HitBodies[ rResult.HitOffset + Slot ] = ( PhysicsRigidBody* ) rHit.actor->userData;
+		};
+
+		uint32_t HitCount = 0;
+
+		switch( rQuery.Type )
+		{
+			case QueryType::Raycast:
+			{
+				if( MultiHit )
+				{
+					physx::PxRaycastHit* pTouches = nullptr;
+
+					HitCount = GatherClosestTouches( rQuery.MaxHits, [&]( physx::PxRaycastBuffer& rBuffer )
+						{
+							rScene.raycast( rQuery.Pose.p, rQuery.Direction, rQuery.MaxDistance, rBuffer, physx::PxHitFlag::eDEFAULT, FilterData );
+						}, pTouches );
+
+					for( uint32_t i = 0; i < HitCount; i++ )
+						StoreLocationHit( i, pTouches[ i ] );
+				}
+				else
+				{
+					physx::PxRaycastBuffer Buffer;
+
+					if( rScene.raycast( rQuery.Pose.p, rQuery.Direction, rQuery.MaxDistance, Buffer, physx::PxHitFlag::eDEFAULT, FilterData ) && Buffer.hasBlock )
+					{
+						StoreLocationHit( 0, Buffer.block );
+						HitCount = 1;
+					}
+				}
+			} break;
+
+			case QueryType::Sweep:
+			{
+				if( MultiHit )
+				{
+					physx::PxSweepHit* pTouches = nullptr;
+
+					HitCount = GatherClosestTouches( rQuery.MaxHits, [&]( physx::PxSweepBuffer& rBuffer )
+						{
+							rScene.sweep( rQuery.Geometry.any(), rQuery.Pose, rQuery.Direction, rQuery.MaxDistance, rBuffer, physx::PxHitFlag::eDEFAULT, FilterData );
+						}, pTouches );
+
+					for( uint32_t i = 0; i < HitCount; i++ )
+						StoreLocationHit( i, pTouches[ i ] );
+				}
+				else
+				{
+					physx::PxSweepBuffer Buffer;
+
+					if( rScene.sweep( rQuery.Geometry.any(), rQuery.Pose, rQuery.Direction, rQuery.MaxDistance, Buffer, physx::PxHitFlag::eDEFAULT, FilterData ) && Buffer.hasBlock )
+					{
+						StoreLocationHit( 0, Buffer.block );
+						HitCount = 1;
+					}
+				}
+			} break;
+
+			case QueryType::Overlap:
+			{
+				physx::PxOverlapHit* pTouches = GetTouchBuffer<physx::PxOverlapHit>( rQuery.MaxHits );
+				physx::PxOverlapBuffer Buffer( pTouches, rQuery.MaxHits );
+
+				rScene.overlap( rQuery.Geometry.any(), rQuery.Pose, Buffer, FilterData );
+
+				HitCount = Buffer.getNbTouches();
+
+				for( uint32_t i = 0; i < HitCount; i++ )
+					m_HitBodies[ rResult.HitOffset + i ] = ( PhysicsRigidBody* ) pTouches[ i ].actor->userData;
+			} break;
+		}
+
+		rResult.HitCount = HitCount;
+	}
+
+}
@@ -0,0 +1,145 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Base.h"
+#include "Saturn/Scene/Entity.h"
+
+#include "PhysicsShapeTypes.h"
+
+#include "PxPhysicsAPI.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+namespace Saturn {
+
+	class PhysicsScene;
+	class PhysicsRigidBody;
+
+	// Shape used by sweeps and overlaps.
+	struct PhysicsQueryGeometry
+	{
+		ShapeType Type = ShapeType::Sphere;
+
+		// Box only.
+		glm::vec3 HalfExtents = glm::vec3( 0.5f );
+
+		// Sphere and capsule.
+		float Radius = 0.5f;
+
+		// Capsule only, the capsule runs along the local x axis like PhysX capsules.
+		float HalfHeight = 0.5f;
+
+		static PhysicsQueryGeometry Sphere( float Radius ) { PhysicsQueryGeometry Geometry; Geometry.Type = ShapeType::Sphere; Geometry.Radius = Radius; return Geometry; }
+		static PhysicsQueryGeometry Box( const glm::vec3& HalfExtents ) { PhysicsQueryGeometry Geometry; Geometry.Type = ShapeType::Box; Geometry.HalfExtents = HalfExtents; return Geometry; }
+		static PhysicsQueryGeometry Capsule( float Radius, float HalfHeight ) { PhysicsQueryGeometry Geometry; Geometry.Type = ShapeType::Capusle; Geometry.Radius = Radius; Geometry.HalfHeight = HalfHeight; return Geometry; }
+	};
+
+	struct PhysicsQueryHit
+	{
+		Ref<Entity> Hit = nullptr;
+		glm::vec3 Position = glm::vec3( 0.0f );
+		glm::vec3 Normal = glm::vec3( 0.0f );
+
+		// Zero for overlaps.
+		float Distance = 0.0f;
+	};
+
+	// The hits of one query are "PhysicsQueryBatch::GetHits()[ HitOffset ... HitOffset + HitCount ]".
+	struct PhysicsQueryResult
+	{
+		uint32_t HitOffset = 0;
+		uint32_t HitCount = 0;
+	};
+
+	// Gathers raycasts, sweeps and overlaps and runs them together on the engine workers.
+	// With "MaxHits" of 1 a raycast or sweep returns the closest hit, above that it returns the closest "MaxHits" hits along the way sorted by distance.
+	// Overlaps have no distance, they return any "MaxHits" shapes they touch.
+	// Only shapes on a layer in "LayerMask" are hit.
+	class PhysicsQueryBatch
+	{
+	public:
+		PhysicsQueryBatch() = default;
+		~PhysicsQueryBatch() = default;
+
+		// All return the index of the query in "GetResults()".
+		uint32_t AddRaycast( const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, uint32_t LayerMask = PHYSICS_ALL_LAYERS, uint32_t MaxHits = 1 );
+		uint32_t AddSweep( const PhysicsQueryGeometry& rGeometry, const glm::vec3& Origin, const glm::quat& Rotation, const glm::vec3& Direction, float MaxDistance, uint32_t LayerMask = PHYSICS_ALL_LAYERS, uint32_t MaxHits = 1 );
+		uint32_t AddOverlap( const PhysicsQueryGeometry& rGeometry, const glm::vec3& Position, const glm::quat& Rotation, uint32_t LayerMask = PHYSICS_ALL_LAYERS, uint32_t MaxHits = 1 );
+
+		// Runs every query and waits for them, a step that is still running is waited on first so the scene is not written to meanwhile.
+		// The events of that step are not dispatched, that is left to the scene's next FetchResults.
+		// Results stay valid until the next Clear or Execute.
+		void Execute( PhysicsScene& rScene );
+
+		// Removes the queries and their results.
+		void Clear();
+
+		uint32_t GetQueryCount() const { return ( uint32_t ) m_Queries.size(); }
+
+		const std::vector<PhysicsQueryResult>& GetResults() const { return m_Results; }
+		const std::vector<PhysicsQueryHit>& GetHits() const { return m_Hits; }
+
+		const PhysicsQueryHit* GetHits( uint32_t Query ) const { return m_Hits.data() + m_Results[ Query ].HitOffset; }
+		uint32_t GetHitCount( uint32_t Query ) const { return m_Results[ Query ].HitCount; }
+
+	private:
+		enum class QueryType : uint8_t
+		{
+			Raycast,
+			Sweep,
+			Overlap
+		};
+
+		struct Query
+		{
+			QueryType Type;
+			physx::PxGeometryHolder Geometry;
+			physx::PxTransform Pose;
+			physx::PxVec3 Direction;
+			float MaxDistance;
+			uint32_t LayerMask;
+			uint32_t MaxHits;
+		};
+
+		uint32_t AddQuery( const Query& rQuery );
+		void RunQuery( physx::PxScene& rScene, uint32_t Index );
+
+	private:
+		std::vector<Query> m_Queries;
+		std::vector<PhysicsQueryResult> m_Results;
+		std::vector<PhysicsQueryHit> m_Hits;
+
+		// Filled by the workers, turned into entities once every query is done as entity references are not thread safe.
+		std::vector<PhysicsRigidBody*> m_HitBodies;
+	};
+}
@@ -43,6 +43,8 @@ namespace Saturn {
 		physx::PxRigidDynamic* pBody = PhysicsFoundation::Get().GetPhysics().createRigidDynamic( Auxiliary::GLMTransformToPx( tc.GetTransform() ) );
 		
 		m_Actor = pBody;
+		m_CurrentPose = pBody->getGlobalPose();
+		m_PreviousPose = m_CurrentPose;
 		m_Actor->setActorFlag( physx::PxActorFlag::eVISUALIZATION, true );
 
 		SetKinematic( rb.IsKinematic );
@@ -90,6 +92,20 @@ namespace Saturn {
 		SetMass( rb.Mass );
 	}
 
+	void PhysicsRigidBody::ApplySettings( const PhysicsSettings& rSettings )
+	{
+		RigidbodyComponent& rb = m_Entity->GetComponent<RigidbodyComponent>();
+		physx::PxRigidDynamic* pBody = ( physx::PxRigidDynamic* ) m_Actor;
+
+		pBody->setSolverIterationCounts( rSettings.PositionIterations, rSettings.VelocityIterations );
+
+		if( rSettings.SleepThreshold >= 0.0f )
+			pBody->setSleepThreshold( rSettings.SleepThreshold );
+
+		// PhysX does not allow CCD on kinematic bodies.
+		pBody->setRigidBodyFlag( physx::PxRigidBodyFlag::eENABLE_CCD, rSettings.EnableCCD && rb.UseCCD && !m_Kinematic );
+	}
+
 	void PhysicsRigidBody::AttachPhysicsShape( ShapeType type )
 	{
 		switch( type )
@@ -157,6 +173,11 @@ namespace Saturn {
 	void PhysicsRigidBody::SetKinematic( bool val )
 	{
 		physx::PxRigidDynamic* pBody = ( physx::PxRigidDynamic* ) m_Actor;
+
+		// Kinematic bodies can not use CCD.
+		if( val )
+			pBody->setRigidBodyFlag( physx::PxRigidBodyFlag::eENABLE_CCD, false );
+
 		pBody->setRigidBodyFlag( physx::PxRigidBodyFlag::eKINEMATIC, val );
 
 		m_Kinematic = val;
@@ -270,16 +291,23 @@ namespace Saturn {
 		return m_LockFlags & RigidbodyLockFlags::RotationX && m_LockFlags & RigidbodyLockFlags::RotationY && m_LockFlags & RigidbodyLockFlags::RotationZ;
 	}
 
-	void PhysicsRigidBody::SyncTransfrom()
+	void PhysicsRigidBody::SyncTransfrom( float Alpha )
 	{
 		TransformComponent& tc = m_Entity->GetComponent<TransformComponent>();
 
-		physx::PxTransform actorPose = m_Actor->getGlobalPose();
+		glm::vec3 Position = Auxiliary::PxToGLM( m_CurrentPose.p );
+		glm::quat Rotation = Auxiliary::QPxToGLM( m_CurrentPose.q );
+
+		if( Alpha < 1.0f )
+		{
+			Position = glm::mix( Auxiliary::PxToGLM( m_PreviousPose.p ), Position, Alpha );
+			Rotation = glm::slerp( Auxiliary::QPxToGLM( m_PreviousPose.q ), Rotation, Alpha );
+		}
 
-		tc.Position = Auxiliary::PxToGLM( actorPose.p );
+		tc.Position = Position;
 
 		if( !AllRotationLocked() )
-			tc.SetRotation( Auxiliary::QPxToGLM( actorPose.q ) );
+			tc.SetRotation( Rotation );
 	}
 
 }
\ No newline at end of file
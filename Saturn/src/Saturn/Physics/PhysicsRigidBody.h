@@ -30,6 +30,7 @@
 
 #include "Saturn/Scene/Entity.h"
 #include "PhysicsShapes.h"
+#include "PhysicsSettings.h"
 
 #include "PxPhysicsAPI.h"
 
@@ -43,6 +44,9 @@ namespace Saturn {
 
 		void CreateShape();
 
+		// Applies the project's solver, sleep and CCD settings, call this after the shape was created as the body might have become kinematic.
+		void ApplySettings( const PhysicsSettings& rSettings );
+
 		void SetKinematic( bool val );
 		void SetMass( float val );
 		void SetLinearDrag( float value );
@@ -51,7 +55,17 @@ namespace Saturn {
 		void Rotate( const glm::vec3& rRotation );
 		void Rotate( const glm::quat& rRotation );
 
-		void SyncTransfrom();
+		// Writes the pose into the TransformComponent, "Alpha" blends from the pose before the last step (0) to the current one (1).
+		// Only reads the cached poses, the actor is not touched.
+		void SyncTransfrom( float Alpha = 1.0f );
+
+		// Called for every active actor after a step was fetched, caches the new pose and keeps the old one to interpolate from.
+		void OnStepMoved( uint64_t Step ) { m_PreviousPose = m_CurrentPose; m_CurrentPose = m_Actor->getGlobalPose(); m_LastMovedStep = Step; }
+
+		// Called once the body stopped being active, it stays at the last pose until it moves again.
+		void OnStepSettled() { m_PreviousPose = m_CurrentPose; }
+
+		uint64_t GetLastMovedStep() const { return m_LastMovedStep; }
 
 		bool IsKiniematic() { return m_Kinematic; }
 
@@ -71,6 +85,13 @@ namespace Saturn {
 		void SetOnCollisionHit( std::function<void( Ref<Entity> rOther )>&& rrFunc ) { m_OnMeshHit = rrFunc; }
 		void SetOnCollisionExit( std::function<void( Ref<Entity> rOther )>&& rrFunc ) { m_OnMeshExit = rrFunc; }
 
+		// Called every step the bodies keep touching.
+		void SetOnCollisionStay( std::function<void( Ref<Entity> rOther )>&& rrFunc ) { m_OnMeshStay = rrFunc; }
+
+		// Called on both the trigger's body and the other body.
+		void SetOnTriggerEnter( std::function<void( Ref<Entity> rOther )>&& rrFunc ) { m_OnTriggerEnter = rrFunc; }
+		void SetOnTriggerExit( std::function<void( Ref<Entity> rOther )>&& rrFunc ) { m_OnTriggerExit = rrFunc; }
+
 		void OnCollisionHit ( Ref<Entity> rOther ) { m_OnMeshHit( rOther ); }
 		void OnCollisionExit( Ref<Entity> rOther ) { m_OnMeshExit( rOther ); }
 
@@ -89,8 +110,17 @@ namespace Saturn {
 
 		uint32_t m_LockFlags;
 
+		// Poses of the last two steps this body moved in.
+		physx::PxTransform m_PreviousPose = physx::PxTransform( physx::PxIdentity );
+		physx::PxTransform m_CurrentPose = physx::PxTransform( physx::PxIdentity );
+
+		uint64_t m_LastMovedStep = 0;
+
 		std::function<void( Ref<Entity> rOther )> m_OnMeshHit;
 		std::function<void( Ref<Entity> rOther )> m_OnMeshExit;
+		std::function<void( Ref<Entity> rOther )> m_OnMeshStay;
+		std::function<void( Ref<Entity> rOther )> m_OnTriggerEnter;
+		std::function<void( Ref<Entity> rOther )> m_OnTriggerExit;
 	private:
 		friend class PhysicsShape;
 		friend class PhysicsFoundation;
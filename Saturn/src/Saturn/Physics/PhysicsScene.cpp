@@ -38,6 +38,12 @@
 #include "PhysicsFoundation.h"
 #include "PhysicsRigidBody.h"
 #include "PhysicsAuxiliary.h"
+#include "PhysicsCooking.h"
+
+#include "Saturn/Project/Project.h"
+#include "Saturn/Vulkan/Renderer2D.h"
+
+#include <unordered_set>
 
 namespace Saturn {
 
@@ -49,6 +55,12 @@ namespace Saturn {
 
 	PhysicsScene::~PhysicsScene()
 	{
+		// Actors can not be released while they are simulated.
+		FetchResults();
+
+		// Events point to the bodies deleted below.
+		PhysicsFoundation::Get().m_ContantCallback.ClearEvents();
+
 		PhysicsFoundation::Get().DisconnectPVD();
 
 		auto rView = m_Scene->GetAllEntitiesWith<RigidbodyComponent>();
@@ -61,6 +73,17 @@ namespace Saturn {
 			rb.Rigidbody = nullptr;
 		}
 
+		// The actors are gone, so these are empty.
+		for( physx::PxAggregate* pAggregate : m_Aggregates )
+			pAggregate->release();
+
+		m_Aggregates.clear();
+
+		m_Bodies.clear();
+		m_ActiveBodies.clear();
+		m_PreviousActiveBodies.clear();
+		m_SettledBodies.clear();
+
 		m_Scene = nullptr;
 
 		PHYSX_TERMINATE_ITEM( m_PhysicsScene );
@@ -83,8 +106,9 @@ namespace Saturn {
 		if( ( FilterData0.word0 & FilterData1.word1 ) || ( FilterData1.word0 & FilterData0.word1 ) )
 		{
 			rPairFlags |= physx::PxPairFlag::eNOTIFY_TOUCH_FOUND;
+			rPairFlags |= physx::PxPairFlag::eNOTIFY_TOUCH_PERSISTS;
 			rPairFlags |= physx::PxPairFlag::eNOTIFY_TOUCH_LOST;
-			rPairFlags |= physx::PxPairFlag::eNOTIFY_TOUCH_CCD;
+			rPairFlags |= physx::PxPairFlag::eNOTIFY_CONTACT_POINTS;
 
 			return physx::PxFilterFlag::eDEFAULT;
 		}
@@ -94,51 +118,436 @@ namespace Saturn {
 
 	void PhysicsScene::CreateScene()
 	{
+		if( Project::GetActiveProject() )
+			m_Settings = Project::GetActiveProject()->GetPhysicsSettings();
+
 		physx::PxSceneDesc SceneDesc( PhysicsFoundation::Get().m_Physics->getTolerancesScale() );
 		SceneDesc.gravity = physx::PxVec3( 0.0f, -9.81f, 0.0f );
 
-		SceneDesc.cpuDispatcher = PhysicsFoundation::Get().m_Dispatcher;
+		SceneDesc.cpuDispatcher = PhysicsFoundation::Get().GetDispatcher();
 		SceneDesc.simulationEventCallback = &PhysicsFoundation::Get().m_ContantCallback;
 		SceneDesc.filterShader = CollisionFilterShader;
 
-		SceneDesc.broadPhaseType = physx::PxBroadPhaseType::eABP;
+		switch( m_Settings.BroadphaseType )
+		{
+			case PhysicsBroadphaseType::SAP:
+				SceneDesc.broadPhaseType = physx::PxBroadPhaseType::eSAP;
+				break;
+
+			case PhysicsBroadphaseType::MBP:
+				SceneDesc.broadPhaseType = physx::PxBroadPhaseType::eMBP;
+				break;
+
+			case PhysicsBroadphaseType::ABP:
+			default:
+				SceneDesc.broadPhaseType = physx::PxBroadPhaseType::eABP;
+				break;
+		}
+
+		SceneDesc.solverType = m_Settings.SolverType == PhysicsSolverType::TGS ? physx::PxSolverType::eTGS : physx::PxSolverType::ePGS;
 		SceneDesc.frictionType = physx::PxFrictionType::ePATCH;
-		SceneDesc.flags = physx::PxSceneFlag::eENABLE_CCD;
+
+		SceneDesc.bounceThresholdVelocity = m_Settings.BounceThresholdVelocity;
+		SceneDesc.frictionOffsetThreshold = m_Settings.FrictionOffsetThreshold;
+
+		SceneDesc.flags = m_Settings.EnableCCD ? physx::PxSceneFlags( physx::PxSceneFlag::eENABLE_CCD ) : physx::PxSceneFlags();
+
+		// Lets us only write back the actors that moved in a step.
+		SceneDesc.flags |= physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS;
 
 		m_PhysicsScene = PhysicsFoundation::Get().m_Physics->createScene( SceneDesc );
-		PhysicsFoundation::Get().ConnectPVD();
 
-		m_PhysicsScene->setVisualizationParameter( physx::PxVisualizationParameter::eSCALE, 1.0f );
-		m_PhysicsScene->setVisualizationParameter( physx::PxVisualizationParameter::eCOLLISION_SHAPES, 1.0f );
+		// MBP only tracks objects inside its regions, split the world bounds into a grid of them.
+		if( m_Settings.BroadphaseType == PhysicsBroadphaseType::MBP )
+		{
+			const physx::PxU32 Subdivisions = std::clamp( m_Settings.WorldSubdivisions, 1u, 16u );
+			std::vector<physx::PxBounds3> Regions( Subdivisions * Subdivisions );
+
+			physx::PxBounds3 WorldBounds( Auxiliary::GLMToPx( m_Settings.WorldBoundsMin ), Auxiliary::GLMToPx( m_Settings.WorldBoundsMax ) );
+			physx::PxU32 RegionCount = physx::PxBroadPhaseExt::createRegionsFromWorldBounds( Regions.data(), WorldBounds, Subdivisions );
+
+			for( physx::PxU32 i = 0; i < RegionCount; i++ )
+			{
+				physx::PxBroadPhaseRegion Region;
+				Region.bounds = Regions[ i ];
+				Region.userData = nullptr;
+
+				m_PhysicsScene->addBroadPhaseRegion( Region );
+			}
+		}
+
+		PhysicsFoundation::Get().ConnectPVD();
 
-		// Add all current bodies to the scene.
+		ApplyDebugDrawFlags();
 
 		auto rView = m_Scene->GetAllEntitiesWith<RigidbodyComponent>();
 
+		// Cook the mesh colliders of every body at once on the workers, with a warm cache nothing is cooked.
+		Timer CookTimer;
+
+		std::vector<MeshColliderRequest> ColliderRequests;
+
+		for( auto& rEntity : rView )
+		{
+			// Same priority as PhysicsRigidBody::CreateShape.
+			if( rEntity->HasComponent<BoxColliderComponent>() || rEntity->HasComponent<SphereColliderComponent>() || rEntity->HasComponent<CapsuleColliderComponent>() )
+				continue;
+
+			if( !rEntity->HasComponent<StaticMeshComponent>() )
+				continue;
+
+			const Ref<StaticMesh>& rMesh = rEntity->GetComponent<StaticMeshComponent>().Mesh;
+
+			if( rMesh && rMesh->GetAttachedShape() > ShapeType::Capusle )
+				ColliderRequests.push_back( { rMesh, rMesh->GetAttachedShape() } );
+		}
+
+		if( !ColliderRequests.empty() )
+			PhysicsCooking::Get().CookMeshColliders( ColliderRequests );
+
+		float CookTime = CookTimer.ElapsedMilliseconds();
+
+		// Create all current bodies, they are added to the scene together afterwards.
+		Timer CreateTimer;
+
 		for( auto& rEntity : rView )
 		{
 			auto& rb = rEntity->GetComponent<RigidbodyComponent>();
 
 			rb.Rigidbody = new PhysicsRigidBody( rEntity );
 			rb.Rigidbody->CreateShape();
+			rb.Rigidbody->ApplySettings( m_Settings );
+
+			m_Bodies.push_back( rb.Rigidbody );
+		}
+
+		PhysicsCooking::Get().ClearColliderKeys();
+
+		float CreateTime = CreateTimer.ElapsedMilliseconds();
+
+		Timer InsertTimer;
+
+		InsertBodies();
+
+		SAT_CORE_INFO( "Physics scene: prepared colliders in {0} ms, created {1} bodies in {2} ms, inserted them in {3} ms ({4} aggregates)", CookTime, m_Bodies.size(), CreateTime, InsertTimer.ElapsedMilliseconds(), m_Aggregates.size() );
+	}
+
+	void PhysicsScene::InsertBodies()
+	{
+		SAT_PF_EVENT();
+
+		// Parent of every entity, so the root of a body can be found without searching the scene.
+		std::unordered_map<UUID, UUID> Parents;
+
+		m_Scene->Each( [&]( const Ref<Entity>& rEntity )
+			{
+				Parents[ rEntity->GetUUID() ] = rEntity->GetParent();
+			} );
+
+		auto FindRoot = [&]( UUID ID )
+		{
+			auto Itr = Parents.find( ID );
+
+			while( Itr != Parents.end() && Itr->second != 0 )
+			{
+				ID = Itr->second;
+				Itr = Parents.find( ID );
+			}
+
+			return ID;
+		};
+
+		std::unordered_set<UUID> BodyEntities;
+
+		for( PhysicsRigidBody* pBody : m_Bodies )
+			BodyEntities.insert( pBody->GetEntity()->GetUUID() );
+
+		// Bodies under a root entity that is a body itself make up one compound object, in the order they were created.
+		// Bodies that only share a parent, like everything under a level's folder entity, are spread out and stay loose.
+		std::vector<std::vector<physx::PxActor*>> Clusters;
+		std::unordered_map<UUID, size_t> ClusterIndices;
+
+		// Compounds go into an aggregate so the broad phase sees them as one entry, everything else is added in a single call.
+		std::vector<physx::PxActor*> LooseActors;
+
+		for( PhysicsRigidBody* pBody : m_Bodies )
+		{
+			UUID Root = FindRoot( pBody->GetEntity()->GetUUID() );
+
+			if( !BodyEntities.contains( Root ) )
+			{
+				LooseActors.push_back( &pBody->GetActor() );
+				continue;
+			}
+
+			auto [Itr, Inserted] = ClusterIndices.try_emplace( Root, Clusters.size() );
+
+			if( Inserted )
+				Clusters.emplace_back();
+
+			Clusters[ Itr->second ].push_back( &pBody->GetActor() );
+		}
+
+		for( const auto& rCluster : Clusters )
+		{
+			for( size_t First = 0; First < rCluster.size(); First += PHYSICS_MAX_AGGREGATE_SIZE )
+			{
+				uint32_t Count = ( uint32_t ) std::min<size_t>( rCluster.size() - First, PHYSICS_MAX_AGGREGATE_SIZE );
+
+				if( Count == 1 )
+				{
+					LooseActors.push_back( rCluster[ First ] );
+					continue;
+				}
+
+				// Self collision stays on, parts of a compound collided with each other before they were aggregated.
+				physx::PxAggregate* pAggregate = PhysicsFoundation::Get().m_Physics->createAggregate( Count, true );
+
+				for( uint32_t i = 0; i < Count; i++ )
+					pAggregate->addActor( *rCluster[ First + i ] );
+
+				m_PhysicsScene->addAggregate( *pAggregate );
+				m_Aggregates.push_back( pAggregate );
+			}
+		}
+
+		if( !LooseActors.empty() )
+			m_PhysicsScene->addActors( LooseActors.data(), ( physx::PxU32 ) LooseActors.size() );
+	}
+
+	uint32_t PhysicsScene::Accumulate( Timestep ts )
+	{
+		m_Accumulator += ts.Seconds();
+
+		uint32_t Steps = ( uint32_t ) ( m_Accumulator / m_FixedTimestep );
+
+		if( Steps > m_MaxSubSteps )
+		{
+			Steps = m_MaxSubSteps;
+			m_Accumulator = ( double ) m_FixedTimestep * Steps;
+		}
+
+		m_Accumulator -= ( double ) m_FixedTimestep * Steps;
+
+		return Steps;
+	}
+
+	void PhysicsScene::BeginStep( bool LastStep )
+	{
+		SAT_PF_EVENT();
 
-			// Maybe we could use addActors?
-			AddToScene( rb.Rigidbody->GetActor() );
+		FetchResults();
+
+		ApplyDebugDrawFlags();
+
+		m_PhysicsScene->simulate( m_FixedTimestep );
+
+		m_Simulating = true;
+		m_Stats.Steps++;
+
+		if( !m_AsyncStep || !LastStep )
+		{
+			FetchResults();
+			return;
 		}
+
+		m_Overlapping = true;
+		m_OverlapTimer.Reset();
 	}
 
-	void PhysicsScene::Update( Timestep ts )
+	void PhysicsScene::FetchResults()
 	{
+		WaitForStep();
+
+		if( !m_EventsPending )
+			return;
+
+		m_EventsPending = false;
+
+		// The scene can be written to again, gameplay callbacks are safe from here.
+		PhysicsFoundation::Get().m_ContantCallback.DispatchEvents();
+	}
+
+	void PhysicsScene::WaitForStep()
+	{
+		if( !m_Simulating )
+			return;
+
 		SAT_PF_EVENT();
 
-		float FixedTimestep = 1.0f / 100.0f;
+		if( m_Overlapping )
+			m_Stats.OverlapTime += m_OverlapTimer.ElapsedMilliseconds();
+
+		m_Overlapping = false;
+
+		Timer WaitTimer;
 
-		m_PhysicsScene->simulate( FixedTimestep );
 		m_PhysicsScene->fetchResults( true );
+
+		m_Stats.WaitTime += WaitTimer.ElapsedMilliseconds();
+		m_Simulating = false;
+
+		GatherActiveBodies();
+		GatherDebugDraw();
+
+		m_EventsPending = true;
+	}
+
+	void PhysicsScene::ApplyDebugDrawFlags()
+	{
+		uint32_t Flags = PhysicsFoundation::Get().GetDebugDrawFlags();
+
+		if( Flags == m_DebugDrawFlags )
+			return;
+
+		m_DebugDrawFlags = Flags;
+
+		auto SetParameter = [&]( physx::PxVisualizationParameter::Enum Parameter, bool Enabled )
+			{
+				m_PhysicsScene->setVisualizationParameter( Parameter, Enabled ? 1.0f : 0.0f );
+			};
+
+		// A scale of zero turns the visualization off, PhysX then skips building the render buffer.
+		SetParameter( physx::PxVisualizationParameter::eSCALE, Flags != PhysicsDebugDraw_None );
+
+		SetParameter( physx::PxVisualizationParameter::eCOLLISION_SHAPES, Flags & PhysicsDebugDraw_Shapes );
+		SetParameter( physx::PxVisualizationParameter::eCONTACT_POINT, Flags & PhysicsDebugDraw_Contacts );
+		SetParameter( physx::PxVisualizationParameter::eCONTACT_NORMAL, Flags & PhysicsDebugDraw_Contacts );
+		SetParameter( physx::PxVisualizationParameter::eCOLLISION_AABBS, Flags & PhysicsDebugDraw_AABBs );
+		SetParameter( physx::PxVisualizationParameter::eJOINT_LOCAL_FRAMES, Flags & PhysicsDebugDraw_Joints );
+		SetParameter( physx::PxVisualizationParameter::eJOINT_LIMITS, Flags & PhysicsDebugDraw_Joints );
+
+		if( Flags == PhysicsDebugDraw_None )
+			m_DebugLines.clear();
+	}
+
+	void PhysicsScene::GatherDebugDraw()
+	{
+		if( m_DebugDrawFlags == PhysicsDebugDraw_None )
+			return;
+
+		SAT_PF_EVENT();
+
+		const physx::PxRenderBuffer& rBuffer = m_PhysicsScene->getRenderBuffer();
+
+		// PhysX colors are 0xAARRGGBB, the alpha is ignored.
+		auto ToColor = []( physx::PxU32 Color )
+			{
+				return glm::vec4( ( ( Color >> 16 ) & 0xFF ) / 255.0f, ( ( Color >> 8 ) & 0xFF ) / 255.0f, ( Color & 0xFF ) / 255.0f, 1.0f );
+			};
+
+		auto AddLine = [&]( const physx::PxVec3& rStart, physx::PxU32 StartColor, const physx::PxVec3& rEnd, physx::PxU32 EndColor )
+			{
+				m_DebugLines.push_back( { Auxiliary::PxToGLM( rStart ), ToColor( StartColor ) } );
+				m_DebugLines.push_back( { Auxiliary::PxToGLM( rEnd ), ToColor( EndColor ) } );
+			};
+
+		m_DebugLines.clear();
+		m_DebugLines.reserve( ( rBuffer.getNbLines() + rBuffer.getNbTriangles() * 3 + rBuffer.getNbPoints() * 3 ) * 2 );
+
+		const physx::PxDebugLine* pLines = rBuffer.getLines();
+
+		for( physx::PxU32 i = 0; i < rBuffer.getNbLines(); i++ )
+			AddLine( pLines[ i ].pos0, pLines[ i ].color0, pLines[ i ].pos1, pLines[ i ].color1 );
+
+		const physx::PxDebugTriangle* pTriangles = rBuffer.getTriangles();
+
+		for( physx::PxU32 i = 0; i < rBuffer.getNbTriangles(); i++ )
+		{
+			const physx::PxDebugTriangle& rTriangle = pTriangles[ i ];
+
+			AddLine( rTriangle.pos0, rTriangle.color0, rTriangle.pos1, rTriangle.color1 );
+			AddLine( rTriangle.pos1, rTriangle.color1, rTriangle.pos2, rTriangle.color2 );
+			AddLine( rTriangle.pos2, rTriangle.color2, rTriangle.pos0, rTriangle.color0 );
+		}
+
+		// Points are drawn as small crosses.
+		const physx::PxDebugPoint* pPoints = rBuffer.getPoints();
+		const float PointSize = m_Settings.ToleranceLength * 0.01f;
+
+		for( physx::PxU32 i = 0; i < rBuffer.getNbPoints(); i++ )
+		{
+			const physx::PxDebugPoint& rPoint = pPoints[ i ];
+
+			AddLine( rPoint.pos - physx::PxVec3( PointSize, 0.0f, 0.0f ), rPoint.color, rPoint.pos + physx::PxVec3( PointSize, 0.0f, 0.0f ), rPoint.color );
+			AddLine( rPoint.pos - physx::PxVec3( 0.0f, PointSize, 0.0f ), rPoint.color, rPoint.pos + physx::PxVec3( 0.0f, PointSize, 0.0f ), rPoint.color );
+			AddLine( rPoint.pos - physx::PxVec3( 0.0f, 0.0f, PointSize ), rPoint.color, rPoint.pos + physx::PxVec3( 0.0f, 0.0f, PointSize ), rPoint.color );
+		}
+	}
+
+	void PhysicsScene::SubmitDebugDraw()
+	{
+		if( m_DebugLines.empty() )
+			return;
+
+		Renderer2D::Get().SubmitLines( m_DebugLines.data(), ( uint32_t ) m_DebugLines.size() );
+	}
+
+	void PhysicsScene::GatherActiveBodies()
+	{
+		SAT_PF_EVENT();
+
+		m_FetchedSteps++;
+
+		std::swap( m_ActiveBodies, m_PreviousActiveBodies );
+		m_ActiveBodies.clear();
+
+		physx::PxU32 ActiveCount = 0;
+		physx::PxActor** ppActiveActors = m_PhysicsScene->getActiveActors( ActiveCount );
+
+		for( physx::PxU32 i = 0; i < ActiveCount; i++ )
+		{
+			PhysicsRigidBody* pBody = ( PhysicsRigidBody* ) ppActiveActors[ i ]->userData;
+
+			if( !pBody )
+				continue;
+
+			pBody->OnStepMoved( m_FetchedSteps );
+			m_ActiveBodies.push_back( pBody );
+		}
+
+		// Bodies that went to sleep in this step still need to be put at their final pose once.
+		for( PhysicsRigidBody* pBody : m_PreviousActiveBodies )
+		{
+			if( pBody->GetLastMovedStep() == m_FetchedSteps )
+				continue;
+
+			pBody->OnStepSettled();
+			m_SettledBodies.push_back( pBody );
+		}
+
+		m_Stats.ActiveBodies = ( uint32_t ) m_ActiveBodies.size();
+	}
+
+	void PhysicsScene::ClearEvents()
+	{
+		PhysicsFoundation::Get().m_ContantCallback.ClearEvents();
+	}
+
+	const std::vector<PhysicsContactEvent>& PhysicsScene::GetContactEvents() const
+	{
+		return PhysicsFoundation::Get().m_ContantCallback.GetEvents();
+	}
+
+	void PhysicsScene::Interpolate()
+	{
+		SAT_PF_EVENT();
+
+		float Alpha = m_Interpolate ? ( float ) ( m_Accumulator / m_FixedTimestep ) : 1.0f;
+
+		// Settled bodies go first, a body that settled and woke up again in the same frame is then overwritten by its active pose.
+		for( PhysicsRigidBody* pBody : m_SettledBodies )
+			pBody->SyncTransfrom();
+
+		m_SettledBodies.clear();
+
+		for( PhysicsRigidBody* pBody : m_ActiveBodies )
+			pBody->SyncTransfrom( Alpha );
 	}
 
 	bool PhysicsScene::Raycast( const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, RaycastHitResult* pOut )
 	{
+		// Queries are allowed while a step is running, they see the scene as it was before the step.
 		RaycastHitResult Hit = {};
 
 		physx::PxRaycastBuffer PhysXOutHit = {};
@@ -29,11 +29,18 @@
 #pragma once
 
 #include "Saturn/Scene/Scene.h"
+#include "Saturn/Core/Timer.h"
+
+#include "PhysicsSettings.h"
 
 #include "PxPhysicsAPI.h"
 
 namespace Saturn {
 
+	class PhysicsRigidBody;
+	struct PhysicsContactEvent;
+	struct LineDrawCommand;
+
 	struct RaycastHitResult
 	{
 		bool Success = false;
@@ -42,6 +49,30 @@ namespace Saturn {
 		float Distance = 0.0f;
 	};
 
+	// Times are in milliseconds and cover the last frame.
+	struct PhysicsStepStats
+	{
+		uint32_t Steps = 0;
+
+		// Time between starting the step that is left running and asking for its results, the main thread rendered while PhysX simulated.
+		float OverlapTime = 0.0f;
+
+		// Time spent blocked in fetchResults.
+		float WaitTime = 0.0f;
+
+		// Bodies that moved in the last fetched step, only these are written back to their transforms.
+		uint32_t ActiveBodies = 0;
+	};
+
+	constexpr float PHYSICS_DEFAULT_FIXED_TIMESTEP = 1.0f / 100.0f;
+	constexpr uint32_t PHYSICS_DEFAULT_MAX_SUBSTEPS = 8;
+
+	// PhysX limit for the actors in one aggregate.
+	constexpr uint32_t PHYSICS_MAX_AGGREGATE_SIZE = 128;
+
+	// The simulation always advances in steps of the fixed timestep, so the outcome does not depend on the frame rate.
+	// Rendered transforms are interpolated between the last two finished steps.
+	// The last step of a frame is left running on the PhysX workers while the frame is rendered, its results are fetched at the start of the next update.
 	class PhysicsScene : public RefTarget
 	{
 	public:
@@ -49,15 +80,115 @@ namespace Saturn {
 		~PhysicsScene();
 
 		void CreateScene();
-		void Update( Timestep ts );
 
+		// Adds the frame time to the accumulator and returns how many steps to run, at most the max sub steps.
+		// Time past that is dropped, otherwise a slow frame makes the next one slower (death spiral).
+		uint32_t Accumulate( Timestep ts );
+
+		// Starts one fixed step. Only the last step of a frame is left running (when async steps are on), any other step is waited on
+		// straight away so the gameplay update and the events of the next step see its results.
+		// A step that is still running is finished first.
+		void BeginStep( bool LastStep = true );
+
+		// Waits for the step started by BeginStep, does nothing when no step is running.
+		// This is the sync point for anything that needs the new poses, until then reads return the poses of the last fetched step.
+		void FetchResults();
+
+		// Same as FetchResults but the events are left for the next FetchResults to dispatch.
+		// For engine code that only needs PhysX to stop writing to the scene and must not run gameplay callbacks, e.g. query batches.
+		void WaitForStep();
+
+		bool IsSimulating() const { return m_Simulating; }
+
+		// Contact and trigger events of every step fetched this frame, they are dispatched to the bodies in FetchResults.
+		const std::vector<PhysicsContactEvent>& GetContactEvents() const;
+
+		// Called once per frame before stepping.
+		void ClearEvents();
+
+		// Writes the pose between the last two steps into the TransformComponent of every body that moved, by how far the accumulator is into the next step.
+		// Sleeping and static bodies are skipped, so the cost follows the number of active actors and not the body count.
+		void Interpolate();
+
+		void SetFixedTimestep( float Timestep ) { m_FixedTimestep = Timestep; }
+		float GetFixedTimestep() const { return m_FixedTimestep; }
+
+		void SetMaxSubSteps( uint32_t MaxSubSteps ) { m_MaxSubSteps = MaxSubSteps; }
+		uint32_t GetMaxSubSteps() const { return m_MaxSubSteps; }
+
+		// When off the transforms are the pose of the last step.
+		void SetInterpolation( bool Enabled ) { m_Interpolate = Enabled; }
+		bool IsInterpolating() const { return m_Interpolate; }
+
+		// When off BeginStep waits for the results straight away.
+		void SetAsyncStep( bool Enabled ) { m_AsyncStep = Enabled; }
+		bool IsAsyncStep() const { return m_AsyncStep; }
+
+		// Clears the stats, called once per frame before stepping.
+		void ResetStats() { m_Stats = {}; }
+		const PhysicsStepStats& GetStats() const { return m_Stats; }
+
+		// Closest hit only, use a PhysicsQueryBatch for many queries, sweeps, overlaps or layer masks.
 		[[nodiscard]] bool Raycast( const glm::vec3& Origin, const glm::vec3& Direction, float MaxDistance, RaycastHitResult* pOut );
 
+		// Submits the debug visualization of the last fetched step to the Renderer2D, the categories are PhysicsFoundation's debug draw flags.
+		void SubmitDebugDraw();
+
 	private:
 		void AddToScene( physx::PxRigidActor& rBody );
+
+		// Adds every created body to the scene at once, a body and the bodies in its children are put into an aggregate.
+		void InsertBodies();
+		void GatherActiveBodies();
+
+		// Visualization parameters can only be changed while the scene is not simulating.
+		void ApplyDebugDrawFlags();
+		void GatherDebugDraw();
 	private:
 		physx::PxScene* m_PhysicsScene;
 
 		Ref<Scene> m_Scene;
+
+		// Copied from the project when the scene was created.
+		PhysicsSettings m_Settings;
+
+		// Owned by the RigidbodyComponents.
+		std::vector<PhysicsRigidBody*> m_Bodies;
+
+		std::vector<physx::PxAggregate*> m_Aggregates;
+
+		// Bodies PhysX reported as active after the last fetched step, and the ones that stopped being active since the last Interpolate.
+		std::vector<PhysicsRigidBody*> m_ActiveBodies;
+		std::vector<PhysicsRigidBody*> m_PreviousActiveBodies;
+		std::vector<PhysicsRigidBody*> m_SettledBodies;
+
+		uint64_t m_FetchedSteps = 0;
+
+		float m_FixedTimestep = PHYSICS_DEFAULT_FIXED_TIMESTEP;
+		uint32_t m_MaxSubSteps = PHYSICS_DEFAULT_MAX_SUBSTEPS;
+		bool m_Interpolate = true;
+		bool m_AsyncStep = true;
+
+		bool m_Simulating = false;
+
+		// The running step was left to overlap the rest of the frame, only then is its time counted as overlap.
+		bool m_Overlapping = false;
+
+		// A step was waited on but its events have not been dispatched yet.
+		bool m_EventsPending = false;
+
+		Timer m_OverlapTimer;
+		PhysicsStepStats m_Stats;
+
+		// Double so small frame times still add up over a long session.
+		double m_Accumulator = 0.0;
+
+		// Flags the visualization parameters were last set for.
+		uint32_t m_DebugDrawFlags = 0;
+
+		// Two vertices per line, built from the render buffer of the last fetched step.
+		std::vector<LineDrawCommand> m_DebugLines;
+	private:
+		friend class PhysicsQueryBatch;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+
+namespace Saturn {
+
+	enum class PhysicsBroadphaseType : uint8_t
+	{
+		// Sweep and prune, good when most objects are asleep or do not move.
+		SAP,
+
+		// Multi box pruning, needs world bounds and works best when objects are spread out over them.
+		MBP,
+
+		// Automatic box pruning, MBP without the bounds.
+		ABP
+	};
+
+	enum class PhysicsSolverType : uint8_t
+	{
+		// Projected Gauss-Seidel.
+		PGS,
+
+		// Temporal Gauss-Seidel, converges better for stacks, chains and large mass ratios but costs more per iteration.
+		TGS
+	};
+
+	// Stored in the project file, applied to every physics scene when it is created.
+	// The tolerance scale is used when the physics foundation is initialized, changing it needs a restart.
+	struct PhysicsSettings
+	{
+		float ToleranceLength = 10.0f;
+		float ToleranceSpeed = 10.0f;
+
+		PhysicsBroadphaseType BroadphaseType = PhysicsBroadphaseType::ABP;
+
+		// MBP only, the bounds are split into "WorldSubdivisions" * "WorldSubdivisions" regions on the xz plane.
+		// PhysX allows at most 256 regions, so subdivisions are kept in [1, 16].
+		glm::vec3 WorldBoundsMin = glm::vec3( -1000.0f );
+		glm::vec3 WorldBoundsMax = glm::vec3( 1000.0f );
+		uint32_t WorldSubdivisions = 4;
+
+		PhysicsSolverType SolverType = PhysicsSolverType::PGS;
+		uint32_t PositionIterations = 4;
+		uint32_t VelocityIterations = 1;
+
+		// When off the "Use CCD" option of rigid bodies is ignored.
+		bool EnableCCD = true;
+
+		// Mass normalized kinetic energy below which a body can go to sleep, negative keeps the PhysX default.
+		float SleepThreshold = -1.0f;
+
+		// Relative speed below which contacts do not bounce, the default is what PhysX picks for the tolerance scale above.
+		float BounceThresholdVelocity = 2.0f;
+
+		// Distance at which contacts start using friction with an offset, the default is what PhysX picks for the tolerance scale above.
+		float FrictionOffsetThreshold = 0.4f;
+	};
+}
@@ -59,4 +59,8 @@ namespace Saturn {
 		RotationY = BIT( 4 ),
 		RotationZ = BIT( 5 )
 	};
+
+	// Collision layers are bits in word0 of a shape's filter data, every shape is on the default layer for now.
+	constexpr uint32_t PHYSICS_DEFAULT_LAYER = BIT( 0 );
+	constexpr uint32_t PHYSICS_ALL_LAYERS = 0xFFFFFFFF;
 }
\ No newline at end of file
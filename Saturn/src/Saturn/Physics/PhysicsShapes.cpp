@@ -50,10 +50,13 @@ namespace Saturn {
 	void PhysicsShape::SetFilterData()
 	{
 		physx::PxFilterData data;
-		data.word0 = BIT( 0 );
-		data.word1 = BIT( 0 );
+		data.word0 = PHYSICS_DEFAULT_LAYER;
+		data.word1 = PHYSICS_DEFAULT_LAYER;
 
 		m_Shape->setSimulationFilterData( data );
+
+		// Scene queries match their layer mask against word0.
+		m_Shape->setQueryFilterData( data );
 	}
 
 	//////////////////////////////////////////////////////////////////////////
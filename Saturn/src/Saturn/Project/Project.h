@@ -32,6 +32,7 @@
 #include "Saturn/GameFramework/ActionBinding.h"
 
 #include "Saturn/Core/UUID.h"
+#include "Saturn/Physics/PhysicsSettings.h"
 
 #include <string>
 #include <filesystem>
@@ -122,6 +123,13 @@ namespace Saturn {
 		void AddActionBinding( const ActionBinding& rBinding ) { m_ActionBindings.push_back( rBinding ); }
 		void RemoveActionBinding( const ActionBinding& rBinding );
 
+	public:
+		//////////////////////////////////////////////////////////////////////////
+		// Physics
+
+		PhysicsSettings& GetPhysicsSettings() { return m_PhysicsSettings; }
+		const PhysicsSettings& GetPhysicsSettings() const { return m_PhysicsSettings; }
+
 	public:
 		//////////////////////////////////////////////////////////////////////////
 		// Premake, Building & Preparation for Distribution (Used in Editor)
@@ -145,6 +153,7 @@ namespace Saturn {
 	private:
 		ProjectConfig m_Config;
 		std::vector<ActionBinding> m_ActionBindings;
+		PhysicsSettings m_PhysicsSettings;
 
 		// Absolute root path
 		std::filesystem::path m_RootPath;
@@ -0,0 +1,306 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "HeadlessLayer.h"
+
+#include "Saturn/Project/Project.h"
+
+#include "Saturn/Core/App.h"
+#include "Saturn/Core/VirtualFS.h"
+#include "Saturn/Core/EngineSettings.h"
+#include "Saturn/Core/StringAuxiliary.h"
+#include "Saturn/Core/Renderer/RenderThread.h"
+
+#include "Saturn/Serialisation/SceneSerialiser.h"
+#include "Saturn/Serialisation/ProjectSerialiser.h"
+
+#include "Saturn/GameFramework/Core/GameModule.h"
+
+#include "Saturn/Vulkan/SceneRenderer.h"
+#include "Saturn/Vulkan/VulkanContext.h"
+#include "Saturn/Vulkan/GPUProfiler.h"
+
+#include "Saturn/Asset/AssetManager.h"
+
+#include "Saturn/Physics/PhysicsFoundation.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace Saturn {
+
+	HeadlessLayer::HeadlessLayer( const HeadlessSpecification& rSpecification )
+		: m_Specification( rSpecification ), m_Scene( Ref<Scene>::Create() ),
+		m_Camera( 45.0f, ( float ) Application::Get().GetWidth(), ( float ) Application::Get().GetHeight(), 0.1f, 1000.0f )
+	{
+		SAT_CORE_ASSERT( Application::Get().HasFlag( ApplicationFlag_Headless ), "HeadlessLayer requires ApplicationFlag_Headless." );
+
+		Scene::SetActiveScene( m_Scene.Get() );
+
+		auto& rUserSettings = EngineSettings::Get();
+
+		ProjectSerialiser ps;
+		ps.Deserialise( rUserSettings.FullStartupProjPath.string() );
+
+		SAT_CORE_ASSERT( Project::GetActiveProject(), "No project was given." );
+
+		// Init Physics, after the project as the tolerance scale comes from the project's physics settings.
+		PhysicsFoundation* pPhysicsFoundation = new PhysicsFoundation();
+		pPhysicsFoundation->Init();
+
+		VirtualFS::Get().MountBase( Project::GetActiveConfig().Name, rUserSettings.StartupProject );
+
+		AssetManager* pAssetManager = new AssetManager();
+
+		m_GameModule = new GameModule();
+
+		// Automated runs need a clean failure, not a dialog or a debugger break.
+		if( !OpenScene() )
+		{
+			m_Finished = true;
+
+			Application::Get().SetExitCode( 1 );
+			Application::Get().Close();
+
+			return;
+		}
+
+		// Nothing to present to, the composite image is the final output.
+		Application::Get().PrimarySceneRenderer().SetSwapchainTarget( false );
+		Application::Get().PrimarySceneRenderer().SetViewportSize( Application::Get().GetWidth(), Application::Get().GetHeight() );
+
+		m_CPUFrameTimes.reserve( m_Specification.FrameCount );
+		m_GPUFrameTimes.reserve( m_Specification.FrameCount );
+
+		SAT_CORE_INFO( "Headless: rendering {0} frames ({1} warmup) of \"{2}\" at {3}x{4}", 
+			m_Specification.FrameCount, m_Specification.WarmupFrames, m_Scene->Name, Application::Get().GetWidth(), Application::Get().GetHeight() );
+	}
+
+	HeadlessLayer::~HeadlessLayer()
+	{
+		Application::Get().PrimarySceneRenderer().SetCurrentScene( nullptr );
+
+		m_Scene = nullptr;
+
+		VirtualFS::Get().UnmountBase( Project::GetActiveConfig().Name );
+	}
+
+	bool HeadlessLayer::OpenScene()
+	{
+		Ref<Asset> asset = nullptr;
+
+		if( m_Specification.Scene.empty() )
+			asset = AssetManager::Get().FindAsset( Project::GetActiveProject()->GetConfig().StartupSceneID );
+		else
+		{
+			asset = AssetManager::Get().FindAsset( std::filesystem::path( m_Specification.Scene ) );
+
+			if( !asset )
+				asset = AssetManager::Get().FindAsset( m_Specification.Scene, AssetType::Scene );
+		}
+
+		if( !asset )
+		{
+			SAT_CORE_ERROR( "Headless: could not find the scene to render: \"{0}\"", m_Specification.Scene );
+			return false;
+		}
+
+		Ref<Scene> newScene = Ref<Scene>::Create();
+		Scene::SetActiveScene( newScene.Get() );
+
+		SceneSerialiser serialiser( newScene );
+		serialiser.Deserialise( asset->Path );
+
+		m_Scene = newScene;
+
+		m_Scene->Name = asset->Name;
+		m_Scene->Path = asset->Path;
+		m_Scene->ID = asset->ID;
+		m_Scene->Type = asset->Type;
+		m_Scene->Flags = asset->Flags;
+
+		Application::Get().PrimarySceneRenderer().SetCurrentScene( m_Scene.Get() );
+
+		return true;
+	}
+
+	void HeadlessLayer::OnUpdate( Timestep time )
+	{
+		if( m_Finished )
+			return;
+
+		// The checks build and step their own scenes, nothing has to be rendered for them.
+		if( m_Specification.PhysicsChecks )
+		{
+			m_PhysicsCheckResults = PhysicsChecks::RunAll();
+
+			for( const PhysicsCheckResult& rResult : m_PhysicsCheckResults )
+			{
+				if( !rResult.Passed )
+					Application::Get().SetExitCode( 1 );
+			}
+
+			Finish();
+			return;
+		}
+
+		const uint32_t FirstFrame = m_Specification.WarmupFrames;
+		const uint32_t EndFrame = m_Specification.WarmupFrames + m_Specification.FrameCount;
+
+		auto IsMeasured = [&]( int64_t Frame ) { return Frame >= FirstFrame && Frame < EndFrame; };
+
+		// Time between two updates is the whole frame, including waiting on the GPU.
+		if( IsMeasured( ( int64_t ) m_FramesRendered - 1 ) )
+			m_CPUFrameTimes.push_back( m_FrameTimer.ElapsedMilliseconds() );
+
+		// GPU timings are read back MAX_FRAMES_IN_FLIGHT frames late, so the latest result is from an older frame than the CPU time.
+		GPUProfiler* pProfiler = VulkanContext::Get().GetGPUProfiler();
+
+		if( pProfiler->IsSupported() && IsMeasured( ( int64_t ) m_FramesRendered - 1 - MAX_FRAMES_IN_FLIGHT ) )
+			m_GPUFrameTimes.push_back( pProfiler->GetFrameTime() );
+
+		m_FrameTimer.Reset();
+
+		// Keep rendering until the timings of the last measured frame have been read back.
+		if( m_FramesRendered >= EndFrame + MAX_FRAMES_IN_FLIGHT )
+		{
+			Finish();
+			return;
+		}
+
+		SceneRenderer& rSceneRenderer = Application::Get().PrimarySceneRenderer();
+
+		if( m_Scene->GetMainCameraEntity() )
+			m_Scene->OnRenderRuntime( time, rSceneRenderer );
+		else
+			m_Scene->OnRenderEditor( m_Camera, time, rSceneRenderer );
+
+		m_FramesRendered++;
+	}
+
+	void HeadlessLayer::Finish()
+	{
+		m_Finished = true;
+
+		WriteStats();
+
+		// The last frame has been submitted and waited on, so the composite image holds it.
+		if( !m_Specification.ImagePath.empty() )
+		{
+			std::filesystem::path ImagePath = m_Specification.ImagePath;
+
+			RenderThread::Get().Queue( [ImagePath]
+				{
+					Application::Get().PrimarySceneRenderer().SaveCompositeImage( ImagePath );
+
+					SAT_CORE_INFO( "Headless: wrote composite image to {0}", ImagePath.string() );
+				} );
+		}
+
+		Application::Get().Close();
+	}
+
+	bool HeadlessLayer::WriteStats()
+	{
+		std::ofstream Stream( m_Specification.StatsPath );
+
+		if( !Stream )
+		{
+			SAT_CORE_WARN( "Headless: failed to open stats file: {0}", m_Specification.StatsPath.string() );
+			return false;
+		}
+
+		auto WriteSeries = [&]( const char* pName, std::vector<float> Times )
+		{
+			Stream << "\t\"" << pName << "\": { ";
+
+			if( Times.empty() )
+			{
+				Stream << "\"frames\": 0 }";
+				return;
+			}
+
+			std::sort( Times.begin(), Times.end() );
+
+			float Total = 0.0f;
+			for( float Time : Times )
+				Total += Time;
+
+			auto Percentile = [&]( float P ) { return Times[ ( size_t ) ( P * ( float ) ( Times.size() - 1 ) + 0.5f ) ]; };
+
+			Stream << "\"frames\": " << Times.size() 
+				<< ", \"min\": " << Times.front() 
+				<< ", \"avg\": " << Total / ( float ) Times.size() 
+				<< ", \"max\": " << Times.back()
+				<< ", \"p50\": " << Percentile( 0.50f ) 
+				<< ", \"p95\": " << Percentile( 0.95f ) 
+				<< ", \"p99\": " << Percentile( 0.99f ) << " }";
+		};
+
+		Stream << "{\n";
+		Stream << "\t\"scene\": \"" << Auxiliary::EscapeJson( m_Scene->Name ) << "\",\n";
+		Stream << "\t\"width\": " << Application::Get().GetWidth() << ",\n";
+		Stream << "\t\"height\": " << Application::Get().GetHeight() << ",\n";
+		Stream << "\t\"warmup\": " << m_Specification.WarmupFrames << ",\n";
+
+		WriteSeries( "cpu_ms", m_CPUFrameTimes );
+		Stream << ",\n";
+		WriteSeries( "gpu_ms", m_GPUFrameTimes );
+		Stream << ",\n";
+
+		// Per pass timings of the latest frame that was read back.
+		const auto& rScopes = VulkanContext::Get().GetGPUProfiler()->GetResults();
+
+		Stream << "\t\"gpu_scopes\": [\n";
+
+		for( size_t i = 0; i < rScopes.size(); i++ )
+		{
+			Stream << "\t\t{ \"name\": \"" << Auxiliary::EscapeJson( rScopes[ i ].Name ) << "\", \"depth\": " << rScopes[ i ].Depth << ", \"ms\": " << rScopes[ i ].Milliseconds << " }";
+			Stream << ( i + 1 < rScopes.size() ? ",\n" : "\n" );
+		}
+
+		Stream << "\t],\n";
+
+		Stream << "\t\"physics_checks\": [\n";
+
+		for( size_t i = 0; i < m_PhysicsCheckResults.size(); i++ )
+		{
+			const PhysicsCheckResult& rResult = m_PhysicsCheckResults[ i ];
+
+			Stream << "\t\t{ \"name\": \"" << Auxiliary::EscapeJson( rResult.Name ) << "\", \"passed\": " << ( rResult.Passed ? "true" : "false" ) << ", \"message\": \"" << Auxiliary::EscapeJson( rResult.Message ) << "\" }";
+			Stream << ( i + 1 < m_PhysicsCheckResults.size() ? ",\n" : "\n" );
+		}
+
+		Stream << "\t]\n}\n";
+
+		SAT_CORE_INFO( "Headless: wrote frame stats to {0}", m_Specification.StatsPath.string() );
+
+		return true;
+	}
+}
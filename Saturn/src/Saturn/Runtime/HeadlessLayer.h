@@ -0,0 +1,96 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Saturn/Core/Layer.h"
+#include "Saturn/Core/Timer.h"
+#include "Saturn/Core/Renderer/EditorCamera.h"
+#include "Saturn/Scene/Scene.h"
+#include "Saturn/Physics/PhysicsChecks.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Saturn {
+
+	class GameModule;
+
+	struct HeadlessSpecification
+	{
+		// Asset path or name of the scene to render, the project's startup scene is used when empty.
+		std::string Scene;
+
+		uint32_t FrameCount = 300;
+
+		// Frames rendered before we start recording, lets shaders, pipelines and streaming settle.
+		uint32_t WarmupFrames = 10;
+
+		std::filesystem::path StatsPath = "HeadlessStats.json";
+
+		// When set the final composite image is written here, used for golden image comparisons.
+		std::filesystem::path ImagePath;
+
+		// Runs the physics checks on the first update instead of measuring frames, the results are written to the stats file.
+		bool PhysicsChecks = false;
+	};
+
+	// Renders a scene into the scene renderer's offscreen targets for a fixed number of frames then closes the application.
+	// Requires ApplicationFlag_Headless, there is no window so no input, ImGui or game scripts.
+	class HeadlessLayer : public Layer
+	{
+	public:
+		HeadlessLayer( const HeadlessSpecification& rSpecification );
+		~HeadlessLayer();
+
+		void OnUpdate( Timestep time ) override;
+
+	private:
+		// False when the scene could not be found.
+		bool OpenScene();
+		void Finish();
+		bool WriteStats();
+
+	private:
+		HeadlessSpecification m_Specification;
+
+		Ref<Scene> m_Scene;
+		EditorCamera m_Camera;
+		GameModule* m_GameModule = nullptr;
+
+		uint32_t m_FramesRendered = 0;
+		bool m_Finished = false;
+
+		Timer m_FrameTimer;
+		std::vector<float> m_CPUFrameTimes;
+		std::vector<float> m_GPUFrameTimes;
+
+		std::vector<PhysicsCheckResult> m_PhysicsCheckResults;
+	};
+}
@@ -61,10 +61,6 @@ namespace Saturn {
 	{
 		Scene::SetActiveScene( m_RuntimeScene.Get() );
 
-		// Init Physics
-		PhysicsFoundation* pPhysicsFoundation = new PhysicsFoundation();
-		pPhysicsFoundation->Init();
-
 		auto& rUserSettings = EngineSettings::Get();
 #if !defined( SAT_DIST )
 
@@ -74,6 +70,10 @@ namespace Saturn {
 		SAT_CORE_ASSERT( Project::GetActiveProject(), "No project was given." );
 #endif
 
+		// Init Physics, after the project as the tolerance scale comes from the project's physics settings.
+		PhysicsFoundation* pPhysicsFoundation = new PhysicsFoundation();
+		pPhysicsFoundation->Init();
+
 		VirtualFS::Get().MountBase( Project::GetActiveConfig().Name, rUserSettings.StartupProject );
 
 		AssetManager* pAssetManager = new AssetManager();
@@ -165,15 +165,24 @@ namespace Saturn {
 		SAT_PF_EVENT();
 
 		// Update Cycle.
-		// Step 1: Update and simulate the physics scene.
-		// Step 2: Update all entities.
+		// Step 1: Fetch the physics step that ran while the last frame was rendered.
+		// Step 2: Run as many fixed physics steps as fit in the frame time, entities get a physics update before each one. The last step keeps running after this.
+		// Step 3: Interpolate the rigid body transforms between the last two finished steps.
+		// Step 4: Update all entities.
 
 		// TODO: We might want to change the order of this update cycle.
 		if( m_RuntimeRunning ) 
 		{
-			// Simulate the physics scene.
-			m_PhysicsScene->Update( ts );
-			OnUpdatePhysics( ts );
+			m_PhysicsScene->ResetStats();
+			m_PhysicsScene->ClearEvents();
+			m_PhysicsScene->FetchResults();
+
+			uint32_t Steps = m_PhysicsScene->Accumulate( ts );
+
+			for( uint32_t i = 0; i < Steps; i++ )
+				OnUpdatePhysics( m_PhysicsScene->GetFixedTimestep(), i + 1 == Steps );
+
+			m_PhysicsScene->Interpolate();
 
 			for( auto&& [id, entity] : m_EntityIDMap )
 			{
@@ -182,23 +191,17 @@ namespace Saturn {
 		}
 	}
 	
-	void Scene::OnUpdatePhysics( Timestep ts )
+	void Scene::OnUpdatePhysics( Timestep ts, bool LastStep )
 	{
 		SAT_PF_EVENT();
 
-		auto rigidBodies = GetAllEntitiesWith<RigidbodyComponent>();
-		
-		float FixedTimestep = 1.0f / 100.0f;
+		// "ts" is always the fixed timestep.
 		for( auto&& [id, entity] : m_EntityIDMap )
 		{
-			entity->OnPhysicsUpdate( FixedTimestep );
+			entity->OnPhysicsUpdate( ts );
 		}
 
-		for( auto& entity : rigidBodies )
-		{
-			auto& rb = entity->GetComponent<RigidbodyComponent>();
-			rb.Rigidbody->SyncTransfrom();
-		}
+		m_PhysicsScene->BeginStep( LastStep );
 	}
 
 	void Scene::OnRenderEditor( const EditorCamera& rCamera, Timestep ts, SceneRenderer& rSceneRenderer )
@@ -208,6 +211,9 @@ namespace Saturn {
 		Renderer2D::Get().SetCamera( rCamera.ViewProjection(), rCamera.ViewMatrix() );
 		Renderer2D::Get().Prepare();
 
+		// Set before submitting meshes, LODs are selected from the camera position.
+		rSceneRenderer.SetCamera( { rCamera, rCamera.ViewMatrix() } );
+
 		// Lights
 		{
 			m_Lights = Lights();
@@ -299,8 +305,6 @@ namespace Saturn {
 				}
 			}
 		}
-
-		rSceneRenderer.SetCamera( { rCamera, rCamera.ViewMatrix() } );
 	}
 
 	void Scene::OnRenderRuntime( Timestep ts, SceneRenderer& rSceneRenderer )
@@ -316,10 +320,18 @@ namespace Saturn {
 		auto view = glm::inverse( GetTransformRelativeToParent( cameraEntity ) );
 		SceneCamera& camera = cameraEntity->GetComponent<CameraComponent>().Camera;
 
-		// We currently do not use the 2D renderer in runtime however make sure that we "Prepare" it.
+		// Set before submitting meshes, LODs are selected from the camera position.
+		camera.SetViewportSize( rSceneRenderer.Width(), rSceneRenderer.Height() );
+		rSceneRenderer.SetCamera( { camera, view } );
+
+		// The 2D renderer is only used for the physics debug visualization in runtime, however make sure that we "Prepare" it.
 		// Preparing the Renderer2D will reset the quad index count and the vertex buffer ptr.
+		Renderer2D::Get().SetCamera( camera.ProjectionMatrix() * view, view );
 		Renderer2D::Get().Prepare();
 
+		if( m_PhysicsScene )
+			m_PhysicsScene->SubmitDebugDraw();
+
 		// Lights
 		{
 			m_Lights = Lights();
@@ -383,9 +395,6 @@ namespace Saturn {
 					rSceneRenderer.SubmitStaticMesh( entity, meshComponent.Mesh, targetMaterialRegistry, transform );
 			}
 		}
-
-		camera.SetViewportSize( rSceneRenderer.Width(), rSceneRenderer.Height() );
-		rSceneRenderer.SetCamera( { camera, view } );
 	}
 
 	Ref<Entity> Scene::CreateEntityWithIDScript( UUID uuid, const std::string& name /*= "" */, const std::string& rScriptName )
@@ -609,12 +618,16 @@ namespace Saturn {
 
 		m_RuntimeRunning = true;
 
+		Timer StartTimer;
+
 		m_PhysicsScene = new PhysicsScene( this );
 
 		for( auto&& [id, entity] : m_EntityIDMap )
 		{
 			entity->BeginPlay();
 		}
+
+		SAT_CORE_INFO( "Runtime start took {0} ms", StartTimer.ElapsedMilliseconds() );
 	}
 
 	void Scene::OnRuntimeEnd()
@@ -622,6 +635,8 @@ namespace Saturn {
 		if( m_PhysicsScene )
 			delete m_PhysicsScene;
 
+		m_PhysicsScene = nullptr;
+
 		m_RuntimeRunning = false;
 	}
 
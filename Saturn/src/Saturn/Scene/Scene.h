@@ -169,7 +169,11 @@ namespace Saturn {
 		void DeleteEntity( Ref<Entity> entity );
 
 		void OnUpdate( Timestep ts );
-		void OnUpdatePhysics( Timestep ts );
+		// "LastStep" is set for the last fixed step of a frame, only that step keeps running after this returns.
+		void OnUpdatePhysics( Timestep ts, bool LastStep = true );
+
+		// Null while the runtime is not running.
+		PhysicsScene* GetPhysicsScene() { return m_PhysicsScene; }
 
 	public:
 		template<typename T>
@@ -349,6 +349,10 @@ namespace Saturn {
 
 		out << YAML::Key << "Physics Material ID" << YAML::Value << (int)mesh->GetPhysicsMaterial();
 
+		out << YAML::Key << "Compact Vertices" << YAML::Value << mesh->HasCompactVertices();
+
+		out << YAML::Key << "LOD Ratios" << YAML::Value << YAML::Flow << mesh->GetLodRatios();
+
 		out << YAML::EndMap;
 
 		out << YAML::EndMap;
@@ -377,12 +381,19 @@ namespace Saturn {
 		auto filepath = meshData[ "Filepath" ].as<std::string>();
 		auto shapeType = meshData[ "Attached Shape" ].as<int>( 0 );
 		auto physicsMaterial = meshData[ "Physics Material ID" ].as<uint64_t>( 0 );
+		auto compactVertices = meshData[ "Compact Vertices" ].as<bool>( false );
+		auto lodRatios = meshData[ "LOD Ratios" ];
 
 		auto realMeshPath = Project::GetActiveProject()->FilepathAbs( filepath );
 		auto mesh = Ref<StaticMesh>::Create( realMeshPath.string() );
 
 		mesh->SetAttachedShape( (ShapeType)shapeType );
 		mesh->SetPhysicsMaterial( physicsMaterial );
+		mesh->SetCompactVertices( compactVertices );
+
+		// Assets from before LODs keep the default ratios.
+		if( lodRatios )
+			mesh->SetLodRatios( lodRatios.as<std::vector<float>>() );
 
 		// TODO: (Asset) Fix this.
 		struct
@@ -82,6 +82,27 @@ namespace Saturn {
 			}
 
 			out << YAML::EndSeq;
+
+			const PhysicsSettings& rPhysics = rProject->GetPhysicsSettings();
+
+			out << YAML::Key << "Physics";
+			out << YAML::BeginMap;
+
+			out << YAML::Key << "ToleranceLength" << YAML::Value << rPhysics.ToleranceLength;
+			out << YAML::Key << "ToleranceSpeed" << YAML::Value << rPhysics.ToleranceSpeed;
+			out << YAML::Key << "Broadphase" << YAML::Value << ( int ) rPhysics.BroadphaseType;
+			out << YAML::Key << "WorldBoundsMin" << YAML::Value << rPhysics.WorldBoundsMin;
+			out << YAML::Key << "WorldBoundsMax" << YAML::Value << rPhysics.WorldBoundsMax;
+			out << YAML::Key << "WorldSubdivisions" << YAML::Value << rPhysics.WorldSubdivisions;
+			out << YAML::Key << "Solver" << YAML::Value << ( int ) rPhysics.SolverType;
+			out << YAML::Key << "PositionIterations" << YAML::Value << rPhysics.PositionIterations;
+			out << YAML::Key << "VelocityIterations" << YAML::Value << rPhysics.VelocityIterations;
+			out << YAML::Key << "EnableCCD" << YAML::Value << rPhysics.EnableCCD;
+			out << YAML::Key << "SleepThreshold" << YAML::Value << rPhysics.SleepThreshold;
+			out << YAML::Key << "BounceThresholdVelocity" << YAML::Value << rPhysics.BounceThresholdVelocity;
+			out << YAML::Key << "FrictionOffsetThreshold" << YAML::Value << rPhysics.FrictionOffsetThreshold;
+
+			out << YAML::EndMap;
 		}
 
 		out << YAML::EndMap;
@@ -136,6 +157,29 @@ namespace Saturn {
 			}
 		}
 
+		// Older projects do not have this, they keep the defaults.
+		auto physics = project[ "Physics" ];
+
+		if( physics )
+		{
+			PhysicsSettings& rPhysics = newProject->GetPhysicsSettings();
+			const PhysicsSettings Defaults{};
+
+			rPhysics.ToleranceLength = physics[ "ToleranceLength" ].as<float>( Defaults.ToleranceLength );
+			rPhysics.ToleranceSpeed = physics[ "ToleranceSpeed" ].as<float>( Defaults.ToleranceSpeed );
+			rPhysics.BroadphaseType = ( PhysicsBroadphaseType ) physics[ "Broadphase" ].as<int>( ( int ) Defaults.BroadphaseType );
+			rPhysics.WorldBoundsMin = physics[ "WorldBoundsMin" ].as<glm::vec3>( Defaults.WorldBoundsMin );
+			rPhysics.WorldBoundsMax = physics[ "WorldBoundsMax" ].as<glm::vec3>( Defaults.WorldBoundsMax );
+			rPhysics.WorldSubdivisions = std::clamp( physics[ "WorldSubdivisions" ].as<uint32_t>( Defaults.WorldSubdivisions ), 1u, 16u );
+			rPhysics.SolverType = ( PhysicsSolverType ) physics[ "Solver" ].as<int>( ( int ) Defaults.SolverType );
+			rPhysics.PositionIterations = physics[ "PositionIterations" ].as<uint32_t>( Defaults.PositionIterations );
+			rPhysics.VelocityIterations = physics[ "VelocityIterations" ].as<uint32_t>( Defaults.VelocityIterations );
+			rPhysics.EnableCCD = physics[ "EnableCCD" ].as<bool>( Defaults.EnableCCD );
+			rPhysics.SleepThreshold = physics[ "SleepThreshold" ].as<float>( Defaults.SleepThreshold );
+			rPhysics.BounceThresholdVelocity = physics[ "BounceThresholdVelocity" ].as<float>( Defaults.BounceThresholdVelocity );
+			rPhysics.FrictionOffsetThreshold = physics[ "FrictionOffsetThreshold" ].as<float>( Defaults.FrictionOffsetThreshold );
+		}
+
 		Project::SetActiveProject( newProject );
 	}
 
@@ -0,0 +1,342 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "BindlessResources.h"
+
+#include "VulkanContext.h"
+#include "VulkanAllocator.h"
+#include "VulkanDebug.h"
+
+namespace Saturn {
+
+	static constexpr uint32_t s_MaxBindlessTextures = 16384;
+	static constexpr uint32_t s_DefaultMaterialCapacity = 1024;
+
+	bool BindlessResources::IsSupported( VkPhysicalDevice PhysicalDevice, VkPhysicalDeviceDescriptorIndexingFeatures& rFeatures )
+	{
+		VkPhysicalDeviceDescriptorIndexingFeatures IndexingFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES };
+
+		VkPhysicalDeviceFeatures2 Features = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+		Features.pNext = &IndexingFeatures;
+
+		vkGetPhysicalDeviceFeatures2( PhysicalDevice, &Features );
+
+		bool Supported = IndexingFeatures.runtimeDescriptorArray
+			&& IndexingFeatures.descriptorBindingPartiallyBound
+			&& IndexingFeatures.descriptorBindingSampledImageUpdateAfterBind
+			&& IndexingFeatures.descriptorBindingUpdateUnusedWhilePending
+			&& IndexingFeatures.shaderSampledImageArrayNonUniformIndexing;
+
+		rFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES };
+
+		if( Supported )
+		{
+			rFeatures.runtimeDescriptorArray = VK_TRUE;
+			rFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+			rFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+			rFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+			rFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		}
+
+		return Supported;
+	}
+
+	BindlessResources::BindlessResources()
+	{
+		VkDevice LogicalDevice = VulkanContext::Get().GetDevice();
+
+		VkPhysicalDeviceDescriptorIndexingProperties IndexingProperties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES };
+
+		VkPhysicalDeviceProperties2 Properties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+		Properties.pNext = &IndexingProperties;
+
+		vkGetPhysicalDeviceProperties2( VulkanContext::Get().GetPhysicalDevice(), &Properties );
+
+		m_MaxTextures = std::min( { s_MaxBindlessTextures,
+			IndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+			IndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages } );
+
+		SAT_CORE_INFO( "Bindless textures enabled, max textures: {0}", m_MaxTextures );
+
+		// Create the set layout.
+		std::array<VkDescriptorSetLayoutBinding, 2> Bindings = {};
+		Bindings[ 0 ].binding = 0;
+		Bindings[ 0 ].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		Bindings[ 0 ].descriptorCount = m_MaxTextures;
+		Bindings[ 0 ].stageFlags = VK_SHADER_STAGE_ALL;
+
+		Bindings[ 1 ].binding = 1;
+		Bindings[ 1 ].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		Bindings[ 1 ].descriptorCount = 1;
+		Bindings[ 1 ].stageFlags = VK_SHADER_STAGE_ALL;
+
+		std::array<VkDescriptorBindingFlags, 2> BindingFlags = {
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+			0
+		};
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo BindingFlagsInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+		BindingFlagsInfo.bindingCount = ( uint32_t ) BindingFlags.size();
+		BindingFlagsInfo.pBindingFlags = BindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo LayoutInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+		LayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		LayoutInfo.bindingCount = ( uint32_t ) Bindings.size();
+		LayoutInfo.pBindings = Bindings.data();
+		LayoutInfo.pNext = &BindingFlagsInfo;
+
+		VK_CHECK( vkCreateDescriptorSetLayout( LogicalDevice, &LayoutInfo, nullptr, &m_SetLayout ) );
+
+		// Create the pool, one set per frame in flight.
+		std::array<VkDescriptorPoolSize, 2> PoolSizes = {};
+		PoolSizes[ 0 ] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_MaxTextures * MAX_FRAMES_IN_FLIGHT };
+		PoolSizes[ 1 ] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_FRAMES_IN_FLIGHT };
+
+		VkDescriptorPoolCreateInfo PoolInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+		PoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		PoolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+		PoolInfo.poolSizeCount = ( uint32_t ) PoolSizes.size();
+		PoolInfo.pPoolSizes = PoolSizes.data();
+
+		VK_CHECK( vkCreateDescriptorPool( LogicalDevice, &PoolInfo, nullptr, &m_Pool ) );
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			VkDescriptorSetAllocateInfo AllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+			AllocateInfo.descriptorPool = m_Pool;
+			AllocateInfo.descriptorSetCount = 1;
+			AllocateInfo.pSetLayouts = &m_SetLayout;
+
+			VK_CHECK( vkAllocateDescriptorSets( LogicalDevice, &AllocateInfo, &m_DescriptorSets[ i ] ) );
+
+			SetDebugUtilsObjectName( "Bindless Descriptor Set", ( uint64_t ) m_DescriptorSets[ i ], VK_OBJECT_TYPE_DESCRIPTOR_SET );
+		}
+
+		m_MaterialCapacity = s_DefaultMaterialCapacity;
+		m_Materials.resize( m_MaterialCapacity );
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+			CreateMaterialBuffer( i );
+	}
+
+	BindlessResources::~BindlessResources()
+	{
+		VkDevice LogicalDevice = VulkanContext::Get().GetDevice();
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			if( !m_MaterialBuffers[ i ] )
+				continue;
+
+			pAllocator->UnmapMemory( pAllocator->GetAllocationFromBuffer( m_MaterialBuffers[ i ] ) );
+			pAllocator->DestroyBuffer( m_MaterialBuffers[ i ] );
+		}
+
+		vkDestroyDescriptorPool( LogicalDevice, m_Pool, nullptr );
+		vkDestroyDescriptorSetLayout( LogicalDevice, m_SetLayout, nullptr );
+	}
+
+	void BindlessResources::SetDefaultTexture( const VkDescriptorImageInfo& rImageInfo )
+	{
+		WriteTexture( 0, rImageInfo );
+	}
+
+	uint32_t BindlessResources::RegisterTexture( const VkDescriptorImageInfo& rImageInfo )
+	{
+		uint32_t Index = 0;
+
+		if( m_FreeTextureSlots.size() )
+		{
+			Index = m_FreeTextureSlots.back();
+			m_FreeTextureSlots.pop_back();
+		}
+		else
+		{
+			if( m_TextureCount >= m_MaxTextures )
+			{
+				SAT_CORE_WARN( "Bindless texture array is full ({0} textures), texture will use the default slot!", m_MaxTextures );
+				return 0;
+			}
+
+			Index = m_TextureCount++;
+		}
+
+		WriteTexture( Index, rImageInfo );
+
+		return Index;
+	}
+
+	uint32_t BindlessResources::UpdateTexture( uint32_t Index, const VkDescriptorImageInfo& rImageInfo )
+	{
+		// Register first so the old slot can not be handed straight back to us.
+		uint32_t NewIndex = RegisterTexture( rImageInfo );
+
+		UnregisterTexture( Index );
+
+		return NewIndex;
+	}
+
+	void BindlessResources::UnregisterTexture( uint32_t Index )
+	{
+		// Slot 0 is the default texture, it is never freed.
+		if( Index == 0 )
+			return;
+
+		m_PendingTextureFrees[ m_CurrentFrame ].push_back( Index );
+	}
+
+	uint32_t BindlessResources::AllocateMaterial()
+	{
+		uint32_t Index = 0;
+
+		if( m_FreeMaterialSlots.size() )
+		{
+			Index = m_FreeMaterialSlots.back();
+			m_FreeMaterialSlots.pop_back();
+		}
+		else
+		{
+			// The GPU buffers are replaced in BeginFrame, a frame that is being recorded keeps its buffer and descriptor.
+			if( m_MaterialCount >= m_MaterialCapacity )
+			{
+				m_MaterialCapacity *= 2;
+				m_Materials.resize( m_MaterialCapacity );
+			}
+
+			Index = m_MaterialCount++;
+		}
+
+		m_Materials[ Index ] = {};
+		m_MaterialsDirtyFrames = MAX_FRAMES_IN_FLIGHT;
+
+		return Index;
+	}
+
+	void BindlessResources::FreeMaterial( uint32_t Index )
+	{
+		m_PendingMaterialFrees[ m_CurrentFrame ].push_back( Index );
+	}
+
+	void BindlessResources::UpdateMaterial( uint32_t Index, const BindlessMaterial& rMaterial )
+	{
+		if( memcmp( &m_Materials[ Index ], &rMaterial, sizeof( BindlessMaterial ) ) == 0 )
+			return;
+
+		m_Materials[ Index ] = rMaterial;
+		m_MaterialsDirtyFrames = MAX_FRAMES_IN_FLIGHT;
+
+		// The current frame has not been submitted yet so we can write to its buffer directly, unless the slot is past the end of it.
+		if( Index < m_BufferCapacity[ m_CurrentFrame ] )
+			m_pMaterialData[ m_CurrentFrame ][ Index ] = rMaterial;
+	}
+
+	void BindlessResources::BeginFrame( uint32_t Frame )
+	{
+		m_CurrentFrame = Frame;
+
+		// The last time this frame was used was MAX_FRAMES_IN_FLIGHT frames ago, so nothing can be using these slots.
+		m_FreeTextureSlots.insert( m_FreeTextureSlots.end(), m_PendingTextureFrees[ Frame ].begin(), m_PendingTextureFrees[ Frame ].end() );
+		m_PendingTextureFrees[ Frame ].clear();
+
+		m_FreeMaterialSlots.insert( m_FreeMaterialSlots.end(), m_PendingMaterialFrees[ Frame ].begin(), m_PendingMaterialFrees[ Frame ].end() );
+		m_PendingMaterialFrees[ Frame ].clear();
+
+		// The fence for this frame was waited on and nothing has been recorded yet, so its buffer and descriptor can be replaced.
+		if( m_BufferCapacity[ Frame ] < m_MaterialCapacity )
+			CreateMaterialBuffer( Frame );
+
+		// Each frame has its own copy of the material buffer, copy the latest data into the buffer for this frame.
+		if( m_MaterialsDirtyFrames > 0 )
+		{
+			memcpy( m_pMaterialData[ Frame ], m_Materials.data(), sizeof( BindlessMaterial ) * m_MaterialCount );
+
+			m_MaterialsDirtyFrames--;
+		}
+	}
+
+	void BindlessResources::Bind( VkCommandBuffer CommandBuffer, VkPipelineBindPoint BindPoint, VkPipelineLayout Layout, uint32_t SetIndex )
+	{
+		vkCmdBindDescriptorSets( CommandBuffer, BindPoint, Layout, SetIndex, 1, &m_DescriptorSets[ m_CurrentFrame ], 0, nullptr );
+	}
+
+	void BindlessResources::WriteTexture( uint32_t Index, const VkDescriptorImageInfo& rImageInfo )
+	{
+		std::array<VkWriteDescriptorSet, MAX_FRAMES_IN_FLIGHT> WriteDescriptorSets = {};
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			WriteDescriptorSets[ i ] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			WriteDescriptorSets[ i ].dstSet = m_DescriptorSets[ i ];
+			WriteDescriptorSets[ i ].dstBinding = 0;
+			WriteDescriptorSets[ i ].dstArrayElement = Index;
+			WriteDescriptorSets[ i ].descriptorCount = 1;
+			WriteDescriptorSets[ i ].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			WriteDescriptorSets[ i ].pImageInfo = &rImageInfo;
+		}
+
+		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), ( uint32_t ) WriteDescriptorSets.size(), WriteDescriptorSets.data(), 0, nullptr );
+	}
+
+	void BindlessResources::CreateMaterialBuffer( uint32_t Frame )
+	{
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		if( m_MaterialBuffers[ Frame ] )
+		{
+			pAllocator->UnmapMemory( pAllocator->GetAllocationFromBuffer( m_MaterialBuffers[ Frame ] ) );
+			pAllocator->DestroyBuffer( m_MaterialBuffers[ Frame ] );
+		}
+
+		VkBufferCreateInfo BufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		BufferInfo.size = sizeof( BindlessMaterial ) * m_MaterialCapacity;
+		BufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VmaAllocation Allocation = pAllocator->AllocateBuffer( BufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &m_MaterialBuffers[ Frame ] );
+		m_pMaterialData[ Frame ] = pAllocator->MapMemory<BindlessMaterial>( Allocation );
+		m_BufferCapacity[ Frame ] = m_MaterialCapacity;
+
+		memcpy( m_pMaterialData[ Frame ], m_Materials.data(), sizeof( BindlessMaterial ) * m_MaterialCount );
+
+		VkDescriptorBufferInfo DescriptorBufferInfo = {};
+		DescriptorBufferInfo.buffer = m_MaterialBuffers[ Frame ];
+		DescriptorBufferInfo.offset = 0;
+		DescriptorBufferInfo.range = VK_WHOLE_SIZE;
+
+		VkWriteDescriptorSet WriteDescriptorSet = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		WriteDescriptorSet.dstSet = m_DescriptorSets[ Frame ];
+		WriteDescriptorSet.dstBinding = 1;
+		WriteDescriptorSet.descriptorCount = 1;
+		WriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		WriteDescriptorSet.pBufferInfo = &DescriptorBufferInfo;
+
+		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &WriteDescriptorSet, 0, nullptr );
+	}
+}
@@ -0,0 +1,136 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include <glm/glm.hpp>
+#include <vulkan.h>
+#include <vma/vk_mem_alloc.h>
+#include <vector>
+
+namespace Saturn {
+
+	class Texture2D;
+
+	// Must match "Material" in shader_new_bindless.glsl (std430).
+	struct BindlessMaterial
+	{
+		glm::vec3 AlbedoColor = glm::vec3( 1.0f );
+		float Roughness = 0.0f;
+		float Metalness = 0.0f;
+		float Emissive = 0.0f;
+		float UseNormalMap = 0.0f;
+
+		uint32_t AlbedoTexture = 0;
+		uint32_t NormalTexture = 0;
+		uint32_t MetallicTexture = 0;
+		uint32_t RoughnessTexture = 0;
+
+		uint32_t Padding = 0;
+	};
+
+	// Bindless mode (ApplicationFlag_BindlessTextures), requires descriptor indexing.
+	// Every loaded Texture2D gets a slot in one large texture array and every material asset gets a slot in the material storage buffer.
+	// Shaders that declare an unsized sampler array (i.e. "uniform sampler2D u_Textures[]") will use this layout for that set:
+	//  binding 0: sampler2D[] textures
+	//  binding 1: Material[] materials
+	class BindlessResources
+	{
+	public:
+		// Checks if the physical device supports the features we need, fills "rFeatures" with what should be enabled.
+		static bool IsSupported( VkPhysicalDevice PhysicalDevice, VkPhysicalDeviceDescriptorIndexingFeatures& rFeatures );
+
+	public:
+		BindlessResources();
+		~BindlessResources();
+
+		// Slot 0, used when a texture is missing or the array is full.
+		void SetDefaultTexture( const VkDescriptorImageInfo& rImageInfo );
+
+		uint32_t RegisterTexture( const VkDescriptorImageInfo& rImageInfo );
+		// Frames in flight may still be sampling the old slot, so the new image gets a fresh slot and the old one is freed once those frames are done.
+		// Returns the new slot.
+		uint32_t UpdateTexture( uint32_t Index, const VkDescriptorImageInfo& rImageInfo );
+		void UnregisterTexture( uint32_t Index );
+
+		uint32_t AllocateMaterial();
+		void FreeMaterial( uint32_t Index );
+		void UpdateMaterial( uint32_t Index, const BindlessMaterial& rMaterial );
+
+		// Called from Renderer::BeginFrame once the fence for "Frame" has been waited on.
+		void BeginFrame( uint32_t Frame );
+
+		void Bind( VkCommandBuffer CommandBuffer, VkPipelineBindPoint BindPoint, VkPipelineLayout Layout, uint32_t SetIndex );
+
+		VkDescriptorSetLayout GetSetLayout() const { return m_SetLayout; }
+		VkDescriptorSet GetDescriptorSet( uint32_t Frame ) const { return m_DescriptorSets[ Frame ]; }
+
+		uint32_t GetMaxTextures() const { return m_MaxTextures; }
+		uint32_t GetTextureCount() const { return m_TextureCount - 1 - ( uint32_t ) m_FreeTextureSlots.size(); }
+		uint32_t GetMaterialCount() const { return m_MaterialCount - ( uint32_t ) m_FreeMaterialSlots.size(); }
+
+	private:
+		void WriteTexture( uint32_t Index, const VkDescriptorImageInfo& rImageInfo );
+		// (Re)creates the material buffer of "Frame" at the current capacity, only valid when the frame is not in flight or being recorded.
+		void CreateMaterialBuffer( uint32_t Frame );
+
+	private:
+		uint32_t m_MaxTextures = 0;
+
+		// Slot 0 is reserved for the default texture.
+		uint32_t m_TextureCount = 1;
+		std::vector<uint32_t> m_FreeTextureSlots;
+
+		uint32_t m_MaterialCount = 0;
+		uint32_t m_MaterialCapacity = 0;
+		std::vector<uint32_t> m_FreeMaterialSlots;
+		std::vector<BindlessMaterial> m_Materials;
+
+		// Slots can only be re-used once no frame in flight can read them.
+		std::vector<uint32_t> m_PendingTextureFrees[ MAX_FRAMES_IN_FLIGHT ];
+		std::vector<uint32_t> m_PendingMaterialFrees[ MAX_FRAMES_IN_FLIGHT ];
+
+		// Number of frames that still need the latest copy of m_Materials.
+		uint32_t m_MaterialsDirtyFrames = 0;
+
+		VkDescriptorSetLayout m_SetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool m_Pool = VK_NULL_HANDLE;
+
+		VkDescriptorSet m_DescriptorSets[ MAX_FRAMES_IN_FLIGHT ] = {};
+
+		VkBuffer m_MaterialBuffers[ MAX_FRAMES_IN_FLIGHT ] = {};
+		BindlessMaterial* m_pMaterialData[ MAX_FRAMES_IN_FLIGHT ] = {};
+
+		// Growing the material array only raises m_MaterialCapacity, each frame's buffer catches up in its own BeginFrame.
+		uint32_t m_BufferCapacity[ MAX_FRAMES_IN_FLIGHT ] = {};
+
+		uint32_t m_CurrentFrame = 0;
+	};
+}
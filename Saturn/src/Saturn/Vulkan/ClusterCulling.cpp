@@ -0,0 +1,240 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "ClusterCulling.h"
+
+#include "VulkanContext.h"
+#include "MeshGeometryPool.h"
+
+namespace Saturn {
+
+	static constexpr uint32_t s_MinDrawCapacity = 256;
+
+	ClusterCulling::ClusterCulling()
+	{
+		m_Shader = ShaderLibrary::Get().FindOrLoad( "ClusterCull", "content/shaders/ClusterCull.glsl" );
+		m_Pipeline = Ref<ComputePipeline>::Create( m_Shader );
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			m_DrawBuffers[ i ] = Ref<StorageBuffer>::Create( 0, 1, VMA_MEMORY_USAGE_CPU_TO_GPU );
+			m_DescriptorSets[ i ] = m_Shader->CreateDescriptorSet( 0 );
+		}
+	}
+
+	ClusterCulling::~ClusterCulling()
+	{
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			m_DrawBuffers[ i ] = nullptr;
+			m_IndexBuffers[ i ] = nullptr;
+			m_DescriptorSets[ i ] = nullptr;
+		}
+
+		m_Pipeline = nullptr;
+		m_Shader = nullptr;
+	}
+
+	void ClusterCulling::Reset()
+	{
+		m_Draws.clear();
+		m_DrawIndices.clear();
+
+		m_TotalIndices = 0;
+		m_TotalMeshlets = 0;
+	}
+
+	void ClusterCulling::AddDraw( const StaticMeshKey& rKey, const Ref<StaticMesh>& rMesh, uint32_t SubmeshIndex, uint32_t InstanceCount )
+	{
+		const Submesh& rSubmesh = rMesh->Submeshes()[ SubmeshIndex ];
+		const MeshGeometryRange& rRange = rMesh->GetGeometryRange();
+
+		if( !rSubmesh.MeshletCount || !rRange.MeshletCount || InstanceCount > MaxInstances || HasDraw( rKey ) )
+			return;
+
+		ClusterDraw Draw = {};
+		Draw.MeshletOffset = rRange.MeshletOffset + rSubmesh.BaseMeshlet;
+		Draw.MeshletCount = rSubmesh.MeshletCount;
+		Draw.OutputOffset = m_TotalIndices;
+		Draw.SourceFirstIndex = rRange.IndexOffset + rSubmesh.BaseIndex;
+
+		m_DrawIndices[ rKey ] = ( uint32_t ) m_Draws.size();
+		m_Draws.push_back( Draw );
+
+		// Worst case every meshlet is visible.
+		m_TotalIndices += rSubmesh.IndexCount;
+		m_TotalMeshlets += rSubmesh.MeshletCount;
+	}
+
+	void ClusterCulling::Dispatch( VkCommandBuffer CommandBuffer, const Ref<InstanceCulling>& rCulling, const Ref<HiZPyramid>& rHiZ, const glm::mat4& rViewProjection, const glm::vec3& rCameraPosition )
+	{
+		SAT_PF_EVENT();
+
+		m_Frame = Renderer::Get().GetCurrentFrame();
+
+		if( m_Draws.empty() )
+			return;
+
+		// Only known once the instance culling buffers exist for this frame.
+		for( auto&& [key, index] : m_DrawIndices )
+		{
+			ClusterDraw& rDraw = m_Draws[ index ];
+
+			rDraw.InstanceOffset = rCulling->GetInstanceOffset( key, 0 ) / sizeof( TransformBufferData );
+			rDraw.CommandIndex = ( uint32_t ) ( rCulling->GetIndirectDraw( key, 0 ).Offset / sizeof( VkDrawIndexedIndirectCommand ) );
+		}
+
+		IndirectDraw Commands = rCulling->GetIndirectDraw( m_DrawIndices.begin()->first, 0 );
+
+		// Nothing to patch, draw every meshlet from the pool instead.
+		if( !Commands.Buffer )
+		{
+			Reset();
+			return;
+		}
+
+		MeshGeometryPool* pPool = VulkanContext::Get().GetMeshGeometryPool();
+		const uint32_t DrawCount = ( uint32_t ) m_Draws.size();
+
+		//////////////////////////////////////////////////////////////////////////
+		// Buffers, we have waited for this frame's fence so they can be re-created.
+
+		size_t DrawSize = m_Draws.size() * sizeof( ClusterDraw );
+		size_t IndexSize = ( size_t ) m_TotalIndices * sizeof( uint32_t );
+
+		auto& rDrawBuffer = m_DrawBuffers[ m_Frame ];
+		auto& rIndexBuffer = m_IndexBuffers[ m_Frame ];
+
+		if( rDrawBuffer->GetSize() < DrawSize )
+			rDrawBuffer->Resize( ( uint32_t ) std::max( { DrawSize, rDrawBuffer->GetSize() * 2, s_MinDrawCapacity * sizeof( ClusterDraw ) } ) );
+
+		if( !rIndexBuffer || rIndexBuffer->GetSize() < IndexSize )
+		{
+			size_t Size = std::max( IndexSize, rIndexBuffer ? rIndexBuffer->GetSize() * 2 : 0 );
+
+			rIndexBuffer = Ref<VertexBuffer>::Create( Size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY );
+		}
+
+		rDrawBuffer->SetData( m_Draws.data(), DrawSize );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Descriptors, the pool's buffers can move when it grows or is defragmented.
+
+		Ref<DescriptorSet>& rDescriptorSet = m_DescriptorSets[ m_Frame ];
+
+		VkDescriptorBufferInfo MeshletBufferInfo = {};
+		MeshletBufferInfo.buffer = pPool->GetMeshletBuffer();
+		MeshletBufferInfo.range = VK_WHOLE_SIZE;
+
+		VkDescriptorBufferInfo InstanceBufferInfo = {};
+		InstanceBufferInfo.buffer = rCulling->GetInstanceBuffer()->GetBuffer();
+		InstanceBufferInfo.range = VK_WHOLE_SIZE;
+
+		VkDescriptorBufferInfo SourceIndexBufferInfo = {};
+		SourceIndexBufferInfo.buffer = pPool->GetIndexBuffer();
+		SourceIndexBufferInfo.range = VK_WHOLE_SIZE;
+
+		VkDescriptorBufferInfo CommandBufferInfo = {};
+		CommandBufferInfo.buffer = Commands.Buffer;
+		CommandBufferInfo.range = VK_WHOLE_SIZE;
+
+		VkDescriptorBufferInfo IndexBufferInfo = {};
+		IndexBufferInfo.buffer = rIndexBuffer->GetBuffer();
+		IndexBufferInfo.range = VK_WHOLE_SIZE;
+
+		m_Shader->WriteSB( 0, 0, MeshletBufferInfo, rDescriptorSet );
+		m_Shader->WriteSB( 0, 1, rDrawBuffer->GetBufferInfo(), rDescriptorSet );
+		m_Shader->WriteSB( 0, 2, InstanceBufferInfo, rDescriptorSet );
+		m_Shader->WriteSB( 0, 3, SourceIndexBufferInfo, rDescriptorSet );
+		m_Shader->WriteSB( 0, 4, CommandBufferInfo, rDescriptorSet );
+		m_Shader->WriteSB( 0, 5, IndexBufferInfo, rDescriptorSet );
+
+		// The shader still needs an image when the occlusion test is off.
+		const bool UseHiZ = rHiZ && rHiZ->GetMipCount();
+
+		if( UseHiZ )
+			m_Shader->WriteDescriptor( "u_HiZ", rHiZ->GetDescriptorInfo(), rDescriptorSet->GetVulkanSet() );
+		else
+			m_Shader->WriteDescriptor( "u_HiZ", Renderer::Get().GetPinkTexture()->GetDescriptorInfo(), rDescriptorSet->GetVulkanSet() );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Cull
+
+		// Wait for instance culling and the HiZ build, and for the pre depth pass that read the commands we are about to patch.
+		VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr );
+
+		struct
+		{
+			glm::mat4 ViewProjection;
+			glm::vec4 CameraPosition;
+
+			// x, y = depth buffer size, z = HiZ mip count (zero disables the occlusion test), w = draw count
+			glm::uvec4 Params;
+		} PushConstants = {};
+
+		PushConstants.ViewProjection = rViewProjection;
+		PushConstants.CameraPosition = glm::vec4( rCameraPosition, 1.0f );
+		PushConstants.Params = { UseHiZ ? rHiZ->GetWidth() : 0, UseHiZ ? rHiZ->GetHeight() : 0, UseHiZ ? rHiZ->GetMipCount() : 0, DrawCount };
+
+		m_Pipeline->BindWithCommandBuffer( CommandBuffer );
+
+		m_Pipeline->AddPushConstant( &PushConstants, 0, sizeof( PushConstants ) );
+
+		// One workgroup per draw.
+		m_Pipeline->Execute( rDescriptorSet->GetVulkanSet(), DrawCount, 1, 1 );
+
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr );
+
+		m_Pipeline->Unbind();
+	}
+
+	VkBuffer ClusterCulling::GetIndexBuffer()
+	{
+		return m_IndexBuffers[ m_Frame ] ? m_IndexBuffers[ m_Frame ]->GetBuffer() : VK_NULL_HANDLE;
+	}
+}
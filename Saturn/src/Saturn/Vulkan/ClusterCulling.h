@@ -0,0 +1,119 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+#include "GPUScene.h"
+#include "Mesh.h"
+#include "InstanceCulling.h"
+#include "HiZPyramid.h"
+
+#include "VertexBuffer.h"
+#include "StorageBuffer.h"
+#include "ComputePipeline.h"
+#include "DescriptorSet.h"
+
+#include <glm/glm.hpp>
+#include <vulkan.h>
+#include <unordered_map>
+#include <vector>
+
+namespace Saturn {
+
+	// Meshlet culling for the camera view, runs after InstanceCulling and the HiZ build.
+	// Every meshlet of a draw is tested against the frustum, its normal cone and the HiZ pyramid for every visible instance.
+	// The indices of the meshlets that survive are compacted into a separate index buffer and the draw's indirect command is patched to read them.
+	class ClusterCulling : public RefTarget
+	{
+	public:
+		// A meshlet is kept if any instance can see it, past this it is rarely culled and the instance loop gets expensive.
+		static constexpr uint32_t MaxInstances = 16;
+
+	public:
+		ClusterCulling();
+		~ClusterCulling();
+
+		// Removes last frame's draws.
+		void Reset();
+
+		// Only LOD 0 has meshlets, "rKey" must also be a draw in the InstanceCulling that is passed to Dispatch.
+		void AddDraw( const StaticMeshKey& rKey, const Ref<StaticMesh>& rMesh, uint32_t SubmeshIndex, uint32_t InstanceCount );
+
+		// Must be called outside of a render pass, after the HiZ pyramid has been built for this frame.
+		// "rHiZ" can be null, the occlusion test is then skipped.
+		void Dispatch( VkCommandBuffer CommandBuffer, const Ref<InstanceCulling>& rCulling, const Ref<HiZPyramid>& rHiZ, const glm::mat4& rViewProjection, const glm::vec3& rCameraPosition );
+
+		bool HasDraw( const StaticMeshKey& rKey ) const { return m_DrawIndices.find( rKey ) != m_DrawIndices.end(); }
+
+		// Replaces the geometry pool's index buffer for every draw in this frame.
+		VkBuffer GetIndexBuffer();
+
+		uint32_t GetDrawCount() const { return ( uint32_t ) m_Draws.size(); }
+		uint32_t GetMeshletCount() const { return m_TotalMeshlets; }
+
+	private:
+		// Must match with "ClusterDraw" in ClusterCull.glsl (std430).
+		struct ClusterDraw
+		{
+			uint32_t MeshletOffset = 0;
+			uint32_t MeshletCount = 0;
+
+			// First culled camera instance in InstanceCulling's instance buffer.
+			uint32_t InstanceOffset = 0;
+
+			// Index of the camera command in InstanceCulling's indirect buffer.
+			uint32_t CommandIndex = 0;
+
+			// Where the visible indices are written to.
+			uint32_t OutputOffset = 0;
+
+			// LOD 0 of the submesh in the geometry pool's index buffer.
+			uint32_t SourceFirstIndex = 0;
+
+			uint32_t Padding[ 2 ] = {};
+		};
+
+	private:
+		std::vector<ClusterDraw> m_Draws;
+		std::unordered_map<StaticMeshKey, uint32_t> m_DrawIndices;
+
+		uint32_t m_TotalIndices = 0;
+		uint32_t m_TotalMeshlets = 0;
+
+		// Frame that was last dispatched, the getters read its buffers.
+		uint32_t m_Frame = 0;
+
+		Ref<StorageBuffer> m_DrawBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref<VertexBuffer> m_IndexBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref<DescriptorSet> m_DescriptorSets[ MAX_FRAMES_IN_FLIGHT ];
+
+		Ref<Shader> m_Shader = nullptr;
+		Ref<ComputePipeline> m_Pipeline = nullptr;
+	};
+}
@@ -30,6 +30,7 @@
 #include "DescriptorSet.h"
 
 #include "VulkanContext.h"
+#include "Renderer.h"
 
 namespace Saturn {
 
@@ -99,11 +100,15 @@ namespace Saturn {
 			WriteDescriptorSet.pImageInfo = nullptr;
 
 		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &WriteDescriptorSet, 0, nullptr );
+
+		Renderer::Get().GetStats().DescriptorWrites++;
 	}
 
 	void DescriptorSet::Write( std::vector< VkWriteDescriptorSet > WriteDescriptorSets )
 	{
 		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), (uint32_t)WriteDescriptorSets.size(), WriteDescriptorSets.data(), 0, nullptr );
+
+		Renderer::Get().GetStats().DescriptorWrites += ( uint32_t ) WriteDescriptorSets.size();
 	}
 
 	void DescriptorSet::Bind( VkCommandBuffer CommandBuffer, VkPipelineLayout PipelineLayout )
@@ -120,4 +125,80 @@ namespace Saturn {
 		
 		VK_CHECK( vkAllocateDescriptorSets( VulkanContext::Get().GetDevice(), &AllocateInfo, &m_Set ) );
 	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	DescriptorSetCache::DescriptorSetCache()
+	{
+		std::vector<VkDescriptorPoolSize> PoolSizes;
+
+		PoolSizes.push_back( { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4096 } );
+		PoolSizes.push_back( { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 4096 } );
+		PoolSizes.push_back( { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1024 } );
+		PoolSizes.push_back( { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 256 } );
+
+		m_Pool = Ref<DescriptorPool>::Create( PoolSizes, 1024 );
+	}
+
+	DescriptorSetCache::~DescriptorSetCache()
+	{
+		Terminate();
+	}
+
+	bool DescriptorSetCache::Acquire( size_t Hash, VkDescriptorSetLayout Layout, VkDescriptorSet& rSet )
+	{
+		auto Itr = m_Sets.find( Hash );
+
+		if( Itr != m_Sets.end() )
+		{
+			Itr->second.RefCount++;
+			rSet = Itr->second.Set;
+
+			Renderer::Get().GetStats().DescriptorSetCacheHits++;
+
+			return false;
+		}
+
+		VkDescriptorSetAllocateInfo AllocateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+		AllocateInfo.descriptorPool = m_Pool->GetVulkanPool();
+		AllocateInfo.descriptorSetCount = 1;
+		AllocateInfo.pSetLayouts = &Layout;
+
+		VK_CHECK( vkAllocateDescriptorSets( VulkanContext::Get().GetDevice(), &AllocateInfo, &rSet ) );
+
+		m_Sets[ Hash ] = { .Set = rSet, .RefCount = 1 };
+
+		Renderer::Get().GetStats().DescriptorSetAllocations++;
+
+		return true;
+	}
+
+	void DescriptorSetCache::Release( size_t Hash )
+	{
+		auto Itr = m_Sets.find( Hash );
+
+		if( Itr != m_Sets.end() && Itr->second.RefCount > 0 )
+			Itr->second.RefCount--;
+	}
+
+	void DescriptorSetCache::Collect()
+	{
+		for( auto Itr = m_Sets.begin(); Itr != m_Sets.end(); )
+		{
+			if( Itr->second.RefCount == 0 )
+			{
+				vkFreeDescriptorSets( VulkanContext::Get().GetDevice(), m_Pool->GetVulkanPool(), 1, &Itr->second.Set );
+				Itr = m_Sets.erase( Itr );
+			}
+			else
+				Itr++;
+		}
+	}
+
+	void DescriptorSetCache::Terminate()
+	{
+		// Destroying the pool frees all of the sets.
+		m_Sets.clear();
+		m_Pool = nullptr;
+	}
 }
\ No newline at end of file
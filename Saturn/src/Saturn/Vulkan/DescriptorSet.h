@@ -30,6 +30,7 @@
 
 #include <vulkan.h>
 #include <vector>
+#include <unordered_map>
 
 namespace Saturn {
 
@@ -148,4 +149,37 @@ namespace Saturn {
 		
 		DescriptorSetSpecification m_Specification = {};
 	};
+
+	// Persistent descriptor sets keyed by a hash of the layout and the resources written to them.
+	// Users that write the same resources into the same layout will share one set.
+	// Sets are never freed straight away, once their ref count hits zero they are freed in Collect() (called when the frame is no longer in flight).
+	class DescriptorSetCache : public RefTarget
+	{
+	public:
+		DescriptorSetCache();
+		~DescriptorSetCache();
+
+		// Returns true if the set was just allocated and the caller needs to write its descriptors.
+		bool Acquire( size_t Hash, VkDescriptorSetLayout Layout, VkDescriptorSet& rSet );
+		void Release( size_t Hash );
+
+		void Collect();
+		void Terminate();
+
+		// The last storage buffer that was written into the set, so shared sets only get re-written when the buffer changes.
+		VkBuffer& BoundStorageBuffer( size_t Hash ) { return m_Sets.at( Hash ).StorageBuffer; }
+
+		uint32_t GetLiveSetCount() const { return ( uint32_t ) m_Sets.size(); }
+
+	private:
+		struct CacheEntry
+		{
+			VkDescriptorSet Set = VK_NULL_HANDLE;
+			uint32_t RefCount = 0;
+			VkBuffer StorageBuffer = VK_NULL_HANDLE;
+		};
+
+		Ref<DescriptorPool> m_Pool = nullptr;
+		std::unordered_map<size_t, CacheEntry> m_Sets;
+	};
 }
\ No newline at end of file
@@ -178,13 +178,15 @@ namespace Saturn {
 					m_ColorAttachmentsResources.push_back( rImage );
 			}
 
+			VkImageView ImageView = m_Specification.Layered ? rImage->GetArrayImageView() : rImage->GetImageView( m_Specification.ExistingImageLayer );
+
 			if( m_AttachmentImageViews.size() )
 			{
-				m_AttachmentImageViews[ imageIndex ] = rImage->GetImageView( m_Specification.ExistingImageLayer );
+				m_AttachmentImageViews[ imageIndex ] = ImageView;
 			}
 			else 
 			{
-				m_AttachmentImageViews.push_back( rImage->GetImageView( m_Specification.ExistingImageLayer ) );
+				m_AttachmentImageViews.push_back( ImageView );
 			}
 		}
 
@@ -232,7 +234,7 @@ namespace Saturn {
 
 		FramebufferCreateInfo.width = m_Specification.Width;
 		FramebufferCreateInfo.height = m_Specification.Height;
-		FramebufferCreateInfo.layers = 1;
+		FramebufferCreateInfo.layers = m_Specification.Layered ? m_Specification.ArrayLevels : 1;
 
 		VK_CHECK( vkCreateFramebuffer( VulkanContext::Get().GetDevice(), &FramebufferCreateInfo, nullptr, &m_Framebuffer ) );
 	}
@@ -59,6 +59,9 @@ namespace Saturn {
 		uint32_t ArrayLevels = 1;
 		uint32_t ExistingImageLayer = 0;
 
+		// Attach every layer of the images, the vertex shader picks the layer with gl_Layer. ExistingImageLayer is ignored.
+		bool Layered = false;
+
 		VkSampleCountFlagBits MSAASamples = VK_SAMPLE_COUNT_1_BIT;
 
 		bool CreateDepth = true;
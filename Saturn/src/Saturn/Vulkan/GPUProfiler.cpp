@@ -0,0 +1,261 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "GPUProfiler.h"
+
+#include "VulkanContext.h"
+
+#include "Saturn/Core/StringAuxiliary.h"
+
+#include <fstream>
+
+namespace Saturn {
+
+	// Two queries per scope.
+	static constexpr uint32_t s_MaxQueriesPerFrame = 256;
+
+	GPUProfiler::GPUProfiler()
+	{
+		VkPhysicalDevice PhysicalDevice = VulkanContext::Get().GetPhysicalDevice();
+
+		VkPhysicalDeviceProperties Properties;
+		vkGetPhysicalDeviceProperties( PhysicalDevice, &Properties );
+
+		uint32_t QueueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties( PhysicalDevice, &QueueFamilyCount, nullptr );
+
+		std::vector<VkQueueFamilyProperties> QueueFamilies( QueueFamilyCount );
+		vkGetPhysicalDeviceQueueFamilyProperties( PhysicalDevice, &QueueFamilyCount, QueueFamilies.data() );
+
+		uint32_t ValidBits = QueueFamilies[ VulkanContext::Get().GetQueueFamilyIndices().GraphicsFamily.value() ].timestampValidBits;
+
+		m_Supported = ValidBits > 0 && Properties.limits.timestampPeriod > 0.0f;
+
+		if( !m_Supported )
+		{
+			SAT_CORE_WARN( "Timestamp queries are not supported on the graphics queue, GPU timings will be unavailable." );
+			return;
+		}
+
+		m_TimestampPeriod = Properties.limits.timestampPeriod;
+		m_TimestampMask = ValidBits >= 64 ? ~0ull : ( ( 1ull << ValidBits ) - 1 );
+
+		VkQueryPoolCreateInfo QueryPoolInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+		QueryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		QueryPoolInfo.queryCount = s_MaxQueriesPerFrame;
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+			VK_CHECK( vkCreateQueryPool( VulkanContext::Get().GetDevice(), &QueryPoolInfo, nullptr, &m_QueryPools[ i ] ) );
+	}
+
+	GPUProfiler::~GPUProfiler()
+	{
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			if( m_QueryPools[ i ] )
+				vkDestroyQueryPool( VulkanContext::Get().GetDevice(), m_QueryPools[ i ], nullptr );
+		}
+	}
+
+	void GPUProfiler::BeginFrame( VkCommandBuffer CommandBuffer, uint32_t Frame )
+	{
+		if( !m_Supported )
+			return;
+
+		ReadResults( Frame );
+
+		m_CommandBuffer = CommandBuffer;
+		m_CurrentFrame = Frame;
+
+		m_QueryCounts[ Frame ] = 0;
+		m_PendingScopes[ Frame ].clear();
+		m_ScopeStack.clear();
+
+		vkCmdResetQueryPool( CommandBuffer, m_QueryPools[ Frame ], 0, s_MaxQueriesPerFrame );
+	}
+
+	void GPUProfiler::BeginScope( VkCommandBuffer CommandBuffer, const std::string& rName )
+	{
+		// Only the frame command buffer is profiled.
+		if( !m_Supported || CommandBuffer != m_CommandBuffer )
+			return;
+
+		uint32_t& rQueryCount = m_QueryCounts[ m_CurrentFrame ];
+
+		if( rQueryCount + 2 > s_MaxQueriesPerFrame )
+		{
+			m_ScopeStack.push_back( UINT32_MAX );
+			return;
+		}
+
+		auto& rScopes = m_PendingScopes[ m_CurrentFrame ];
+
+		PendingScope& rScope = rScopes.emplace_back();
+		rScope.Name = rName;
+		rScope.Depth = ( uint32_t ) m_ScopeStack.size();
+		rScope.BeginQuery = rQueryCount++;
+		rScope.EndQuery = UINT32_MAX;
+
+		m_ScopeStack.push_back( ( uint32_t ) rScopes.size() - 1 );
+
+		vkCmdWriteTimestamp( CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_QueryPools[ m_CurrentFrame ], rScope.BeginQuery );
+	}
+
+	void GPUProfiler::EndScope( VkCommandBuffer CommandBuffer )
+	{
+		if( !m_Supported || CommandBuffer != m_CommandBuffer || m_ScopeStack.empty() )
+			return;
+
+		uint32_t Index = m_ScopeStack.back();
+		m_ScopeStack.pop_back();
+
+		if( Index == UINT32_MAX )
+			return;
+
+		PendingScope& rScope = m_PendingScopes[ m_CurrentFrame ][ Index ];
+		rScope.EndQuery = m_QueryCounts[ m_CurrentFrame ]++;
+
+		vkCmdWriteTimestamp( CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_QueryPools[ m_CurrentFrame ], rScope.EndQuery );
+	}
+
+	void GPUProfiler::ReadResults( uint32_t Frame )
+	{
+		uint32_t QueryCount = m_QueryCounts[ Frame ];
+
+		if( QueryCount == 0 )
+			return;
+
+		std::vector<uint64_t> Timestamps( QueryCount );
+
+		// The fence for this frame has been waited on, so every query should be available.
+		VkResult Result = vkGetQueryPoolResults( VulkanContext::Get().GetDevice(), m_QueryPools[ Frame ], 0, QueryCount,
+			Timestamps.size() * sizeof( uint64_t ), Timestamps.data(), sizeof( uint64_t ), VK_QUERY_RESULT_64_BIT );
+
+		if( Result != VK_SUCCESS )
+			return;
+
+		m_Results.clear();
+
+		uint64_t FrameBegin = UINT64_MAX;
+		uint64_t FrameEnd = 0;
+
+		for( const PendingScope& rScope : m_PendingScopes[ Frame ] )
+		{
+			// Scope was never closed.
+			if( rScope.EndQuery == UINT32_MAX )
+				continue;
+
+			uint64_t Begin = Timestamps[ rScope.BeginQuery ] & m_TimestampMask;
+			uint64_t End = Timestamps[ rScope.EndQuery ] & m_TimestampMask;
+
+			FrameBegin = std::min( FrameBegin, Begin );
+			FrameEnd = std::max( FrameEnd, End );
+
+			GPUProfilerScope& rResult = m_Results.emplace_back();
+			rResult.Name = rScope.Name;
+			rResult.Depth = rScope.Depth;
+			rResult.Milliseconds = End > Begin ? ( float ) ( ( double ) ( End - Begin ) * m_TimestampPeriod / 1000000.0 ) : 0.0f;
+		}
+
+		m_FrameTime = FrameEnd > FrameBegin ? ( float ) ( ( double ) ( FrameEnd - FrameBegin ) * m_TimestampPeriod / 1000000.0 ) : 0.0f;
+
+		if( m_CaptureFramesLeft )
+		{
+			m_CapturedFrames.push_back( m_Results );
+			m_CaptureFramesLeft--;
+		}
+	}
+
+	void GPUProfiler::StartCapture( uint32_t FrameCount )
+	{
+		m_CapturedFrames.clear();
+		m_CaptureFramesLeft = FrameCount;
+	}
+
+	bool GPUProfiler::SaveCapture( const std::filesystem::path& rPath ) const
+	{
+		if( rPath.extension() == ".csv" )
+			return SaveCaptureCSV( rPath );
+
+		return SaveCaptureJSON( rPath );
+	}
+
+	bool GPUProfiler::SaveCaptureCSV( const std::filesystem::path& rPath ) const
+	{
+		std::ofstream Stream( rPath );
+
+		if( !Stream )
+		{
+			SAT_CORE_WARN( "Failed to open GPU capture file: {0}", rPath.string() );
+			return false;
+		}
+
+		Stream << "frame,scope,depth,ms\n";
+
+		for( size_t i = 0; i < m_CapturedFrames.size(); i++ )
+		{
+			for( const GPUProfilerScope& rScope : m_CapturedFrames[ i ] )
+				Stream << i << ",\"" << rScope.Name << "\"," << rScope.Depth << "," << rScope.Milliseconds << "\n";
+		}
+
+		return true;
+	}
+
+	bool GPUProfiler::SaveCaptureJSON( const std::filesystem::path& rPath ) const
+	{
+		std::ofstream Stream( rPath );
+
+		if( !Stream )
+		{
+			SAT_CORE_WARN( "Failed to open GPU capture file: {0}", rPath.string() );
+			return false;
+		}
+
+		Stream << "{\n\t\"frames\": [\n";
+
+		for( size_t i = 0; i < m_CapturedFrames.size(); i++ )
+		{
+			Stream << "\t\t{ \"frame\": " << i << ", \"scopes\": [\n";
+
+			const auto& rScopes = m_CapturedFrames[ i ];
+
+			for( size_t j = 0; j < rScopes.size(); j++ )
+			{
+				Stream << "\t\t\t{ \"name\": \"" << Auxiliary::EscapeJson( rScopes[ j ].Name ) << "\", \"depth\": " << rScopes[ j ].Depth << ", \"ms\": " << rScopes[ j ].Milliseconds << " }";
+				Stream << ( j + 1 < rScopes.size() ? ",\n" : "\n" );
+			}
+
+			Stream << "\t\t] }" << ( i + 1 < m_CapturedFrames.size() ? ",\n" : "\n" );
+		}
+
+		Stream << "\t]\n}\n";
+
+		return true;
+	}
+}
@@ -0,0 +1,113 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include <vulkan.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Saturn {
+
+	struct GPUProfilerScope
+	{
+		std::string Name;
+		uint32_t Depth = 0;
+		float Milliseconds = 0.0f;
+	};
+
+	// GPU timings for the frame command buffer, using timestamp queries.
+	// Every CmdBeginDebugLabel/CmdEndDebugLabel pair that is recorded into the frame command buffer becomes a scope.
+	// Results are read back when the frame in flight comes around again, so they are MAX_FRAMES_IN_FLIGHT frames old.
+	class GPUProfiler
+	{
+	public:
+		GPUProfiler();
+		~GPUProfiler();
+
+		// Called from Renderer::BeginFrame once the fence for "Frame" has been waited on.
+		void BeginFrame( VkCommandBuffer CommandBuffer, uint32_t Frame );
+
+		void BeginScope( VkCommandBuffer CommandBuffer, const std::string& rName );
+		void EndScope( VkCommandBuffer CommandBuffer );
+
+		// Scopes of the latest frame that was read back, in the order they were recorded.
+		const std::vector<GPUProfilerScope>& GetResults() const { return m_Results; }
+		float GetFrameTime() const { return m_FrameTime; }
+
+		bool IsSupported() const { return m_Supported; }
+
+		// Records the results of the next "FrameCount" frames.
+		void StartCapture( uint32_t FrameCount );
+		bool IsCapturing() const { return m_CaptureFramesLeft > 0; }
+		uint32_t GetCapturedFrameCount() const { return ( uint32_t ) m_CapturedFrames.size(); }
+
+		// Writes the capture as CSV if the extension is ".csv", otherwise JSON.
+		bool SaveCapture( const std::filesystem::path& rPath ) const;
+
+	private:
+		void ReadResults( uint32_t Frame );
+
+		bool SaveCaptureCSV( const std::filesystem::path& rPath ) const;
+		bool SaveCaptureJSON( const std::filesystem::path& rPath ) const;
+
+	private:
+		struct PendingScope
+		{
+			std::string Name;
+			uint32_t Depth = 0;
+			uint32_t BeginQuery = 0;
+			uint32_t EndQuery = 0;
+		};
+
+		bool m_Supported = false;
+
+		// Nanoseconds per tick.
+		float m_TimestampPeriod = 1.0f;
+		uint64_t m_TimestampMask = ~0ull;
+
+		VkQueryPool m_QueryPools[ MAX_FRAMES_IN_FLIGHT ] = {};
+		uint32_t m_QueryCounts[ MAX_FRAMES_IN_FLIGHT ] = {};
+		std::vector<PendingScope> m_PendingScopes[ MAX_FRAMES_IN_FLIGHT ];
+
+		// Indices into m_PendingScopes of the scopes that are still open.
+		std::vector<uint32_t> m_ScopeStack;
+
+		VkCommandBuffer m_CommandBuffer = VK_NULL_HANDLE;
+		uint32_t m_CurrentFrame = 0;
+
+		std::vector<GPUProfilerScope> m_Results;
+		float m_FrameTime = 0.0f;
+
+		uint32_t m_CaptureFramesLeft = 0;
+		std::vector<std::vector<GPUProfilerScope>> m_CapturedFrames;
+	};
+}
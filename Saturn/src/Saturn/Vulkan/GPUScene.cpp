@@ -0,0 +1,383 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "GPUScene.h"
+
+#include "VulkanContext.h"
+#include "Renderer.h"
+
+namespace Saturn {
+
+	static constexpr uint32_t s_DefaultSlotCapacity = 1024 * 10;
+	static constexpr uint32_t s_MinBucketCapacity = 4;
+	static constexpr uint32_t s_ScatterGroupSize = 64;
+	static constexpr uint64_t s_StaticFrameCount = 60;
+
+	static TransformBufferData ToTransformBufferData( const glm::mat4& rTransform )
+	{
+		TransformBufferData Data;
+		Data.TransfromBufferR[ 0 ] = { rTransform[ 0 ][ 0 ], rTransform[ 1 ][ 0 ], rTransform[ 2 ][ 0 ], rTransform[ 3 ][ 0 ] };
+		Data.TransfromBufferR[ 1 ] = { rTransform[ 0 ][ 1 ], rTransform[ 1 ][ 1 ], rTransform[ 2 ][ 1 ], rTransform[ 3 ][ 1 ] };
+		Data.TransfromBufferR[ 2 ] = { rTransform[ 0 ][ 2 ], rTransform[ 1 ][ 2 ], rTransform[ 2 ][ 2 ], rTransform[ 3 ][ 2 ] };
+		Data.TransfromBufferR[ 3 ] = { rTransform[ 0 ][ 3 ], rTransform[ 1 ][ 3 ], rTransform[ 2 ][ 3 ], rTransform[ 3 ][ 3 ] };
+
+		return Data;
+	}
+
+	GPUScene::GPUScene()
+	{
+		m_ScatterShader = ShaderLibrary::Get().FindOrLoad( "InstanceScatter", "content/shaders/InstanceScatter.glsl" );
+		m_ScatterPipeline = Ref<ComputePipeline>::Create( m_ScatterShader );
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			m_DeltaBuffers[ i ] = Ref<StorageBuffer>::Create( 0, 1, VMA_MEMORY_USAGE_CPU_TO_GPU );
+			m_DescriptorSets[ i ] = m_ScatterShader->CreateDescriptorSet( 0 );
+		}
+
+		GrowInstanceBuffer( s_DefaultSlotCapacity );
+	}
+
+	GPUScene::~GPUScene()
+	{
+		m_Buckets.clear();
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			m_RetiredBuffers[ i ].clear();
+			m_DeltaBuffers[ i ] = nullptr;
+			m_DescriptorSets[ i ] = nullptr;
+		}
+
+		m_InstanceBuffer = nullptr;
+		m_ScatterPipeline = nullptr;
+		m_ScatterShader = nullptr;
+	}
+
+	void GPUScene::Submit( const StaticMeshKey& rKey, UUID EntityID, const glm::mat4& rTransform )
+	{
+		InstanceBucket& rBucket = m_Buckets.try_emplace( rKey ).first->second;
+		rBucket.LastSubmittedFrame = m_FrameCounter;
+
+		TransformBufferData Data = ToTransformBufferData( rTransform );
+
+		auto Itr = rBucket.Slots.find( EntityID );
+
+		if( Itr == rBucket.Slots.end() )
+		{
+			uint32_t Slot = ( uint32_t ) rBucket.Entities.size();
+
+			rBucket.Slots[ EntityID ] = Slot;
+			rBucket.Entities.push_back( EntityID );
+			rBucket.Transforms.push_back( Data );
+			rBucket.LastSubmitted.push_back( m_FrameCounter );
+			rBucket.DirtySlots.push_back( Slot );
+			rBucket.LastChangedFrame = m_FrameCounter;
+
+			return;
+		}
+
+		uint32_t Slot = Itr->second;
+		rBucket.LastSubmitted[ Slot ] = m_FrameCounter;
+
+		// Static geometry ends here, nothing to upload.
+		if( memcmp( &rBucket.Transforms[ Slot ], &Data, sizeof( TransformBufferData ) ) == 0 )
+			return;
+
+		rBucket.Transforms[ Slot ] = Data;
+		rBucket.DirtySlots.push_back( Slot );
+		rBucket.LastChangedFrame = m_FrameCounter;
+	}
+
+	void GPUScene::Update( VkCommandBuffer CommandBuffer )
+	{
+		SAT_PF_EVENT();
+
+		uint32_t frame = Renderer::Get().GetCurrentFrame();
+
+		// We have waited for this frame's fence, nothing can read these anymore.
+		m_RetiredBuffers[ frame ].clear();
+
+		m_InstanceCount = 0;
+		m_DirtyCount = 0;
+		m_UploadSize = 0;
+
+		//////////////////////////////////////////////////////////////////////////
+		// Remove what was not submitted and make sure every bucket has enough slots.
+
+		for( auto Itr = m_Buckets.begin(); Itr != m_Buckets.end(); )
+		{
+			InstanceBucket& rBucket = Itr->second;
+
+			if( rBucket.LastSubmittedFrame != m_FrameCounter )
+			{
+				if( rBucket.Capacity )
+					FreeSlots( rBucket.Offset, rBucket.Capacity );
+
+				if( rBucket.Static )
+					m_StaticVersion++;
+
+				Itr = m_Buckets.erase( Itr );
+				continue;
+			}
+
+			// The last instance takes the slot of a removed instance, so only one transform has to be written.
+			for( uint32_t i = 0; i < rBucket.Entities.size(); )
+			{
+				if( rBucket.LastSubmitted[ i ] == m_FrameCounter )
+				{
+					i++;
+					continue;
+				}
+
+				uint32_t Last = ( uint32_t ) rBucket.Entities.size() - 1;
+
+				rBucket.Slots.erase( rBucket.Entities[ i ] );
+
+				if( i != Last )
+				{
+					rBucket.Entities[ i ] = rBucket.Entities[ Last ];
+					rBucket.Transforms[ i ] = rBucket.Transforms[ Last ];
+					rBucket.LastSubmitted[ i ] = rBucket.LastSubmitted[ Last ];
+
+					rBucket.Slots[ rBucket.Entities[ i ] ] = i;
+					rBucket.DirtySlots.push_back( i );
+				}
+
+				rBucket.Entities.pop_back();
+				rBucket.Transforms.pop_back();
+				rBucket.LastSubmitted.pop_back();
+
+				rBucket.LastChangedFrame = m_FrameCounter;
+			}
+
+			bool Static = m_FrameCounter - rBucket.LastChangedFrame >= s_StaticFrameCount;
+
+			if( Static != rBucket.Static )
+			{
+				rBucket.Static = Static;
+				m_StaticVersion++;
+			}
+
+			uint32_t Count = ( uint32_t ) rBucket.Entities.size();
+
+			if( Count > rBucket.Capacity )
+			{
+				if( rBucket.Capacity )
+					FreeSlots( rBucket.Offset, rBucket.Capacity );
+
+				rBucket.Capacity = std::max( { Count, rBucket.Capacity * 2, s_MinBucketCapacity } );
+				rBucket.Offset = AllocateSlots( rBucket.Capacity );
+				rBucket.Moved = true;
+			}
+
+			m_InstanceCount += Count;
+
+			Itr++;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Build the delta list.
+
+		m_Deltas.clear();
+
+		for( auto& [key, rBucket] : m_Buckets )
+		{
+			uint32_t Count = ( uint32_t ) rBucket.Entities.size();
+
+			if( rBucket.Moved || m_InstanceBufferLost )
+			{
+				for( uint32_t i = 0; i < Count; i++ )
+					m_Deltas.push_back( { rBucket.Transforms[ i ], rBucket.Offset + i } );
+			}
+			else
+			{
+				// Slots past the end were removed this frame.
+				for( uint32_t Slot : rBucket.DirtySlots )
+				{
+					if( Slot < Count )
+						m_Deltas.push_back( { rBucket.Transforms[ Slot ], rBucket.Offset + Slot } );
+				}
+			}
+
+			rBucket.DirtySlots.clear();
+			rBucket.Moved = false;
+		}
+
+		m_InstanceBufferLost = false;
+		m_FrameCounter++;
+
+		m_DirtyCount = ( uint32_t ) m_Deltas.size();
+
+		if( m_Deltas.empty() )
+			return;
+
+		//////////////////////////////////////////////////////////////////////////
+		// Upload & scatter
+
+		m_UploadSize = m_Deltas.size() * sizeof( InstanceDelta );
+
+		auto& rDeltaBuffer = m_DeltaBuffers[ frame ];
+
+		if( rDeltaBuffer->GetSize() < m_UploadSize )
+			rDeltaBuffer->Resize( ( uint32_t ) std::max( m_UploadSize, rDeltaBuffer->GetSize() * 2 ) );
+
+		rDeltaBuffer->SetData( m_Deltas.data(), m_UploadSize );
+
+		VkDescriptorBufferInfo InstanceBufferInfo = {};
+		InstanceBufferInfo.buffer = m_InstanceBuffer->GetBuffer();
+		InstanceBufferInfo.range = VK_WHOLE_SIZE;
+
+		Ref<DescriptorSet>& rDescriptorSet = m_DescriptorSets[ frame ];
+
+		m_ScatterShader->WriteSB( 0, 0, InstanceBufferInfo, rDescriptorSet );
+		m_ScatterShader->WriteSB( 0, 1, rDeltaBuffer->GetBufferInfo(), rDescriptorSet );
+
+		// Frames that are still in flight could be reading the slots we are about to write.
+		VkMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr );
+
+		uint32_t DeltaCount = m_DirtyCount;
+
+		m_ScatterPipeline->BindWithCommandBuffer( CommandBuffer );
+
+		m_ScatterPipeline->AddPushConstant( &DeltaCount, 0, sizeof( uint32_t ) );
+
+		m_ScatterPipeline->Execute( rDescriptorSet->GetVulkanSet(), ( DeltaCount + s_ScatterGroupSize - 1 ) / s_ScatterGroupSize, 1, 1 );
+
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr );
+
+		m_ScatterPipeline->Unbind();
+	}
+
+	uint32_t GPUScene::GetInstanceOffset( const StaticMeshKey& rKey ) const
+	{
+		auto Itr = m_Buckets.find( rKey );
+
+		if( Itr == m_Buckets.end() )
+			return 0;
+
+		return Itr->second.Offset * sizeof( TransformBufferData );
+	}
+
+	bool GPUScene::IsStatic( const StaticMeshKey& rKey ) const
+	{
+		auto Itr = m_Buckets.find( rKey );
+
+		return Itr != m_Buckets.end() && Itr->second.Static;
+	}
+
+	uint32_t GPUScene::AllocateSlots( uint32_t Count )
+	{
+		// First fit.
+		for( auto Itr = m_FreeRanges.begin(); Itr != m_FreeRanges.end(); Itr++ )
+		{
+			if( Itr->Count < Count )
+				continue;
+
+			uint32_t Offset = Itr->Offset;
+
+			Itr->Offset += Count;
+			Itr->Count -= Count;
+
+			if( Itr->Count == 0 )
+				m_FreeRanges.erase( Itr );
+
+			return Offset;
+		}
+
+		uint32_t Offset = m_SlotTop;
+		m_SlotTop += Count;
+
+		if( m_SlotTop > m_SlotCapacity )
+			GrowInstanceBuffer( m_SlotTop );
+
+		return Offset;
+	}
+
+	void GPUScene::FreeSlots( uint32_t Offset, uint32_t Count )
+	{
+		// Keep the free list sorted so neighbours can be merged.
+		auto Itr = std::lower_bound( m_FreeRanges.begin(), m_FreeRanges.end(), Offset, []( const SlotRange& rRange, uint32_t Value ) { return rRange.Offset < Value; } );
+		Itr = m_FreeRanges.insert( Itr, { Offset, Count } );
+
+		if( Itr + 1 != m_FreeRanges.end() && Itr->Offset + Itr->Count == ( Itr + 1 )->Offset )
+		{
+			Itr->Count += ( Itr + 1 )->Count;
+			m_FreeRanges.erase( Itr + 1 );
+		}
+
+		if( Itr != m_FreeRanges.begin() && ( Itr - 1 )->Offset + ( Itr - 1 )->Count == Itr->Offset )
+		{
+			( Itr - 1 )->Count += Itr->Count;
+			Itr = m_FreeRanges.erase( Itr ) - 1;
+		}
+
+		// Give the last range back to the top.
+		if( Itr->Offset + Itr->Count == m_SlotTop )
+		{
+			m_SlotTop = Itr->Offset;
+			m_FreeRanges.erase( Itr );
+		}
+	}
+
+	void GPUScene::GrowInstanceBuffer( uint32_t RequiredSlots )
+	{
+		uint32_t frame = Renderer::Get().GetCurrentFrame();
+
+		m_SlotCapacity = std::max( RequiredSlots, m_SlotCapacity * 2 );
+
+		if( m_InstanceBuffer )
+			m_RetiredBuffers[ frame ].push_back( m_InstanceBuffer );
+
+		m_InstanceBuffer = Ref<VertexBuffer>::Create( m_SlotCapacity * sizeof( TransformBufferData ), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY );
+
+		// Rare, so just write every instance again rather than copying the old buffer.
+		m_InstanceBufferLost = true;
+	}
+}
@@ -0,0 +1,197 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+#include "Saturn/Core/UUID.h"
+#include "Saturn/Asset/Asset.h"
+#include "Saturn/Asset/MaterialAsset.h"
+
+#include "VertexBuffer.h"
+#include "StorageBuffer.h"
+#include "ComputePipeline.h"
+#include "DescriptorSet.h"
+
+#include <glm/glm.hpp>
+#include <vulkan.h>
+#include <unordered_map>
+#include <vector>
+
+namespace Saturn {
+
+	struct StaticMeshKey
+	{
+		AssetID MeshID;
+		Ref<MaterialRegistry> Registry;
+
+		uint32_t SubmeshIndex;
+
+		// Instances of different LODs are different draws.
+		uint32_t Lod;
+
+		StaticMeshKey( AssetID meshID, Ref<MaterialRegistry> materialReg, uint32_t submeshIndex, uint32_t lod = 0 ) : MeshID( meshID ), SubmeshIndex( submeshIndex ), Lod( lod ) { Registry = materialReg; }
+
+		bool operator==( const StaticMeshKey& rKey )
+		{
+			return ( MeshID == rKey.MeshID && Registry == rKey.Registry && SubmeshIndex == rKey.SubmeshIndex && Lod == rKey.Lod );
+		}
+
+		bool operator==( const StaticMeshKey& rKey ) const
+		{
+			return ( MeshID == rKey.MeshID && Registry == rKey.Registry && SubmeshIndex == rKey.SubmeshIndex && Lod == rKey.Lod );
+		}
+	};
+
+	// Data that gets sent to the vertex shader
+	struct TransformBufferData
+	{
+		glm::vec4 TransfromBufferR[ 4 ];
+	};
+
+	// Must match "InstanceDelta" in InstanceScatter.glsl (std430).
+	struct InstanceDelta
+	{
+		TransformBufferData Transform;
+		uint32_t Slot = 0;
+		uint32_t Padding[ 3 ] = {};
+	};
+}
+
+namespace std {
+
+	template<>
+	struct hash< Saturn::StaticMeshKey >
+	{
+		size_t operator()( const Saturn::StaticMeshKey& rKey ) const
+		{
+			return rKey.Registry->GetID() ^ rKey.MeshID ^ rKey.SubmeshIndex ^ ( ( size_t ) rKey.Lod << 32 );
+		}
+	};
+}
+
+namespace Saturn {
+
+	// Persistent, GPU resident instance transforms for static meshes.
+	// Every StaticMeshKey owns a contiguous range of slots so it can still be drawn with one instanced draw, an entity keeps its slot for as long as it is submitted.
+	// Only transforms that changed since they were last written are uploaded, "InstanceScatter" then copies them into the instance buffer.
+	class GPUScene : public RefTarget
+	{
+	public:
+		GPUScene();
+		~GPUScene();
+
+		void Submit( const StaticMeshKey& rKey, UUID EntityID, const glm::mat4& rTransform );
+
+		// Assigns slots for this frame's submissions, uploads the dirty transforms and records the scatter.
+		// Must be called outside of a render pass and before any draw that reads the instance buffer.
+		void Update( VkCommandBuffer CommandBuffer );
+
+		Ref<VertexBuffer> GetInstanceBuffer() { return m_InstanceBuffer; }
+
+		// Byte offset of the first instance of "rKey" in the instance buffer.
+		uint32_t GetInstanceOffset( const StaticMeshKey& rKey ) const;
+
+		// A key is static once none of its instances were added, removed or moved for a while, static shadow casters are cached.
+		bool IsStatic( const StaticMeshKey& rKey ) const;
+
+		// Changes whenever a key becomes static or stops being static.
+		uint64_t GetStaticVersion() const { return m_StaticVersion; }
+
+		uint32_t GetInstanceCount() const { return m_InstanceCount; }
+		uint32_t GetSlotCapacity() const { return m_SlotCapacity; }
+		uint32_t GetDirtyCount() const { return m_DirtyCount; }
+		size_t GetUploadSize() const { return m_UploadSize; }
+
+	private:
+		struct InstanceBucket
+		{
+			// Range of slots owned by this key.
+			uint32_t Offset = 0;
+			uint32_t Capacity = 0;
+
+			// Local slot -> entity and the transform the GPU has for it.
+			std::vector<UUID> Entities;
+			std::vector<TransformBufferData> Transforms;
+			std::vector<uint64_t> LastSubmitted;
+			std::unordered_map<UUID, uint32_t> Slots;
+
+			std::vector<uint32_t> DirtySlots;
+
+			uint64_t LastSubmittedFrame = 0;
+			uint64_t LastChangedFrame = 0;
+
+			bool Static = false;
+
+			// The range moved, every instance has to be written again.
+			bool Moved = false;
+		};
+
+		struct SlotRange
+		{
+			uint32_t Offset = 0;
+			uint32_t Count = 0;
+		};
+
+		uint32_t AllocateSlots( uint32_t Count );
+		void FreeSlots( uint32_t Offset, uint32_t Count );
+		void GrowInstanceBuffer( uint32_t RequiredSlots );
+
+	private:
+		std::unordered_map<StaticMeshKey, InstanceBucket> m_Buckets;
+
+		std::vector<SlotRange> m_FreeRanges;
+		uint32_t m_SlotTop = 0;
+		uint32_t m_SlotCapacity = 0;
+
+		// Incremented after every update, used to find entities that were not submitted.
+		uint64_t m_FrameCounter = 1;
+
+		uint64_t m_StaticVersion = 0;
+
+		// Set when the instance buffer was re-created, nothing has been written to the new one.
+		bool m_InstanceBufferLost = false;
+
+		Ref<VertexBuffer> m_InstanceBuffer = nullptr;
+
+		// Old instance buffers can still be read by frames in flight.
+		std::vector<Ref<VertexBuffer>> m_RetiredBuffers[ MAX_FRAMES_IN_FLIGHT ];
+
+		std::vector<InstanceDelta> m_Deltas;
+		Ref<StorageBuffer> m_DeltaBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref<DescriptorSet> m_DescriptorSets[ MAX_FRAMES_IN_FLIGHT ];
+
+		Ref<Shader> m_ScatterShader = nullptr;
+		Ref<ComputePipeline> m_ScatterPipeline = nullptr;
+
+		// Stats
+		uint32_t m_InstanceCount = 0;
+		uint32_t m_DirtyCount = 0;
+		size_t m_UploadSize = 0;
+	};
+}
@@ -0,0 +1,396 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "HiZPyramid.h"
+
+#include "VulkanContext.h"
+#include "VulkanImageAux.h"
+#include "VulkanDebug.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "SamplerCache.h"
+
+namespace Saturn {
+
+	// Levels at or below this size are read back, 256x256 floats is 256KB.
+	static constexpr uint32_t s_ReadbackMaxSize = 256;
+	static constexpr uint32_t s_GroupSize = 8;
+
+	struct HiZPushConstants
+	{
+		glm::ivec2 SourceSize;
+		glm::ivec2 DestSize;
+
+		uint32_t FromDepth;
+		uint32_t ReadbackOffset;
+	};
+
+	HiZPyramid::HiZPyramid()
+	{
+		m_Shader = ShaderLibrary::Get().FindOrLoad( "HiZBuild", "content/shaders/HiZBuild.glsl" );
+		m_Pipeline = Ref<ComputePipeline>::Create( m_Shader );
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+			m_ReadbackBuffers[ i ] = Ref<StorageBuffer>::Create( 0, 3, VMA_MEMORY_USAGE_GPU_TO_CPU );
+
+		// Depth is only ever fetched.
+		VkSamplerCreateInfo SamplerCreateInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+		SamplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+		SamplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+		SamplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		SamplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		SamplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		SamplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		SamplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+		m_DepthSampler = VulkanContext::Get().GetSamplerCache()->Acquire( SamplerCreateInfo );
+	}
+
+	HiZPyramid::~HiZPyramid()
+	{
+		Terminate();
+
+		if( SamplerCache* pSamplerCache = VulkanContext::Get().GetSamplerCache() )
+			pSamplerCache->Release( m_DepthSampler );
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+			m_ReadbackBuffers[ i ] = nullptr;
+
+		m_Pipeline = nullptr;
+		m_Shader = nullptr;
+	}
+
+	void HiZPyramid::Terminate()
+	{
+		VkDevice LogicalDevice = VulkanContext::Get().GetDevice();
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			m_DescriptorSets[ i ].clear();
+			m_Built[ i ] = false;
+		}
+
+		for( Level& rLevel : m_Levels )
+			vkDestroyImageView( LogicalDevice, rLevel.ImageView, nullptr );
+
+		m_Levels.clear();
+
+		if( m_ImageView )
+			vkDestroyImageView( LogicalDevice, m_ImageView, nullptr );
+
+		if( m_Image )
+			vkDestroyImage( LogicalDevice, m_Image, nullptr );
+
+		if( m_ImageMemory )
+			vkFreeMemory( LogicalDevice, m_ImageMemory, nullptr );
+
+		m_Image = VK_NULL_HANDLE;
+		m_ImageMemory = VK_NULL_HANDLE;
+		m_ImageView = VK_NULL_HANDLE;
+
+		m_HasReadback = false;
+	}
+
+	void HiZPyramid::Resize( uint32_t Width, uint32_t Height, Ref<Image2D> DepthImage )
+	{
+		Terminate();
+
+		m_Width = Width;
+		m_Height = Height;
+
+		if( Width == 0 || Height == 0 )
+			return;
+
+		// Every level is half of the one above, rounded up so the edges are never lost.
+		uint32_t LevelWidth = Width;
+		uint32_t LevelHeight = Height;
+
+		do
+		{
+			LevelWidth = ( LevelWidth + 1 ) / 2;
+			LevelHeight = ( LevelHeight + 1 ) / 2;
+
+			m_Levels.push_back( { .Width = LevelWidth, .Height = LevelHeight } );
+
+		} while( LevelWidth > 1 || LevelHeight > 1 );
+
+		m_ReadbackMip = 0;
+		m_ReadbackTexels = 0;
+
+		while( m_Levels[ m_ReadbackMip ].Width > s_ReadbackMaxSize || m_Levels[ m_ReadbackMip ].Height > s_ReadbackMaxSize )
+			m_ReadbackMip++;
+
+		for( uint32_t i = m_ReadbackMip; i < m_Levels.size(); i++ )
+		{
+			m_Levels[ i ].ReadbackOffset = m_ReadbackTexels;
+			m_ReadbackTexels += m_Levels[ i ].Width * m_Levels[ i ].Height;
+		}
+
+		m_Readback.resize( m_ReadbackTexels );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Image
+
+		const uint32_t MipCount = ( uint32_t ) m_Levels.size();
+
+		CreateImage( m_Levels[ 0 ].Width, m_Levels[ 0 ].Height, VK_FORMAT_R32_SFLOAT, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL, 
+			VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Image, m_ImageMemory, MipCount, 1 );
+
+		SetDebugUtilsObjectName( "HiZ Pyramid", ( uint64_t ) m_Image, VK_OBJECT_TYPE_IMAGE );
+
+		for( uint32_t i = 0; i < MipCount; i++ )
+		{
+			VkImageSubresourceRange Range = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .baseMipLevel = i, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1 };
+
+			m_Levels[ i ].ImageView = CreateImageView( Range, m_Image, VK_FORMAT_R32_SFLOAT );
+		}
+
+		VkImageSubresourceRange FullRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .baseMipLevel = 0, .levelCount = MipCount, .baseArrayLayer = 0, .layerCount = 1 };
+
+		m_ImageView = CreateImageView( FullRange, m_Image, VK_FORMAT_R32_SFLOAT );
+
+		// The pyramid stays in the general layout, it is only ever read and written by compute.
+		VkCommandBuffer CommandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
+
+		TransitionImageLayout( CommandBuffer, m_Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, FullRange, 
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT );
+
+		VulkanContext::Get().EndSingleTimeCommands( CommandBuffer );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Descriptor sets
+
+		VkDescriptorImageInfo DepthInfo = {};
+		DepthInfo.imageView = DepthImage->GetImageView();
+		DepthInfo.sampler = m_DepthSampler;
+		DepthInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+		for( uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++ )
+		{
+			m_ReadbackBuffers[ frame ]->Resize( m_ReadbackTexels * sizeof( float ) );
+
+			for( uint32_t i = 0; i < MipCount; i++ )
+			{
+				Ref<DescriptorSet> Set = m_Shader->CreateDescriptorSet( 0 );
+
+				// Level 0 reads from depth, but the source still has to point to something.
+				VkDescriptorImageInfo SourceInfo = {};
+				SourceInfo.imageView = m_Levels[ i == 0 ? 0 : i - 1 ].ImageView;
+				SourceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+				VkDescriptorImageInfo DestInfo = {};
+				DestInfo.imageView = m_Levels[ i ].ImageView;
+				DestInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+				m_Shader->WriteDescriptor( "u_Depth", DepthInfo, Set->GetVulkanSet() );
+				m_Shader->WriteDescriptor( "u_Source", SourceInfo, Set->GetVulkanSet() );
+				m_Shader->WriteDescriptor( "o_HiZ", DestInfo, Set->GetVulkanSet() );
+				m_Shader->WriteSB( 0, 3, m_ReadbackBuffers[ frame ]->GetBufferInfo(), Set );
+
+				m_DescriptorSets[ frame ].push_back( Set );
+			}
+		}
+	}
+
+	VkDescriptorImageInfo HiZPyramid::GetDescriptorInfo() const
+	{
+		VkDescriptorImageInfo Info = {};
+		Info.imageView = m_ImageView;
+		Info.sampler = m_DepthSampler;
+		Info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		return Info;
+	}
+
+	void HiZPyramid::BeginFrame( uint32_t Frame )
+	{
+		SAT_PF_EVENT();
+
+		// The previous frame is the best match for this frame's camera, Renderer::EndFrame normally waits for it.
+		// Otherwise this frame's buffer is from MAX_FRAMES_IN_FLIGHT frames ago and we have already waited for its fence.
+		uint32_t PreviousFrame = ( Frame + MAX_FRAMES_IN_FLIGHT - 1 ) % MAX_FRAMES_IN_FLIGHT;
+		uint32_t Source = UINT32_MAX;
+
+		if( m_Built[ PreviousFrame ] && Renderer::Get().IsFrameComplete( PreviousFrame ) )
+			Source = PreviousFrame;
+		else if( m_Built[ Frame ] )
+			Source = Frame;
+
+		m_HasReadback = Source != UINT32_MAX;
+
+		if( !m_HasReadback )
+			return;
+
+		m_ReadbackBuffers[ Source ]->GetData( m_Readback.data(), m_ReadbackTexels * sizeof( float ) );
+		m_ReadbackViewProjection = m_BuiltViewProjection[ Source ];
+	}
+
+	void HiZPyramid::Build( VkCommandBuffer CommandBuffer, const glm::mat4& rViewProjection )
+	{
+		SAT_PF_EVENT();
+
+		if( m_Levels.empty() )
+			return;
+
+		uint32_t frame = Renderer::Get().GetCurrentFrame();
+
+		// Wait for the depth writes.
+		VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr );
+
+		m_Pipeline->BindWithCommandBuffer( CommandBuffer );
+
+		HiZPushConstants PushConstants = {};
+		PushConstants.SourceSize = glm::ivec2( m_Width, m_Height );
+
+		for( uint32_t i = 0; i < m_Levels.size(); i++ )
+		{
+			const Level& rLevel = m_Levels[ i ];
+
+			PushConstants.DestSize = glm::ivec2( rLevel.Width, rLevel.Height );
+			PushConstants.FromDepth = i == 0 ? 1 : 0;
+			PushConstants.ReadbackOffset = rLevel.ReadbackOffset;
+
+			m_Pipeline->AddPushConstant( &PushConstants, 0, sizeof( HiZPushConstants ) );
+			m_Pipeline->Execute( m_DescriptorSets[ frame ][ i ]->GetVulkanSet(), ( rLevel.Width + s_GroupSize - 1 ) / s_GroupSize, ( rLevel.Height + s_GroupSize - 1 ) / s_GroupSize, 1 );
+
+			// The next level reads this one.
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+			vkCmdPipelineBarrier( CommandBuffer,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				0,
+				1, &barrier,
+				0, nullptr,
+				0, nullptr );
+
+			PushConstants.SourceSize = PushConstants.DestSize;
+		}
+
+		// The depth buffer is used by the geometry pass next, and the read back is for the host.
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr );
+
+		m_Pipeline->Unbind();
+
+		m_BuiltViewProjection[ frame ] = rViewProjection;
+		m_Built[ frame ] = true;
+	}
+
+	bool HiZPyramid::IsOccluded( const AABB& rBounds, const glm::mat4& rTransform ) const
+	{
+		if( !m_HasReadback )
+			return false;
+
+		// Empty or invalid bounds.
+		if( rBounds.Min.x > rBounds.Max.x || rBounds.Min.y > rBounds.Max.y || rBounds.Min.z > rBounds.Max.z )
+			return false;
+
+		const glm::mat4 MVP = m_ReadbackViewProjection * rTransform;
+
+		glm::vec2 ScreenMin( FLT_MAX );
+		glm::vec2 ScreenMax( -FLT_MAX );
+		float NearestDepth = FLT_MAX;
+
+		for( uint32_t i = 0; i < 8; i++ )
+		{
+			glm::vec3 Corner = { 
+				( i & 1 ) ? rBounds.Max.x : rBounds.Min.x, 
+				( i & 2 ) ? rBounds.Max.y : rBounds.Min.y, 
+				( i & 4 ) ? rBounds.Max.z : rBounds.Min.z };
+
+			glm::vec4 Clip = MVP * glm::vec4( Corner, 1.0f );
+
+			// Crosses the near plane.
+			if( Clip.w <= 1e-5f || Clip.z < 0.0f )
+				return false;
+
+			glm::vec3 NDC = glm::vec3( Clip ) / Clip.w;
+
+			ScreenMin = glm::min( ScreenMin, glm::vec2( NDC ) );
+			ScreenMax = glm::max( ScreenMax, glm::vec2( NDC ) );
+			NearestDepth = glm::min( NearestDepth, NDC.z );
+		}
+
+		// Not on screen for the pyramid's camera, so we know nothing about it.
+		if( ScreenMax.x < -1.0f || ScreenMax.y < -1.0f || ScreenMin.x > 1.0f || ScreenMin.y > 1.0f )
+			return false;
+
+		ScreenMin = glm::clamp( ScreenMin * 0.5f + 0.5f, 0.0f, 1.0f );
+		ScreenMax = glm::clamp( ScreenMax * 0.5f + 0.5f, 0.0f, 1.0f );
+
+		// In depth buffer pixels, a pixel "p" is in texel "p >> ( Mip + 1 )" of a level.
+		glm::uvec2 PixelMin = glm::min( glm::uvec2( ScreenMin * glm::vec2( m_Width, m_Height ) ), glm::uvec2( m_Width - 1, m_Height - 1 ) );
+		glm::uvec2 PixelMax = glm::min( glm::uvec2( ScreenMax * glm::vec2( m_Width, m_Height ) ), glm::uvec2( m_Width - 1, m_Height - 1 ) );
+
+		// Smallest level where the box covers at most 2x2 texels.
+		uint32_t Mip = m_ReadbackMip;
+
+		while( Mip + 1 < m_Levels.size() && 
+			( ( PixelMax.x >> ( Mip + 1 ) ) - ( PixelMin.x >> ( Mip + 1 ) ) > 1 || ( PixelMax.y >> ( Mip + 1 ) ) - ( PixelMin.y >> ( Mip + 1 ) ) > 1 ) )
+		{
+			Mip++;
+		}
+
+		const Level& rLevel = m_Levels[ Mip ];
+		const float* pTexels = m_Readback.data() + rLevel.ReadbackOffset;
+
+		glm::uvec2 TexelMin = glm::min( PixelMin >> ( Mip + 1 ), glm::uvec2( rLevel.Width - 1, rLevel.Height - 1 ) );
+		glm::uvec2 TexelMax = glm::min( PixelMax >> ( Mip + 1 ), glm::uvec2( rLevel.Width - 1, rLevel.Height - 1 ) );
+
+		float FarthestDepth = 0.0f;
+
+		for( uint32_t y = TexelMin.y; y <= TexelMax.y; y++ )
+		{
+			for( uint32_t x = TexelMin.x; x <= TexelMax.x; x++ )
+				FarthestDepth = glm::max( FarthestDepth, pTexels[ y * rLevel.Width + x ] );
+		}
+
+		return NearestDepth > FarthestDepth;
+	}
+}
@@ -0,0 +1,123 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+#include "Saturn/Core/AABB/AABB.h"
+
+#include "Image2D.h"
+#include "StorageBuffer.h"
+#include "ComputePipeline.h"
+#include "DescriptorSet.h"
+
+#include <glm/glm.hpp>
+#include <vulkan.h>
+#include <vector>
+
+namespace Saturn {
+
+	// Hierarchical Z pyramid built from the pre depth buffer, each level stores the farthest depth of the four texels below it.
+	// The coarse levels are read back so the CPU can test bounding boxes against the previous frame's depth before anything is drawn.
+	class HiZPyramid : public RefTarget
+	{
+	public:
+		HiZPyramid();
+		~HiZPyramid();
+
+		// Re-creates the pyramid for "DepthImage", must be called whenever the depth buffer is re-created.
+		void Resize( uint32_t Width, uint32_t Height, Ref<Image2D> DepthImage );
+
+		// Takes the newest pyramid that the GPU has finished with, called once per frame before any occlusion tests.
+		void BeginFrame( uint32_t Frame );
+
+		// Reduces the depth buffer, it must be in VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL and outside of a render pass.
+		// "rViewProjection" is the matrix the depth buffer was rendered with.
+		void Build( VkCommandBuffer CommandBuffer, const glm::mat4& rViewProjection );
+
+		// True if the box is behind the depth of the read back pyramid. Boxes that cross the near plane or leave the screen are never occluded.
+		bool IsOccluded( const AABB& rBounds, const glm::mat4& rTransform ) const;
+
+		// False until a pyramid has been read back, or right after a resize.
+		bool HasReadback() const { return m_HasReadback; }
+
+		uint32_t GetMipCount() const { return ( uint32_t ) m_Levels.size(); }
+		VkImageView GetMipImageView( uint32_t Mip ) const { return m_Levels[ Mip ].ImageView; }
+		VkImage GetImage() const { return m_Image; }
+
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+
+		// Every level of the pyramid built this frame, for compute shaders that fetch it directly.
+		VkDescriptorImageInfo GetDescriptorInfo() const;
+
+	private:
+		void Terminate();
+
+	private:
+		struct Level
+		{
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+
+			VkImageView ImageView = VK_NULL_HANDLE;
+
+			// Offset in texels into the read back buffer, UINT32_MAX if this level is not read back.
+			uint32_t ReadbackOffset = UINT32_MAX;
+		};
+
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+
+		std::vector<Level> m_Levels;
+
+		// First level that is read back.
+		uint32_t m_ReadbackMip = 0;
+		uint32_t m_ReadbackTexels = 0;
+
+		VkImage m_Image = VK_NULL_HANDLE;
+		VkDeviceMemory m_ImageMemory = VK_NULL_HANDLE;
+		VkImageView m_ImageView = VK_NULL_HANDLE;
+		VkSampler m_DepthSampler = VK_NULL_HANDLE;
+
+		Ref<Shader> m_Shader = nullptr;
+		Ref<ComputePipeline> m_Pipeline = nullptr;
+
+		// One set per level.
+		std::vector<Ref<DescriptorSet>> m_DescriptorSets[ MAX_FRAMES_IN_FLIGHT ];
+
+		Ref<StorageBuffer> m_ReadbackBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		glm::mat4 m_BuiltViewProjection[ MAX_FRAMES_IN_FLIGHT ]{};
+		bool m_Built[ MAX_FRAMES_IN_FLIGHT ] = {};
+
+		// CPU copy of the levels from m_ReadbackMip.
+		std::vector<float> m_Readback;
+		glm::mat4 m_ReadbackViewProjection{};
+		bool m_HasReadback = false;
+	};
+}
@@ -32,6 +32,7 @@
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
 #include "VulkanImageAux.h"
+#include "SamplerCache.h"
 
 namespace Saturn {
 
@@ -48,7 +49,6 @@ namespace Saturn {
 	Image2D::~Image2D()
 	{
 		vkDestroyImage( VulkanContext::Get().GetDevice(), m_Image, nullptr );
-		vkDestroySampler( VulkanContext::Get().GetDevice(), m_Sampler, nullptr );
 		vkFreeMemory( VulkanContext::Get().GetDevice(), m_Memory, nullptr );
 		vkDestroyImageView( VulkanContext::Get().GetDevice(), m_ImageView, nullptr );
 
@@ -58,6 +58,9 @@ namespace Saturn {
 			m_ImageViewes[ i ] = nullptr;
 		}
 
+		if( SamplerCache* pSamplerCache = VulkanContext::Get().GetSamplerCache() )
+			pSamplerCache->Release( m_Sampler );
+
 		m_Image = nullptr;
 		m_Sampler = nullptr;
 		m_Memory = nullptr;
@@ -71,7 +74,7 @@ namespace Saturn {
 	void Image2D::Resize( uint32_t Width, uint32_t Height )
 	{
 		vkDestroyImage( VulkanContext::Get().GetDevice(), m_Image, nullptr );
-		vkDestroySampler( VulkanContext::Get().GetDevice(), m_Sampler, nullptr );
+		VulkanContext::Get().GetSamplerCache()->Release( m_Sampler );
 		vkDestroyImageView( VulkanContext::Get().GetDevice(), m_ImageView, nullptr );
 		vkFreeMemory( VulkanContext::Get().GetDevice(), m_Memory, nullptr );
 
@@ -100,7 +103,7 @@ namespace Saturn {
 		if( IsColorFormat( m_Format ) )
 			ImageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 		else
-			ImageCreateInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+			ImageCreateInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
 		if( m_MSAASamples > VK_SAMPLE_COUNT_1_BIT )
 		{
@@ -196,8 +199,8 @@ namespace Saturn {
 		SamplerCreateInfo.maxLod = 1.0f;
 		SamplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
 
-		VK_CHECK( vkCreateSampler( VulkanContext::Get().GetDevice(), &SamplerCreateInfo, nullptr, &m_Sampler ) );
-		SetDebugUtilsObjectName( "Base image sampler", ( uint64_t ) m_Sampler, VK_OBJECT_TYPE_SAMPLER );
+		// Every image samples the same way, they all share one sampler.
+		m_Sampler = VulkanContext::Get().GetSamplerCache()->Acquire( SamplerCreateInfo );
 
 		m_DescriptorImageInfo.sampler = m_Sampler;
 		m_DescriptorImageInfo.imageView = m_ImageView;
@@ -76,6 +76,8 @@ namespace Saturn {
 
 		VkImage GetImage() { return m_Image; }
 		VkImageView GetImageView( size_t index = 0 ) { return m_ImageViewes[ index ]; }
+		// View of every layer, this is also the view in the descriptor info.
+		VkImageView GetArrayImageView() { return m_ImageView; }
 		VkSampler GetSampler() { return m_Sampler; }
 		VkDeviceMemory GetMemory() { return m_Memory; }
 
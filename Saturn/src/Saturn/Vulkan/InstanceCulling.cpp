@@ -0,0 +1,320 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "InstanceCulling.h"
+
+#include "VulkanContext.h"
+
+namespace Saturn {
+
+	static constexpr uint32_t s_MinDrawCapacity = 256;
+
+	// Gribb & Hartmann, planes point inwards. Depth is zero to one.
+	static void ExtractFrustumPlanes( const glm::mat4& rViewProjection, glm::vec4* pPlanes )
+	{
+		glm::vec4 Row0 = { rViewProjection[ 0 ][ 0 ], rViewProjection[ 1 ][ 0 ], rViewProjection[ 2 ][ 0 ], rViewProjection[ 3 ][ 0 ] };
+		glm::vec4 Row1 = { rViewProjection[ 0 ][ 1 ], rViewProjection[ 1 ][ 1 ], rViewProjection[ 2 ][ 1 ], rViewProjection[ 3 ][ 1 ] };
+		glm::vec4 Row2 = { rViewProjection[ 0 ][ 2 ], rViewProjection[ 1 ][ 2 ], rViewProjection[ 2 ][ 2 ], rViewProjection[ 3 ][ 2 ] };
+		glm::vec4 Row3 = { rViewProjection[ 0 ][ 3 ], rViewProjection[ 1 ][ 3 ], rViewProjection[ 2 ][ 3 ], rViewProjection[ 3 ][ 3 ] };
+
+		pPlanes[ 0 ] = Row3 + Row0; // Left
+		pPlanes[ 1 ] = Row3 - Row0; // Right
+		pPlanes[ 2 ] = Row3 + Row1; // Bottom
+		pPlanes[ 3 ] = Row3 - Row1; // Top
+		pPlanes[ 4 ] = Row2;        // Near
+		pPlanes[ 5 ] = Row3 - Row2; // Far
+
+		for( uint32_t i = 0; i < 6; i++ )
+		{
+			float Length = glm::length( glm::vec3( pPlanes[ i ] ) );
+
+			if( Length > 0.0f )
+				pPlanes[ i ] /= Length;
+		}
+	}
+
+	InstanceCulling::InstanceCulling()
+	{
+		m_Shader = ShaderLibrary::Get().FindOrLoad( "InstanceCull", "content/shaders/InstanceCull.glsl" );
+		m_Pipeline = Ref<ComputePipeline>::Create( m_Shader );
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			m_DrawBuffers[ i ] = Ref<StorageBuffer>::Create( 0, 1, VMA_MEMORY_USAGE_CPU_TO_GPU );
+			m_ViewBuffers[ i ] = Ref<StorageBuffer>::Create( 0, 2, VMA_MEMORY_USAGE_CPU_TO_GPU );
+			m_DescriptorSets[ i ] = m_Shader->CreateDescriptorSet( 0 );
+		}
+	}
+
+	InstanceCulling::~InstanceCulling()
+	{
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			m_DrawBuffers[ i ] = nullptr;
+			m_ViewBuffers[ i ] = nullptr;
+			m_IndirectBuffers[ i ] = nullptr;
+			m_CulledInstanceBuffers[ i ] = nullptr;
+			m_DescriptorSets[ i ] = nullptr;
+		}
+
+		m_Pipeline = nullptr;
+		m_Shader = nullptr;
+	}
+
+	void InstanceCulling::Reset()
+	{
+		m_Draws.clear();
+		m_Views.clear();
+		m_DrawIndices.clear();
+
+		m_TotalInstances = 0;
+		m_LayeredViewMask = 0;
+		m_ShadowViewMask = 0;
+	}
+
+	void InstanceCulling::SetLayeredViews( uint32_t ViewMask )
+	{
+		uint32_t Bits = ViewMask;
+
+		while( Bits && !( Bits & 1 ) )
+			Bits >>= 1;
+
+		SAT_CORE_ASSERT( ( Bits & ( Bits + 1 ) ) == 0, "Layered views must be consecutive!" );
+
+		m_LayeredViewMask = ViewMask;
+	}
+
+	uint32_t InstanceCulling::AddView( const glm::mat4& rViewProjection )
+	{
+		SAT_CORE_ASSERT( m_Views.size() < MaxViews, "Too many culling views!" );
+
+		CullView& rView = m_Views.emplace_back();
+		ExtractFrustumPlanes( rViewProjection, rView.Planes );
+
+		return ( uint32_t ) m_Views.size() - 1;
+	}
+
+	void InstanceCulling::AddDraw( const StaticMeshKey& rKey, const Ref<StaticMesh>& rMesh, uint32_t SubmeshIndex, uint32_t Lod, uint32_t InstanceCount, uint32_t ViewMask )
+	{
+		const Submesh& rSubmesh = rMesh->Submeshes()[ SubmeshIndex ];
+		const MeshGeometryRange& rRange = rMesh->GetGeometryRange();
+
+		SubmeshLod LodRange = rSubmesh.GetLod( Lod );
+
+		auto Itr = m_DrawIndices.find( rKey );
+
+		if( Itr != m_DrawIndices.end() )
+		{
+			CullDraw& rDraw = m_Draws[ Itr->second ];
+			rDraw.ViewMask |= ViewMask;
+
+			if( ViewMask & ~m_ShadowViewMask )
+			{
+				rDraw.IndexCount = LodRange.IndexCount;
+				rDraw.FirstIndex = rRange.IndexOffset + LodRange.BaseIndex;
+			}
+
+			if( ViewMask & m_ShadowViewMask )
+			{
+				rDraw.ShadowIndexCount = LodRange.IndexCount;
+				rDraw.ShadowFirstIndex = rRange.IndexOffset + LodRange.BaseIndex;
+			}
+
+			return;
+		}
+
+		CullDraw Draw = {};
+		Draw.BoundsMin = glm::vec4( rSubmesh.BoundingBox.Min, 0.0f );
+		Draw.BoundsMax = glm::vec4( rSubmesh.BoundingBox.Max, 0.0f );
+		Draw.InstanceCount = InstanceCount;
+		Draw.OutputOffset = m_TotalInstances;
+		Draw.IndexCount = LodRange.IndexCount;
+		Draw.FirstIndex = rRange.IndexOffset + LodRange.BaseIndex;
+		Draw.ShadowIndexCount = Draw.IndexCount;
+		Draw.ShadowFirstIndex = Draw.FirstIndex;
+		Draw.VertexOffset = ( int32_t ) ( rRange.VertexOffset + rSubmesh.BaseVertex );
+		Draw.ViewMask = ViewMask;
+
+		m_DrawIndices[ rKey ] = ( uint32_t ) m_Draws.size();
+		m_Draws.push_back( Draw );
+
+		m_TotalInstances += InstanceCount;
+	}
+
+	void InstanceCulling::Dispatch( VkCommandBuffer CommandBuffer, const Ref<GPUScene>& rScene )
+	{
+		SAT_PF_EVENT();
+
+		m_Frame = Renderer::Get().GetCurrentFrame();
+
+		if( m_Draws.empty() || m_Views.empty() )
+			return;
+
+		// Instance offsets are only known once the scene has been updated.
+		for( auto&& [key, index] : m_DrawIndices )
+			m_Draws[ index ].InstanceOffset = rScene->GetInstanceOffset( key ) / sizeof( TransformBufferData );
+
+		const uint32_t DrawCount = ( uint32_t ) m_Draws.size();
+		const uint32_t ViewCount = ( uint32_t ) m_Views.size();
+
+		//////////////////////////////////////////////////////////////////////////
+		// Buffers, we have waited for this frame's fence so they can be re-created.
+
+		size_t DrawSize = m_Draws.size() * sizeof( CullDraw );
+		size_t ViewSize = m_Views.size() * sizeof( CullView );
+		size_t IndirectSize = ( size_t ) DrawCount * ViewCount * sizeof( VkDrawIndexedIndirectCommand );
+		size_t CulledSize = std::max( ( size_t ) m_TotalInstances * ViewCount, ( size_t ) 1 ) * sizeof( TransformBufferData );
+
+		auto& rDrawBuffer = m_DrawBuffers[ m_Frame ];
+		auto& rViewBuffer = m_ViewBuffers[ m_Frame ];
+		auto& rIndirectBuffer = m_IndirectBuffers[ m_Frame ];
+		auto& rCulledBuffer = m_CulledInstanceBuffers[ m_Frame ];
+
+		if( rDrawBuffer->GetSize() < DrawSize )
+			rDrawBuffer->Resize( ( uint32_t ) std::max( { DrawSize, rDrawBuffer->GetSize() * 2, s_MinDrawCapacity * sizeof( CullDraw ) } ) );
+
+		if( rViewBuffer->GetSize() < ViewSize )
+			rViewBuffer->Resize( ( uint32_t ) ( MaxViews * sizeof( CullView ) ) );
+
+		if( !rIndirectBuffer || rIndirectBuffer->GetSize() < IndirectSize )
+		{
+			size_t Size = std::max( IndirectSize, rIndirectBuffer ? rIndirectBuffer->GetSize() * 2 : 0 );
+
+			rIndirectBuffer = Ref<VertexBuffer>::Create( Size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY );
+		}
+
+		if( !rCulledBuffer || rCulledBuffer->GetSize() < CulledSize )
+		{
+			size_t Size = std::max( CulledSize, rCulledBuffer ? rCulledBuffer->GetSize() * 2 : 0 );
+
+			rCulledBuffer = Ref<VertexBuffer>::Create( Size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY );
+		}
+
+		rDrawBuffer->SetData( m_Draws.data(), DrawSize );
+		rViewBuffer->SetData( m_Views.data(), ViewSize );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Descriptors
+
+		Ref<DescriptorSet>& rDescriptorSet = m_DescriptorSets[ m_Frame ];
+
+		VkDescriptorBufferInfo InstanceBufferInfo = {};
+		InstanceBufferInfo.buffer = rScene->GetInstanceBuffer()->GetBuffer();
+		InstanceBufferInfo.range = VK_WHOLE_SIZE;
+
+		VkDescriptorBufferInfo IndirectBufferInfo = {};
+		IndirectBufferInfo.buffer = rIndirectBuffer->GetBuffer();
+		IndirectBufferInfo.range = VK_WHOLE_SIZE;
+
+		VkDescriptorBufferInfo CulledBufferInfo = {};
+		CulledBufferInfo.buffer = rCulledBuffer->GetBuffer();
+		CulledBufferInfo.range = VK_WHOLE_SIZE;
+
+		m_Shader->WriteSB( 0, 0, InstanceBufferInfo, rDescriptorSet );
+		m_Shader->WriteSB( 0, 1, rDrawBuffer->GetBufferInfo(), rDescriptorSet );
+		m_Shader->WriteSB( 0, 2, rViewBuffer->GetBufferInfo(), rDescriptorSet );
+		m_Shader->WriteSB( 0, 3, IndirectBufferInfo, rDescriptorSet );
+		m_Shader->WriteSB( 0, 4, CulledBufferInfo, rDescriptorSet );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Cull
+
+		// Wait for the instance scatter, and for anything that still reads the outputs.
+		VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr );
+
+		struct
+		{
+			uint32_t DrawCount;
+			uint32_t ViewCount;
+			uint32_t LayeredViewMask;
+			uint32_t ShadowViewMask;
+		} PushConstants = { DrawCount, ViewCount, m_LayeredViewMask, m_ShadowViewMask };
+
+		m_Pipeline->BindWithCommandBuffer( CommandBuffer );
+
+		m_Pipeline->AddPushConstant( &PushConstants, 0, sizeof( PushConstants ) );
+
+		// One workgroup per draw and view.
+		m_Pipeline->Execute( rDescriptorSet->GetVulkanSet(), DrawCount, ViewCount, 1 );
+
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr );
+
+		m_Pipeline->Unbind();
+	}
+
+	uint32_t InstanceCulling::GetInstanceOffset( const StaticMeshKey& rKey, uint32_t View ) const
+	{
+		auto Itr = m_DrawIndices.find( rKey );
+
+		if( Itr == m_DrawIndices.end() )
+			return 0;
+
+		const CullDraw& rDraw = m_Draws[ Itr->second ];
+
+		return ( rDraw.OutputOffset * ( uint32_t ) m_Views.size() + View * rDraw.InstanceCount ) * sizeof( TransformBufferData );
+	}
+
+	IndirectDraw InstanceCulling::GetIndirectDraw( const StaticMeshKey& rKey, uint32_t View )
+	{
+		auto Itr = m_DrawIndices.find( rKey );
+
+		if( Itr == m_DrawIndices.end() || !m_IndirectBuffers[ m_Frame ] )
+			return {};
+
+		IndirectDraw Draw;
+		Draw.Buffer = m_IndirectBuffers[ m_Frame ]->GetBuffer();
+		Draw.Offset = ( ( VkDeviceSize ) View * m_Draws.size() + Itr->second ) * sizeof( VkDrawIndexedIndirectCommand );
+
+		return Draw;
+	}
+
+	Ref<VertexBuffer> InstanceCulling::GetInstanceBuffer() const
+	{
+		return m_CulledInstanceBuffers[ m_Frame ];
+	}
+}
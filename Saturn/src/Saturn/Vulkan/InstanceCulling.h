@@ -0,0 +1,142 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+#include "GPUScene.h"
+#include "Mesh.h"
+#include "Renderer.h"
+
+#include "VertexBuffer.h"
+#include "StorageBuffer.h"
+#include "ComputePipeline.h"
+#include "DescriptorSet.h"
+
+#include <glm/glm.hpp>
+#include <vulkan.h>
+#include <unordered_map>
+#include <vector>
+
+namespace Saturn {
+
+	// GPU driven culling for the static meshes in a GPUScene.
+	// Every draw is frustum culled against every view in compute, the visible transforms are compacted into a separate instance buffer and an indirect command is written per draw and view.
+	// Recording the draws then only depends on the number of submeshes, not on the number of instances.
+	class InstanceCulling : public RefTarget
+	{
+	public:
+		static constexpr uint32_t MaxViews = 32;
+
+	public:
+		InstanceCulling();
+		~InstanceCulling();
+
+		// Removes last frame's views and draws.
+		void Reset();
+
+		// Returns the index of the view, which is used as the bit in the draw's view mask.
+		uint32_t AddView( const glm::mat4& rViewProjection );
+
+		// "ViewMask" must be consecutive views. They share one indirect command per draw, use the first view to get it.
+		// Every visible instance is written once per layer, the layer (relative to the first view) replaces the x of the transform's bottom row.
+		void SetLayeredViews( uint32_t ViewMask );
+
+		// Views that draw the shadow index range of a draw, the other views draw the main range.
+		void SetShadowViews( uint32_t ViewMask ) { m_ShadowViewMask = ViewMask; }
+
+		// Adding the same key twice merges the view masks, "Lod" sets the index range of the views in "ViewMask".
+		void AddDraw( const StaticMeshKey& rKey, const Ref<StaticMesh>& rMesh, uint32_t SubmeshIndex, uint32_t Lod, uint32_t InstanceCount, uint32_t ViewMask );
+
+		// Must be called outside of a render pass, after the GPUScene has been updated.
+		void Dispatch( VkCommandBuffer CommandBuffer, const Ref<GPUScene>& rScene );
+
+		bool HasDraw( const StaticMeshKey& rKey ) const { return m_DrawIndices.find( rKey ) != m_DrawIndices.end(); }
+
+		// Byte offset of the first culled instance of "rKey" for "View" in the culled instance buffer.
+		uint32_t GetInstanceOffset( const StaticMeshKey& rKey, uint32_t View ) const;
+		IndirectDraw GetIndirectDraw( const StaticMeshKey& rKey, uint32_t View );
+
+		Ref<VertexBuffer> GetInstanceBuffer() const;
+
+		uint32_t GetDrawCount() const { return ( uint32_t ) m_Draws.size(); }
+		uint32_t GetViewCount() const { return ( uint32_t ) m_Views.size(); }
+
+	private:
+		// Must match with "CullDraw" in InstanceCull.glsl (std430).
+		struct CullDraw
+		{
+			glm::vec4 BoundsMin;
+			glm::vec4 BoundsMax;
+
+			uint32_t InstanceOffset = 0;
+			uint32_t InstanceCount = 0;
+			uint32_t OutputOffset = 0;
+
+			uint32_t IndexCount = 0;
+			uint32_t FirstIndex = 0;
+			int32_t VertexOffset = 0;
+
+			uint32_t ViewMask = 0;
+
+			// Shadow passes can use a different LOD.
+			uint32_t ShadowIndexCount = 0;
+			uint32_t ShadowFirstIndex = 0;
+
+			uint32_t Padding[ 3 ] = {};
+		};
+
+		struct CullView
+		{
+			glm::vec4 Planes[ 6 ];
+		};
+
+	private:
+		std::vector<CullDraw> m_Draws;
+		std::vector<CullView> m_Views;
+		std::unordered_map<StaticMeshKey, uint32_t> m_DrawIndices;
+
+		// Instances of all draws, a draw owns "ViewCount * InstanceCount" culled instances.
+		uint32_t m_TotalInstances = 0;
+
+		uint32_t m_LayeredViewMask = 0;
+		uint32_t m_ShadowViewMask = 0;
+
+		// Frame that was last dispatched, the getters read its buffers.
+		uint32_t m_Frame = 0;
+
+		Ref<StorageBuffer> m_DrawBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref<StorageBuffer> m_ViewBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref<VertexBuffer> m_IndirectBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref<VertexBuffer> m_CulledInstanceBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref<DescriptorSet> m_DescriptorSets[ MAX_FRAMES_IN_FLIGHT ];
+
+		Ref<Shader> m_Shader = nullptr;
+		Ref<ComputePipeline> m_Pipeline = nullptr;
+	};
+}
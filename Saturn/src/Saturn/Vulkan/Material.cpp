@@ -96,6 +96,8 @@ namespace Saturn {
 			
 			texture = nullptr;
 		}
+
+		RN_Clean();
 	}
 	
 	void Material::Copy( Ref<Material>& rOther )
@@ -111,6 +113,8 @@ namespace Saturn {
 
 		m_Shader = rOther->m_Shader;
 		m_PushConstantData = rOther->m_PushConstantData;
+
+		MarkDirty();
 	}
 
 	void Material::Bind( const Ref< StaticMesh >& rMesh, Submesh& rSubmsh, Ref< Shader >& Shader )
@@ -119,12 +123,7 @@ namespace Saturn {
 
 	void Material::Bind( VkCommandBuffer CommandBuffer, Ref< Shader >& Shader )
 	{
-		uint32_t frame = Renderer::Get().GetCurrentFrame();
-
 		RN_Update();
-
-		VkDescriptorSet Set = m_DescriptorSets[ frame ];
-		Shader->WriteAllUBs( Set );
 	}
 
 	void Material::BindDS( VkCommandBuffer CommandBuffer, VkPipelineLayout Layout )
@@ -137,17 +136,40 @@ namespace Saturn {
 
 	void Material::RN_Update()
 	{
+		SAT_PF_EVENT();
+
 		uint32_t frame = Renderer::Get().GetCurrentFrame();
 
-		m_DescriptorSets[ frame ] = m_Shader->AllocateDescriptorSet( 0, true );
+		if( m_Updated[ frame ] && m_DescriptorSets[ frame ] )
+			return;
+
+		m_Updated[ frame ] = true;
+
+		size_t Hash = CalculateSetHash();
+
+		if( Hash == m_SetHashes[ frame ] && m_DescriptorSets[ frame ] )
+			return;
+
+		Ref<DescriptorSetCache> Cache = Renderer::Get().GetDescriptorSetCache();
+
+		if( m_DescriptorSets[ frame ] )
+			Cache->Release( m_SetHashes[ frame ] );
+
+		m_SetHashes[ frame ] = Hash;
+
+		// Another material is already using the same resources, or we have used this set before.
+		if( !Cache->Acquire( Hash, m_Shader->GetSetLayout( 0 ), m_DescriptorSets[ frame ] ) )
+			return;
 
 		for( auto& [name, texture] : m_Textures )
 		{
+			Ref<Texture2D> Texture = texture ? texture : Renderer::Get().GetPinkTexture();
+
 			VkDescriptorImageInfo ImageInfo = {};
 			ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-			ImageInfo.imageView = m_Textures[ name ]->GetImageView();
-			ImageInfo.sampler = m_Textures[ name ]->GetSampler();
+			ImageInfo.imageView = Texture->GetImageView();
+			ImageInfo.sampler = Texture->GetSampler();
 
 			m_Shader->WriteDescriptor( name, ImageInfo, m_DescriptorSets[ frame ] );
 		}
@@ -169,6 +191,59 @@ namespace Saturn {
 
 	void Material::RN_Clean()
 	{
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			Ref<DescriptorSetCache> Cache = Renderer::Get().GetDescriptorSetCache( i );
+
+			if( Cache && m_DescriptorSets[ i ] )
+				Cache->Release( m_SetHashes[ i ] );
+
+			m_DescriptorSets[ i ] = VK_NULL_HANDLE;
+			m_SetHashes[ i ] = 0;
+		}
+	}
+
+	void Material::MarkDirty()
+	{
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+			m_Updated[ i ] = false;
+	}
+
+	size_t Material::CalculateSetHash()
+	{
+		size_t Hash = m_Shader->GetShaderHash();
+		HashCombine( Hash, ( uint64_t ) m_Shader->GetSetLayout( 0 ) );
+
+		// Unordered maps, so the order of the textures can not be relied on.
+		size_t TextureHash = 0;
+
+		for( auto& [name, texture] : m_Textures )
+		{
+			Ref<Texture2D> Texture = texture ? texture : Renderer::Get().GetPinkTexture();
+
+			size_t Entry = std::hash<std::string>{}( name );
+			HashCombine( Entry, ( uint64_t ) Texture->GetImageView() );
+			HashCombine( Entry, ( uint64_t ) Texture->GetSampler() );
+
+			TextureHash += Entry;
+		}
+
+		for( auto& [name, textures] : m_TextureArrays )
+		{
+			size_t Entry = std::hash<std::string>{}( name );
+
+			for( auto& texture : textures )
+			{
+				HashCombine( Entry, ( uint64_t ) texture->GetImageView() );
+				HashCombine( Entry, ( uint64_t ) texture->GetSampler() );
+			}
+
+			TextureHash += Entry;
+		}
+
+		HashCombine( Hash, TextureHash );
+
+		return Hash;
 	}
 
 	void Material::SetResource( const std::string& Name, const Ref< Saturn::Texture2D >& Texture )
@@ -176,6 +251,9 @@ namespace Saturn {
 		if( m_Textures[ Name ] )
 			m_AnyValueChanged = true;
 
+		if( m_Textures[ Name ] != Texture )
+			MarkDirty();
+
 		m_Textures[ Name ] = Texture;
 	}
 
@@ -187,10 +265,15 @@ namespace Saturn {
 
 		auto& textures = m_TextureArrays[ Name ];
 
-		if( textures.size() >= Index )
+		if( textures.size() <= Index )
 			textures.resize( Index + 1 );
 
+		if( textures[ Index ] == Texture )
+			return;
+
 		textures[ Index ] = Texture;
+
+		MarkDirty();
 	}
 
 	Ref< Texture2D > Material::GetResource( const std::string& Name )
@@ -207,5 +290,7 @@ namespace Saturn {
 		rWDS.dstSet = m_DescriptorSets[ frame ];
 
 		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &rWDS, 0, nullptr );
+
+		Renderer::Get().GetStats().DescriptorWrites++;
 	}
 }
\ No newline at end of file
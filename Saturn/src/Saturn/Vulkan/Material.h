@@ -56,6 +56,9 @@ namespace Saturn {
 		void RN_Update();
 		void RN_Clean();
 
+		// Forces the descriptor sets to be re-hashed next time they are bound. Call this when a texture was changed without SetResource.
+		void MarkDirty();
+
 		void SetResource( const std::string& Name, const Ref< Saturn::Texture2D >& Texture );
 		void SetResource( const std::string& Name, const Ref< Saturn::Texture2D >& Texture, uint32_t Index );
 
@@ -128,13 +131,17 @@ namespace Saturn {
 
 		void WriteDescriptor( VkWriteDescriptorSet& rWDS );
 
+		size_t CalculateSetHash();
+
 	private:
 		std::string m_Name = "";
 		Ref< Saturn::Shader > m_Shader;
 
 		bool m_AnyValueChanged = false;
 
-		bool m_Updated[ MAX_FRAMES_IN_FLIGHT ];
+		// False when the set for that frame needs to be re-hashed.
+		bool m_Updated[ MAX_FRAMES_IN_FLIGHT ] = {};
+		size_t m_SetHashes[ MAX_FRAMES_IN_FLIGHT ] = {};
 
 		Buffer m_PushConstantData;
 		
@@ -144,7 +151,7 @@ namespace Saturn {
 		// Binding Name -> Textures
 		std::unordered_map< std::string, std::vector< Ref<Texture2D> > > m_TextureArrays;
 
-		VkDescriptorSet m_DescriptorSets[ MAX_FRAMES_IN_FLIGHT ];
+		VkDescriptorSet m_DescriptorSets[ MAX_FRAMES_IN_FLIGHT ] = {};
 
 	private:
 		friend class MaterialInstance;
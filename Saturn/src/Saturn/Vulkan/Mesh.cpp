@@ -33,6 +33,9 @@
 #include "Renderer.h"
 #include "DescriptorSet.h"
 #include "MaterialInstance.h"
+#include "VertexCompression.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
 
 #include "Saturn/Serialisation/AssetRegistrySerialiser.h"
 #include "Saturn/Serialisation/AssetSerialisers.h"
@@ -130,8 +133,13 @@ namespace Saturn {
 
 	StaticMesh::~StaticMesh()
 	{
-		m_VertexBuffer = nullptr;
-		m_IndexBuffer = nullptr;
+		// The pool is gone when the mesh outlives the context.
+		MeshGeometryPool* pPool = VulkanContext::Get().GetMeshGeometryPool();
+
+		if( pPool && m_GeometryHandle != InvalidGeometryHandle )
+			pPool->Free( m_GeometryHandle );
+
+		m_GeometryHandle = InvalidGeometryHandle;
 
 		m_Vertices.clear();
 
@@ -205,14 +213,111 @@ namespace Saturn {
 
 				m_Indices.push_back( { mesh->mFaces[ i ].mIndices[ 0 ], mesh->mFaces[ i ].mIndices[ 1 ], mesh->mFaces[ i ].mIndices[ 2 ] } );
 			}
+
+			// Indices are relative to the submesh, so every submesh is optimized on its own. The result ends up in the cooked mesh data.
+			static_assert( sizeof( Index ) == sizeof( uint32_t ) * 3 );
+
+			MeshOptimizer::OptimizeSubmesh( &m_Vertices[ submesh.BaseVertex ], submesh.VertexCount, 
+				reinterpret_cast< uint32_t* >( &m_Indices[ submesh.BaseIndex / 3 ] ), submesh.IndexCount, m_OptimizationStats );
 		}
 
-		m_VertexBuffer = Ref<VertexBuffer>::Create( m_Vertices.data(), ( uint32_t ) ( m_Vertices.size() * sizeof( StaticVertex ) ) );
-		m_IndexBuffer = Ref<IndexBuffer>::Create( m_Indices.data(), m_Indices.size() * sizeof( Index ) );
+		BuildMeshlets();
+		GenerateLods();
+		UploadGeometry();
 
 		TraverseNodes( m_Scene->mRootNode );
 	}
 
+	// How far a LOD may move the surface, relative to the size of the submesh.
+	static constexpr float s_LodMaxError = 0.02f;
+
+	void StaticMesh::GenerateLods()
+	{
+		SAT_PF_EVENT();
+
+		// LOD 0 of every submesh comes first, anything after that are old LODs.
+		m_Indices.resize( m_IndicesCount / 3 );
+
+		for( Submesh& rSubmesh : m_Submeshes )
+		{
+			rSubmesh.Lods.clear();
+
+			// Copy as m_Indices grows while we append the LODs.
+			const uint32_t* pLod0 = reinterpret_cast< const uint32_t* >( &m_Indices[ rSubmesh.BaseIndex / 3 ] );
+			std::vector<uint32_t> Source( pLod0, pLod0 + rSubmesh.IndexCount );
+
+			for( size_t i = 0; i < m_LodRatios.size() && i < MAX_SUBMESH_LODS - 1; i++ )
+			{
+				uint32_t Target = ( uint32_t ) ( rSubmesh.IndexCount * m_LodRatios[ i ] ) / 3 * 3;
+
+				// Every LOD is simplified from the previous one.
+				std::vector<uint32_t> Simplified = MeshSimplifier::Simplify( &m_Vertices[ rSubmesh.BaseVertex ], rSubmesh.VertexCount, Source.data(), ( uint32_t ) Source.size(), Target, s_LodMaxError );
+
+				// Locked seams and borders or the error limit stopped the simplifier early, a LOD that is barely smaller is not worth it.
+				if( Simplified.empty() || Simplified.size() > Source.size() * 9 / 10 )
+					break;
+
+				MeshOptimizer::OptimizeVertexCache( Simplified.data(), ( uint32_t ) Simplified.size(), rSubmesh.VertexCount );
+
+				SubmeshLod& rLod = rSubmesh.Lods.emplace_back();
+				rLod.BaseIndex = ( uint32_t ) m_Indices.size() * 3;
+				rLod.IndexCount = ( uint32_t ) Simplified.size();
+
+				for( size_t t = 0; t < Simplified.size(); t += 3 )
+					m_Indices.push_back( { Simplified[ t ], Simplified[ t + 1 ], Simplified[ t + 2 ] } );
+
+				Source = std::move( Simplified );
+			}
+		}
+	}
+
+	void StaticMesh::BuildMeshlets()
+	{
+		SAT_PF_EVENT();
+
+		m_Meshlets.clear();
+
+		// Only LOD 0, the simplified LODs are already cheap.
+		for( Submesh& rSubmesh : m_Submeshes )
+		{
+			rSubmesh.BaseMeshlet = ( uint32_t ) m_Meshlets.size();
+
+			MeshletBuilder::Build( &m_Vertices[ rSubmesh.BaseVertex ], rSubmesh.VertexCount, 
+				reinterpret_cast< const uint32_t* >( &m_Indices[ rSubmesh.BaseIndex / 3 ] ), rSubmesh.IndexCount, m_Meshlets );
+
+			rSubmesh.MeshletCount = ( uint32_t ) m_Meshlets.size() - rSubmesh.BaseMeshlet;
+		}
+	}
+
+	void StaticMesh::SetLodRatios( const std::vector<float>& rRatios )
+	{
+		if( m_LodRatios == rRatios )
+			return;
+
+		m_LodRatios = rRatios;
+
+		if( !CanGenerateLods() )
+			return;
+
+		GenerateLods();
+		UploadGeometry();
+	}
+
+	void StaticMesh::UploadGeometry()
+	{
+		MeshGeometryPool* pPool = VulkanContext::Get().GetMeshGeometryPool();
+
+		if( m_GeometryHandle != InvalidGeometryHandle )
+			pPool->Free( m_GeometryHandle );
+
+		m_GeometryHandle = pPool->Allocate( m_Vertices, m_Indices, m_Meshlets );
+	}
+
+	const MeshGeometryRange& StaticMesh::GetGeometryRange() const
+	{
+		return VulkanContext::Get().GetMeshGeometryPool()->GetRange( m_GeometryHandle );
+	}
+
 	void StaticMesh::TraverseNodes( aiNode* node, const glm::mat4& parentTransform /*= glm::mat4( 1.0f )*/, uint32_t level /*= 0 */ )
 	{
 		glm::mat4 transform = parentTransform * Mat4FromAssimpMat4( node->mTransformation );
@@ -549,15 +654,65 @@ namespace Saturn {
 	//////////////////////////////////////////////////////////////////////////
 	// SERIALISATION/DESERIALISATION
 
+	// Written before the vertex count, mesh data from before the header starts with the vertex count.
+	static constexpr uint32_t s_MeshDataMagic = 0x4853454D; // "MESH"
+
+	// Version 1 did not write a version, the magic is directly followed by the vertex format.
+	// Version 2 added submesh LODs, version 3 added meshlets.
+	static constexpr uint32_t s_MeshDataVersion = 3;
+
+	enum class MeshVertexFormat : uint32_t
+	{
+		Full = 0,
+		Quantized = 1
+	};
+
 	void StaticMesh::SerialiseData( std::ofstream& rStream )
 	{
+		MeshVertexFormat Format = m_CompactVertices ? MeshVertexFormat::Quantized : MeshVertexFormat::Full;
+
+		RawSerialisation::WriteObject( s_MeshDataMagic, rStream );
+		RawSerialisation::WriteObject( s_MeshDataVersion, rStream );
+		RawSerialisation::WriteObject( Format, rStream );
+
 		RawSerialisation::WriteObject( m_VertexCount, rStream );
 		RawSerialisation::WriteObject( m_IndicesCount, rStream );
 
 		RawSerialisation::WriteVector( m_Indices, rStream );
-		RawSerialisation::WriteVector( m_Vertices, rStream );
+
+		// Submeshes first, quantized vertices need their bounds.
 		RawSerialisation::WriteVector( m_Submeshes, rStream );
 
+		for( const Submesh& rSubmesh : m_Submeshes )
+			RawSerialisation::WriteVector( rSubmesh.Lods, rStream );
+
+		RawSerialisation::WriteVector( m_LodRatios, rStream );
+
+		for( const Submesh& rSubmesh : m_Submeshes )
+		{
+			RawSerialisation::WriteObject( rSubmesh.BaseMeshlet, rStream );
+			RawSerialisation::WriteObject( rSubmesh.MeshletCount, rStream );
+		}
+
+		RawSerialisation::WriteVector( m_Meshlets, rStream );
+
+		if( Format == MeshVertexFormat::Quantized )
+		{
+			std::vector<QuantizedStaticVertex> Vertices( m_Vertices.size() );
+
+			for( const Submesh& rSubmesh : m_Submeshes )
+			{
+				for( uint32_t i = rSubmesh.BaseVertex; i < rSubmesh.BaseVertex + rSubmesh.VertexCount; i++ )
+					Vertices[ i ] = VertexCompression::Quantize( m_Vertices[ i ], rSubmesh.BoundingBox );
+			}
+
+			RawSerialisation::WriteVector( Vertices, rStream );
+		}
+		else
+		{
+			RawSerialisation::WriteVector( m_Vertices, rStream );
+		}
+
 		RawSerialisation::WriteMatrix4x4( m_Transform, rStream );
 		RawSerialisation::WriteMatrix4x4( m_InverseTransform, rStream );
 
@@ -573,18 +728,109 @@ namespace Saturn {
 
 	void StaticMesh::DeserialiseData( std::istream& rStream )
 	{
-		RawSerialisation::ReadObject( m_VertexCount, rStream );
+		uint32_t Header = 0;
+		RawSerialisation::ReadObject( Header, rStream );
+
+		bool HasHeader = Header == s_MeshDataMagic;
+		MeshVertexFormat Format = MeshVertexFormat::Full;
+		uint32_t Version = 0;
+
+		auto ReadSubmeshes = [&]()
+		{
+			RawSerialisation::ReadVector( m_Submeshes, rStream );
+
+			if( Version < 2 )
+				return;
+
+			for( Submesh& rSubmesh : m_Submeshes )
+				RawSerialisation::ReadVector( rSubmesh.Lods, rStream );
+
+			RawSerialisation::ReadVector( m_LodRatios, rStream );
+
+			if( Version < 3 )
+				return;
+
+			for( Submesh& rSubmesh : m_Submeshes )
+			{
+				RawSerialisation::ReadObject( rSubmesh.BaseMeshlet, rStream );
+				RawSerialisation::ReadObject( rSubmesh.MeshletCount, rStream );
+			}
+
+			RawSerialisation::ReadVector( m_Meshlets, rStream );
+		};
+
+		if( HasHeader )
+		{
+			uint32_t VersionOrFormat = 0;
+			RawSerialisation::ReadObject( VersionOrFormat, rStream );
+
+			// Versions start at 2, so 0 and 1 can only be the vertex format of version 1 data.
+			if( VersionOrFormat <= ( uint32_t ) MeshVertexFormat::Quantized )
+			{
+				Version = 1;
+				Format = ( MeshVertexFormat ) VersionOrFormat;
+			}
+			else
+			{
+				Version = VersionOrFormat;
+
+				// Reading on would interpret every field at the wrong offset, so this also has to stop release builds.
+				if( Version > s_MeshDataVersion )
+				{
+					SAT_CORE_VERIFY( false, "Mesh data is from an unsupported version, please re-import the mesh." );
+					return;
+				}
+
+				RawSerialisation::ReadObject( Format, rStream );
+			}
+
+			RawSerialisation::ReadObject( m_VertexCount, rStream );
+		}
+		else
+		{
+			m_VertexCount = Header;
+		}
+
 		RawSerialisation::ReadObject( m_IndicesCount, rStream );
 
 		RawSerialisation::ReadVector( m_Indices, rStream );
-		RawSerialisation::ReadVector( m_Vertices, rStream );
-		RawSerialisation::ReadVector( m_Submeshes, rStream );
+
+		if( !HasHeader )
+		{
+			RawSerialisation::ReadVector( m_Vertices, rStream );
+			RawSerialisation::ReadVector( m_Submeshes, rStream );
+		}
+		else if( Format == MeshVertexFormat::Quantized )
+		{
+			ReadSubmeshes();
+
+			std::vector<QuantizedStaticVertex> Vertices;
+			RawSerialisation::ReadVector( Vertices, rStream );
+
+			m_Vertices.resize( Vertices.size() );
+
+			for( const Submesh& rSubmesh : m_Submeshes )
+			{
+				for( uint32_t i = rSubmesh.BaseVertex; i < rSubmesh.BaseVertex + rSubmesh.VertexCount; i++ )
+					m_Vertices[ i ] = VertexCompression::Dequantize( Vertices[ i ], rSubmesh.BoundingBox );
+			}
+		}
+		else
+		{
+			ReadSubmeshes();
+			RawSerialisation::ReadVector( m_Vertices, rStream );
+		}
+
+		m_CompactVertices = Format == MeshVertexFormat::Quantized;
 
 		RawSerialisation::ReadMatrix4x4( m_Transform, rStream );
 		RawSerialisation::ReadMatrix4x4( m_InverseTransform, rStream );
 
-		m_VertexBuffer = Ref<VertexBuffer>::Create( m_Vertices.data(), ( uint32_t ) ( m_Vertices.size() * sizeof( StaticVertex ) ) );
-		m_IndexBuffer = Ref<IndexBuffer>::Create( m_Indices.data(), m_Indices.size() * sizeof( Index ) );
+		// Older data has no meshlets, they only need LOD 0 so they can be built here.
+		if( Version < 3 )
+			BuildMeshlets();
+
+		UploadGeometry();
 
 		m_MeshShader = ShaderLibrary::Get().Find( "shader_new" );
 		m_BaseMaterial = Ref< Material >::Create( m_MeshShader, "Base Material" );
@@ -34,6 +34,9 @@
 #include "Shader.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
+#include "MeshGeometryPool.h"
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
 #include "Material.h"
 
 #include "Saturn/Asset/MaterialAsset.h"
@@ -58,6 +61,16 @@ struct aiScene;
 
 namespace Saturn {
 
+	// LOD 0 plus up to three simplified LODs.
+	constexpr uint32_t MAX_SUBMESH_LODS = 4;
+
+	// Index range of a simplified LOD, it uses the same vertices as LOD 0.
+	struct SubmeshLod
+	{
+		uint32_t BaseIndex;
+		uint32_t IndexCount;
+	};
+
 	class Submesh
 	{
 	public:
@@ -71,7 +84,25 @@ namespace Saturn {
 		AABB BoundingBox;
 
 		std::string NodeName, MeshName;
+
+		// LOD 1 and up, BaseIndex and IndexCount are LOD 0.
+		std::vector<SubmeshLod> Lods;
+
+		// Meshlets of LOD 0 in the mesh's meshlet list.
+		uint32_t BaseMeshlet = 0;
+		uint32_t MeshletCount = 0;
 	public:
+		uint32_t GetLodCount() const { return ( uint32_t ) Lods.size() + 1; }
+
+		// Clamped to the last LOD.
+		SubmeshLod GetLod( uint32_t Lod ) const
+		{
+			if( Lod == 0 || Lods.empty() )
+				return { BaseIndex, IndexCount };
+
+			return Lods[ std::min( Lod, ( uint32_t ) Lods.size() ) - 1 ];
+		}
+
 		bool operator==( const Submesh& other ) const
 		{
 			return BaseVertex == other.BaseVertex && BaseIndex == other.BaseIndex && MaterialIndex == other.MaterialIndex && IndexCount == other.IndexCount && VertexCount == other.VertexCount && NodeName == other.NodeName && MeshName == other.MeshName;
@@ -152,8 +183,8 @@ namespace Saturn {
 		std::vector<Submesh>& Submeshes() { return m_Submeshes; }
 		const std::vector<Submesh>& Submeshes() const { return m_Submeshes; }
 
-		Ref<VertexBuffer> GetVertexBuffer() { return m_VertexBuffer; }
-		Ref<IndexBuffer> GetIndexBuffer() { return m_IndexBuffer; }
+		// Where the vertices and indices are in the MeshGeometryPool, submesh offsets are relative to this.
+		const MeshGeometryRange& GetGeometryRange() const;
 
 		Ref<Shader> GetShader() { return m_MeshShader; }
 
@@ -163,6 +194,9 @@ namespace Saturn {
 		std::vector<Index>& Indices() { return m_Indices; }
 		const std::vector<Index>& Indices() const { return m_Indices; }
 
+		// Meshlets of every submesh, see Submesh::BaseMeshlet.
+		const std::vector<Meshlet>& Meshlets() const { return m_Meshlets; }
+
 		void SetAttachedShape( ShapeType type ) { m_AttachedPhysicsShape = type; }
 		const ShapeType GetAttachedShape() const { return m_AttachedPhysicsShape; }
 
@@ -172,6 +206,23 @@ namespace Saturn {
 		Ref<MaterialRegistry>& GetMaterialRegistry() { return m_MaterialRegistry; }
 		const Ref<MaterialRegistry>& GetMaterialRegistry() const { return m_MaterialRegistry; }
 
+		// Import option, the cooked mesh data stores QuantizedStaticVertex instead of StaticVertex.
+		void SetCompactVertices( bool Compact ) { m_CompactVertices = Compact; }
+		bool HasCompactVertices() const { return m_CompactVertices; }
+
+		// Vertex cache stats from the import, not available for meshes loaded from cooked data.
+		const MeshOptimizationStats& GetOptimizationStats() const { return m_OptimizationStats; }
+
+		static std::vector<float> GetDefaultLodRatios() { return { 0.5f, 0.25f, 0.125f }; }
+
+		// Target index count of every simplified LOD relative to LOD 0, an empty list disables LODs.
+		// Changing the ratios regenerates the LODs when the mesh was imported from its source file.
+		void SetLodRatios( const std::vector<float>& rRatios );
+		const std::vector<float>& GetLodRatios() const { return m_LodRatios; }
+
+		// False when the mesh was loaded from cooked data, the LODs can only be generated from the source file.
+		bool CanGenerateLods() const { return m_Scene != nullptr; }
+
 	public:
 		void SerialiseData( std::ofstream& rStream );
 		void DeserialiseData( std::istream& rStream );
@@ -180,10 +231,14 @@ namespace Saturn {
 		void TraverseNodes( aiNode* node, const glm::mat4& parentTransform = glm::mat4( 1.0f ), uint32_t level = 0 );
 		void CreateVertices();
 		void CreateMaterials();
+		void GenerateLods();
+		void BuildMeshlets();
+		void UploadGeometry();
 
 	private:
-		Ref<VertexBuffer> m_VertexBuffer;
-		Ref<IndexBuffer> m_IndexBuffer;
+		static constexpr uint32_t InvalidGeometryHandle = UINT32_MAX;
+
+		uint32_t m_GeometryHandle = InvalidGeometryHandle;
 
 		std::vector<StaticVertex> m_Vertices;
 		std::vector<Submesh> m_Submeshes;
@@ -191,6 +246,7 @@ namespace Saturn {
 		std::string m_FilePath;
 
 		std::vector<Index> m_Indices;
+		std::vector<Meshlet> m_Meshlets;
 
 		glm::mat4 m_InverseTransform = {};
 		glm::mat4 m_Transform = {};
@@ -205,6 +261,11 @@ namespace Saturn {
 		ShapeType m_AttachedPhysicsShape = ShapeType::Unknown;
 		AssetID m_PhysicsMaterial = 0;
 
+		bool m_CompactVertices = false;
+		MeshOptimizationStats m_OptimizationStats;
+
+		std::vector<float> m_LodRatios = GetDefaultLodRatios();
+
 		Ref<MaterialRegistry> m_MaterialRegistry;
 
 		std::unique_ptr<Assimp::Importer> m_Importer;
@@ -0,0 +1,424 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "MeshGeometryPool.h"
+
+#include "VulkanContext.h"
+#include "VulkanAllocator.h"
+#include "VulkanDebug.h"
+#include "VertexCompression.h"
+
+namespace Saturn {
+
+	static constexpr uint32_t s_InitialVertexCapacity = 256 * 1024;
+	static constexpr uint32_t s_InitialIndexCapacity = 1024 * 1024;
+	static constexpr uint32_t s_InitialMeshletCapacity = 16 * 1024;
+
+	MeshGeometryPool::MeshGeometryPool()
+	{
+		m_VertexArena.Usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		m_VertexArena.Stride = sizeof( CompactStaticVertex );
+		m_VertexArena.pName = "Mesh Geometry Pool Vertices";
+
+		// Cluster culling copies the visible triangles out of the index arena.
+		m_IndexArena.Usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		m_IndexArena.Stride = sizeof( uint32_t );
+		m_IndexArena.pName = "Mesh Geometry Pool Indices";
+
+		m_MeshletArena.Usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		m_MeshletArena.Stride = sizeof( Meshlet );
+		m_MeshletArena.pName = "Mesh Geometry Pool Meshlets";
+
+		CreateArena( m_VertexArena, s_InitialVertexCapacity );
+		CreateArena( m_IndexArena, s_InitialIndexCapacity );
+		CreateArena( m_MeshletArena, s_InitialMeshletCapacity );
+	}
+
+	MeshGeometryPool::~MeshGeometryPool()
+	{
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			for( VkBuffer Buffer : m_RetiredBuffers[ i ] )
+				pAllocator->DestroyBuffer( Buffer );
+
+			m_RetiredBuffers[ i ].clear();
+			m_PendingFrees[ i ].clear();
+		}
+
+		pAllocator->DestroyBuffer( m_VertexArena.Buffer );
+		pAllocator->DestroyBuffer( m_IndexArena.Buffer );
+		pAllocator->DestroyBuffer( m_MeshletArena.Buffer );
+
+		m_VertexArena.Buffer = VK_NULL_HANDLE;
+		m_IndexArena.Buffer = VK_NULL_HANDLE;
+		m_MeshletArena.Buffer = VK_NULL_HANDLE;
+	}
+
+	uint32_t MeshGeometryPool::Allocate( const std::vector<StaticVertex>& rVertices, const std::vector<Index>& rIndices, const std::vector<Meshlet>& rMeshlets )
+	{
+		SAT_PF_EVENT();
+
+		SAT_CORE_ASSERT( !rVertices.empty() && !rIndices.empty(), "Mesh geometry must have vertices and indices!" );
+
+		MeshGeometryRange Range;
+		Range.VertexCount = ( uint32_t ) rVertices.size();
+		Range.IndexCount = ( uint32_t ) rIndices.size() * 3;
+		Range.MeshletCount = ( uint32_t ) rMeshlets.size();
+
+		Range.VertexOffset = AllocateBlock( m_VertexArena, Range.VertexCount );
+		Range.IndexOffset = AllocateBlock( m_IndexArena, Range.IndexCount );
+
+		if( Range.MeshletCount )
+			Range.MeshletOffset = AllocateBlock( m_MeshletArena, Range.MeshletCount );
+
+		std::vector<CompactStaticVertex> CompactVertices( rVertices.size() );
+
+		for( size_t i = 0; i < rVertices.size(); i++ )
+			CompactVertices[ i ] = VertexCompression::Compress( rVertices[ i ] );
+
+		Upload( m_VertexArena, Range.VertexOffset, CompactVertices.data(), Range.VertexCount );
+		Upload( m_IndexArena, Range.IndexOffset, rIndices.data(), Range.IndexCount );
+
+		if( Range.MeshletCount )
+			Upload( m_MeshletArena, Range.MeshletOffset, rMeshlets.data(), Range.MeshletCount );
+
+		uint32_t Handle = 0;
+
+		if( m_FreeHandles.size() )
+		{
+			Handle = m_FreeHandles.back();
+			m_FreeHandles.pop_back();
+
+			m_Ranges[ Handle ] = Range;
+		}
+		else
+		{
+			Handle = ( uint32_t ) m_Ranges.size();
+			m_Ranges.push_back( Range );
+		}
+
+		return Handle;
+	}
+
+	void MeshGeometryPool::Free( uint32_t Handle )
+	{
+		// Frames in flight may still draw from the range.
+		m_PendingFrees[ m_CurrentFrame ].push_back( Handle );
+	}
+
+	void MeshGeometryPool::BeginFrame( uint32_t Frame )
+	{
+		m_CurrentFrame = Frame;
+
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		// The last time this frame was used was MAX_FRAMES_IN_FLIGHT frames ago, so nothing can be using these.
+		for( VkBuffer Buffer : m_RetiredBuffers[ Frame ] )
+			pAllocator->DestroyBuffer( Buffer );
+
+		m_RetiredBuffers[ Frame ].clear();
+
+		if( m_PendingFrees[ Frame ].empty() )
+		{
+			if( m_DefragmentRequested )
+				Defragment();
+
+			return;
+		}
+
+		for( uint32_t Handle : m_PendingFrees[ Frame ] )
+		{
+			MeshGeometryRange& rRange = m_Ranges[ Handle ];
+
+			// Zero when the range was dropped by Defragment.
+			if( rRange.VertexCount )
+				ReleaseBlock( m_VertexArena, rRange.VertexOffset, rRange.VertexCount );
+
+			if( rRange.IndexCount )
+				ReleaseBlock( m_IndexArena, rRange.IndexOffset, rRange.IndexCount );
+
+			if( rRange.MeshletCount )
+				ReleaseBlock( m_MeshletArena, rRange.MeshletOffset, rRange.MeshletCount );
+
+			rRange = {};
+			m_FreeHandles.push_back( Handle );
+		}
+
+		m_PendingFrees[ Frame ].clear();
+
+		// Holes can be re-used by meshes that fit, but unloading a level leaves lots of small ones.
+		if( m_DefragmentRequested || GetFragmentedCount( m_VertexArena ) > m_VertexArena.Capacity / 4 || GetFragmentedCount( m_IndexArena ) > m_IndexArena.Capacity / 4
+			|| GetFragmentedCount( m_MeshletArena ) > m_MeshletArena.Capacity / 4 )
+			Defragment();
+	}
+
+	void MeshGeometryPool::Bind( VkCommandBuffer CommandBuffer )
+	{
+		VkDeviceSize Offsets[] = { 0 };
+
+		vkCmdBindVertexBuffers( CommandBuffer, 0, 1, &m_VertexArena.Buffer, Offsets );
+		vkCmdBindIndexBuffer( CommandBuffer, m_IndexArena.Buffer, 0, VK_INDEX_TYPE_UINT32 );
+	}
+
+	void MeshGeometryPool::Defragment()
+	{
+		SAT_PF_EVENT();
+
+		// Ranges that are waiting to be freed are not copied, frames in flight still read them from the old buffers.
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			for( uint32_t Handle : m_PendingFrees[ i ] )
+				m_Ranges[ Handle ] = {};
+		}
+
+		Arena OldVertexArena = m_VertexArena;
+		Arena OldIndexArena = m_IndexArena;
+		Arena OldMeshletArena = m_MeshletArena;
+
+		CreateArena( m_VertexArena, OldVertexArena.Capacity );
+		CreateArena( m_IndexArena, OldIndexArena.Capacity );
+		CreateArena( m_MeshletArena, OldMeshletArena.Capacity );
+
+		std::vector<VkBufferCopy> VertexCopies;
+		std::vector<VkBufferCopy> IndexCopies;
+		std::vector<VkBufferCopy> MeshletCopies;
+
+		for( MeshGeometryRange& rRange : m_Ranges )
+		{
+			if( !rRange.VertexCount )
+				continue;
+
+			VertexCopies.push_back( { ( VkDeviceSize ) rRange.VertexOffset * m_VertexArena.Stride, ( VkDeviceSize ) m_VertexArena.Used * m_VertexArena.Stride, ( VkDeviceSize ) rRange.VertexCount * m_VertexArena.Stride } );
+			IndexCopies.push_back( { ( VkDeviceSize ) rRange.IndexOffset * m_IndexArena.Stride, ( VkDeviceSize ) m_IndexArena.Used * m_IndexArena.Stride, ( VkDeviceSize ) rRange.IndexCount * m_IndexArena.Stride } );
+
+			rRange.VertexOffset = m_VertexArena.Used;
+			rRange.IndexOffset = m_IndexArena.Used;
+
+			m_VertexArena.Used += rRange.VertexCount;
+			m_IndexArena.Used += rRange.IndexCount;
+
+			if( rRange.MeshletCount )
+			{
+				MeshletCopies.push_back( { ( VkDeviceSize ) rRange.MeshletOffset * m_MeshletArena.Stride, ( VkDeviceSize ) m_MeshletArena.Used * m_MeshletArena.Stride, ( VkDeviceSize ) rRange.MeshletCount * m_MeshletArena.Stride } );
+
+				rRange.MeshletOffset = m_MeshletArena.Used;
+				m_MeshletArena.Used += rRange.MeshletCount;
+			}
+		}
+
+		m_VertexArena.FreeBlocks = { { m_VertexArena.Used, m_VertexArena.Capacity - m_VertexArena.Used } };
+		m_IndexArena.FreeBlocks = { { m_IndexArena.Used, m_IndexArena.Capacity - m_IndexArena.Used } };
+		m_MeshletArena.FreeBlocks = { { m_MeshletArena.Used, m_MeshletArena.Capacity - m_MeshletArena.Used } };
+
+		if( VertexCopies.size() )
+		{
+			VkCommandBuffer CommandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
+
+			vkCmdCopyBuffer( CommandBuffer, OldVertexArena.Buffer, m_VertexArena.Buffer, ( uint32_t ) VertexCopies.size(), VertexCopies.data() );
+			vkCmdCopyBuffer( CommandBuffer, OldIndexArena.Buffer, m_IndexArena.Buffer, ( uint32_t ) IndexCopies.size(), IndexCopies.data() );
+
+			if( MeshletCopies.size() )
+				vkCmdCopyBuffer( CommandBuffer, OldMeshletArena.Buffer, m_MeshletArena.Buffer, ( uint32_t ) MeshletCopies.size(), MeshletCopies.data() );
+
+			VulkanContext::Get().EndSingleTimeCommands( CommandBuffer );
+		}
+
+		RetireBuffer( OldVertexArena.Buffer );
+		RetireBuffer( OldIndexArena.Buffer );
+		RetireBuffer( OldMeshletArena.Buffer );
+
+		m_DefragmentCount++;
+		m_DefragmentRequested = false;
+
+		SAT_CORE_INFO( "Mesh geometry pool defragmented, {0} vertices and {1} indices in use.", m_VertexArena.Used, m_IndexArena.Used );
+	}
+
+	void MeshGeometryPool::CreateArena( Arena& rArena, uint32_t Capacity )
+	{
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		BufferCreateInfo.size = ( VkDeviceSize ) Capacity * rArena.Stride;
+		BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | rArena.Usage;
+		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_GPU_ONLY, &rArena.Buffer );
+		SetDebugUtilsObjectName( rArena.pName, ( uint64_t ) rArena.Buffer, VK_OBJECT_TYPE_BUFFER );
+
+		rArena.Capacity = Capacity;
+		rArena.Used = 0;
+		rArena.FreeBlocks = { { 0, Capacity } };
+	}
+
+	void MeshGeometryPool::GrowArena( Arena& rArena, uint32_t Count )
+	{
+		SAT_PF_EVENT();
+
+		Arena OldArena = rArena;
+
+		uint32_t NewCapacity = std::max( OldArena.Capacity * 2, OldArena.Capacity + Count );
+
+		CreateArena( rArena, NewCapacity );
+
+		// Everything up to the old capacity is copied, the new space at the end is free.
+		rArena.Used = OldArena.Used;
+		rArena.FreeBlocks = OldArena.FreeBlocks;
+
+		VkCommandBuffer CommandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
+
+		VkBufferCopy CopyRegion = {};
+		CopyRegion.size = ( VkDeviceSize ) OldArena.Capacity * rArena.Stride;
+
+		vkCmdCopyBuffer( CommandBuffer, OldArena.Buffer, rArena.Buffer, 1, &CopyRegion );
+
+		VulkanContext::Get().EndSingleTimeCommands( CommandBuffer );
+
+		RetireBuffer( OldArena.Buffer );
+
+		uint32_t Added = NewCapacity - OldArena.Capacity;
+
+		if( rArena.FreeBlocks.size() && rArena.FreeBlocks.back().Offset + rArena.FreeBlocks.back().Count == OldArena.Capacity )
+			rArena.FreeBlocks.back().Count += Added;
+		else
+			rArena.FreeBlocks.push_back( { OldArena.Capacity, Added } );
+
+		SAT_CORE_INFO( "{0} grown to {1} elements.", rArena.pName, NewCapacity );
+	}
+
+	uint32_t MeshGeometryPool::AllocateBlock( Arena& rArena, uint32_t Count )
+	{
+		for( size_t i = 0; i < rArena.FreeBlocks.size(); i++ )
+		{
+			FreeBlock& rBlock = rArena.FreeBlocks[ i ];
+
+			if( rBlock.Count < Count )
+				continue;
+
+			uint32_t Offset = rBlock.Offset;
+
+			rBlock.Offset += Count;
+			rBlock.Count -= Count;
+
+			if( rBlock.Count == 0 )
+				rArena.FreeBlocks.erase( rArena.FreeBlocks.begin() + i );
+
+			rArena.Used += Count;
+
+			return Offset;
+		}
+
+		GrowArena( rArena, Count );
+
+		return AllocateBlock( rArena, Count );
+	}
+
+	void MeshGeometryPool::ReleaseBlock( Arena& rArena, uint32_t Offset, uint32_t Count )
+	{
+		auto& rBlocks = rArena.FreeBlocks;
+
+		auto Itr = std::lower_bound( rBlocks.begin(), rBlocks.end(), Offset, []( const FreeBlock& rBlock, uint32_t Offset ) { return rBlock.Offset < Offset; } );
+
+		Itr = rBlocks.insert( Itr, { Offset, Count } );
+
+		// Merge with the next block.
+		auto Next = Itr + 1;
+		if( Next != rBlocks.end() && Itr->Offset + Itr->Count == Next->Offset )
+		{
+			Itr->Count += Next->Count;
+			rBlocks.erase( Next );
+		}
+
+		// Merge with the previous block.
+		if( Itr != rBlocks.begin() )
+		{
+			auto Prev = Itr - 1;
+
+			if( Prev->Offset + Prev->Count == Itr->Offset )
+			{
+				Prev->Count += Itr->Count;
+				rBlocks.erase( Itr );
+			}
+		}
+
+		rArena.Used -= Count;
+	}
+
+	void MeshGeometryPool::Upload( Arena& rArena, uint32_t Offset, const void* pData, uint32_t Count )
+	{
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+
+		VkDeviceSize Size = ( VkDeviceSize ) Count * rArena.Stride;
+
+		VkBuffer StagingBuffer;
+
+		VkBufferCreateInfo BufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+		BufferCreateInfo.size = Size;
+		BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		auto StagingAllocation = pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &StagingBuffer );
+
+		void* pDstData = pAllocator->MapMemory< void >( StagingAllocation );
+		memcpy( pDstData, pData, Size );
+		pAllocator->UnmapMemory( StagingAllocation );
+
+		VkCommandBuffer CommandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
+
+		VkBufferCopy CopyRegion = {};
+		CopyRegion.dstOffset = ( VkDeviceSize ) Offset * rArena.Stride;
+		CopyRegion.size = Size;
+
+		vkCmdCopyBuffer( CommandBuffer, StagingBuffer, rArena.Buffer, 1, &CopyRegion );
+
+		VulkanContext::Get().EndSingleTimeCommands( CommandBuffer );
+
+		pAllocator->DestroyBuffer( StagingBuffer );
+	}
+
+	void MeshGeometryPool::RetireBuffer( VkBuffer Buffer )
+	{
+		m_RetiredBuffers[ m_CurrentFrame ].push_back( Buffer );
+	}
+
+	uint32_t MeshGeometryPool::GetFragmentedCount( const Arena& rArena ) const
+	{
+		uint32_t Count = 0;
+
+		for( const FreeBlock& rBlock : rArena.FreeBlocks )
+		{
+			// The space at the end is not a hole.
+			if( rBlock.Offset + rBlock.Count != rArena.Capacity )
+				Count += rBlock.Count;
+		}
+
+		return Count;
+	}
+}
@@ -0,0 +1,153 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Meshlet.h"
+
+#include <vulkan.h>
+#include <vma/vk_mem_alloc.h>
+#include <vector>
+
+namespace Saturn {
+
+	// Where a mesh lives in the pool, in vertices, indices and meshlets. Add to the submesh's BaseVertex, BaseIndex and BaseMeshlet when drawing.
+	struct MeshGeometryRange
+	{
+		uint32_t VertexOffset = 0;
+		uint32_t VertexCount = 0;
+
+		uint32_t IndexOffset = 0;
+		uint32_t IndexCount = 0;
+
+		uint32_t MeshletOffset = 0;
+		uint32_t MeshletCount = 0;
+	};
+
+	// One vertex buffer, one index buffer and one meshlet buffer for every static mesh, meshes are sub-allocated from them.
+	// Freed ranges are only re-used once no frame in flight can read them, when too much of the arenas are holes they are compacted into new buffers.
+	class MeshGeometryPool
+	{
+	public:
+		MeshGeometryPool();
+		~MeshGeometryPool();
+
+		// Compresses and uploads the geometry, returns the handle for the allocation. Vertices are stored as CompactStaticVertex.
+		uint32_t Allocate( const std::vector<StaticVertex>& rVertices, const std::vector<Index>& rIndices, const std::vector<Meshlet>& rMeshlets );
+		void Free( uint32_t Handle );
+
+		// Ranges move when the pool is compacted, do not keep them.
+		const MeshGeometryRange& GetRange( uint32_t Handle ) const { return m_Ranges[ Handle ]; }
+
+		// Called from Renderer::BeginFrame once the fence for "Frame" has been waited on.
+		void BeginFrame( uint32_t Frame );
+
+		// Binds the vertex arena to binding 0 and the index arena.
+		void Bind( VkCommandBuffer CommandBuffer );
+
+		// Defragments on the next BeginFrame, buffers can not be swapped while a frame is being recorded.
+		void RequestDefragment() { m_DefragmentRequested = true; }
+
+		VkBuffer GetVertexBuffer() const { return m_VertexArena.Buffer; }
+		VkBuffer GetIndexBuffer() const { return m_IndexArena.Buffer; }
+
+		// The index and meshlet arenas can also be read as storage buffers.
+		VkBuffer GetMeshletBuffer() const { return m_MeshletArena.Buffer; }
+
+		uint32_t GetAllocationCount() const { return ( uint32_t ) ( m_Ranges.size() - m_FreeHandles.size() ); }
+
+		uint32_t GetVerticesUsed() const { return m_VertexArena.Used; }
+		uint32_t GetVertexCapacity() const { return m_VertexArena.Capacity; }
+		uint32_t GetIndicesUsed() const { return m_IndexArena.Used; }
+		uint32_t GetIndexCapacity() const { return m_IndexArena.Capacity; }
+		uint32_t GetMeshletsUsed() const { return m_MeshletArena.Used; }
+
+		uint32_t GetDefragmentCount() const { return m_DefragmentCount; }
+
+	private:
+		// Moves every allocation to the start of new buffers.
+		void Defragment();
+
+	private:
+		struct FreeBlock
+		{
+			uint32_t Offset = 0;
+			uint32_t Count = 0;
+		};
+
+		struct Arena
+		{
+			VkBuffer Buffer = VK_NULL_HANDLE;
+			VkBufferUsageFlags Usage = 0;
+			uint32_t Stride = 0;
+			const char* pName = nullptr;
+
+			// In elements.
+			uint32_t Capacity = 0;
+			uint32_t Used = 0;
+
+			// Sorted by offset, neighbours are always merged. Everything past the last allocation is also a block.
+			std::vector<FreeBlock> FreeBlocks;
+		};
+
+		void CreateArena( Arena& rArena, uint32_t Capacity );
+		// Grows "rArena" until "Count" more elements fit at the end, the contents are copied.
+		void GrowArena( Arena& rArena, uint32_t Count );
+
+		uint32_t AllocateBlock( Arena& rArena, uint32_t Count );
+		void ReleaseBlock( Arena& rArena, uint32_t Offset, uint32_t Count );
+
+		void Upload( Arena& rArena, uint32_t Offset, const void* pData, uint32_t Count );
+
+		// The buffer may still be used by a frame in flight.
+		void RetireBuffer( VkBuffer Buffer );
+
+		// Elements in the holes between allocations.
+		uint32_t GetFragmentedCount( const Arena& rArena ) const;
+
+	private:
+		Arena m_VertexArena;
+		Arena m_IndexArena;
+		Arena m_MeshletArena;
+
+		std::vector<MeshGeometryRange> m_Ranges;
+		std::vector<uint32_t> m_FreeHandles;
+
+		// Ranges and buffers can only be released once no frame in flight can read them.
+		std::vector<uint32_t> m_PendingFrees[ MAX_FRAMES_IN_FLIGHT ];
+		std::vector<VkBuffer> m_RetiredBuffers[ MAX_FRAMES_IN_FLIGHT ];
+
+		uint32_t m_CurrentFrame = 0;
+		uint32_t m_DefragmentCount = 0;
+		bool m_DefragmentRequested = false;
+	};
+}
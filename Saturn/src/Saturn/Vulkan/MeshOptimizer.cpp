@@ -0,0 +1,317 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+
+namespace Saturn {
+
+	void MeshOptimizer::OptimizeSubmesh( StaticVertex* pVertices, uint32_t VertexCount, uint32_t* pIndices, uint32_t IndexCount, MeshOptimizationStats& rStats )
+	{
+		SAT_PF_EVENT();
+
+		if( IndexCount < 3 || VertexCount == 0 )
+			return;
+
+		VertexCacheStats Before = AnalyzeVertexCache( pIndices, IndexCount, VertexCount );
+
+		std::vector<uint32_t> Clusters = OptimizeVertexCache( pIndices, IndexCount, VertexCount );
+
+		// Allow 5% more cache misses for less overdraw.
+		OptimizeOverdraw( pIndices, IndexCount, pVertices, VertexCount, Clusters, 1.05f );
+
+		OptimizeVertexFetch( pVertices, VertexCount, pIndices, IndexCount );
+
+		rStats.Before += Before;
+		rStats.After += AnalyzeVertexCache( pIndices, IndexCount, VertexCount );
+		rStats.Available = true;
+	}
+
+	std::vector<uint32_t> MeshOptimizer::OptimizeVertexCache( uint32_t* pIndices, uint32_t IndexCount, uint32_t VertexCount )
+	{
+		uint32_t TriangleCount = IndexCount / 3;
+
+		// Triangles that have not been emitted yet, per vertex.
+		std::vector<uint32_t> Live( VertexCount, 0 );
+
+		for( uint32_t i = 0; i < IndexCount; i++ )
+			Live[ pIndices[ i ] ]++;
+
+		// Vertex to triangle adjacency, the triangles of vertex "v" are Adjacency[ Offsets[ v ] ] to Adjacency[ Offsets[ v + 1 ] ].
+		std::vector<uint32_t> Offsets( VertexCount + 1, 0 );
+
+		for( uint32_t v = 0; v < VertexCount; v++ )
+			Offsets[ v + 1 ] = Offsets[ v ] + Live[ v ];
+
+		std::vector<uint32_t> Adjacency( IndexCount );
+		std::vector<uint32_t> Fill( Offsets.begin(), Offsets.end() - 1 );
+
+		for( uint32_t t = 0; t < TriangleCount; t++ )
+		{
+			for( uint32_t k = 0; k < 3; k++ )
+				Adjacency[ Fill[ pIndices[ t * 3 + k ] ]++ ] = t;
+		}
+
+		std::vector<uint32_t> Timestamps( VertexCount, 0 );
+		std::vector<bool> Emitted( TriangleCount, false );
+
+		std::vector<uint32_t> DeadEnds;
+		std::vector<uint32_t> Candidates;
+
+		std::vector<uint32_t> Output;
+		Output.reserve( IndexCount );
+
+		std::vector<uint32_t> Clusters;
+
+		uint32_t Time = CacheSize + 1;
+		uint32_t Cursor = 0;
+
+		auto SkipDeadEnd = [&]() -> int64_t
+		{
+			// Recently used vertices first, they may still be in the cache.
+			while( DeadEnds.size() )
+			{
+				uint32_t Vertex = DeadEnds.back();
+				DeadEnds.pop_back();
+
+				if( Live[ Vertex ] > 0 )
+					return Vertex;
+			}
+
+			while( Cursor < VertexCount )
+			{
+				if( Live[ Cursor ] > 0 )
+					return Cursor;
+
+				Cursor++;
+			}
+
+			return -1;
+		};
+
+		auto GetNextVertex = [&]() -> int64_t
+		{
+			int64_t Best = -1;
+			int64_t BestPriority = -1;
+
+			for( uint32_t Vertex : Candidates )
+			{
+				if( Live[ Vertex ] == 0 )
+					continue;
+
+				// Only vertices that will still be in the cache once all of their triangles are emitted get a priority, older ones first.
+				int64_t Priority = 0;
+
+				if( Time - Timestamps[ Vertex ] + 2 * Live[ Vertex ] <= CacheSize )
+					Priority = Time - Timestamps[ Vertex ];
+
+				if( Priority > BestPriority )
+				{
+					Best = Vertex;
+					BestPriority = Priority;
+				}
+			}
+
+			return Best == -1 ? SkipDeadEnd() : Best;
+		};
+
+		int64_t Fan = SkipDeadEnd();
+
+		while( Fan != -1 )
+		{
+			if( Time - Timestamps[ Fan ] > CacheSize )
+				Clusters.push_back( ( uint32_t ) Output.size() / 3 );
+
+			Candidates.clear();
+
+			for( uint32_t i = Offsets[ Fan ]; i < Offsets[ Fan + 1 ]; i++ )
+			{
+				uint32_t Triangle = Adjacency[ i ];
+
+				if( Emitted[ Triangle ] )
+					continue;
+
+				for( uint32_t k = 0; k < 3; k++ )
+				{
+					uint32_t Vertex = pIndices[ Triangle * 3 + k ];
+
+					Output.push_back( Vertex );
+					DeadEnds.push_back( Vertex );
+					Candidates.push_back( Vertex );
+
+					Live[ Vertex ]--;
+
+					if( Time - Timestamps[ Vertex ] > CacheSize )
+						Timestamps[ Vertex ] = Time++;
+				}
+
+				Emitted[ Triangle ] = true;
+			}
+
+			Fan = GetNextVertex();
+		}
+
+		std::copy( Output.begin(), Output.end(), pIndices );
+
+		return Clusters;
+	}
+
+	void MeshOptimizer::OptimizeOverdraw( uint32_t* pIndices, uint32_t IndexCount, const StaticVertex* pVertices, uint32_t VertexCount, const std::vector<uint32_t>& rClusters, float Threshold )
+	{
+		if( rClusters.size() < 2 )
+			return;
+
+		uint32_t TriangleCount = IndexCount / 3;
+
+		struct Cluster
+		{
+			uint32_t Start = 0;
+			uint32_t End = 0;
+
+			glm::vec3 Centroid{ 0.0f };
+			glm::vec3 Normal{ 0.0f };
+			float Area = 0.0f;
+
+			float SortKey = 0.0f;
+		};
+
+		std::vector<Cluster> Clusters( rClusters.size() );
+
+		glm::vec3 MeshCentroid( 0.0f );
+		float MeshArea = 0.0f;
+
+		for( size_t c = 0; c < Clusters.size(); c++ )
+		{
+			Cluster& rCluster = Clusters[ c ];
+			rCluster.Start = rClusters[ c ];
+			rCluster.End = c + 1 < rClusters.size() ? rClusters[ c + 1 ] : TriangleCount;
+
+			for( uint32_t t = rCluster.Start; t < rCluster.End; t++ )
+			{
+				const StaticVertex& rA = pVertices[ pIndices[ t * 3 + 0 ] ];
+				const StaticVertex& rB = pVertices[ pIndices[ t * 3 + 1 ] ];
+				const StaticVertex& rC = pVertices[ pIndices[ t * 3 + 2 ] ];
+
+				// Degenerate triangles still count a little so empty clusters have a centroid.
+				float Area = glm::max( glm::length( glm::cross( rB.Position - rA.Position, rC.Position - rA.Position ) ) * 0.5f, FLT_EPSILON );
+
+				rCluster.Centroid += ( rA.Position + rB.Position + rC.Position ) / 3.0f * Area;
+				rCluster.Area += Area;
+
+				// Vertex normals do not depend on the winding order.
+				rCluster.Normal += ( rA.Normal + rB.Normal + rC.Normal ) * Area;
+			}
+
+			MeshCentroid += rCluster.Centroid;
+			MeshArea += rCluster.Area;
+
+			rCluster.Centroid /= rCluster.Area;
+		}
+
+		MeshCentroid /= MeshArea;
+
+		for( Cluster& rCluster : Clusters )
+		{
+			float Length = glm::length( rCluster.Normal );
+
+			if( Length > 0.0f )
+				rCluster.SortKey = glm::dot( rCluster.Centroid - MeshCentroid, rCluster.Normal / Length );
+		}
+
+		std::stable_sort( Clusters.begin(), Clusters.end(), []( const Cluster& rA, const Cluster& rB ) { return rA.SortKey > rB.SortKey; } );
+
+		std::vector<uint32_t> Sorted;
+		Sorted.reserve( IndexCount );
+
+		for( const Cluster& rCluster : Clusters )
+			Sorted.insert( Sorted.end(), pIndices + rCluster.Start * 3, pIndices + rCluster.End * 3 );
+
+		float CacheACMR = AnalyzeVertexCache( pIndices, IndexCount, VertexCount ).GetACMR();
+		float SortedACMR = AnalyzeVertexCache( Sorted.data(), IndexCount, VertexCount ).GetACMR();
+
+		if( SortedACMR <= CacheACMR * Threshold )
+			std::copy( Sorted.begin(), Sorted.end(), pIndices );
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch( StaticVertex* pVertices, uint32_t VertexCount, uint32_t* pIndices, uint32_t IndexCount )
+	{
+		std::vector<uint32_t> Remap( VertexCount, UINT32_MAX );
+		uint32_t Next = 0;
+
+		for( uint32_t i = 0; i < IndexCount; i++ )
+		{
+			uint32_t& rIndex = pIndices[ i ];
+
+			if( Remap[ rIndex ] == UINT32_MAX )
+				Remap[ rIndex ] = Next++;
+
+			rIndex = Remap[ rIndex ];
+		}
+
+		for( uint32_t v = 0; v < VertexCount; v++ )
+		{
+			if( Remap[ v ] == UINT32_MAX )
+				Remap[ v ] = Next++;
+		}
+
+		std::vector<StaticVertex> Reordered( VertexCount );
+
+		for( uint32_t v = 0; v < VertexCount; v++ )
+			Reordered[ Remap[ v ] ] = pVertices[ v ];
+
+		std::copy( Reordered.begin(), Reordered.end(), pVertices );
+	}
+
+	VertexCacheStats MeshOptimizer::AnalyzeVertexCache( const uint32_t* pIndices, uint32_t IndexCount, uint32_t VertexCount )
+	{
+		VertexCacheStats Stats;
+		Stats.Triangles = IndexCount / 3;
+
+		std::vector<uint32_t> Timestamps( VertexCount, 0 );
+		uint32_t Time = CacheSize + 1;
+
+		for( uint32_t i = 0; i < IndexCount; i++ )
+		{
+			uint32_t& rTimestamp = Timestamps[ pIndices[ i ] ];
+
+			if( rTimestamp == 0 )
+				Stats.Vertices++;
+
+			// FIFO, a hit does not refresh the entry.
+			if( Time - rTimestamp > CacheSize )
+			{
+				rTimestamp = Time++;
+				Stats.Transformed++;
+			}
+		}
+
+		return Stats;
+	}
+}
@@ -0,0 +1,91 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "VertexBuffer.h"
+
+#include <vector>
+
+namespace Saturn {
+
+	// Result of running an index buffer through a simulated FIFO post-transform cache.
+	struct VertexCacheStats
+	{
+		uint32_t Transformed = 0;
+		uint32_t Triangles = 0;
+		uint32_t Vertices = 0;
+
+		// Average cache miss ratio, transformed vertices per triangle. 0.5 is the best case, 3.0 the worst.
+		float GetACMR() const { return Triangles ? ( float ) Transformed / ( float ) Triangles : 0.0f; }
+		// Average transformed vertex ratio, how many times each vertex is transformed. 1.0 is the best case.
+		float GetATVR() const { return Vertices ? ( float ) Transformed / ( float ) Vertices : 0.0f; }
+
+		VertexCacheStats& operator+=( const VertexCacheStats& rOther )
+		{
+			Transformed += rOther.Transformed;
+			Triangles += rOther.Triangles;
+			Vertices += rOther.Vertices;
+
+			return *this;
+		}
+	};
+
+	struct MeshOptimizationStats
+	{
+		VertexCacheStats Before;
+		VertexCacheStats After;
+
+		// False when the mesh was loaded from cooked data.
+		bool Available = false;
+	};
+
+	// Reorders the triangles and vertices of a submesh, run once at import.
+	// Indices are relative to the vertices passed in, triangles never move between submeshes.
+	class MeshOptimizer
+	{
+	public:
+		static constexpr uint32_t CacheSize = 16;
+
+		// Runs every stage below in order.
+		static void OptimizeSubmesh( StaticVertex* pVertices, uint32_t VertexCount, uint32_t* pIndices, uint32_t IndexCount, MeshOptimizationStats& rStats );
+
+		// Tipsify, from "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (Sander, Nehab and Barczak 2007).
+		// Returns the first triangle of every cluster, a new cluster starts when the next fan vertex is not in the cache.
+		static std::vector<uint32_t> OptimizeVertexCache( uint32_t* pIndices, uint32_t IndexCount, uint32_t VertexCount );
+
+		// Sorts the clusters so that the ones facing away from the center of the mesh are drawn first, they are the most likely to occlude the rest.
+		// The new order is only kept when the ACMR stays under "Threshold" times the cache optimized ACMR.
+		static void OptimizeOverdraw( uint32_t* pIndices, uint32_t IndexCount, const StaticVertex* pVertices, uint32_t VertexCount, const std::vector<uint32_t>& rClusters, float Threshold );
+
+		// Moves the vertices into the order they are first used by the index buffer, unused vertices end up at the back.
+		static void OptimizeVertexFetch( StaticVertex* pVertices, uint32_t VertexCount, uint32_t* pIndices, uint32_t IndexCount );
+
+		static VertexCacheStats AnalyzeVertexCache( const uint32_t* pIndices, uint32_t IndexCount, uint32_t VertexCount );
+	};
+}
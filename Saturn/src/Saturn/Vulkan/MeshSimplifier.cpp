@@ -0,0 +1,390 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace Saturn {
+
+	// Symmetric 4x4 matrix, the sum of the squared distances to a set of planes.
+	struct Quadric
+	{
+		double A00 = 0.0, A01 = 0.0, A02 = 0.0, A03 = 0.0;
+		double A11 = 0.0, A12 = 0.0, A13 = 0.0;
+		double A22 = 0.0, A23 = 0.0;
+		double A33 = 0.0;
+
+		void AddPlane( double A, double B, double C, double D )
+		{
+			A00 += A * A; A01 += A * B; A02 += A * C; A03 += A * D;
+			A11 += B * B; A12 += B * C; A13 += B * D;
+			A22 += C * C; A23 += C * D;
+			A33 += D * D;
+		}
+
+		Quadric& operator+=( const Quadric& rOther )
+		{
+			A00 += rOther.A00; A01 += rOther.A01; A02 += rOther.A02; A03 += rOther.A03;
+			A11 += rOther.A11; A12 += rOther.A12; A13 += rOther.A13;
+			A22 += rOther.A22; A23 += rOther.A23;
+			A33 += rOther.A33;
+
+			return *this;
+		}
+
+		double Evaluate( const glm::vec3& rPoint ) const
+		{
+			double X = rPoint.x, Y = rPoint.y, Z = rPoint.z;
+
+			double Error = A00 * X * X + 2.0 * A01 * X * Y + 2.0 * A02 * X * Z + 2.0 * A03 * X
+				+ A11 * Y * Y + 2.0 * A12 * Y * Z + 2.0 * A13 * Y
+				+ A22 * Z * Z + 2.0 * A23 * Z
+				+ A33;
+
+			// Rounding can make it slightly negative.
+			return std::max( Error, 0.0 );
+		}
+	};
+
+	struct Collapse
+	{
+		double Cost = 0.0;
+
+		uint32_t From = 0;
+		uint32_t To = 0;
+
+		uint32_t FromVersion = 0;
+		uint32_t ToVersion = 0;
+
+		bool operator>( const Collapse& rOther ) const { return Cost > rOther.Cost; }
+	};
+
+	std::vector<uint32_t> MeshSimplifier::Simplify( const StaticVertex* pVertices, uint32_t VertexCount, const uint32_t* pIndices, uint32_t IndexCount, uint32_t TargetIndexCount, float MaxError )
+	{
+		SAT_PF_EVENT();
+
+		std::vector<uint32_t> Triangles( pIndices, pIndices + IndexCount );
+
+		if( IndexCount <= TargetIndexCount || VertexCount == 0 )
+			return Triangles;
+
+		uint32_t TriangleCount = IndexCount / 3;
+
+		//////////////////////////////////////////////////////////////////////////
+		// Vertices with the same position are one vertex to the simplifier, every copy with different attributes is a wedge.
+
+		std::vector<uint32_t> Order( VertexCount );
+
+		for( uint32_t v = 0; v < VertexCount; v++ )
+			Order[ v ] = v;
+
+		auto PositionLess = [&]( uint32_t A, uint32_t B )
+		{
+			const glm::vec3& rA = pVertices[ A ].Position;
+			const glm::vec3& rB = pVertices[ B ].Position;
+
+			if( rA.x != rB.x ) return rA.x < rB.x;
+			if( rA.y != rB.y ) return rA.y < rB.y;
+			return rA.z < rB.z;
+		};
+
+		std::sort( Order.begin(), Order.end(), PositionLess );
+
+		std::vector<uint32_t> Canonical( VertexCount );
+		std::vector<uint32_t> WedgeCount( VertexCount, 0 );
+
+		for( uint32_t i = 0; i < VertexCount; i++ )
+		{
+			bool SameAsPrevious = i > 0 && !PositionLess( Order[ i - 1 ], Order[ i ] );
+
+			Canonical[ Order[ i ] ] = SameAsPrevious ? Canonical[ Order[ i - 1 ] ] : Order[ i ];
+			WedgeCount[ Canonical[ Order[ i ] ] ]++;
+		}
+
+		// A vertex with more than one wedge is on a seam, collapsing it would tear the attributes.
+		std::vector<bool> Locked( VertexCount, false );
+
+		for( uint32_t v = 0; v < VertexCount; v++ )
+		{
+			if( WedgeCount[ v ] > 1 )
+				Locked[ v ] = true;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Open borders and non-manifold edges are locked as well.
+
+		std::vector<uint64_t> Edges;
+		Edges.reserve( IndexCount );
+
+		for( uint32_t t = 0; t < TriangleCount; t++ )
+		{
+			for( uint32_t k = 0; k < 3; k++ )
+			{
+				uint32_t A = Canonical[ Triangles[ t * 3 + k ] ];
+				uint32_t B = Canonical[ Triangles[ t * 3 + ( k + 1 ) % 3 ] ];
+
+				Edges.push_back( ( ( uint64_t ) std::min( A, B ) << 32 ) | std::max( A, B ) );
+			}
+		}
+
+		std::sort( Edges.begin(), Edges.end() );
+
+		for( size_t i = 0; i < Edges.size(); )
+		{
+			size_t Count = 1;
+
+			while( i + Count < Edges.size() && Edges[ i + Count ] == Edges[ i ] )
+				Count++;
+
+			if( Count != 2 )
+			{
+				Locked[ ( uint32_t ) ( Edges[ i ] >> 32 ) ] = true;
+				Locked[ ( uint32_t ) ( Edges[ i ] & 0xFFFFFFFF ) ] = true;
+			}
+
+			i += Count;
+		}
+
+		//////////////////////////////////////////////////////////////////////////
+		// Quadrics and adjacency.
+
+		std::vector<Quadric> Quadrics( VertexCount );
+		std::vector<std::vector<uint32_t>> Adjacency( VertexCount );
+
+		glm::vec3 BoundsMin( FLT_MAX );
+		glm::vec3 BoundsMax( -FLT_MAX );
+
+		for( uint32_t t = 0; t < TriangleCount; t++ )
+		{
+			const glm::vec3& rP0 = pVertices[ Triangles[ t * 3 + 0 ] ].Position;
+			const glm::vec3& rP1 = pVertices[ Triangles[ t * 3 + 1 ] ].Position;
+			const glm::vec3& rP2 = pVertices[ Triangles[ t * 3 + 2 ] ].Position;
+
+			glm::vec3 Normal = glm::cross( rP1 - rP0, rP2 - rP0 );
+			float Length = glm::length( Normal );
+
+			if( Length > 0.0f )
+			{
+				Normal /= Length;
+
+				Quadric Plane;
+				Plane.AddPlane( Normal.x, Normal.y, Normal.z, -glm::dot( Normal, rP0 ) );
+
+				for( uint32_t k = 0; k < 3; k++ )
+					Quadrics[ Canonical[ Triangles[ t * 3 + k ] ] ] += Plane;
+			}
+
+			for( uint32_t k = 0; k < 3; k++ )
+			{
+				uint32_t Vertex = Canonical[ Triangles[ t * 3 + k ] ];
+
+				Adjacency[ Vertex ].push_back( t );
+
+				BoundsMin = glm::min( BoundsMin, pVertices[ Vertex ].Position );
+				BoundsMax = glm::max( BoundsMax, pVertices[ Vertex ].Position );
+			}
+		}
+
+		double Extent = glm::length( BoundsMax - BoundsMin );
+
+		if( Extent <= 0.0 )
+			return Triangles;
+
+		double ErrorLimit = ( double ) MaxError * Extent;
+		ErrorLimit *= ErrorLimit;
+
+		//////////////////////////////////////////////////////////////////////////
+		// Collapse the cheapest edge until we reach the target, entries in the queue go stale when either vertex changes.
+
+		std::vector<bool> RemovedVertex( VertexCount, false );
+		std::vector<bool> RemovedTriangle( TriangleCount, false );
+		std::vector<uint32_t> Versions( VertexCount, 0 );
+
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> Queue;
+
+		auto PushCollapse = [&]( uint32_t From, uint32_t To )
+		{
+			if( Locked[ From ] )
+				return;
+
+			Quadric Combined = Quadrics[ From ];
+			Combined += Quadrics[ To ];
+
+			Queue.push( { Combined.Evaluate( pVertices[ To ].Position ), From, To, Versions[ From ], Versions[ To ] } );
+		};
+
+		for( uint32_t t = 0; t < TriangleCount; t++ )
+		{
+			for( uint32_t k = 0; k < 3; k++ )
+			{
+				uint32_t A = Canonical[ Triangles[ t * 3 + k ] ];
+				uint32_t B = Canonical[ Triangles[ t * 3 + ( k + 1 ) % 3 ] ];
+
+				if( A == B )
+					continue;
+
+				PushCollapse( A, B );
+				PushCollapse( B, A );
+			}
+		}
+
+		auto ContainsVertex = [&]( uint32_t Triangle, uint32_t Vertex )
+		{
+			return Canonical[ Triangles[ Triangle * 3 + 0 ] ] == Vertex || Canonical[ Triangles[ Triangle * 3 + 1 ] ] == Vertex || Canonical[ Triangles[ Triangle * 3 + 2 ] ] == Vertex;
+		};
+
+		uint32_t LiveTriangles = TriangleCount;
+
+		while( LiveTriangles * 3 > TargetIndexCount && !Queue.empty() )
+		{
+			Collapse Top = Queue.top();
+			Queue.pop();
+
+			uint32_t From = Top.From;
+			uint32_t To = Top.To;
+
+			if( RemovedVertex[ From ] || RemovedVertex[ To ] || Versions[ From ] != Top.FromVersion || Versions[ To ] != Top.ToVersion )
+				continue;
+
+			if( Top.Cost > ErrorLimit )
+				break;
+
+			// The wedge of "To" that the triangles of "From" will use, "From" has a single wedge as it is not locked.
+			uint32_t Wedge = UINT32_MAX;
+
+			for( uint32_t Triangle : Adjacency[ From ] )
+			{
+				if( RemovedTriangle[ Triangle ] || !ContainsVertex( Triangle, To ) )
+					continue;
+
+				for( uint32_t k = 0; k < 3; k++ )
+				{
+					if( Canonical[ Triangles[ Triangle * 3 + k ] ] == To )
+						Wedge = Triangles[ Triangle * 3 + k ];
+				}
+
+				break;
+			}
+
+			// The edge does not exist anymore.
+			if( Wedge == UINT32_MAX )
+				continue;
+
+			// Reject collapses that would flip a triangle.
+			bool Flips = false;
+
+			for( uint32_t Triangle : Adjacency[ From ] )
+			{
+				if( RemovedTriangle[ Triangle ] || ContainsVertex( Triangle, To ) )
+					continue;
+
+				glm::vec3 Before[ 3 ];
+				glm::vec3 After[ 3 ];
+
+				for( uint32_t k = 0; k < 3; k++ )
+				{
+					uint32_t Vertex = Canonical[ Triangles[ Triangle * 3 + k ] ];
+
+					Before[ k ] = pVertices[ Vertex ].Position;
+					After[ k ] = Vertex == From ? pVertices[ To ].Position : Before[ k ];
+				}
+
+				glm::vec3 NormalBefore = glm::cross( Before[ 1 ] - Before[ 0 ], Before[ 2 ] - Before[ 0 ] );
+				glm::vec3 NormalAfter = glm::cross( After[ 1 ] - After[ 0 ], After[ 2 ] - After[ 0 ] );
+
+				if( glm::dot( NormalBefore, NormalAfter ) <= 0.0f )
+				{
+					Flips = true;
+					break;
+				}
+			}
+
+			if( Flips )
+				continue;
+
+			for( uint32_t Triangle : Adjacency[ From ] )
+			{
+				if( RemovedTriangle[ Triangle ] )
+					continue;
+
+				if( ContainsVertex( Triangle, To ) )
+				{
+					RemovedTriangle[ Triangle ] = true;
+					LiveTriangles--;
+
+					continue;
+				}
+
+				for( uint32_t k = 0; k < 3; k++ )
+				{
+					if( Canonical[ Triangles[ Triangle * 3 + k ] ] == From )
+						Triangles[ Triangle * 3 + k ] = Wedge;
+				}
+
+				Adjacency[ To ].push_back( Triangle );
+			}
+
+			Adjacency[ From ].clear();
+
+			Quadrics[ To ] += Quadrics[ From ];
+			RemovedVertex[ From ] = true;
+			Versions[ To ]++;
+
+			for( uint32_t Triangle : Adjacency[ To ] )
+			{
+				if( RemovedTriangle[ Triangle ] )
+					continue;
+
+				for( uint32_t k = 0; k < 3; k++ )
+				{
+					uint32_t Neighbour = Canonical[ Triangles[ Triangle * 3 + k ] ];
+
+					if( Neighbour == To )
+						continue;
+
+					PushCollapse( To, Neighbour );
+					PushCollapse( Neighbour, To );
+				}
+			}
+		}
+
+		std::vector<uint32_t> Result;
+		Result.reserve( LiveTriangles * 3 );
+
+		for( uint32_t t = 0; t < TriangleCount; t++ )
+		{
+			if( !RemovedTriangle[ t ] )
+				Result.insert( Result.end(), Triangles.begin() + t * 3, Triangles.begin() + t * 3 + 3 );
+		}
+
+		return Result;
+	}
+}
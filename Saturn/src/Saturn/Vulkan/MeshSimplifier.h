@@ -0,0 +1,46 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "VertexBuffer.h"
+
+#include <vector>
+
+namespace Saturn {
+
+	// Quadric error edge collapse simplification, "Surface Simplification Using Quadric Error Metrics" (Garland and Heckbert 1997).
+	// Edges are collapsed into one of their vertices, vertices are never moved or added so LODs can share the vertices of LOD 0.
+	class MeshSimplifier
+	{
+	public:
+		// Collapses the cheapest edges until at most "TargetIndexCount" indices are left, or until the next collapse would move the surface further than "MaxError".
+		// "MaxError" is relative to the size of the submesh. UV seams and open borders are locked so the texture mapping and the silhouette stay intact.
+		static std::vector<uint32_t> Simplify( const StaticVertex* pVertices, uint32_t VertexCount, const uint32_t* pIndices, uint32_t IndexCount, uint32_t TargetIndexCount, float MaxError );
+	};
+}
@@ -0,0 +1,153 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "Meshlet.h"
+
+namespace Saturn {
+
+	void MeshletBuilder::Build( const StaticVertex* pVertices, uint32_t VertexCount, const uint32_t* pIndices, uint32_t IndexCount, std::vector<Meshlet>& rMeshlets )
+	{
+		SAT_PF_EVENT();
+
+		// Meshlet that last used a vertex, plus one.
+		std::vector<uint32_t> LastMeshlet( VertexCount, 0 );
+
+		uint32_t MeshletID = 1;
+		uint32_t FirstIndex = 0;
+		uint32_t UniqueVertices = 0;
+
+		for( uint32_t i = 0; i < IndexCount; i += 3 )
+		{
+			uint32_t NewVertices = 0;
+
+			for( uint32_t k = 0; k < 3; k++ )
+			{
+				if( LastMeshlet[ pIndices[ i + k ] ] != MeshletID )
+					NewVertices++;
+			}
+
+			// The triangle does not fit, close the meshlet.
+			if( UniqueVertices + NewVertices > MESHLET_MAX_VERTICES || ( i - FirstIndex ) / 3 == MESHLET_MAX_TRIANGLES )
+			{
+				rMeshlets.push_back( ComputeBounds( pVertices, pIndices, FirstIndex, i - FirstIndex ) );
+
+				MeshletID++;
+				FirstIndex = i;
+				UniqueVertices = 0;
+			}
+
+			for( uint32_t k = 0; k < 3; k++ )
+			{
+				if( LastMeshlet[ pIndices[ i + k ] ] != MeshletID )
+				{
+					LastMeshlet[ pIndices[ i + k ] ] = MeshletID;
+					UniqueVertices++;
+				}
+			}
+		}
+
+		if( IndexCount > FirstIndex )
+			rMeshlets.push_back( ComputeBounds( pVertices, pIndices, FirstIndex, IndexCount - FirstIndex ) );
+	}
+
+	Meshlet MeshletBuilder::ComputeBounds( const StaticVertex* pVertices, const uint32_t* pIndices, uint32_t FirstIndex, uint32_t IndexCount )
+	{
+		Meshlet Result = {};
+		Result.FirstIndex = FirstIndex;
+		Result.IndexCount = IndexCount;
+
+		//////////////////////////////////////////////////////////////////////////
+		// Bounding sphere, centered on the bounding box.
+
+		glm::vec3 Min( FLT_MAX );
+		glm::vec3 Max( -FLT_MAX );
+
+		for( uint32_t i = FirstIndex; i < FirstIndex + IndexCount; i++ )
+		{
+			Min = glm::min( Min, pVertices[ pIndices[ i ] ].Position );
+			Max = glm::max( Max, pVertices[ pIndices[ i ] ].Position );
+		}
+
+		glm::vec3 Center = ( Min + Max ) * 0.5f;
+		float Radius = 0.0f;
+
+		for( uint32_t i = FirstIndex; i < FirstIndex + IndexCount; i++ )
+			Radius = glm::max( Radius, glm::length( pVertices[ pIndices[ i ] ].Position - Center ) );
+
+		Result.BoundingSphere = glm::vec4( Center, Radius );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Normal cone, "Optimizing the Graphics Pipeline with Compute" (Wihlidal 2016) and meshoptimizer.
+
+		std::vector<glm::vec3> Normals;
+		Normals.reserve( IndexCount / 3 );
+
+		glm::vec3 Axis( 0.0f );
+
+		for( uint32_t i = FirstIndex; i < FirstIndex + IndexCount; i += 3 )
+		{
+			const glm::vec3& rP0 = pVertices[ pIndices[ i + 0 ] ].Position;
+			const glm::vec3& rP1 = pVertices[ pIndices[ i + 1 ] ].Position;
+			const glm::vec3& rP2 = pVertices[ pIndices[ i + 2 ] ].Position;
+
+			glm::vec3 Normal = glm::cross( rP1 - rP0, rP2 - rP0 );
+			float Length = glm::length( Normal );
+
+			// Degenerate triangles are never rasterized.
+			if( Length <= 0.0f )
+				continue;
+
+			Normals.push_back( Normal / Length );
+			Axis += Normals.back();
+		}
+
+		float AxisLength = glm::length( Axis );
+
+		// A cutoff of one can never be reached, the meshlet is never back facing.
+		Result.Cone = glm::vec4( 0.0f, 0.0f, 1.0f, 1.0f );
+
+		if( AxisLength <= 0.0f )
+			return Result;
+
+		Axis /= AxisLength;
+
+		float MinDot = 1.0f;
+
+		for( const glm::vec3& rNormal : Normals )
+			MinDot = glm::min( MinDot, glm::dot( rNormal, Axis ) );
+
+		// The triangles face too many directions, the cone would be wider than a hemisphere.
+		if( MinDot <= 0.1f )
+			return Result;
+
+		Result.Cone = glm::vec4( Axis, glm::sqrt( 1.0f - MinDot * MinDot ) );
+
+		return Result;
+	}
+}
@@ -0,0 +1,69 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "VertexBuffer.h"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Saturn {
+
+	constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+	constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+	// A small cluster of triangles that is culled on its own, see ClusterCulling.
+	// Must match with "Meshlet" in ClusterCull.glsl (std430).
+	struct Meshlet
+	{
+		// xyz = center, w = radius. In the same space as the submesh vertices.
+		glm::vec4 BoundingSphere;
+
+		// xyz = average normal, w = cutoff. Every triangle faces away from a camera when
+		// dot( center - camera, axis ) >= cutoff * length( center - camera ) + radius.
+		glm::vec4 Cone;
+
+		// Range in the submesh's LOD 0 indices.
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+
+		uint32_t Padding[ 2 ];
+	};
+
+	class MeshletBuilder
+	{
+	public:
+		// Splits the triangles in the order they are in, so every meshlet is a contiguous range of "pIndices".
+		// The indices should be optimized for the vertex cache first, neighbouring triangles then share vertices and end up in the same meshlet.
+		static void Build( const StaticVertex* pVertices, uint32_t VertexCount, const uint32_t* pIndices, uint32_t IndexCount, std::vector<Meshlet>& rMeshlets );
+
+	private:
+		static Meshlet ComputeBounds( const StaticVertex* pVertices, const uint32_t* pIndices, uint32_t FirstIndex, uint32_t IndexCount );
+	};
+}
@@ -33,6 +33,8 @@
 
 #include "VulkanDebug.h"
 #include "DescriptorSet.h"
+#include "BindlessResources.h"
+#include "MeshGeometryPool.h"
 #include "MaterialInstance.h"
 #include "Shader.h"
 #include "Framebuffer.h"
@@ -88,6 +90,9 @@ namespace Saturn {
 
 		m_PinkTextureCube = Ref< TextureCube >::Create( ImageFormat::BGRA8, 1, 1, pData );
 
+		if( VulkanContext::Get().IsBindlessEnabled() )
+			VulkanContext::Get().GetBindlessResources()->SetDefaultTexture( m_PinkTexture->GetDescriptorInfo() );
+
 		delete[] pData;
 
 		std::vector<VkDescriptorPoolSize> PoolSizes;
@@ -106,6 +111,7 @@ namespace Saturn {
 		for( int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
 		{
 			m_RendererDescriptorPools[i] = Ref<DescriptorPool>::Create( PoolSizes, 100000 );
+			m_DescriptorSetCaches[i] = Ref<DescriptorSetCache>::Create();
 		}
 	}
 	
@@ -125,6 +131,7 @@ namespace Saturn {
 		{
 			m_RendererDescriptorSets[ i ] = nullptr;
 			m_RendererDescriptorPools[ i ] = nullptr;
+			m_DescriptorSetCaches[ i ] = nullptr;
 		}
 
 		if( m_FlightFences.size() )
@@ -174,7 +181,7 @@ namespace Saturn {
 		vkCmdEndRenderPass( CommandBuffer );
 	}
 	
-	void Renderer::RenderMeshWithoutMaterial( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref<StaticMesh> mesh, uint32_t count, Ref<VertexBuffer> transformVB, uint32_t TransformOffset, uint32_t SubmeshIndex, Buffer additionalData )
+	void Renderer::RenderMeshWithoutMaterial( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref<StaticMesh> mesh, uint32_t count, Ref<VertexBuffer> transformVB, uint32_t TransformOffset, uint32_t SubmeshIndex, uint32_t Lod, Buffer additionalData, const IndirectDraw& rIndirect )
 	{	
 		SAT_PF_EVENT();
 
@@ -185,13 +192,11 @@ namespace Saturn {
 
 		auto& rSubmesh = mesh->Submeshes()[ SubmeshIndex ];
 		{ 
-			mesh->GetVertexBuffer()->Bind( CommandBuffer );
+			VulkanContext::Get().GetMeshGeometryPool()->Bind( CommandBuffer );
 
 			VkDeviceSize offset[ 1 ] = { TransformOffset };
 			transformVB->Bind( CommandBuffer, 1, offset );
 
-			mesh->GetIndexBuffer()->Bind( CommandBuffer );
-
 			Pipeline->Bind( CommandBuffer );
 
 			if( PushConstant.Size > 0 )
@@ -201,7 +206,7 @@ namespace Saturn {
 			
 			Pipeline->GetDescriptorSet( ShaderType::Vertex, 0 )->Bind( CommandBuffer, Pipeline->GetPipelineLayout() );
 
-			vkCmdDrawIndexed( CommandBuffer, rSubmesh.IndexCount, count, rSubmesh.BaseIndex, rSubmesh.BaseVertex, 0 );
+			DrawSubmesh( CommandBuffer, mesh, rSubmesh, Lod, count, rIndirect );
 		}
 
 		PushConstant.Free();
@@ -262,7 +267,7 @@ namespace Saturn {
 	void Renderer::SubmitMesh( 
 		VkCommandBuffer CommandBuffer, Ref< Saturn::Pipeline > Pipeline, Ref< StaticMesh > mesh, 
 		Ref<StorageBufferSet>& rStorageBufferSet, Ref< MaterialRegistry > materialRegistry, 
-		uint32_t SubmeshIndex, uint32_t count, Ref<VertexBuffer> transformData, uint32_t transformOffset )
+		uint32_t SubmeshIndex, uint32_t Lod, uint32_t count, Ref<VertexBuffer> transformData, uint32_t transformOffset, const IndirectDraw& rIndirect )
 	{
 		SAT_PF_EVENT();
 
@@ -270,10 +275,9 @@ namespace Saturn {
 
 		VkDeviceSize transformOffsets[ 1 ] = { transformOffset };
 
-		mesh->GetVertexBuffer()->Bind( CommandBuffer );
+		// Every static mesh shares the same vertex and index buffer.
+		VulkanContext::Get().GetMeshGeometryPool()->Bind( CommandBuffer );
 		transformData->Bind( CommandBuffer, 1, transformOffsets );
-
-		mesh->GetIndexBuffer()->Bind( CommandBuffer );
 		Pipeline->Bind( CommandBuffer );
 
 		Submesh& rSubmesh = mesh->Submeshes()[ SubmeshIndex ];
@@ -282,7 +286,11 @@ namespace Saturn {
 
 			const auto& StorageWriteDescriptors = GetStorageBufferWriteDescriptors( rStorageBufferSet, rMaterialAsset );
 
-			rMaterialAsset->Bind( mesh, rSubmesh, Shader, StorageWriteDescriptors[ m_FrameCount ] );
+			// Shaders without storage buffers in set 0 will have no write descriptors.
+			if( StorageWriteDescriptors.size() )
+				rMaterialAsset->Bind( mesh, rSubmesh, Shader, StorageWriteDescriptors[ m_FrameCount ] );
+			else
+				rMaterialAsset->Bind( mesh, rSubmesh, Shader );
 
 			VkDescriptorSet Set = rMaterialAsset->GetMaterial()->GetDescriptorSet( m_FrameCount );
 
@@ -298,7 +306,56 @@ namespace Saturn {
 			vkCmdBindDescriptorSets( CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
 				Pipeline->GetPipelineLayout(), 0, ( uint32_t ) DescriptorSets.size(), DescriptorSets.data(), 0, nullptr );
 
-			vkCmdDrawIndexed( CommandBuffer, rSubmesh.IndexCount, count, rSubmesh.BaseIndex, rSubmesh.BaseVertex, 0 );
+			DrawSubmesh( CommandBuffer, mesh, rSubmesh, Lod, count, rIndirect );
+		}
+	}
+
+	void Renderer::SubmitMeshBindless( 
+		VkCommandBuffer CommandBuffer, Ref< Saturn::Pipeline > Pipeline, Ref< StaticMesh > mesh, 
+		Ref< MaterialRegistry > materialRegistry, uint32_t SubmeshIndex, uint32_t Lod, uint32_t count, 
+		Ref<VertexBuffer> transformData, uint32_t transformOffset, const IndirectDraw& rIndirect )
+	{
+		SAT_PF_EVENT();
+
+		VkDeviceSize transformOffsets[ 1 ] = { transformOffset };
+
+		// Every static mesh shares the same vertex and index buffer.
+		VulkanContext::Get().GetMeshGeometryPool()->Bind( CommandBuffer );
+		transformData->Bind( CommandBuffer, 1, transformOffsets );
+
+		Submesh& rSubmesh = mesh->Submeshes()[ SubmeshIndex ];
+		{
+			auto& rMaterialAsset = materialRegistry->GetMaterials()[ rSubmesh.MaterialIndex ];
+
+			rMaterialAsset->BindBindless();
+
+			uint32_t MaterialIndex = rMaterialAsset->GetBindlessIndex();
+			vkCmdPushConstants( CommandBuffer, Pipeline->GetPipelineLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof( uint32_t ), &MaterialIndex );
+
+			DrawSubmesh( CommandBuffer, mesh, rSubmesh, Lod, count, rIndirect );
+		}
+	}
+
+	void Renderer::DrawSubmesh( VkCommandBuffer CommandBuffer, const Ref<StaticMesh>& rMesh, const Submesh& rSubmesh, uint32_t Lod, uint32_t count, const IndirectDraw& rIndirect )
+	{
+		if( rIndirect.Buffer )
+		{
+			// The geometry is shared, but each command still has its own material binding and instance buffer offset (FirstInstance is 0).
+			// So this is not merged into one vkCmdDrawIndexedIndirectCount.
+			// Every draw binds the pool again, so this does not leak into the next one.
+			if( rIndirect.IndexBuffer )
+				vkCmdBindIndexBuffer( CommandBuffer, rIndirect.IndexBuffer, 0, VK_INDEX_TYPE_UINT32 );
+
+			vkCmdDrawIndexedIndirect( CommandBuffer, rIndirect.Buffer, rIndirect.Offset, 1, sizeof( VkDrawIndexedIndirectCommand ) );
+		}
+		else
+		{
+			const MeshGeometryRange& rRange = rMesh->GetGeometryRange();
+
+			// Every LOD uses the vertices of LOD 0.
+			SubmeshLod Range = rSubmesh.GetLod( Lod );
+
+			vkCmdDrawIndexed( CommandBuffer, Range.IndexCount, count, rRange.IndexOffset + Range.BaseIndex, ( int32_t ) ( rRange.VertexOffset + rSubmesh.BaseVertex ), 0 );
 		}
 	}
 
@@ -325,6 +382,31 @@ namespace Saturn {
 		}
 	}
 
+	void Renderer::SetSceneLightBuffers( const VkDescriptorBufferInfo& rPointLights, const VkDescriptorBufferInfo& rLightClusters, const VkDescriptorBufferInfo& rLightIndices )
+	{
+		SAT_PF_EVENT();
+
+		Ref<Shader> shader = ShaderLibrary::Get().Find( "shader_new" );
+		auto& rWriteDescriptorSets = shader->GetShaderDescriptorSet( 1 ).WriteDescriptorSets;
+
+		// Bindings must match with shader_new.glsl.
+		std::array<VkWriteDescriptorSet, 3> WriteDescriptorSets = {
+			rWriteDescriptorSets[ 13 ],
+			rWriteDescriptorSets[ 14 ],
+			rWriteDescriptorSets[ 15 ]
+		};
+
+		WriteDescriptorSets[ 0 ].pBufferInfo = &rPointLights;
+		WriteDescriptorSets[ 1 ].pBufferInfo = &rLightClusters;
+		WriteDescriptorSets[ 2 ].pBufferInfo = &rLightIndices;
+
+		for( auto& rWDS : WriteDescriptorSets )
+			rWDS.dstSet = m_RendererDescriptorSets[ m_FrameCount ];
+
+		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), ( uint32_t ) WriteDescriptorSets.size(), WriteDescriptorSets.data(), 0, nullptr );
+		m_Stats.DescriptorWrites += ( uint32_t ) WriteDescriptorSets.size();
+	}
+
 	VkCommandBuffer Renderer::AllocateCommandBuffer( VkCommandPool CommandPool )
 	{
 		SAT_PF_EVENT();
@@ -368,6 +450,9 @@ namespace Saturn {
 
 		m_BeginFrameTimer.Reset();
 
+		m_LastFrameStats = m_Stats;
+		m_Stats = {};
+
 		VK_CHECK( vkResetDescriptorPool( LogicalDevice, m_RendererDescriptorPools[ m_FrameCount ]->GetVulkanPool(), 0 ) );
 
 		if( m_PendingShaderReloads.size() )
@@ -392,13 +477,29 @@ namespace Saturn {
 		// Reset current fence.
 		VK_CHECK( vkResetFences( LogicalDevice, 1, &m_FlightFences[ m_FrameCount ] ) );
 
+		// This frame is no longer in flight, so any sets that were released can now be freed.
+		m_DescriptorSetCaches[ m_FrameCount ]->Collect();
+
+		if( VulkanContext::Get().IsBindlessEnabled() )
+			VulkanContext::Get().GetBindlessResources()->BeginFrame( m_FrameCount );
+
+		VulkanContext::Get().GetMeshGeometryPool()->BeginFrame( m_FrameCount );
+
+		// Reads back the timings this frame recorded last time, then resets the queries.
+		VulkanContext::Get().GetGPUProfiler()->BeginFrame( m_CommandBuffer, m_FrameCount );
+
 		// Acquire next image.
-		uint32_t ImageIndex = -1;
-		VulkanContext::Get().GetSwapchain().AcquireNextImage( UINT32_MAX, m_AcquireSemaphore, VK_NULL_HANDLE, &ImageIndex );
+		if( !Application::Get().HasFlag( ApplicationFlag_Headless ) )
+		{
+			uint32_t ImageIndex = -1;
+			VulkanContext::Get().GetSwapchain().AcquireNextImage( UINT32_MAX, m_AcquireSemaphore, VK_NULL_HANDLE, &ImageIndex );
 
-		m_ImageIndex = ImageIndex;
+			m_ImageIndex = ImageIndex;
 
-		SAT_CORE_ASSERT( ImageIndex != UINT32_MAX || ImageIndex != 3435973836 );
+			SAT_CORE_ASSERT( ImageIndex != UINT32_MAX || ImageIndex != 3435973836 );
+		}
+		else
+			m_ImageIndex = m_FrameCount;
 
 		m_BeginFrameTime = m_BeginFrameTimer.ElapsedMilliseconds();
 	}
@@ -421,42 +522,48 @@ namespace Saturn {
 		SubmitInfo.pCommandBuffers = &m_CommandBuffer;
 		SubmitInfo.pWaitDstStageMask = &WaitStage;
 
+		// Headless: nothing was acquired and nothing will be presented.
+		const bool Headless = Application::Get().HasFlag( ApplicationFlag_Headless );
+
 		// SIGNAL the SubmitSemaphore
 		SubmitInfo.pSignalSemaphores = &m_SubmitSemaphore;
-		SubmitInfo.signalSemaphoreCount = 1;
+		SubmitInfo.signalSemaphoreCount = Headless ? 0 : 1;
 
 		// WAIT for AcquireSemaphore
 		SubmitInfo.pWaitSemaphores = &m_AcquireSemaphore;
-		SubmitInfo.waitSemaphoreCount = 1;
+		SubmitInfo.waitSemaphoreCount = Headless ? 0 : 1;
 
 		VK_CHECK( vkResetFences( LogicalDevice, 1, &m_FlightFences[ m_FrameCount ] ) );
 
 		// Use current fence to be signaled.
 		VK_CHECK( vkQueueSubmit( VulkanContext::Get().GetGraphicsQueue(), 1, &SubmitInfo, m_FlightFences[ m_FrameCount ] ) );
 
-		// Present info.
-		VkPresentInfoKHR PresentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
-		PresentInfo.pSwapchains = &VulkanContext::Get().GetSwapchain().GetSwapchain();
-		PresentInfo.swapchainCount = 1;
-		PresentInfo.pImageIndices = &m_ImageIndex;
-
-		// WAIT for SubmitSemaphore
-		PresentInfo.pWaitSemaphores = &m_SubmitSemaphore;
-		PresentInfo.waitSemaphoreCount = 1;
-		
 		m_QueuePresentTimer.Reset();
 
-		VkResult Result = vkQueuePresentKHR( VulkanContext::Get().GetGraphicsQueue(), &PresentInfo );
-
-		if( Result == VK_ERROR_OUT_OF_DATE_KHR ) 
+		if( !Headless )
 		{
-			SAT_CORE_INFO( "Result was VK_ERROR_OUT_OF_DATE_KHR, Swapchain will be re-created!" );
+			// Present info.
+			VkPresentInfoKHR PresentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+			PresentInfo.pSwapchains = &VulkanContext::Get().GetSwapchain().GetSwapchain();
+			PresentInfo.swapchainCount = 1;
+			PresentInfo.pImageIndices = &m_ImageIndex;
+
+			// WAIT for SubmitSemaphore
+			PresentInfo.pWaitSemaphores = &m_SubmitSemaphore;
+			PresentInfo.waitSemaphoreCount = 1;
+		
+			VkResult Result = vkQueuePresentKHR( VulkanContext::Get().GetGraphicsQueue(), &PresentInfo );
+
+			if( Result == VK_ERROR_OUT_OF_DATE_KHR ) 
+			{
+				SAT_CORE_INFO( "Result was VK_ERROR_OUT_OF_DATE_KHR, Swapchain will be re-created!" );
 
-			VulkanContext::Get().GetSwapchain().Recreate();
+				VulkanContext::Get().GetSwapchain().Recreate();
 
-			PresentInfo.pSwapchains = &VulkanContext::Get().GetSwapchain().GetSwapchain();
+				PresentInfo.pSwapchains = &VulkanContext::Get().GetSwapchain().GetSwapchain();
 
-			VK_CHECK( vkQueuePresentKHR( VulkanContext::Get().GetGraphicsQueue(), &PresentInfo ) );
+				VK_CHECK( vkQueuePresentKHR( VulkanContext::Get().GetGraphicsQueue(), &PresentInfo ) );
+			}
 		}
 
 		m_QueuePresentTime = m_QueuePresentTimer.ElapsedMilliseconds();
@@ -470,10 +577,15 @@ namespace Saturn {
 		m_EndFrameTime = m_EndFrameTimer.ElapsedMilliseconds() - m_QueuePresentTime;
 
 		// Clear storage buffer sets. Reallocated next frame.
-		// Not ideal but for now we will do this as in the LightCulling pass we resize the buffer every frame meaning we have to update our cache.
+		// Not ideal but for now we will do this as storage buffers can be resized during the frame meaning we have to update our cache.
 		m_StorageBufferSets.clear();
 	}
 
+	bool Renderer::IsFrameComplete( uint32_t Frame )
+	{
+		return vkGetFenceStatus( VulkanContext::Get().GetDevice(), m_FlightFences[ Frame ] ) == VK_SUCCESS;
+	}
+
 	void Renderer::SubmitTerminateResource( std::function<void()>&& rrFunction )
 	{
 		m_TerminateResourceFuncs.push_back( rrFunction );
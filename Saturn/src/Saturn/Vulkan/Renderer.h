@@ -49,6 +49,23 @@ namespace Saturn {
 		}
 	};
 
+	struct RendererStats
+	{
+		uint32_t DescriptorWrites = 0;
+		uint32_t DescriptorSetAllocations = 0;
+		uint32_t DescriptorSetCacheHits = 0;
+	};
+
+	// When set the draw reads its VkDrawIndexedIndirectCommand from "Buffer" at "Offset", the CPU side instance count is ignored.
+	// "IndexBuffer" replaces the geometry pool's index buffer for this draw (cluster culling writes the visible triangles there).
+	struct IndirectDraw
+	{
+		VkBuffer Buffer = VK_NULL_HANDLE;
+		VkDeviceSize Offset = 0;
+
+		VkBuffer IndexBuffer = VK_NULL_HANDLE;
+	};
+
 	class Renderer : public RefTarget
 	{
 	public:
@@ -63,18 +80,26 @@ namespace Saturn {
 		void BeginRenderPass( VkCommandBuffer CommandBuffer, Pass& rPass );
 		void EndRenderPass( VkCommandBuffer CommandBuffer );
 
-		void RenderMeshWithoutMaterial( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref<StaticMesh> mesh, uint32_t count, Ref<VertexBuffer> transformVB, uint32_t TransformOffset, uint32_t SubmeshIndex, Buffer additionalData = Buffer() );
+		void RenderMeshWithoutMaterial( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref<StaticMesh> mesh, uint32_t count, Ref<VertexBuffer> transformVB, uint32_t TransformOffset, uint32_t SubmeshIndex, uint32_t Lod, Buffer additionalData = Buffer(), const IndirectDraw& rIndirect = {} );
 
 		// Static mesh
 		void RenderSubmesh( VkCommandBuffer CommandBuffer, Ref<Saturn::Pipeline> Pipeline, Ref< StaticMesh > mesh, Submesh& rSubmsh, const glm::mat4 transform );
 
 		void SubmitMesh( VkCommandBuffer CommandBuffer, Ref< Saturn::Pipeline > Pipeline, Ref< StaticMesh > mesh,
-			Ref<StorageBufferSet>& rStorageBufferSet, Ref< MaterialRegistry > materialRegistry, uint32_t SubmeshIndex, uint32_t count,
-			Ref<VertexBuffer> transformData, uint32_t transformOffset );
+			Ref<StorageBufferSet>& rStorageBufferSet, Ref< MaterialRegistry > materialRegistry, uint32_t SubmeshIndex, uint32_t Lod, uint32_t count,
+			Ref<VertexBuffer> transformData, uint32_t transformOffset, const IndirectDraw& rIndirect = {} );
+
+		// Bindless mode, only binds the geometry and pushes the material index. The caller binds the descriptor sets once for all meshes.
+		void SubmitMeshBindless( VkCommandBuffer CommandBuffer, Ref< Saturn::Pipeline > Pipeline, Ref< StaticMesh > mesh,
+			Ref< MaterialRegistry > materialRegistry, uint32_t SubmeshIndex, uint32_t Lod, uint32_t count,
+			Ref<VertexBuffer> transformData, uint32_t transformOffset, const IndirectDraw& rIndirect = {} );
 
 		const std::vector<VkWriteDescriptorSet>& GetStorageBufferWriteDescriptors( Ref<StorageBufferSet>& rStorageBufferSet, Ref<MaterialAsset>& rMaterialAsset );
 
 		void SetSceneEnvironment( Ref<Image2D> ShadowMap, Ref<EnvironmentMap> Environment, Ref<Texture2D> BDRF );
+		// Must be called after SetSceneEnvironment, the environment set is re-allocated every frame.
+		void SetSceneLightBuffers( const VkDescriptorBufferInfo& rPointLights, const VkDescriptorBufferInfo& rLightClusters, const VkDescriptorBufferInfo& rLightIndices );
+		VkDescriptorSet GetSceneEnvironmentSet() { return m_RendererDescriptorSets[ m_FrameCount ]; }
 
 		// Allocate command buffer.
 		VkCommandBuffer AllocateCommandBuffer( VkCommandPool CommandPool );
@@ -90,6 +115,9 @@ namespace Saturn {
 		uint32_t GetImageIndex() { return m_ImageIndex; }
 		uint32_t GetCurrentFrame() { return m_FrameCount; }
 
+		// True once the GPU has finished the last submit of "Frame".
+		bool IsFrameComplete( uint32_t Frame );
+
 		std::pair< float, float > GetFrameTimings() { return std::make_pair( m_BeginFrameTime, m_EndFrameTime ); }
 		float GetQueuePresentTime() { return m_QueuePresentTime; }
 
@@ -101,6 +129,14 @@ namespace Saturn {
 		std::pair< Ref<VertexBuffer>, Ref<IndexBuffer>> CreateFullscreenQuad();
 		
 		Ref<DescriptorPool> GetDescriptorPool() { return m_RendererDescriptorPools[ m_FrameCount ]; }
+		
+		// Persistent sets for the current frame in flight, see Material::RN_Update.
+		Ref<DescriptorSetCache> GetDescriptorSetCache() { return m_DescriptorSetCaches[ m_FrameCount ]; }
+		Ref<DescriptorSetCache> GetDescriptorSetCache( uint32_t Frame ) { return m_DescriptorSetCaches[ Frame ]; }
+
+		// Reset at the start of every frame, use GetLastFrameStats for a complete frame.
+		RendererStats& GetStats() { return m_Stats; }
+		const RendererStats& GetLastFrameStats() const { return m_LastFrameStats; }
 
 		void AddShaderReloadCB( const std::function<void( const std::string& )>& rFunc );
 		void OnShaderReloaded( const std::string& rName );
@@ -119,6 +155,8 @@ namespace Saturn {
 		void Init();
 		void Terminate();
 
+		void DrawSubmesh( VkCommandBuffer CommandBuffer, const Ref<StaticMesh>& rMesh, const Submesh& rSubmesh, uint32_t Lod, uint32_t count, const IndirectDraw& rIndirect );
+
 	private:
 		uint32_t m_ImageIndex = 0;
 		uint32_t m_ImageCount = 0;
@@ -149,6 +187,10 @@ namespace Saturn {
 		VkDescriptorSet m_RendererDescriptorSets[MAX_FRAMES_IN_FLIGHT];
 
 		Ref< DescriptorPool > m_RendererDescriptorPools[ MAX_FRAMES_IN_FLIGHT ];
+		Ref< DescriptorSetCache > m_DescriptorSetCaches[ MAX_FRAMES_IN_FLIGHT ];
+
+		RendererStats m_Stats;
+		RendererStats m_LastFrameStats;
 
 		// frame -> shader name -> set
 		std::unordered_map< uint32_t, std::unordered_map< std::string, std::vector<VkWriteDescriptorSet>>> m_StorageBufferSets;
@@ -31,6 +31,7 @@
 
 #include "Renderer.h"
 #include "VulkanDebug.h"
+#include "BindlessResources.h"
 
 #include <Ruby/RubyWindow.h>
 
@@ -43,17 +44,20 @@ namespace Saturn {
 	static constexpr uint32_t s_MaxIndices = s_MaxQuads * 6;
 	static constexpr uint32_t s_MaxTextureSlots = 32;
 
-	static constexpr uint32_t s_MaxLines = 2000;
+	// Large enough for physics debug visualization of a busy scene.
+	static constexpr uint32_t s_MaxLines = 100000;
 	static constexpr uint32_t s_MaxLineVertices = s_MaxLines * 2;
-	static constexpr uint32_t s_MaxLineIndices = s_MaxLines * 6;
+	static constexpr uint32_t s_MaxLineIndices = s_MaxLineVertices;
 
 	void Renderer2D::Init()
 	{
 		if( Application::Get().HasFlag( ApplicationFlag_UIOnly ) )
 			return;
 
-		m_Width = Application::Get().GetWindow()->GetWidth();
-		m_Height = Application::Get().GetWindow()->GetHeight();
+		m_Width = Application::Get().GetWidth();
+		m_Height = Application::Get().GetHeight();
+
+		m_Bindless = VulkanContext::Get().IsBindlessEnabled();
 
 		// Setup Quads
 		m_QuadVertexPositions.push_back( { -0.5f, -0.5f, 0.0f, 1.0f } );
@@ -138,7 +142,10 @@ namespace Saturn {
 
 		if( !m_QuadShader )
 		{
-			m_QuadShader = ShaderLibrary::Get().FindOrLoad( "Renderer2D", "content/shaders/Renderer2D.glsl" );
+			if( m_Bindless )
+				m_QuadShader = ShaderLibrary::Get().FindOrLoad( "Renderer2D_Bindless", "content/shaders/Renderer2D_Bindless.glsl" );
+			else
+				m_QuadShader = ShaderLibrary::Get().FindOrLoad( "Renderer2D", "content/shaders/Renderer2D.glsl" );
 			m_QuadMaterial = Ref<Material>::Create( m_QuadShader, "QuadMaterial" );
 		}
 
@@ -294,17 +301,23 @@ namespace Saturn {
 		{
 			m_QuadVertexBuffers[ frame ]->Reallocate( m_CurrentQuadBase[ frame ], dataSize );
 
-			for( uint32_t i = 0; i < m_Textures.size(); i++ )
+			if( !m_Bindless )
 			{
-				if( m_Textures[ i ] )
-					m_QuadMaterial->SetResource( "u_InputTexture", m_Textures[ i ], i );
-				else
-					m_QuadMaterial->SetResource( "u_InputTexture", Renderer::Get().GetPinkTexture(), i );
+				for( uint32_t i = 0; i < m_Textures.size(); i++ )
+				{
+					if( m_Textures[ i ] )
+						m_QuadMaterial->SetResource( "u_InputTexture", m_Textures[ i ], i );
+					else
+						m_QuadMaterial->SetResource( "u_InputTexture", Renderer::Get().GetPinkTexture(), i );
+				}
 			}
 
 			m_QuadMaterial->Bind( m_CommandBuffer, m_QuadShader );
 			m_QuadMaterial->BindDS( m_CommandBuffer, m_QuadPipeline->GetPipelineLayout() );
 
+			if( m_Bindless )
+				VulkanContext::Get().GetBindlessResources()->Bind( m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_QuadPipeline->GetPipelineLayout(), 1 );
+
 			m_QuadPipeline->Bind( m_CommandBuffer );
 
 			m_QuadIndexBuffer->Bind( m_CommandBuffer );
@@ -409,25 +422,7 @@ namespace Saturn {
 		// One quad has 4 vertexes so we need to submit them one by one.
 		glm::vec2 TexCoord[] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
 
-		int textureID = 0;
-		for( uint32_t i = 1; i < m_CurrentTextureSlot; i++ )
-		{
-			if( m_Textures[ i ] == rTexture ) 
-			{
-				textureID = i;
-				break;
-			}
-		}
-
-		if( textureID == 0 )
-		{
-			if( m_CurrentTextureSlot >= s_MaxTextureSlots )
-				Reset();
-
-			textureID = m_CurrentTextureSlot;
-			m_Textures[ textureID ] = rTexture;
-			m_CurrentTextureSlot++;
-		}
+		float textureID = FindOrAddTexture( rTexture );
 
 		for( size_t i = 0; i < 4; i++ )
 		{
@@ -485,25 +480,7 @@ namespace Saturn {
 		glm::vec3 CamRight = { m_CameraView[ 0 ][ 0 ], m_CameraView[ 1 ][ 0 ], m_CameraView[ 2 ][ 0 ] };
 		glm::vec3 CamUp = { m_CameraView[ 0 ][ 1 ], m_CameraView[ 1 ][ 1 ], m_CameraView[ 2 ][ 1 ] };
 
-		int textureID = 0;
-		for( uint32_t i = 1; i < m_CurrentTextureSlot; i++ )
-		{
-			if( m_Textures[ i ] == rTexture )
-			{
-				textureID = i;
-				break;
-			}
-		}
-
-		if( textureID == 0 )
-		{
-			if( m_CurrentTextureSlot >= s_MaxTextureSlots )
-				Reset();
-
-			textureID = m_CurrentTextureSlot;
-			m_Textures[ textureID ] = rTexture;
-			m_CurrentTextureSlot++;
-		}
+		float textureID = FindOrAddTexture( rTexture );
 
 		m_CurrentQuad->Position = position + CamRight * ( m_QuadVertexPositions[ 0 ].x ) * rSize.x + CamUp * m_QuadVertexPositions[ 0 ].y * rSize.y;
 		m_CurrentQuad->Color = color;
@@ -536,8 +513,40 @@ namespace Saturn {
 		m_QuadIndexCount += 6;
 	}
 
+	float Renderer2D::FindOrAddTexture( const Ref<Texture2D>& rTexture )
+	{
+		// No slot table to manage, the texture already has a stable index in the global array.
+		if( m_Bindless )
+			return ( float ) rTexture->GetBindlessIndex();
+
+		int textureID = 0;
+		for( uint32_t i = 1; i < m_CurrentTextureSlot; i++ )
+		{
+			if( m_Textures[ i ] == rTexture ) 
+			{
+				textureID = i;
+				break;
+			}
+		}
+
+		if( textureID == 0 )
+		{
+			if( m_CurrentTextureSlot >= s_MaxTextureSlots )
+				Reset();
+
+			textureID = m_CurrentTextureSlot;
+			m_Textures[ textureID ] = rTexture;
+			m_CurrentTextureSlot++;
+		}
+
+		return ( float ) textureID;
+	}
+
 	void Renderer2D::SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor )
 	{
+		if( m_LineVertexCount + 2 > s_MaxLineVertices )
+			return;
+
 		m_CurrentLine->Position = rStart;
 		m_CurrentLine->Color = rColor;
 	
@@ -553,6 +562,9 @@ namespace Saturn {
 
 	void Renderer2D::SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor, float Thinkness )
 	{
+		if( m_LineVertexCount + 2 > s_MaxLineVertices )
+			return;
+
 		m_CurrentLine->Position = rStart;
 		m_CurrentLine->Color = rColor;
 
@@ -566,6 +578,20 @@ namespace Saturn {
 		m_LineVertexCount += 2;
 	}
 
+	void Renderer2D::SubmitLines( const LineDrawCommand* pVertices, uint32_t VertexCount )
+	{
+		if( !m_CurrentLine )
+			return;
+
+		// Whole lines only.
+		uint32_t Count = std::min( VertexCount, s_MaxLineVertices - m_LineVertexCount ) & ~1u;
+
+		memcpy( m_CurrentLine, pVertices, Count * sizeof( LineDrawCommand ) );
+
+		m_CurrentLine += Count;
+		m_LineVertexCount += Count;
+	}
+
 	void Renderer2D::SetCamera( const glm::mat4& viewProjection, const glm::mat4& view )
 	{
 		m_CameraViewProjection = viewProjection;
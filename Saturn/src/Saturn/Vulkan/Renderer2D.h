@@ -78,6 +78,9 @@ namespace Saturn {
 		void SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor );
 		void SubmitLine( const glm::vec3& rStart, const glm::vec3& rEnd, const glm::vec4& rColor, float Thinkness );
 
+		// Copies already built line vertices (two per line) in one go, lines past the capacity are dropped.
+		void SubmitLines( const LineDrawCommand* pVertices, uint32_t VertexCount );
+
 		void SetCamera( const glm::mat4& viewProjection, const glm::mat4& view );
 
 		void Prepare();
@@ -97,6 +100,8 @@ namespace Saturn {
 		void RenderAllQuads();
 		void RenderAllLines();
 
+		float FindOrAddTexture( const Ref<Texture2D>& rTexture );
+
 	private:
 		Ref<Pass> m_TargetRenderPass = nullptr;
 		Ref<Pass> m_TempRenderPass = nullptr;
@@ -126,6 +131,9 @@ namespace Saturn {
 		uint32_t m_DefaultTextureSlot = 1;
 		uint32_t m_CurrentTextureSlot = 0;
 
+		// When true textures are indexed from the global bindless array and m_Textures is unused.
+		bool m_Bindless = false;
+
 		glm::mat4 m_CameraView = glm::mat4( 1.0f );
 		glm::mat4 m_CameraViewProjection = glm::mat4( 1.0f );
 
@@ -0,0 +1,167 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "SamplerCache.h"
+
+#include "VulkanContext.h"
+
+namespace Saturn {
+
+	SamplerKey::SamplerKey( const VkSamplerCreateInfo& rCreateInfo )
+	{
+		SAT_CORE_ASSERT( rCreateInfo.pNext == nullptr, "Cached samplers can not have a pNext chain!" );
+
+		Flags = rCreateInfo.flags;
+		MagFilter = rCreateInfo.magFilter;
+		MinFilter = rCreateInfo.minFilter;
+		MipmapMode = rCreateInfo.mipmapMode;
+		AddressModeU = rCreateInfo.addressModeU;
+		AddressModeV = rCreateInfo.addressModeV;
+		AddressModeW = rCreateInfo.addressModeW;
+		MipLodBias = rCreateInfo.mipLodBias;
+		AnisotropyEnable = rCreateInfo.anisotropyEnable;
+		MaxAnisotropy = rCreateInfo.maxAnisotropy;
+		CompareEnable = rCreateInfo.compareEnable;
+		CompareOp = rCreateInfo.compareOp;
+		MinLod = rCreateInfo.minLod;
+		MaxLod = rCreateInfo.maxLod;
+		BorderColor = rCreateInfo.borderColor;
+		UnnormalizedCoordinates = rCreateInfo.unnormalizedCoordinates;
+	}
+
+	SamplerCache::SamplerCache()
+	{
+	}
+
+	SamplerCache::~SamplerCache()
+	{
+		// Anything left is owned by objects that outlive the device, they must not destroy it again.
+		for( auto&& [sampler, entry] : m_Entries )
+			vkDestroySampler( VulkanContext::Get().GetDevice(), sampler, nullptr );
+
+		m_Samplers.clear();
+		m_Entries.clear();
+	}
+
+	VkSampler SamplerCache::Acquire( const VkSamplerCreateInfo& rCreateInfo )
+	{
+		SamplerKey Key( rCreateInfo );
+
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		m_References++;
+
+		auto Itr = m_Samplers.find( Key );
+
+		if( Itr != m_Samplers.end() )
+		{
+			m_Entries[ Itr->second ].References++;
+			return Itr->second;
+		}
+
+		VkSampler Sampler = VK_NULL_HANDLE;
+		VK_CHECK( vkCreateSampler( VulkanContext::Get().GetDevice(), &rCreateInfo, nullptr, &Sampler ) );
+
+		m_Samplers[ Key ] = Sampler;
+		m_Entries[ Sampler ] = { .Key = Key, .References = 1 };
+
+		return Sampler;
+	}
+
+	void SamplerCache::AddReference( VkSampler Sampler )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		auto Itr = m_Entries.find( Sampler );
+
+		if( Itr == m_Entries.end() )
+			return;
+
+		Itr->second.References++;
+		m_References++;
+	}
+
+	void SamplerCache::Release( VkSampler Sampler )
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		auto Itr = m_Entries.find( Sampler );
+
+		if( Itr == m_Entries.end() )
+			return;
+
+		m_References--;
+
+		if( --Itr->second.References > 0 )
+			return;
+
+		vkDestroySampler( VulkanContext::Get().GetDevice(), Sampler, nullptr );
+
+		m_Samplers.erase( Itr->second.Key );
+		m_Entries.erase( Itr );
+	}
+
+	uint32_t SamplerCache::GetLiveSamplerCount() const
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		return ( uint32_t ) m_Entries.size();
+	}
+
+	uint32_t SamplerCache::GetReferenceCount() const
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+
+		return m_References;
+	}
+}
+
+size_t std::hash< Saturn::SamplerKey >::operator()( const Saturn::SamplerKey& rKey ) const
+{
+	size_t Hash = 0;
+
+	Saturn::HashCombine( Hash, rKey.Flags );
+	Saturn::HashCombine( Hash, ( uint32_t ) rKey.MagFilter );
+	Saturn::HashCombine( Hash, ( uint32_t ) rKey.MinFilter );
+	Saturn::HashCombine( Hash, ( uint32_t ) rKey.MipmapMode );
+	Saturn::HashCombine( Hash, ( uint32_t ) rKey.AddressModeU );
+	Saturn::HashCombine( Hash, ( uint32_t ) rKey.AddressModeV );
+	Saturn::HashCombine( Hash, ( uint32_t ) rKey.AddressModeW );
+	Saturn::HashCombine( Hash, rKey.MipLodBias );
+	Saturn::HashCombine( Hash, rKey.AnisotropyEnable );
+	Saturn::HashCombine( Hash, rKey.MaxAnisotropy );
+	Saturn::HashCombine( Hash, rKey.CompareEnable );
+	Saturn::HashCombine( Hash, ( uint32_t ) rKey.CompareOp );
+	Saturn::HashCombine( Hash, rKey.MinLod );
+	Saturn::HashCombine( Hash, rKey.MaxLod );
+	Saturn::HashCombine( Hash, ( uint32_t ) rKey.BorderColor );
+	Saturn::HashCombine( Hash, rKey.UnnormalizedCoordinates );
+
+	return Hash;
+}
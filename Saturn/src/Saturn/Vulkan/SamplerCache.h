@@ -0,0 +1,115 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "Base.h"
+
+#include <vulkan.h>
+#include <unordered_map>
+#include <mutex>
+
+namespace Saturn {
+
+	// Every sampler setting that a VkSamplerCreateInfo without a pNext chain can hold.
+	struct SamplerKey
+	{
+		VkSamplerCreateFlags Flags = 0;
+		VkFilter MagFilter = VK_FILTER_NEAREST;
+		VkFilter MinFilter = VK_FILTER_NEAREST;
+		VkSamplerMipmapMode MipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		VkSamplerAddressMode AddressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		VkSamplerAddressMode AddressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		VkSamplerAddressMode AddressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		float MipLodBias = 0.0f;
+		VkBool32 AnisotropyEnable = VK_FALSE;
+		float MaxAnisotropy = 1.0f;
+		VkBool32 CompareEnable = VK_FALSE;
+		VkCompareOp CompareOp = VK_COMPARE_OP_NEVER;
+		float MinLod = 0.0f;
+		float MaxLod = 0.0f;
+		VkBorderColor BorderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+		VkBool32 UnnormalizedCoordinates = VK_FALSE;
+
+		SamplerKey() = default;
+		SamplerKey( const VkSamplerCreateInfo& rCreateInfo );
+
+		bool operator==( const SamplerKey& rOther ) const = default;
+	};
+}
+
+namespace std {
+
+	template<>
+	struct hash< Saturn::SamplerKey >
+	{
+		size_t operator()( const Saturn::SamplerKey& rKey ) const;
+	};
+}
+
+namespace Saturn {
+
+	// Textures that sample the same way share one VkSampler, drivers only allow a few thousand of them.
+	// Samplers are reference counted and destroyed once the last user has released them.
+	class SamplerCache
+	{
+	public:
+		SamplerCache();
+		~SamplerCache();
+
+		// Returns the sampler for "rCreateInfo", creating it if no one else uses it. Must be released with Release.
+		VkSampler Acquire( const VkSamplerCreateInfo& rCreateInfo );
+
+		// Adds a reference to a sampler from Acquire, for objects that copy the handle of another.
+		void AddReference( VkSampler Sampler );
+
+		// Samplers that did not come from the cache are ignored.
+		void Release( VkSampler Sampler );
+
+		// Number of VkSamplers that exist.
+		uint32_t GetLiveSamplerCount() const;
+
+		// Number of references to those samplers, this many samplers would exist without the cache.
+		uint32_t GetReferenceCount() const;
+
+	private:
+		struct Entry
+		{
+			SamplerKey Key;
+			uint32_t References = 0;
+		};
+
+		std::unordered_map<SamplerKey, VkSampler> m_Samplers;
+		std::unordered_map<VkSampler, Entry> m_Entries;
+
+		uint32_t m_References = 0;
+
+		// Textures can be loaded from other threads.
+		mutable std::mutex m_Mutex;
+	};
+}
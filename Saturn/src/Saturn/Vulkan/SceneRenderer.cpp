@@ -33,6 +33,10 @@
 
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
+#include "BindlessResources.h"
+#include "GPUProfiler.h"
+#include "MeshGeometryPool.h"
+#include "SamplerCache.h"
 #include "Texture.h"
 #include "Mesh.h"
 #include "Material.h"
@@ -54,6 +58,9 @@
 constexpr auto M_PI = 3.14159265358979323846;
 constexpr auto SHADOW_MAP_SIZE = 4096.0f;
 
+constexpr uint32_t CULL_VIEW_CAMERA = 0;
+constexpr uint32_t CULL_VIEW_FIRST_CASCADE = 1;
+
 namespace Saturn {
 
 	//////////////////////////////////////////////////////////////////////////
@@ -70,8 +77,8 @@ namespace Saturn {
 	{
 		if( m_RendererData.Width == 0 && m_RendererData.Height == 0 )
 		{
-			m_RendererData.Width = Application::Get().GetWindow()->GetWidth();
-			m_RendererData.Height = Application::Get().GetWindow()->GetHeight();
+			m_RendererData.Width = Application::Get().GetWidth();
+			m_RendererData.Height = Application::Get().GetHeight();
 		}
 
 		//////////////////////////////////////////////////////////////////////////
@@ -82,7 +89,6 @@ namespace Saturn {
 			return;
 
 		m_RendererData.StorageBufferSet = Ref<StorageBufferSet>::Create( 0, 0 );
-		m_RendererData.StorageBufferSet->Create( 0, 14 ); // Create Light culling buffer.
 
 		m_RendererData.IsSwapchainTarget = HasFlag( SceneRendererFlag_SwapchainTarget );
 
@@ -131,14 +137,9 @@ namespace Saturn {
 		m_RendererData.AOCompositeTimer.Reset();
 		m_RendererData.AOCompositeTimer.Stop();
 
-		constexpr size_t TransformCount = static_cast<size_t>( 1024 ) * 10;
-		m_RendererData.SubmeshTransformData.resize( MAX_FRAMES_IN_FLIGHT );
-		
-		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
-		{
-			m_RendererData.SubmeshTransformData[ i ].VertexBuffer = Ref<VertexBuffer>::Create( sizeof( TransformBufferData ) * TransformCount );
-			m_RendererData.SubmeshTransformData[ i ].pData = new TransformBufferData[ TransformCount ];
-		}
+		m_RendererData.InstanceScene = Ref<GPUScene>::Create();
+		m_RendererData.Culling = Ref<InstanceCulling>::Create();
+		m_RendererData.MeshletCulling = Ref<ClusterCulling>::Create();
 
 		//////////////////////////////////////////////////////////////////////////
 
@@ -156,6 +157,11 @@ namespace Saturn {
 		return m_RendererData.SceneCompositeFramebuffer->GetColorAttachmentsResources()[ 0 ];
 	}
 
+	void SceneRenderer::SaveCompositeImage( const std::filesystem::path& rPath )
+	{
+		m_RendererData.SceneCompositeFramebuffer->Screenshot( 0, rPath );
+	}
+
 	void SceneRenderer::Terminate()
 	{
 		Renderer::Get().ClearShaderReferences();
@@ -208,6 +214,13 @@ namespace Saturn {
 			m_RendererData.StaticMeshShader = ShaderLibrary::Get().FindOrLoad( "shader_new", "content/shaders/shader_new.glsl" );
 		}
 
+		// Material assets still use "shader_new" for their values, the bindless shader reads them from the material buffer.
+		if( VulkanContext::Get().IsBindlessEnabled() && !m_RendererData.StaticMeshBindlessShader )
+		{
+			m_RendererData.StaticMeshBindlessShader = ShaderLibrary::Get().FindOrLoad( "shader_new_bindless", "content/shaders/shader_new_bindless.glsl" );
+			m_RendererData.StaticMeshBindlessMaterial = Ref<Material>::Create( m_RendererData.StaticMeshBindlessShader, "StaticMeshBindlessMaterial" );
+		}
+
 		if( m_RendererData.StaticMeshPipeline )
 			m_RendererData.StaticMeshPipeline = nullptr;
 
@@ -215,16 +228,10 @@ namespace Saturn {
 		PipelineSpec.Width = m_RendererData.Width;
 		PipelineSpec.Height = m_RendererData.Height;
 		PipelineSpec.Name = "Static Meshes";
-		PipelineSpec.Shader = m_RendererData.StaticMeshShader;
+		PipelineSpec.Shader = VulkanContext::Get().IsBindlessEnabled() ? m_RendererData.StaticMeshBindlessShader : m_RendererData.StaticMeshShader;
 		PipelineSpec.RenderPass = m_RendererData.GeometryPass;
 		PipelineSpec.UseDepthTest = true;
-		PipelineSpec.VertexLayout = {
-			{ ShaderDataType::Float3, "a_Position" },
-			{ ShaderDataType::Float3, "a_Normal" },
-			{ ShaderDataType::Float3, "a_Tangent" },
-			{ ShaderDataType::Float3, "a_Binormal" },
-			{ ShaderDataType::Float2, "a_TexCoord" }
-		};
+		PipelineSpec.VertexLayout = GetCompactStaticVertexLayout();
 		PipelineSpec.InstanceLayout = {
 			{ ShaderDataType::Float4, "a_TransformBufferR1" },
 			{ ShaderDataType::Float4, "a_TransformBufferR2" },
@@ -254,13 +261,7 @@ namespace Saturn {
 		PipelineSpec.Name = "DirShadowMap";
 		PipelineSpec.Shader = m_RendererData.DirShadowMapShader;
 		PipelineSpec.UseDepthTest = true;
-		PipelineSpec.VertexLayout = {
-			{ ShaderDataType::Float3, "a_Position" },
-			{ ShaderDataType::Float3, "a_Normal" },
-			{ ShaderDataType::Float3, "a_Tanget" },
-			{ ShaderDataType::Float3, "a_Position" },
-			{ ShaderDataType::Float2, "a_TexCoord" }
-		};
+		PipelineSpec.VertexLayout = GetCompactStaticVertexLayout();
 		PipelineSpec.InstanceLayout = {
 			{ ShaderDataType::Float4, "a_TransformBufferR1" },
 			{ ShaderDataType::Float4, "a_TransformBufferR2" },
@@ -299,6 +300,66 @@ namespace Saturn {
 
 			m_RendererData.DirShadowMapPipelines[ i ] = Ref< Pipeline >::Create( PipelineSpec );
 		}
+
+		m_RendererData.ShadowMapImage = shadowImage;
+		m_RendererData.LayeredShadows = VulkanContext::Get().IsLayeredRenderingSupported();
+
+		if( !m_RendererData.LayeredShadows )
+			return;
+
+		if( !m_RendererData.DirShadowMapLayeredShader )
+		{
+			m_RendererData.DirShadowMapLayeredShader = ShaderLibrary::Get().FindOrLoad( "ShadowMapLayered", "content/shaders/ShadowMapLayered.glsl" );
+		}
+
+		// Cascades are cleared per layer inside the pass, so the pass has to load.
+		PassSpec.Name = "Dir Shadow Map Layered";
+		PassSpec.LoadDepth = true;
+
+		m_RendererData.DirShadowMapLayeredPass = Ref<Pass>::Create( PassSpec );
+
+		FBSpec.RenderPass = m_RendererData.DirShadowMapLayeredPass;
+		FBSpec.ExistingImageLayer = 0;
+		FBSpec.Layered = true;
+
+		m_RendererData.DirShadowMapLayeredFramebuffer = Ref<Framebuffer>::Create( FBSpec );
+
+		Ref<Image2D> cacheImage = Ref<Image2D>::Create( ImageFormat::DEPTH32F, ( uint32_t ) SHADOW_MAP_SIZE, ( uint32_t ) SHADOW_MAP_SIZE, 4 );
+		cacheImage->SetDebugName( "Static shadow cache image" );
+
+		FBSpec.ExistingImages[ 0 ] = cacheImage;
+
+		m_RendererData.ShadowStaticCacheImage = cacheImage;
+		m_RendererData.ShadowStaticCacheFramebuffer = Ref<Framebuffer>::Create( FBSpec );
+
+		PipelineSpec.Name = "DirShadowMapLayered";
+		PipelineSpec.Shader = m_RendererData.DirShadowMapLayeredShader;
+		PipelineSpec.RenderPass = m_RendererData.DirShadowMapLayeredPass;
+
+		m_RendererData.DirShadowMapLayeredPipeline = Ref< Pipeline >::Create( PipelineSpec );
+
+		// The layered pass loads, so both images have to be in the layout it expects before the first frame.
+		VkCommandBuffer CommandBuffer = VulkanContext::Get().BeginSingleTimeCommands();
+
+		VkImageMemoryBarrier Barriers[ 2 ] = {};
+
+		for( uint32_t i = 0; i < 2; i++ )
+		{
+			Barriers[ i ] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			Barriers[ i ].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barriers[ i ].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barriers[ i ].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			Barriers[ i ].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+			Barriers[ i ].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			Barriers[ i ].subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, SHADOW_CASCADE_COUNT };
+		}
+
+		Barriers[ 0 ].image = shadowImage->GetImage();
+		Barriers[ 1 ].image = cacheImage->GetImage();
+
+		vkCmdPipelineBarrier( CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, 0, 0, nullptr, 0, nullptr, 2, Barriers );
+
+		VulkanContext::Get().EndSingleTimeCommands( CommandBuffer );
 	}
 
 	void SceneRenderer::InitPreDepth()
@@ -354,13 +415,7 @@ namespace Saturn {
 		PipelineSpec.RequestDescriptorSets = { ShaderType::Vertex, 0 };
 		PipelineSpec.DepthCompareOp = VK_COMPARE_OP_LESS;
 		PipelineSpec.HasColorAttachment = false;
-		PipelineSpec.VertexLayout = {
-			{ ShaderDataType::Float3, "a_Position" },
-			{ ShaderDataType::Float3, "a_Normal" },
-			{ ShaderDataType::Float3, "a_Tanget" },
-			{ ShaderDataType::Float3, "a_Position" },
-			{ ShaderDataType::Float2, "a_TexCoord" }
-		};
+		PipelineSpec.VertexLayout = GetCompactStaticVertexLayout();
 		PipelineSpec.InstanceLayout = {
 			{ ShaderDataType::Float4, "a_TransformBufferR1" },
 			{ ShaderDataType::Float4, "a_TransformBufferR2" },
@@ -370,6 +425,14 @@ namespace Saturn {
 
 		m_RendererData.PreDepthPipeline = Ref<Pipeline>::Create( PipelineSpec );
 
+		//////////////////////////////////////////////////////////////////////////
+		// Hi-Z
+		//////////////////////////////////////////////////////////////////////////
+		if( !m_RendererData.HiZ )
+			m_RendererData.HiZ = Ref<HiZPyramid>::Create();
+
+		m_RendererData.HiZ->Resize( m_RendererData.Width, m_RendererData.Height, m_RendererData.PreDepthFramebuffer->GetDepthAttachmentsResource() );
+
 		//////////////////////////////////////////////////////////////////////////
 		// Light culling
 		//////////////////////////////////////////////////////////////////////////
@@ -378,12 +441,23 @@ namespace Saturn {
 
 		m_RendererData.LightCullingPipeline = Ref<ComputePipeline>::Create( m_RendererData.LightCullingShader );
 
-		if( m_RendererData.LightCullingDescriptorSet )
-			m_RendererData.LightCullingDescriptorSet = nullptr;
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			m_RendererData.LightCullingDescriptorSets[ i ] = m_RendererData.LightCullingShader->CreateDescriptorSet( 0 );
 
-		m_RendererData.LightCullingDescriptorSet = m_RendererData.LightCullingShader->CreateDescriptorSet( 0 );
+			// Buffers are sized in the light culling pass, they do not depend on the viewport so only create them once.
+			if( m_RendererData.PointLightBuffers[ i ] )
+				continue;
+
+			m_RendererData.PointLightBuffers[ i ] = Ref<StorageBuffer>::Create( 0, 0, VMA_MEMORY_USAGE_CPU_TO_GPU );
+			m_RendererData.LightClusterBuffers[ i ] = Ref<StorageBuffer>::Create( 0, 1 );
+			m_RendererData.LightIndexBuffers[ i ] = Ref<StorageBuffer>::Create( 0, 2 );
+			m_RendererData.LightIndexCounterBuffers[ i ] = Ref<StorageBuffer>::Create( 0, 3, VMA_MEMORY_USAGE_GPU_TO_CPU );
 
-		m_RendererData.LightCullingShader->WriteDescriptor( "u_PreDepth", m_RendererData.PreDepthFramebuffer->GetDepthAttachmentsResource()->GetDescriptorInfo(), m_RendererData.LightCullingDescriptorSet->GetVulkanSet() );
+			uint32_t Zero = 0;
+			m_RendererData.LightIndexCounterBuffers[ i ]->Resize( sizeof( uint32_t ) );
+			m_RendererData.LightIndexCounterBuffers[ i ]->SetData( &Zero, sizeof( uint32_t ) );
+		}
 	}
 
 	void SceneRenderer::InitSceneComposite()
@@ -517,13 +591,7 @@ namespace Saturn {
 		PipelineSpec.RequestDescriptorSets = { ShaderType::Vertex, 0 };
 		PipelineSpec.FrontFace = VK_FRONT_FACE_CLOCKWISE;
 		PipelineSpec.PolygonMode = VK_POLYGON_MODE_LINE;
-		PipelineSpec.VertexLayout = {
-			{ ShaderDataType::Float3, "a_Position" },
-			{ ShaderDataType::Float3, "a_Normal" },
-			{ ShaderDataType::Float3, "a_Tanget" },
-			{ ShaderDataType::Float3, "a_Position" },
-			{ ShaderDataType::Float2, "a_TexCoord" }
-		};
+		PipelineSpec.VertexLayout = GetCompactStaticVertexLayout();
 		PipelineSpec.InstanceLayout = {
 			{ ShaderDataType::Float4, "a_TransformBufferR1" },
 			{ ShaderDataType::Float4, "a_TransformBufferR2" },
@@ -832,13 +900,69 @@ namespace Saturn {
 			lightOrthoMatrix[ 3 ] += roundOffset;
 
 			// Store split distance and matrix in cascade
+			// A cascade that is not rendered this frame keeps the matrix its shadow map was rendered with.
 			m_RendererData.ShadowCascades[ i ].SplitDepth = ( NEAR_CLIP + splitDist * CLIP_RANGE ) * -1.0f;
-			m_RendererData.ShadowCascades[ i ].ViewProjection = lightOrthoMatrix * lightViewMatrix;
+
+			if( m_RendererData.CascadeUpdateMask & ( 1u << i ) )
+				m_RendererData.ShadowCascades[ i ].ViewProjection = lightOrthoMatrix * lightViewMatrix;
 
 			lastSplitDist = cascadeSplits[ i ];
 		}
 	}
 
+	void SceneRenderer::ScheduleCascades( const glm::vec3& Direction )
+	{
+		SAT_PF_EVENT();
+
+		m_RendererData.CascadeUpdateMask = 0;
+
+		for( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			uint64_t Interval = ( uint64_t ) std::max( m_RendererData.CascadeUpdateIntervals[ i ], 1 );
+
+			// Offset by the cascade so cascades with the same interval do not all land on the same frame.
+			if( !m_RendererData.ShadowCascades[ i ].Rendered || ( m_RendererData.ShadowFrameIndex + i ) % Interval == 0 )
+				m_RendererData.CascadeUpdateMask |= 1u << i;
+		}
+
+		m_RendererData.ShadowFrameIndex++;
+
+		UpdateCascades( Direction );
+
+		m_RendererData.CascadeCacheRebuildMask = 0;
+		m_RendererData.CascadeCacheCopyMask = 0;
+
+		// The static cache only needs rendering again when the cascade moved or the set of static casters changed.
+		if( m_RendererData.LayeredShadows && m_RendererData.CacheStaticShadows )
+		{
+			uint64_t StaticVersion = m_RendererData.InstanceScene->GetStaticVersion();
+
+			for( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+			{
+				ShadowCascade& rCascade = m_RendererData.ShadowCascades[ i ];
+
+				if( !( m_RendererData.CascadeUpdateMask & ( 1u << i ) ) )
+					continue;
+
+				if( rCascade.CachedStaticVersion != StaticVersion || rCascade.CachedViewProjection != rCascade.ViewProjection )
+				{
+					m_RendererData.CascadeCacheRebuildMask |= 1u << i;
+
+					rCascade.CachedStaticVersion = StaticVersion;
+					rCascade.CachedViewProjection = rCascade.ViewProjection;
+				}
+			}
+
+			m_RendererData.CascadeCacheCopyMask = m_RendererData.CascadeUpdateMask;
+		}
+
+		for( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			if( m_RendererData.CascadeUpdateMask & ( 1u << i ) )
+				m_RendererData.ShadowCascades[ i ].Rendered = true;
+		}
+	}
+
 	void SceneRenderer::CreateGridComponents()
 	{
 		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
@@ -955,6 +1079,11 @@ namespace Saturn {
 			ImGui::Text( "SceneRenderer::ShadowMapPass: %.2f ms", shadowPassTime );
 
 			ImGui::Text( "SceneRenderer::LightCulling: %.4f ms", m_RendererData.LightCullingTimer.ElapsedMilliseconds() );
+			ImGui::Text( "Light clusters: %u x %u x %u", m_RendererData.LightClusterCount.x, m_RendererData.LightClusterCount.y, m_RendererData.LightClusterCount.z );
+			ImGui::Text( "Light indices: %u / %u", m_RendererData.LightIndicesUsed, m_RendererData.LightIndexCapacity );
+
+			ImGui::Checkbox( "Occlusion culling", &m_RendererData.EnableOcclusionCulling );
+			ImGui::Text( "Occluded: %u / %u", m_RendererData.OcclusionCulled, m_RendererData.OcclusionTested );
 
 			ImGui::Text( "SceneRenderer::GeometryPass: %.2f ms", m_RendererData.GeometryPassTimer.ElapsedMilliseconds() );
 
@@ -967,6 +1096,52 @@ namespace Saturn {
 			ImGui::Text( "Total (RenderThread::Execute): %.2f ms", RenderThread::Get().GetWaitTime() );
 			ImGui::Text( "Total : %.2f ms", Application::Get().Time().Milliseconds() );
 
+			const RendererStats& rStats = Renderer::Get().GetLastFrameStats();
+
+			ImGui::Text( "Descriptor writes: %u", rStats.DescriptorWrites );
+			ImGui::Text( "Descriptor set allocations: %u", rStats.DescriptorSetAllocations );
+			ImGui::Text( "Descriptor set cache hits: %u", rStats.DescriptorSetCacheHits );
+			ImGui::Text( "Cached descriptor sets: %u", Renderer::Get().GetDescriptorSetCache()->GetLiveSetCount() );
+
+			if( VulkanContext::Get().IsBindlessEnabled() )
+			{
+				auto* pBindless = VulkanContext::Get().GetBindlessResources();
+
+				ImGui::Text( "Bindless textures: %u / %u", pBindless->GetTextureCount(), pBindless->GetMaxTextures() );
+				ImGui::Text( "Bindless materials: %u", pBindless->GetMaterialCount() );
+			}
+
+			auto& rInstanceScene = m_RendererData.InstanceScene;
+
+			ImGui::Text( "Instances: %u / %u slots", rInstanceScene->GetInstanceCount(), rInstanceScene->GetSlotCapacity() );
+			ImGui::Text( "Dirty instances: %u (%zu bytes uploaded)", rInstanceScene->GetDirtyCount(), rInstanceScene->GetUploadSize() );
+
+			auto* pGeometryPool = VulkanContext::Get().GetMeshGeometryPool();
+
+			ImGui::Text( "Mesh geometry: %u meshes, %u / %u vertices, %u / %u indices", pGeometryPool->GetAllocationCount(),
+				pGeometryPool->GetVerticesUsed(), pGeometryPool->GetVertexCapacity(), pGeometryPool->GetIndicesUsed(), pGeometryPool->GetIndexCapacity() );
+
+			if( ImGui::Button( "Defragment mesh geometry" ) )
+				pGeometryPool->RequestDefragment();
+
+			auto* pSamplerCache = VulkanContext::Get().GetSamplerCache();
+
+			ImGui::Text( "Samplers: %u live, %u references", pSamplerCache->GetLiveSamplerCount(), pSamplerCache->GetReferenceCount() );
+
+			ImGui::Checkbox( "GPU culling", &m_RendererData.EnableGPUCulling );
+			ImGui::Text( "Culled draws: %u x %u views", m_RendererData.Culling->GetDrawCount(), m_RendererData.Culling->GetViewCount() );
+
+			ImGui::Checkbox( "Cluster culling", &m_RendererData.EnableClusterCulling );
+			ImGui::Text( "Cluster culled draws: %u, %u meshlets", m_RendererData.MeshletCulling->GetDrawCount(), m_RendererData.MeshletCulling->GetMeshletCount() );
+
+			ImGui::Checkbox( "Mesh LODs", &m_RendererData.EnableLods );
+			ImGui::SliderInt( "LOD bias", &m_RendererData.LodBias, -( int ) MAX_SUBMESH_LODS + 1, ( int ) MAX_SUBMESH_LODS - 1 );
+			ImGui::SliderInt( "Shadow LOD bias", &m_RendererData.ShadowLodBias, 0, ( int ) MAX_SUBMESH_LODS - 1 );
+			ImGui::DragScalarN( "LOD screen sizes", ImGuiDataType_Float, m_RendererData.LodScreenSizes, MAX_SUBMESH_LODS - 1, 0.005f );
+
+			for( uint32_t i = 0; i < MAX_SUBMESH_LODS; i++ )
+				ImGui::Text( "LOD %u: %u instances", i, m_RendererData.LodInstanceStats[ i ] );
+
 			if( ImGui::Button( "Screenshot" ) )
 			{
 				m_RendererData.SceneCompositeFramebuffer->Screenshot( 0, "SceneComp.png" );
@@ -975,6 +1150,48 @@ namespace Saturn {
 			Auxiliary::EndTreeNode();
 		}
 
+		if( Auxiliary::TreeNode( "GPU Timings", false ) )
+		{
+			GPUProfiler* pProfiler = VulkanContext::Get().GetGPUProfiler();
+
+			if( pProfiler->IsSupported() )
+			{
+				ImGui::Text( "GPU frame: %.3f ms", pProfiler->GetFrameTime() );
+
+				for( const GPUProfilerScope& rScope : pProfiler->GetResults() )
+					ImGui::Text( "%*s%s: %.3f ms", ( int ) rScope.Depth * 2, "", rScope.Name.c_str(), rScope.Milliseconds );
+
+				if( pProfiler->IsCapturing() )
+				{
+					ImGui::Text( "Capturing... (%u frames)", pProfiler->GetCapturedFrameCount() );
+				}
+				else
+				{
+					if( ImGui::Button( "Capture 300 frames" ) )
+						pProfiler->StartCapture( 300 );
+
+					if( pProfiler->GetCapturedFrameCount() )
+					{
+						ImGui::SameLine();
+
+						if( ImGui::Button( "Save CSV" ) )
+							pProfiler->SaveCapture( "GPUCapture.csv" );
+
+						ImGui::SameLine();
+
+						if( ImGui::Button( "Save JSON" ) )
+							pProfiler->SaveCapture( "GPUCapture.json" );
+					}
+				}
+			}
+			else
+			{
+				ImGui::Text( "Timestamp queries are not supported." );
+			}
+
+			Auxiliary::EndTreeNode();
+		}
+
 		// TEMP: Move to skylight entity.
 		if( Auxiliary::TreeNode( "Environment", false ) )
 		{
@@ -994,6 +1211,14 @@ namespace Saturn {
 
 				ImGui::Checkbox( "Enable shadows", &m_RendererData.EnableShadows );
 
+				ImGui::Text( "Layered cascades: %s", m_RendererData.LayeredShadows ? "Yes" : "No (VK_EXT_shader_viewport_index_layer not supported)" );
+				ImGui::DragInt4( "Cascade update intervals", m_RendererData.CascadeUpdateIntervals, 0.1f, 1, 16 );
+
+				if( m_RendererData.LayeredShadows )
+					ImGui::Checkbox( "Cache static shadows", &m_RendererData.CacheStaticShadows );
+
+				ImGui::Text( "Cascades rendered: %u / %i (%u from cache)", m_RendererData.CascadesUpdated, SHADOW_CASCADE_COUNT, m_RendererData.CascadesFromCache );
+
 				static int index = 0;
 				auto framebuffer = m_RendererData.ShadowCascades[ index ].Framebuffer->GetDepthAttachmentsResource();
 
@@ -1064,35 +1289,32 @@ namespace Saturn {
 		auto& submeshes = mesh->Submeshes();
 		for( size_t i = 0; i < submeshes.size(); i++ )
 		{
-			StaticMeshKey key = { mesh->ID, materialRegistry, (uint32_t)i };
-
 			glm::mat4 submeshTransform = transform * submeshes[ i ].Transform;
 
+			uint32_t lod = SelectLod( submeshes[ i ], submeshTransform );
+			m_RendererData.LodInstanceCounts[ lod ]++;
+
+			StaticMeshKey key = { mesh->ID, materialRegistry, (uint32_t)i, lod };
+
 			auto& command = m_DrawList[ key ];
 			command.entity = entity;
 			command.Mesh = mesh;
 			command.SubmeshIndex = ( uint32_t ) i;
+			command.Lod = lod;
 			command.Instances++;
+			command.Transforms.push_back( submeshTransform );
+
+			// Same key so the shadow draw reads the same instances, only the index range is coarser.
+			uint32_t shadowLod = ( uint32_t ) glm::clamp( ( int ) lod + m_RendererData.ShadowLodBias, 0, ( int ) submeshes[ i ].GetLodCount() - 1 );
 
 			auto& shadow = m_ShadowMapDrawList[ key ];
 			shadow.entity = entity;
 			shadow.Mesh = mesh;
 			shadow.SubmeshIndex = ( uint32_t ) i;
+			shadow.Lod = shadowLod;
 			shadow.Instances++;
 
-			auto& data = m_RendererData.MeshTransforms[ key ].Data.emplace_back();
-			data.TransfromBufferR[ 0 ] = {
-				submeshTransform[ 0 ][ 0 ], submeshTransform[ 1 ][ 0 ], submeshTransform[ 2 ][ 0 ], submeshTransform[ 3 ][ 0 ]
-			};
-			data.TransfromBufferR[ 1 ] = {
-				submeshTransform[ 0 ][ 1 ], submeshTransform[ 1 ][ 1 ], submeshTransform[ 2 ][ 1 ], submeshTransform[ 3 ][ 1 ]
-			};
-			data.TransfromBufferR[ 2 ] = {
-				submeshTransform[ 0 ][ 2 ], submeshTransform[ 1 ][ 2 ], submeshTransform[ 2 ][ 2 ], submeshTransform[ 3 ][ 2 ]
-			};
-			data.TransfromBufferR[ 3 ] = {
-				submeshTransform[ 0 ][ 3 ], submeshTransform[ 1 ][ 3 ], submeshTransform[ 2 ][ 3 ], submeshTransform[ 3 ][ 3 ]
-			};
+			m_RendererData.InstanceScene->Submit( key, entity->GetUUID(), submeshTransform );
 		}
 	}
 
@@ -1104,7 +1326,8 @@ namespace Saturn {
 		auto& submeshes = mesh->Submeshes();
 		for( size_t i = 0; i < submeshes.size(); i++ )
 		{
-			StaticMeshKey key = { mesh->ID, materialRegistry, ( uint32_t ) i };
+			// Must be the key the mesh was submitted with as the instances come from the same GPUScene range, colliders are always drawn at LOD 0.
+			StaticMeshKey key = { mesh->ID, materialRegistry, ( uint32_t ) i, SelectLod( submeshes[ i ], transform * submeshes[ i ].Transform ) };
 
 			auto& command = m_PhysicsColliderDrawList[ key ];
 			command.entity = entity;
@@ -1225,6 +1448,13 @@ namespace Saturn {
 		// Set environment resource.
 		Renderer::Get().SetSceneEnvironment( m_RendererData.ShadowCascades[ 0 ].Framebuffer->GetDepthAttachmentsResource(), m_RendererData.SceneEnvironment, m_RendererData.BRDFLUT_Texture );
 
+		uint32_t frame = Renderer::Get().GetCurrentFrame();
+
+		Renderer::Get().SetSceneLightBuffers( 
+			m_RendererData.PointLightBuffers[ frame ]->GetBufferInfo(),
+			m_RendererData.LightClusterBuffers[ frame ]->GetBufferInfo(),
+			m_RendererData.LightIndexBuffers[ frame ]->GetBufferInfo() );
+
 		RenderStaticMeshes();
 
 		CmdEndDebugLabel( m_RendererData.CommandBuffer );
@@ -1241,70 +1471,114 @@ namespace Saturn {
 	{
 		uint32_t frame = Renderer::Get().GetCurrentFrame();
 
-		Ref< Shader > StaticMeshShader = m_RendererData.StaticMeshShader;
+		const bool Bindless = VulkanContext::Get().IsBindlessEnabled();
 
-		for( auto&& [key, Cmd] : m_DrawList )
-		{
-			// Entity may of been deleted.
-			if( !Cmd.entity )
-				continue;
+		Ref< Shader > StaticMeshShader = Bindless ? m_RendererData.StaticMeshBindlessShader : m_RendererData.StaticMeshShader;
 
-			auto& uuid = Cmd.entity->GetComponent<IdComponent>().ID;
-
-			// u_Matrices
-			RendererData::StaticMeshMatrices u_Matrices = {};
-			u_Matrices.View = m_RendererData.CurrentCamera.ViewMatrix;
-			u_Matrices.ViewProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix;
-
-			LightData u_LightData = {};
-			RendererData::PointLights u_Lights;
+		if( m_DrawList.empty() )
+			return;
 
-			u_Lights.nbLights = int( m_pScene->m_Lights.PointLights.size() );
+		// u_Matrices
+		RendererData::StaticMeshMatrices u_Matrices = {};
+		u_Matrices.View = m_RendererData.CurrentCamera.ViewMatrix;
+		u_Matrices.ViewProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix;
 
-			memcpy( u_Lights.Lights, m_pScene->m_Lights.PointLights.data(), m_pScene->m_Lights.GetPointLightSize() );
+		LightData u_LightData = {};
 
-			SceneData u_SceneData = {};
-			ShadowData u_ShadowData = {};
+		SceneData u_SceneData = {};
+		ShadowData u_ShadowData = {};
 
-			struct DebugData
-			{
-				int TilesCountX;
-			} u_DebugData = {};
+		// Point lights are in set 1, uploaded by the light culling pass.
+		struct ClusterData
+		{
+			glm::uvec4 ClusterCount;
+			glm::vec2 ClusterZParams;
+		} u_ClusterData = {};
 
-			u_DebugData.TilesCountX = ( int ) m_RendererData.LightCullingWorkGroups.x;
+		u_ClusterData.ClusterCount = glm::uvec4( m_RendererData.LightClusterCount, LIGHT_CLUSTER_TILE_SIZE );
+		u_ClusterData.ClusterZParams = m_RendererData.LightClusterZParams;
 
-			auto dirLight = m_pScene->m_Lights.DirectionalLights[ 0 ];
+		auto dirLight = m_pScene->m_Lights.DirectionalLights[ 0 ];
 
-			auto invView = glm::inverse( u_Matrices.View );
+		auto invView = glm::inverse( u_Matrices.View );
 
-			u_SceneData.CameraPosition = invView[ 3 ];
-			u_SceneData.Lights = { .Direction = dirLight.Direction, .Radiance = dirLight.Radiance, .Multiplier = dirLight.Intensity };
+		u_SceneData.CameraPosition = invView[ 3 ];
+		u_SceneData.Lights = { .Direction = dirLight.Direction, .Radiance = dirLight.Radiance, .Multiplier = dirLight.Intensity };
 
-			if( m_RendererData.EnableShadows )
+		if( m_RendererData.EnableShadows )
+		{
+			for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
 			{
-				for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
-				{
-					u_ShadowData.CascadeSplits[ i ] = m_RendererData.ShadowCascades[ i ].SplitDepth;
-					u_LightData.LightMatrix[ i ] = m_RendererData.ShadowCascades[ i ].ViewProjection;
-				}
+				u_ShadowData.CascadeSplits[ i ] = m_RendererData.ShadowCascades[ i ].SplitDepth;
+				u_LightData.LightMatrix[ i ] = m_RendererData.ShadowCascades[ i ].ViewProjection;
 			}
+		}
 
-			StaticMeshShader->UploadUB( ShaderType::Vertex, 0, 0, &u_Matrices, sizeof( u_Matrices ) );
-			StaticMeshShader->UploadUB( ShaderType::Vertex, 0, 1, &u_LightData, sizeof( u_LightData ) );
+		// Same for every mesh, so only upload once.
+		StaticMeshShader->UploadUB( ShaderType::Vertex, 0, 0, &u_Matrices, sizeof( u_Matrices ) );
+		StaticMeshShader->UploadUB( ShaderType::Vertex, 0, 1, &u_LightData, sizeof( u_LightData ) );
 
-			StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 2, &u_SceneData, sizeof( u_SceneData ) );
-			StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 3, &u_ShadowData, sizeof( u_ShadowData ) );
-			StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 12, &u_DebugData, sizeof( u_DebugData ) );
+		StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 2, &u_SceneData, sizeof( u_SceneData ) );
+		StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 3, &u_ShadowData, sizeof( u_ShadowData ) );
+		StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 12, &u_ClusterData, sizeof( u_ClusterData ) );
 
-			//StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 13, &u_Lights, sizeof( u_Lights ) );
-			StaticMeshShader->UploadUB( ShaderType::Fragment, 0, 13, &u_Lights, 16ull + sizeof( PointLight ) * u_Lights.nbLights );
+		if( Bindless )
+		{
+			RenderStaticMeshesBindless();
+			return;
+		}
+
+		for( auto&& [key, Cmd] : m_DrawList )
+		{
+			// Entity may of been deleted.
+			if( !Cmd.entity || Cmd.Occluded )
+				continue;
 
-			const auto& rTransformData = m_RendererData.MeshTransforms[ key ];
+			InstanceDrawData Instances = GetInstanceDrawData( key, CULL_VIEW_CAMERA );
 
 			// Render Submesh
 			Renderer::Get().SubmitMesh( m_RendererData.CommandBuffer,
 				m_RendererData.StaticMeshPipeline,
-				Cmd.Mesh, m_RendererData.StorageBufferSet, key.Registry, Cmd.SubmeshIndex, Cmd.Instances, m_RendererData.SubmeshTransformData[ frame ].VertexBuffer, rTransformData.Offset );
+				Cmd.Mesh, m_RendererData.StorageBufferSet, key.Registry, Cmd.SubmeshIndex, Cmd.Lod, Cmd.Instances, Instances.InstanceBuffer, Instances.InstanceOffset, Instances.Indirect );
+		}
+	}
+
+	void SceneRenderer::RenderStaticMeshesBindless()
+	{
+		uint32_t frame = Renderer::Get().GetCurrentFrame();
+
+		Ref<Shader> BindlessShader = m_RendererData.StaticMeshBindlessShader;
+		Ref<Material> BindlessMaterial = m_RendererData.StaticMeshBindlessMaterial;
+		VkPipelineLayout Layout = m_RendererData.StaticMeshPipeline->GetPipelineLayout();
+
+		// Set 0, uniform buffers are only written when the set is first created.
+		BindlessMaterial->RN_Update();
+
+		m_RendererData.StaticMeshPipeline->Bind( m_RendererData.CommandBuffer );
+
+		// Descriptor set 0, uniform buffers.
+		// Descriptor set 1, environment data.
+		// Descriptor set 2, bindless textures and materials.
+		std::array<VkDescriptorSet, 2> DescriptorSets = {
+			BindlessMaterial->GetDescriptorSet( frame ),
+			Renderer::Get().GetSceneEnvironmentSet()
+		};
+
+		vkCmdBindDescriptorSets( m_RendererData.CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Layout, 0, ( uint32_t ) DescriptorSets.size(), DescriptorSets.data(), 0, nullptr );
+
+		VulkanContext::Get().GetBindlessResources()->Bind( m_RendererData.CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Layout, 2 );
+
+		for( auto&& [key, Cmd] : m_DrawList )
+		{
+			// Entity may of been deleted.
+			if( !Cmd.entity || Cmd.Occluded )
+				continue;
+
+			InstanceDrawData Instances = GetInstanceDrawData( key, CULL_VIEW_CAMERA );
+
+			Renderer::Get().SubmitMeshBindless( m_RendererData.CommandBuffer,
+				m_RendererData.StaticMeshPipeline,
+				Cmd.Mesh, key.Registry, Cmd.SubmeshIndex, Cmd.Lod, Cmd.Instances, Instances.InstanceBuffer, Instances.InstanceOffset, Instances.Indirect );
 		}
 	}
 
@@ -1315,6 +1589,19 @@ namespace Saturn {
 		if( !m_RendererData.EnableShadows )
 			return;
 
+		for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			m_RendererData.ShadowMapTimers[ i ].Reset();
+			m_RendererData.ShadowMapTimers[ i ].Stop();
+		}
+
+		m_RendererData.CascadesUpdated = 0;
+		m_RendererData.CascadesFromCache = 0;
+
+		// Every cascade keeps last frame's shadow map.
+		if( !m_RendererData.CascadeUpdateMask )
+			return;
+
 		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
 		VkExtent2D Extent = { ( uint32_t ) SHADOW_MAP_SIZE, ( uint32_t ) SHADOW_MAP_SIZE };
 		VkCommandBuffer CommandBuffer = m_RendererData.CommandBuffer;
@@ -1340,9 +1627,7 @@ namespace Saturn {
 
 		//////////////////////////////////////////////////////////////////////////
 
-		Ref< Shader > ShadowShader = m_RendererData.DirShadowMapShader;
-
-		UpdateCascades( m_pScene->m_Lights.DirectionalLights[ 0 ].Direction );
+		Ref< Shader > ShadowShader = m_RendererData.LayeredShadows ? m_RendererData.DirShadowMapLayeredShader : m_RendererData.DirShadowMapShader;
 
 		// u_Matrices
 		struct UB_Matrices
@@ -1357,14 +1642,37 @@ namespace Saturn {
 			u_Matrices.ViewProjection[ i ] = m_RendererData.ShadowCascades[ i ].ViewProjection;
 		}
 
-		auto pData = m_RendererData.DirShadowMapShader->MapUB( ShaderType::Vertex, 0, 0 );
+		auto pData = ShadowShader->MapUB( ShaderType::Vertex, 0, 0 );
 
 		memcpy( pData, &u_Matrices, sizeof( u_Matrices ) );
 
-		m_RendererData.DirShadowMapShader->UnmapUB( ShaderType::Vertex, 0, 0 );
+		ShadowShader->UnmapUB( ShaderType::Vertex, 0, 0 );
+
+		for( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			if( m_RendererData.CascadeUpdateMask & ( 1u << i ) )
+				m_RendererData.CascadesUpdated++;
+
+			if( m_RendererData.CascadeCacheCopyMask & ~m_RendererData.CascadeCacheRebuildMask & ( 1u << i ) )
+				m_RendererData.CascadesFromCache++;
+		}
+
+		if( m_RendererData.LayeredShadows )
+		{
+			m_RendererData.ShadowMapTimers[ 0 ].Reset();
+
+			DirShadowMapLayeredPass();
+
+			m_RendererData.ShadowMapTimers[ 0 ].Stop();
+
+			return;
+		}
 
 		for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
 		{
+			if( !( m_RendererData.CascadeUpdateMask & ( 1u << i ) ) )
+				continue;
+
 			m_RendererData.ShadowMapTimers[ i ].Reset();
 
 			RenderPassBeginInfo.framebuffer = m_RendererData.ShadowCascades[ i ].Framebuffer->GetVulkanFramebuffer();
@@ -1378,24 +1686,207 @@ namespace Saturn {
 			vkCmdSetViewport( m_RendererData.CommandBuffer, 0, 1, &Viewport );
 			vkCmdSetScissor( m_RendererData.CommandBuffer, 0, 1, &Scissor );
 
-			for( auto&& [key, Cmd] : m_ShadowMapDrawList )
-			{
-				// Entity may of been deleted.
-				if( !Cmd.entity )
-					continue;
+			RenderShadowCasters( m_RendererData.DirShadowMapPipelines[ i ], 1u << i, ShadowCasterFilter::All );
 
-				// Pass in the cascade index.
-				Buffer AdditionalData( sizeof( uint32_t ), &i );
+			vkCmdEndRenderPass( CommandBuffer );
+			CmdEndDebugLabel( CommandBuffer );
+
+			m_RendererData.ShadowMapTimers[ i ].Stop();
+		}
+	}
+
+	void SceneRenderer::DirShadowMapLayeredPass()
+	{
+		SAT_PF_EVENT();
+
+		VkExtent2D Extent = { ( uint32_t ) SHADOW_MAP_SIZE, ( uint32_t ) SHADOW_MAP_SIZE };
+		VkCommandBuffer CommandBuffer = m_RendererData.CommandBuffer;
+
+		Ref<Pipeline>& rPipeline = m_RendererData.DirShadowMapLayeredPipeline;
 
-				const auto& rTransformData = m_RendererData.MeshTransforms[ key ];
+		// The pass loads, layers are cleared with vkCmdClearAttachments so cascades that are not updated keep their depth.
+		VkRenderPassBeginInfo RenderPassBeginInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+		RenderPassBeginInfo.renderArea.extent = Extent;
+		RenderPassBeginInfo.renderPass = m_RendererData.DirShadowMapLayeredPass->GetVulkanPass();
 
-				Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, m_RendererData.DirShadowMapPipelines[ i ], Cmd.Mesh, Cmd.Instances, m_RendererData.SubmeshTransformData[ frame ].VertexBuffer, rTransformData.Offset, Cmd.SubmeshIndex, AdditionalData );
+		VkViewport Viewport = {};
+		Viewport.x = 0;
+		Viewport.y = 0;
+		Viewport.width = SHADOW_MAP_SIZE;
+		Viewport.height = SHADOW_MAP_SIZE;
+		Viewport.minDepth = 0.0f;
+		Viewport.maxDepth = 1.0f;
+
+		VkRect2D Scissor = { .offset = { 0, 0 }, .extent = Extent };
+
+		auto ClearCascades = [&]( uint32_t CascadeMask )
+		{
+			VkClearAttachment ClearAttachment = {};
+			ClearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+			ClearAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+			VkClearRect Rects[ SHADOW_CASCADE_COUNT ] = {};
+			uint32_t RectCount = 0;
+
+			for( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+			{
+				if( CascadeMask & ( 1u << i ) )
+					Rects[ RectCount++ ] = { Scissor, i, 1 };
 			}
 
+			if( RectCount )
+				vkCmdClearAttachments( CommandBuffer, 1, &ClearAttachment, RectCount, Rects );
+		};
+
+		rPipeline->GetShader()->WriteAllUBs( rPipeline->GetDescriptorSet( ShaderType::Vertex, 0 ) );
+
+		if( m_RendererData.CascadeCacheRebuildMask )
+		{
+			RenderPassBeginInfo.framebuffer = m_RendererData.ShadowStaticCacheFramebuffer->GetVulkanFramebuffer();
+
+			CmdBeginDebugLabel( CommandBuffer, "ShadowMap Static Cache" );
+			vkCmdBeginRenderPass( CommandBuffer, &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
+
+			vkCmdSetViewport( CommandBuffer, 0, 1, &Viewport );
+			vkCmdSetScissor( CommandBuffer, 0, 1, &Scissor );
+
+			ClearCascades( m_RendererData.CascadeCacheRebuildMask );
+
+			RenderShadowCasters( rPipeline, m_RendererData.CascadeCacheRebuildMask, ShadowCasterFilter::Static );
+
 			vkCmdEndRenderPass( CommandBuffer );
 			CmdEndDebugLabel( CommandBuffer );
+		}
 
-			m_RendererData.ShadowMapTimers[ i ].Stop();
+		if( m_RendererData.CascadeCacheCopyMask )
+			CopyStaticShadowCache();
+
+		RenderPassBeginInfo.framebuffer = m_RendererData.DirShadowMapLayeredFramebuffer->GetVulkanFramebuffer();
+
+		CmdBeginDebugLabel( CommandBuffer, "ShadowMap" );
+		vkCmdBeginRenderPass( CommandBuffer, &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
+
+		vkCmdSetViewport( CommandBuffer, 0, 1, &Viewport );
+		vkCmdSetScissor( CommandBuffer, 0, 1, &Scissor );
+
+		// Cascades that came from the cache already have their depth.
+		ClearCascades( m_RendererData.CascadeUpdateMask & ~m_RendererData.CascadeCacheCopyMask );
+
+		ShadowCasterFilter Filter = m_RendererData.CascadeCacheCopyMask ? ShadowCasterFilter::Dynamic : ShadowCasterFilter::All;
+
+		RenderShadowCasters( rPipeline, m_RendererData.CascadeUpdateMask, Filter );
+
+		vkCmdEndRenderPass( CommandBuffer );
+		CmdEndDebugLabel( CommandBuffer );
+	}
+
+	void SceneRenderer::CopyStaticShadowCache()
+	{
+		SAT_PF_EVENT();
+
+		VkCommandBuffer CommandBuffer = m_RendererData.CommandBuffer;
+
+		VkImage CacheImage = m_RendererData.ShadowStaticCacheImage->GetImage();
+		VkImage ShadowImage = m_RendererData.ShadowMapImage->GetImage();
+
+		VkImageMemoryBarrier Barriers[ 2 ] = {};
+
+		for( uint32_t i = 0; i < 2; i++ )
+		{
+			Barriers[ i ] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			Barriers[ i ].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barriers[ i ].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barriers[ i ].subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, SHADOW_CASCADE_COUNT };
+		}
+
+		// The cache may have just been rendered, the shadow map was sampled by the last frame.
+		Barriers[ 0 ].image = CacheImage;
+		Barriers[ 0 ].oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		Barriers[ 0 ].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		Barriers[ 0 ].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		Barriers[ 0 ].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		Barriers[ 1 ].image = ShadowImage;
+		Barriers[ 1 ].oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		Barriers[ 1 ].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		Barriers[ 1 ].srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		Barriers[ 1 ].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, 2, Barriers );
+
+		VkImageCopy Regions[ SHADOW_CASCADE_COUNT ] = {};
+		uint32_t RegionCount = 0;
+
+		for( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+		{
+			if( !( m_RendererData.CascadeCacheCopyMask & ( 1u << i ) ) )
+				continue;
+
+			VkImageCopy& rRegion = Regions[ RegionCount++ ];
+			rRegion.srcSubresource = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, i, 1 };
+			rRegion.dstSubresource = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, i, 1 };
+			rRegion.extent = { ( uint32_t ) SHADOW_MAP_SIZE, ( uint32_t ) SHADOW_MAP_SIZE, 1 };
+		}
+
+		vkCmdCopyImage( CommandBuffer, CacheImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, ShadowImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, RegionCount, Regions );
+
+		Barriers[ 0 ].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		Barriers[ 0 ].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		Barriers[ 0 ].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		Barriers[ 0 ].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		Barriers[ 1 ].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		Barriers[ 1 ].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		Barriers[ 1 ].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		Barriers[ 1 ].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		vkCmdPipelineBarrier( CommandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			0, 0, nullptr, 0, nullptr, 2, Barriers );
+	}
+
+	void SceneRenderer::RenderShadowCasters( const Ref<Pipeline>& rPipeline, uint32_t CascadeMask, ShadowCasterFilter Filter )
+	{
+		VkCommandBuffer CommandBuffer = m_RendererData.CommandBuffer;
+
+		for( auto&& [key, Cmd] : m_ShadowMapDrawList )
+		{
+			// Entity may of been deleted.
+			if( !Cmd.entity )
+				continue;
+
+			if( Filter != ShadowCasterFilter::All && m_RendererData.InstanceScene->IsStatic( key ) != ( Filter == ShadowCasterFilter::Static ) )
+				continue;
+
+			InstanceDrawData Instances = GetInstanceDrawData( key, CULL_VIEW_FIRST_CASCADE );
+
+			// Layered culling wrote the instances of every cascade behind one command, the layer is stored in the transforms.
+			if( m_RendererData.LayeredShadows && Instances.Indirect.Buffer )
+			{
+				uint32_t FirstCascade = 0;
+				Buffer AdditionalData( sizeof( uint32_t ), &FirstCascade );
+
+				Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, rPipeline, Cmd.Mesh, Cmd.Instances, Instances.InstanceBuffer, Instances.InstanceOffset, Cmd.SubmeshIndex, Cmd.Lod, AdditionalData, Instances.Indirect );
+
+				continue;
+			}
+
+			for( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+			{
+				if( !( CascadeMask & ( 1u << i ) ) )
+					continue;
+
+				// Pass in the cascade index.
+				Buffer AdditionalData( sizeof( uint32_t ), &i );
+
+				Instances = GetInstanceDrawData( key, CULL_VIEW_FIRST_CASCADE + i );
+
+				Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, rPipeline, Cmd.Mesh, Cmd.Instances, Instances.InstanceBuffer, Instances.InstanceOffset, Cmd.SubmeshIndex, Cmd.Lod, AdditionalData, Instances.Indirect );
+			}
 		}
 	}
 
@@ -1440,12 +1931,12 @@ namespace Saturn {
 		for( auto&& [key, Cmd]: m_DrawList )
 		{
 			// Entity may of been deleted.
-			if( !Cmd.entity )
+			if( !Cmd.entity || Cmd.Occluded )
 				continue;
 
-			const auto& rTransformData = m_RendererData.MeshTransforms[ key ];
+			InstanceDrawData Instances = GetInstanceDrawData( key, CULL_VIEW_CAMERA );
 
-			Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, m_RendererData.PreDepthPipeline, Cmd.Mesh, Cmd.Instances, m_RendererData.SubmeshTransformData[ frame ].VertexBuffer, rTransformData.Offset, Cmd.SubmeshIndex );
+			Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, m_RendererData.PreDepthPipeline, Cmd.Mesh, Cmd.Instances, Instances.InstanceBuffer, Instances.InstanceOffset, Cmd.SubmeshIndex, Cmd.Lod, Buffer(), Instances.Indirect );
 		}
 
 		m_RendererData.PreDepthPass->EndPass();
@@ -1525,9 +2016,9 @@ namespace Saturn {
 
 		for( auto& [key, Cmd] : m_PhysicsColliderDrawList )
 		{
-			const auto& rTransformData = m_RendererData.MeshTransforms[ key ];
+			uint32_t TransformOffset = m_RendererData.InstanceScene->GetInstanceOffset( key );
 
-			Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, m_RendererData.PhysicsOutlinePipeline, Cmd.Mesh, Cmd.Instances, m_RendererData.SubmeshTransformData[ frame ].VertexBuffer, rTransformData.Offset, Cmd.SubmeshIndex );
+			Renderer::Get().RenderMeshWithoutMaterial( CommandBuffer, m_RendererData.PhysicsOutlinePipeline, Cmd.Mesh, Cmd.Instances, m_RendererData.InstanceScene->GetInstanceBuffer(), TransformOffset, Cmd.SubmeshIndex, 0 );
 		}
 
 		m_RendererData.LateCompositePass->EndPass();
@@ -1572,85 +2063,109 @@ namespace Saturn {
 		pass->EndPass();
 	}
 
-	struct UBLights
-	{
-		uint32_t nbLights = 0;
-		PointLight Lights[ 1024 ];
-	};
-
 	void SceneRenderer::LightCullingPass()
 	{
 		SAT_PF_EVENT();
 
 		m_RendererData.LightCullingTimer.Reset();
 
-		constexpr uint32_t TILE_SIZE = 16;
-		glm::uvec2 Viewport = { m_RendererData.Width, m_RendererData.Height };
-		glm::uvec2 Size = Viewport;
-		Size += TILE_SIZE - Viewport % TILE_SIZE;
+		uint32_t frame = Renderer::Get().GetCurrentFrame();
+		const auto& rPointLights = m_pScene->m_Lights.PointLights;
 
-		m_RendererData.LightCullingWorkGroups = { Size / TILE_SIZE, 1 };
+		glm::uvec3& rClusterCount = m_RendererData.LightClusterCount;
+		rClusterCount.x = std::max( ( m_RendererData.Width + LIGHT_CLUSTER_TILE_SIZE - 1 ) / LIGHT_CLUSTER_TILE_SIZE, 1u );
+		rClusterCount.y = std::max( ( m_RendererData.Height + LIGHT_CLUSTER_TILE_SIZE - 1 ) / LIGHT_CLUSTER_TILE_SIZE, 1u );
+		rClusterCount.z = LIGHT_CLUSTER_SLICES;
 
-		float size = m_RendererData.LightCullingWorkGroups.x * m_RendererData.LightCullingWorkGroups.y * 4.0f * 1024.0f;
-		m_RendererData.StorageBufferSet->Resize( 0, 14, (size_t)size );
+		uint32_t ClusterCount = rClusterCount.x * rClusterCount.y * rClusterCount.z;
 
-		// UBs
-		UBLights u_Lights;
+		// Near and far planes from the projection matrix (GLM_FORCE_DEPTH_ZERO_TO_ONE).
+		const glm::mat4& rProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix();
+		float Near = rProjection[ 3 ][ 2 ] / rProjection[ 2 ][ 2 ];
+		float Far = rProjection[ 3 ][ 2 ] / ( rProjection[ 2 ][ 2 ] + 1.0f );
 
-		struct
-		{
-			glm::vec2 FullResolution;
-		} u_ScreenData{};
+		float LogDepthRange = std::log( Far / Near );
+		m_RendererData.LightClusterZParams.x = LIGHT_CLUSTER_SLICES / LogDepthRange;
+		m_RendererData.LightClusterZParams.y = LIGHT_CLUSTER_SLICES * std::log( Near ) / LogDepthRange;
 
-		struct
-		{
-			glm::mat4 ViewProjection;
-			glm::mat4 Projection;
-			glm::mat4 View;
-			glm::mat4 InvP;
-		} u_Matrices{};
+		//////////////////////////////////////////////////////////////////////////
+		// Size buffers
 
-		u_Matrices.ViewProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix;
-		u_Matrices.Projection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix();
-		u_Matrices.View = glm::inverse( m_RendererData.CurrentCamera.ViewMatrix );
-		u_Matrices.InvP = glm::inverse( u_Matrices.Projection );
+		// We have waited for this frame's fence, so the counter holds how many indices this frame needed last time.
+		auto& rCounterBuffer = m_RendererData.LightIndexCounterBuffers[ frame ];
+
+		uint32_t RequiredIndices = 0;
+		rCounterBuffer->GetData( &RequiredIndices, sizeof( uint32_t ) );
+		m_RendererData.LightIndicesUsed = RequiredIndices;
+
+		uint32_t Zero = 0;
+		rCounterBuffer->SetData( &Zero, sizeof( uint32_t ) );
 
-		u_ScreenData.FullResolution = { m_RendererData.Width, m_RendererData.Height };
+		// Start with room for a few lights per cluster and only ever grow, clusters that do not fit are dropped for a frame.
+		uint32_t IndexCapacity = std::max( m_RendererData.LightIndexCapacity, ClusterCount * 8 );
+		while( IndexCapacity < RequiredIndices )
+			IndexCapacity *= 2;
 
-		u_Lights.nbLights = ( uint32_t ) m_pScene->m_Lights.PointLights.size();
+		m_RendererData.LightIndexCapacity = IndexCapacity;
 
-		std::memcpy( u_Lights.Lights, m_pScene->m_Lights.PointLights.data(), m_pScene->m_Lights.GetPointLightSize() );
+		m_RendererData.LightIndexBuffers[ frame ]->Resize( IndexCapacity * sizeof( uint32_t ) );
+		m_RendererData.LightClusterBuffers[ frame ]->Resize( ClusterCount * sizeof( glm::uvec2 ) );
 
-		m_RendererData.LightCullingShader->UploadUB( ShaderType::Compute, 0, 0, &u_Lights, 16ull + sizeof PointLight * u_Lights.nbLights );
-		m_RendererData.LightCullingShader->UploadUB( ShaderType::Compute, 0, 3, &u_ScreenData, sizeof( u_ScreenData ) );
-		m_RendererData.LightCullingShader->UploadUB( ShaderType::Compute, 0, 4, &u_Matrices, sizeof( u_Matrices ) );
+		// Upload the lights, once per frame. The same buffer is read by the static mesh shader.
+		auto& rLightBuffer = m_RendererData.PointLightBuffers[ frame ];
+		size_t LightDataSize = 16ull + sizeof( PointLight ) * rPointLights.size();
 
-		m_RendererData.LightCullingShader->WriteAllUBs( m_RendererData.LightCullingDescriptorSet );
+		if( rLightBuffer->GetSize() < LightDataSize )
+			rLightBuffer->Resize( ( uint32_t ) std::max( LightDataSize, rLightBuffer->GetSize() * 2 ) );
+
+		uint32_t LightCount = ( uint32_t ) rPointLights.size();
+		rLightBuffer->SetData( &LightCount, sizeof( uint32_t ) );
+
+		if( LightCount )
+			rLightBuffer->SetData( rPointLights.data(), sizeof( PointLight ) * rPointLights.size(), 16 );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Descriptors
 
-		// Write storage buffer
-		Ref<StorageBuffer> SB = m_RendererData.StorageBufferSet->Get( 0, 14, Renderer::Get().GetCurrentFrame() );
+		Ref<DescriptorSet>& rDescriptorSet = m_RendererData.LightCullingDescriptorSets[ frame ];
 
-		m_RendererData.LightCullingShader->WriteSB( 0, 14, SB->GetBufferInfo(), m_RendererData.LightCullingDescriptorSet );
+		m_RendererData.LightCullingShader->WriteSB( 0, 0, rLightBuffer->GetBufferInfo(), rDescriptorSet );
+		m_RendererData.LightCullingShader->WriteSB( 0, 1, m_RendererData.LightClusterBuffers[ frame ]->GetBufferInfo(), rDescriptorSet );
+		m_RendererData.LightCullingShader->WriteSB( 0, 2, m_RendererData.LightIndexBuffers[ frame ]->GetBufferInfo(), rDescriptorSet );
+		m_RendererData.LightCullingShader->WriteSB( 0, 3, rCounterBuffer->GetBufferInfo(), rDescriptorSet );
 
-		// Light culling here
+		struct
+		{
+			glm::mat4 View;
+			glm::vec4 ProjectionParams;
+			glm::vec4 TileScale;
+			glm::uvec4 ClusterCount;
+		} u_ClusterData{};
+
+		u_ClusterData.View = m_RendererData.CurrentCamera.ViewMatrix;
+		u_ClusterData.ProjectionParams = { 1.0f / rProjection[ 0 ][ 0 ], 1.0f / rProjection[ 1 ][ 1 ], Near, Far };
+		u_ClusterData.TileScale = { ( float ) LIGHT_CLUSTER_TILE_SIZE / m_RendererData.Width, ( float ) LIGHT_CLUSTER_TILE_SIZE / m_RendererData.Height, 0.0f, 0.0f };
+		u_ClusterData.ClusterCount = glm::uvec4( rClusterCount, IndexCapacity );
+
+		//////////////////////////////////////////////////////////////////////////
+		// Light culling here, one workgroup per cluster.
 		auto& CullingPipeline = m_RendererData.LightCullingPipeline;
 
 		CullingPipeline->BindWithCommandBuffer( m_RendererData.CommandBuffer );
 
-		CullingPipeline->Execute(
-			m_RendererData.LightCullingDescriptorSet->GetVulkanSet(),
-			( uint32_t ) m_RendererData.LightCullingWorkGroups.x,
-			( uint32_t ) m_RendererData.LightCullingWorkGroups.y,
-			( uint32_t ) m_RendererData.LightCullingWorkGroups.z );
+		CullingPipeline->AddPushConstant( &u_ClusterData, 0, sizeof( u_ClusterData ) );
+
+		CullingPipeline->Execute( rDescriptorSet->GetVulkanSet(), rClusterCount.x, rClusterCount.y, rClusterCount.z );
 
+		// Geometry pass reads the light lists, the CPU reads back the index count when this frame comes around again.
 		VkMemoryBarrier barrier = {};
 		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
 		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_HOST_READ_BIT;
 
 		vkCmdPipelineBarrier( CullingPipeline->GetCommandBuffer(),
 			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT,
 			0,
 			1, &barrier,
 			0, nullptr,
@@ -1963,21 +2478,165 @@ namespace Saturn {
 	{
 		SAT_PF_EVENT();
 
-		// Create our buffers for instance data.
-		uint32_t frame = Renderer::Get().GetCurrentFrame();
+		// Upload the instance transforms that changed.
+		m_RendererData.InstanceScene->Update( m_RendererData.CommandBuffer );
+	}
+
+	void SceneRenderer::OcclusionCull()
+	{
+		SAT_PF_EVENT();
+
+		m_RendererData.OcclusionTested = 0;
+		m_RendererData.OcclusionCulled = 0;
+
+		Ref<HiZPyramid>& rHiZ = m_RendererData.HiZ;
+
+		rHiZ->BeginFrame( Renderer::Get().GetCurrentFrame() );
+
+		if( !m_RendererData.EnableOcclusionCulling || !rHiZ->HasReadback() )
+			return;
+
+		// Draws are instanced per submesh, so a command can only be skipped when every instance is hidden.
+		// The shadow draw list is not touched, an object behind the camera's depth can still cast a visible shadow.
+		for( auto&& [key, Cmd] : m_DrawList )
+		{
+			if( !Cmd.entity )
+				continue;
 
-		uint32_t off = 0;
-		for( auto& [id, buffer] : m_RendererData.MeshTransforms )
+			const AABB& rBounds = Cmd.Mesh->Submeshes()[ Cmd.SubmeshIndex ].BoundingBox;
+
+			Cmd.Occluded = true;
+
+			for( const glm::mat4& rTransform : Cmd.Transforms )
+			{
+				if( !rHiZ->IsOccluded( rBounds, rTransform ) )
+				{
+					Cmd.Occluded = false;
+					break;
+				}
+			}
+
+			m_RendererData.OcclusionTested++;
+
+			if( Cmd.Occluded )
+				m_RendererData.OcclusionCulled++;
+		}
+	}
+
+	void SceneRenderer::CullInstances()
+	{
+		SAT_PF_EVENT();
+
+		Ref<InstanceCulling>& rCulling = m_RendererData.Culling;
+
+		rCulling->Reset();
+
+		// Filled after the pre depth pass, which has to draw every meshlet.
+		m_RendererData.MeshletCulling->Reset();
+
+		if( !m_RendererData.EnableGPUCulling )
+			return;
+
+		rCulling->AddView( m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix );
+
+		uint32_t CascadeMask = 0;
+
+		if( m_RendererData.EnableShadows )
 		{
-			buffer.Offset = off * sizeof( TransformBufferData );
-			for (const auto& transform : buffer.Data )
+			for( uint32_t i = 0; i < SHADOW_CASCADE_COUNT; i++ )
+				CascadeMask |= 1u << rCulling->AddView( m_RendererData.ShadowCascades[ i ].ViewProjection );
+
+			if( m_RendererData.LayeredShadows )
+				rCulling->SetLayeredViews( CascadeMask );
+
+			rCulling->SetShadowViews( CascadeMask );
+		}
+
+		for( auto&& [key, Cmd] : m_DrawList )
+		{
+			if( !Cmd.entity )
+				continue;
+
+			rCulling->AddDraw( key, Cmd.Mesh, Cmd.SubmeshIndex, Cmd.Lod, Cmd.Instances, Cmd.Occluded ? 0 : 1u << CULL_VIEW_CAMERA );
+		}
+
+		if( CascadeMask )
+		{
+			for( auto&& [key, Cmd] : m_ShadowMapDrawList )
 			{
-				m_RendererData.SubmeshTransformData[ frame ].pData[ off ] = transform;
-				off++;
+				if( !Cmd.entity )
+					continue;
+
+				// Only the cascades that are rendered this frame, static casters only go into a cache that is being rebuilt.
+				uint32_t Cascades = m_RendererData.CascadeUpdateMask;
+
+				if( m_RendererData.CascadeCacheCopyMask && m_RendererData.InstanceScene->IsStatic( key ) )
+					Cascades = m_RendererData.CascadeCacheRebuildMask;
+
+				rCulling->AddDraw( key, Cmd.Mesh, Cmd.SubmeshIndex, Cmd.Lod, Cmd.Instances, Cascades << CULL_VIEW_FIRST_CASCADE );
 			}
 		}
 
-		m_RendererData.SubmeshTransformData[ frame ].VertexBuffer->Reallocate( m_RendererData.SubmeshTransformData[ frame ].pData, off * sizeof( TransformBufferData ) );
+		rCulling->Dispatch( m_RendererData.CommandBuffer, m_RendererData.InstanceScene );
+	}
+
+	InstanceDrawData SceneRenderer::GetInstanceDrawData( const StaticMeshKey& rKey, uint32_t View )
+	{
+		InstanceDrawData Data;
+
+		Ref<InstanceCulling>& rCulling = m_RendererData.Culling;
+
+		if( m_RendererData.EnableGPUCulling && rCulling->HasDraw( rKey ) )
+		{
+			Data.InstanceBuffer = rCulling->GetInstanceBuffer();
+			Data.InstanceOffset = rCulling->GetInstanceOffset( rKey, View );
+			Data.Indirect = rCulling->GetIndirectDraw( rKey, View );
+
+			// The camera command now reads the visible meshlets.
+			if( View == CULL_VIEW_CAMERA && m_RendererData.MeshletCulling->HasDraw( rKey ) )
+				Data.Indirect.IndexBuffer = m_RendererData.MeshletCulling->GetIndexBuffer();
+		}
+		else
+		{
+			Data.InstanceBuffer = m_RendererData.InstanceScene->GetInstanceBuffer();
+			Data.InstanceOffset = m_RendererData.InstanceScene->GetInstanceOffset( rKey );
+		}
+
+		return Data;
+	}
+
+	void SceneRenderer::BuildHiZ()
+	{
+		SAT_PF_EVENT();
+
+		// Still built when culling is off, so turning it back on does not test against an old pyramid.
+		glm::mat4 ViewProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix;
+
+		m_RendererData.HiZ->Build( m_RendererData.CommandBuffer, ViewProjection );
+	}
+
+	void SceneRenderer::CullClusters()
+	{
+		SAT_PF_EVENT();
+
+		Ref<ClusterCulling>& rClusterCulling = m_RendererData.MeshletCulling;
+
+		if( !m_RendererData.EnableGPUCulling || !m_RendererData.EnableClusterCulling )
+			return;
+
+		for( auto&& [key, Cmd] : m_DrawList )
+		{
+			// Simplified LODs do not have meshlets.
+			if( !Cmd.entity || Cmd.Occluded || Cmd.Lod != 0 || !m_RendererData.Culling->HasDraw( key ) )
+				continue;
+
+			rClusterCulling->AddDraw( key, Cmd.Mesh, Cmd.SubmeshIndex, Cmd.Instances );
+		}
+
+		glm::mat4 ViewProjection = m_RendererData.CurrentCamera.Camera.ProjectionMatrix() * m_RendererData.CurrentCamera.ViewMatrix;
+		Ref<HiZPyramid> HiZ = m_RendererData.EnableOcclusionCulling ? m_RendererData.HiZ : nullptr;
+
+		rClusterCulling->Dispatch( m_RendererData.CommandBuffer, m_RendererData.Culling, HiZ, ViewProjection, m_RendererData.CameraPosition );
 	}
 
 	void SceneRenderer::RenderScene()
@@ -2002,8 +2661,32 @@ namespace Saturn {
 		for( auto&& func : m_ScheduledFunctions )
 			func();
 
+		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "Instance Upload" );
+
 		InitBuffers();
 
+		CmdEndDebugLabel( m_RendererData.CommandBuffer );
+
+		OcclusionCull();
+
+		// The cascades are needed for culling.
+		if( m_RendererData.EnableShadows )
+		{
+			ScheduleCascades( m_pScene->m_Lights.DirectionalLights[ 0 ].Direction );
+		}
+		else
+		{
+			// Nothing is rendered while shadows are off, every cascade is stale once they are turned on again.
+			for( auto& rCascade : m_RendererData.ShadowCascades )
+				rCascade.Rendered = false;
+		}
+
+		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "Instance Culling" );
+
+		CullInstances();
+
+		CmdEndDebugLabel( m_RendererData.CommandBuffer );
+
 		// Passes
 
 		DirShadowMapPass();
@@ -2014,6 +2697,18 @@ namespace Saturn {
 
 		CmdEndDebugLabel( m_RendererData.CommandBuffer );
 
+		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "HiZ" );
+
+		BuildHiZ();
+
+		CmdEndDebugLabel( m_RendererData.CommandBuffer );
+
+		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "Cluster Culling" );
+
+		CullClusters();
+
+		CmdEndDebugLabel( m_RendererData.CommandBuffer );
+
 		CmdBeginDebugLabel( m_RendererData.CommandBuffer, "LightCulling" );
 
 		LightCullingPass();
@@ -2062,12 +2757,48 @@ namespace Saturn {
 		m_ShadowMapDrawList.clear();
 		m_PhysicsColliderDrawList.clear();
 		m_ScheduledFunctions.clear();
-		m_RendererData.MeshTransforms.clear();
+
+		for( uint32_t i = 0; i < MAX_SUBMESH_LODS; i++ )
+		{
+			m_RendererData.LodInstanceStats[ i ] = m_RendererData.LodInstanceCounts[ i ];
+			m_RendererData.LodInstanceCounts[ i ] = 0;
+		}
 	}
 
 	void SceneRenderer::SetCamera( const RendererCamera& Camera )
 	{
 		m_RendererData.CurrentCamera = Camera;
+		m_RendererData.CameraPosition = glm::vec3( glm::inverse( Camera.ViewMatrix )[ 3 ] );
+	}
+
+	uint32_t SceneRenderer::SelectLod( const Submesh& rSubmesh, const glm::mat4& rTransform ) const
+	{
+		uint32_t LodCount = rSubmesh.GetLodCount();
+
+		if( !m_RendererData.EnableLods || LodCount == 1 )
+			return 0;
+
+		const AABB& rBounds = rSubmesh.BoundingBox;
+
+		glm::vec3 Center = glm::vec3( rTransform * glm::vec4( ( rBounds.Min + rBounds.Max ) * 0.5f, 1.0f ) );
+
+		float Scale = glm::max( glm::length( glm::vec3( rTransform[ 0 ] ) ), glm::max( glm::length( glm::vec3( rTransform[ 1 ] ) ), glm::length( glm::vec3( rTransform[ 2 ] ) ) ) );
+		float Radius = glm::length( rBounds.Max - rBounds.Min ) * 0.5f * Scale;
+		float Distance = glm::length( Center - m_RendererData.CameraPosition );
+
+		uint32_t Lod = 0;
+
+		// Inside the sphere the mesh covers the whole screen.
+		if( Distance > Radius )
+		{
+			// Fraction of the screen height covered by the projected sphere.
+			float ScreenSize = Radius * glm::abs( m_RendererData.CurrentCamera.Camera.ProjectionMatrix()[ 1 ][ 1 ] ) / Distance;
+
+			while( Lod < MAX_SUBMESH_LODS - 1 && ScreenSize < m_RendererData.LodScreenSizes[ Lod ] )
+				Lod++;
+		}
+
+		return ( uint32_t ) glm::clamp( ( int ) Lod + m_RendererData.LodBias, 0, ( int ) LodCount - 1 );
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -2086,7 +2817,16 @@ namespace Saturn {
 		SkyboxDescriptorSet       = nullptr;
 		SC_DescriptorSet          = nullptr;
 		PreethamDescriptorSet     = nullptr;
-		LightCullingDescriptorSet = nullptr;
+
+		for( uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++ )
+		{
+			LightCullingDescriptorSets[ i ] = nullptr;
+			PointLightBuffers[ i ] = nullptr;
+			LightClusterBuffers[ i ] = nullptr;
+			LightIndexBuffers[ i ] = nullptr;
+			LightIndexCounterBuffers[ i ] = nullptr;
+		}
+
 		BloomDS                   = nullptr;
 		TexturePassDescriptorSet  = nullptr;
 
@@ -2108,10 +2848,20 @@ namespace Saturn {
 
 		ShadowCascades.clear();
 
+		DirShadowMapLayeredFramebuffer = nullptr;
+		ShadowStaticCacheFramebuffer = nullptr;
+		ShadowStaticCacheImage = nullptr;
+		ShadowMapImage = nullptr;
+
 		// Render Passes
 		for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
 			DirShadowMapPasses[ i ]->Terminate();
 
+		if( DirShadowMapLayeredPass )
+			DirShadowMapLayeredPass->Terminate();
+
+		DirShadowMapLayeredPass = nullptr;
+
 		GeometryPass->Terminate();
 		SceneComposite->Terminate();
 
@@ -2129,6 +2879,8 @@ namespace Saturn {
 		for( int i = 0; i < SHADOW_CASCADE_COUNT; i++ )
 			DirShadowMapPipelines[ i ] = nullptr;
 
+		DirShadowMapLayeredPipeline = nullptr;
+
 		StaticMeshPipeline      = nullptr;
 		GridPipeline            = nullptr;
 		SkyboxPipeline          = nullptr;
@@ -2141,8 +2893,12 @@ namespace Saturn {
 		GridShader              = nullptr;
 		SkyboxShader            = nullptr;
 		StaticMeshShader        = nullptr; 
+		StaticMeshBindlessShader = nullptr;
+
+		StaticMeshBindlessMaterial = nullptr;
 		SceneCompositeShader    = nullptr;
 		DirShadowMapShader      = nullptr;
+		DirShadowMapLayeredShader = nullptr;
 		PreethamShader          = nullptr;
 		AOCompositeShader       = nullptr;
 		PreDepthShader          = nullptr;
@@ -2160,15 +2916,14 @@ namespace Saturn {
 
 		SceneEnvironment        = nullptr;
 
-		for( auto& buffer : SubmeshTransformData )
-			delete[] buffer.pData;
-
 		// Storage buffer set
 		StorageBufferSet = nullptr;
 
-		SubmeshTransformData.clear();
+		InstanceScene = nullptr;
+		Culling = nullptr;
+		MeshletCulling = nullptr;
 
-		MeshTransforms.clear();
+		HiZ = nullptr;
 	}
 
 }
\ No newline at end of file
@@ -42,11 +42,18 @@
 #include "Framebuffer.h"
 #include "ComputePipeline.h"
 #include "StorageBufferSet.h"
+#include "GPUScene.h"
+#include "HiZPyramid.h"
+#include "InstanceCulling.h"
+#include "ClusterCulling.h"
 
 #include "Pipeline.h"
 
 constexpr int SHADOW_CASCADE_COUNT = 4;
-constexpr int MAX_POINT_LIGHTS = 512;
+
+// Clustered lighting, the light grid is LIGHT_CLUSTER_TILE_SIZE pixel tiles * LIGHT_CLUSTER_SLICES depth slices.
+constexpr uint32_t LIGHT_CLUSTER_TILE_SIZE = 64;
+constexpr uint32_t LIGHT_CLUSTER_SLICES = 24;
 
 namespace Saturn {
 
@@ -56,6 +63,24 @@ namespace Saturn {
 		Ref< StaticMesh > Mesh = nullptr;
 		uint32_t SubmeshIndex = 0;
 		uint32_t Instances = 0;
+
+		// Index range to draw, shadow draws use a coarser LOD than the key's.
+		uint32_t Lod = 0;
+
+		// World transform of every instance, only filled for the main draw list.
+		std::vector<glm::mat4> Transforms;
+
+		// Every instance was behind the previous frame's depth.
+		bool Occluded = false;
+	};
+
+	// Where the instances of a draw come from, either the GPUScene directly or the output of InstanceCulling.
+	struct InstanceDrawData
+	{
+		Ref<VertexBuffer> InstanceBuffer = nullptr;
+		uint32_t InstanceOffset = 0;
+
+		IndirectDraw Indirect;
 	};
 
 	struct ShadowCascade
@@ -64,6 +89,21 @@ namespace Saturn {
 
 		float SplitDepth = 0.0f;
 		glm::mat4 ViewProjection;
+
+		// Never rendered, has to be updated no matter the schedule.
+		bool Rendered = false;
+
+		// What the static shadow cache layer was rendered with.
+		glm::mat4 CachedViewProjection{};
+		uint64_t CachedStaticVersion = UINT64_MAX;
+	};
+
+	// Which shadow casters a shadow pass draws.
+	enum class ShadowCasterFilter
+	{
+		All,
+		Static,
+		Dynamic
 	};
 
 	// Most of theses structs MUST (most of the time) match the structs in the shader.
@@ -100,60 +140,6 @@ namespace Saturn {
 		glm::mat4 ViewMatrix{};
 	};
 
-	struct StaticMeshKey
-	{
-		AssetID MeshID;
-		Ref<MaterialRegistry> Registry;
-
-		uint32_t SubmeshIndex;
-
-		StaticMeshKey( AssetID meshID, Ref<MaterialRegistry> materialReg, uint32_t submeshIndex ) : MeshID( meshID ), SubmeshIndex( submeshIndex ) { Registry = materialReg; }
-
-		bool operator==( const StaticMeshKey& rKey )
-		{
-			return ( MeshID == rKey.MeshID && Registry == rKey.Registry && SubmeshIndex == rKey.SubmeshIndex );
-		}
-
-		bool operator==( const StaticMeshKey& rKey ) const
-		{
-			return ( MeshID == rKey.MeshID && Registry == rKey.Registry && SubmeshIndex == rKey.SubmeshIndex );
-		}
-	};
-
-	// Data that gets sent to the vertex shader
-	struct TransformBufferData
-	{
-		glm::vec4 TransfromBufferR[ 4 ];
-	};
-
-	// For each mesh, what offset are we and how much transform does it have.
-	struct TransformBuffer
-	{
-		uint32_t Offset = 0;
-		std::vector<TransformBufferData> Data;
-	};
-
-	struct SubmeshTransformVB
-	{
-		Ref<VertexBuffer> VertexBuffer;
-		TransformBufferData* pData = nullptr;
-	};
-}
-
-namespace std {
-
-	template<>
-	struct hash< Saturn::StaticMeshKey >
-	{
-		size_t operator()( const Saturn::StaticMeshKey& rKey ) const
-		{
-			return rKey.Registry->GetID() ^ rKey.MeshID ^ rKey.SubmeshIndex;
-		}
-	};
-}
-
-namespace Saturn {
-
 	struct RendererData
 	{
 		void Terminate();
@@ -232,12 +218,6 @@ namespace Saturn {
 			alignas( 4 ) float Roughness;
 		};
 
-		struct PointLights
-		{
-			uint32_t nbLights = 0;
-			PointLight Lights[ 256 ]{};
-		};
-
 		//////////////////////////////////////////////////////////////////////////
 		Ref<StorageBufferSet> StorageBufferSet;
 
@@ -260,6 +240,34 @@ namespace Saturn {
 		
 		std::vector< ShadowCascade > ShadowCascades;
 
+		Ref< Image2D > ShadowMapImage = nullptr;
+
+		// Layered shadow map, every cascade is rendered in one pass. Only used when VK_EXT_shader_viewport_index_layer is supported.
+		bool LayeredShadows = false;
+
+		Ref< Pass > DirShadowMapLayeredPass = nullptr;
+		Ref< Pipeline > DirShadowMapLayeredPipeline = nullptr;
+		Ref< Framebuffer > DirShadowMapLayeredFramebuffer = nullptr;
+
+		// Static casters only, copied into the shadow map while the cascade does not move.
+		bool CacheStaticShadows = true;
+
+		Ref< Image2D > ShadowStaticCacheImage = nullptr;
+		Ref< Framebuffer > ShadowStaticCacheFramebuffer = nullptr;
+
+		// A cascade is rendered every "CascadeUpdateIntervals[ i ]" frames.
+		int CascadeUpdateIntervals[ SHADOW_CASCADE_COUNT ] = { 1, 1, 2, 4 };
+
+		uint64_t ShadowFrameIndex = 0;
+
+		// Bit per cascade.
+		uint32_t CascadeUpdateMask = 0;
+		uint32_t CascadeCacheRebuildMask = 0;
+		uint32_t CascadeCacheCopyMask = 0;
+
+		uint32_t CascadesUpdated = 0;
+		uint32_t CascadesFromCache = 0;
+
 		// PreDepth + Light culling
 		//////////////////////////////////////////////////////////////////////////
 
@@ -269,8 +277,30 @@ namespace Saturn {
 		//Ref< DescriptorSet > PreDepthDescriptorSet = nullptr;
 
 		Ref< ComputePipeline > LightCullingPipeline = nullptr;
-		Ref< DescriptorSet > LightCullingDescriptorSet = nullptr;
-		glm::vec3 LightCullingWorkGroups{};
+		Ref< DescriptorSet > LightCullingDescriptorSets[ MAX_FRAMES_IN_FLIGHT ];
+
+		// Per frame so the culling pass never writes a buffer that an older frame is still reading.
+		Ref< StorageBuffer > PointLightBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref< StorageBuffer > LightClusterBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref< StorageBuffer > LightIndexBuffers[ MAX_FRAMES_IN_FLIGHT ];
+		Ref< StorageBuffer > LightIndexCounterBuffers[ MAX_FRAMES_IN_FLIGHT ];
+
+		glm::uvec3 LightClusterCount{};
+		glm::vec2 LightClusterZParams{};
+
+		// Capacity of the compacted light index list, grown when the read back count does not fit.
+		uint32_t LightIndexCapacity = 0;
+		uint32_t LightIndicesUsed = 0;
+
+		// Occlusion culling
+		//////////////////////////////////////////////////////////////////////////
+
+		bool EnableOcclusionCulling = true;
+
+		Ref<HiZPyramid> HiZ = nullptr;
+
+		uint32_t OcclusionTested = 0;
+		uint32_t OcclusionCulled = 0;
 
 		// Geometry
 		//////////////////////////////////////////////////////////////////////////
@@ -355,14 +385,43 @@ namespace Saturn {
 		Ref<Pipeline> PhysicsOutlinePipeline = nullptr;
 		Ref<Material> PhysicsOutlineMaterial = nullptr;
 
+		// Bindless
+		//////////////////////////////////////////////////////////////////////////
+		// Only holds set 0 (uniform buffers), textures and material values come from BindlessResources.
+		Ref<Material> StaticMeshBindlessMaterial = nullptr;
+
 		// Instanced Rendering
 		//////////////////////////////////////////////////////////////////////////
-		// 		
-		// MESH ID -> TRANSFORMS
-		std::unordered_map< StaticMeshKey, TransformBuffer > MeshTransforms;
+		// Instance transforms for every static mesh, only changes are uploaded.
+		Ref<GPUScene> InstanceScene = nullptr;
+
+		// GPU Culling
+		//////////////////////////////////////////////////////////////////////////
+		// View 0 is the camera, view 1 + i is shadow cascade i.
+		bool EnableGPUCulling = true;
+
+		Ref<InstanceCulling> Culling = nullptr;
+
+		// Meshlets of LOD 0 draws are culled again for the camera once the HiZ has been built, needs GPU culling.
+		bool EnableClusterCulling = true;
+
+		Ref<ClusterCulling> MeshletCulling = nullptr;
+
+		// LODs
+		//////////////////////////////////////////////////////////////////////////
+		// An instance uses LOD i + 1 once its bounding sphere covers less than LodScreenSizes[ i ] of the screen height.
+		bool EnableLods = true;
+		float LodScreenSizes[ MAX_SUBMESH_LODS - 1 ] = { 0.5f, 0.25f, 0.125f };
+
+		// Added to the selected LOD, shadows are added on top of that.
+		int LodBias = 0;
+		int ShadowLodBias = 1;
 
-		// This holds the entire transform data for each submesh, per frame in flight.
-		std::vector< SubmeshTransformVB > SubmeshTransformData;
+		// Instances submitted at every LOD, the stats are from the last rendered frame.
+		uint32_t LodInstanceCounts[ MAX_SUBMESH_LODS ] = {};
+		uint32_t LodInstanceStats[ MAX_SUBMESH_LODS ] = {};
+
+		glm::vec3 CameraPosition = glm::vec3( 0.0f );
 
 		//////////////////////////////////////////////////////////////////////////
 		// SHADERS
@@ -371,9 +430,11 @@ namespace Saturn {
 		Ref< Shader > SkyboxShader = nullptr;
 		Ref< Shader > PreethamShader = nullptr;
 		Ref< Shader > StaticMeshShader = nullptr;
+		Ref< Shader > StaticMeshBindlessShader = nullptr;
 		Ref< Shader > SceneCompositeShader = nullptr;
 		Ref< Shader > TexturePassShader = nullptr;
 		Ref< Shader > DirShadowMapShader = nullptr;
+		Ref< Shader > DirShadowMapLayeredShader = nullptr;
 		Ref< Shader > SelectedGeometryShader = nullptr;
 		Ref< Shader > AOCompositeShader = nullptr;
 		Ref< Shader > PreDepthShader = nullptr;
@@ -415,6 +476,9 @@ namespace Saturn {
 
 		Ref<Image2D> CompositeImage();
 
+		// Reads back the composite image and writes it as a PNG, waits for the GPU.
+		void SaveCompositeImage( const std::filesystem::path& rPath );
+
 		void SetDynamicSky( float Turbidity, float Azimuth, float Inclination );
 		
 		bool HasFlag( SceneRendererFlags flag ) const;
@@ -436,6 +500,7 @@ namespace Saturn {
 		void CheckInvalidSkybox();
 
 		void UpdateCascades( const glm::vec3& Direction );
+		void ScheduleCascades( const glm::vec3& Direction );
 
 		void CreateGridComponents();
 
@@ -455,8 +520,15 @@ namespace Saturn {
 		void InitBuffers();
 
 		void DirShadowMapPass();
+		void DirShadowMapLayeredPass();
+		void CopyStaticShadowCache();
+		void RenderShadowCasters( const Ref<Pipeline>& rPipeline, uint32_t CascadeMask, ShadowCasterFilter Filter );
 		void PreDepthPass();
 		void LightCullingPass();
+		void OcclusionCull();
+		void CullInstances();
+		void BuildHiZ();
+		void CullClusters();
 		void GeometryPass();
 		void BloomPass();
 		void SceneCompositePass();
@@ -464,6 +536,11 @@ namespace Saturn {
 		void TexturePass();
 
 		void RenderStaticMeshes();
+		void RenderStaticMeshesBindless();
+
+		InstanceDrawData GetInstanceDrawData( const StaticMeshKey& rKey, uint32_t View );
+
+		uint32_t SelectLod( const Submesh& rSubmesh, const glm::mat4& rTransform ) const;
 		//void RenderDynamicMeshes();
 
 		void AddScheduledFunction( ScheduledFunc&& rrFunc );
@@ -35,6 +35,7 @@
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
 #include "Renderer.h"
+#include "BindlessResources.h"
 
 #include "Saturn/Serialisation/RawSerialisation.h"
 
@@ -286,6 +287,10 @@ namespace Saturn {
 
 		for ( auto& [ set, descriptorSet ] : m_DescriptorSets )
 		{
+			// Owned by BindlessResources.
+			if( IsBindlessSet( descriptorSet ) )
+				continue;
+
 			vkDestroyDescriptorSetLayout( VulkanContext::Get().GetDevice(), descriptorSet.SetLayout, nullptr );
 		}
 
@@ -308,6 +313,7 @@ namespace Saturn {
 					descriptorSet.WriteDescriptorSets[ texture.Binding ].dstSet = desSet;
 					
 					vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &descriptorSet.WriteDescriptorSets[ texture.Binding ], 0, nullptr );
+					Renderer::Get().GetStats().DescriptorWrites++;
 				}
 			}
 
@@ -319,6 +325,7 @@ namespace Saturn {
 					descriptorSet.WriteDescriptorSets[ texture.Binding ].dstSet = desSet;
 
 					vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &descriptorSet.WriteDescriptorSets[ texture.Binding ], 0, nullptr );
+					Renderer::Get().GetStats().DescriptorWrites++;
 				}
 			}
 		}
@@ -336,6 +343,7 @@ namespace Saturn {
 					descriptorSet.WriteDescriptorSets[ binding ].dstSet = desSet;
 
 					vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &descriptorSet.WriteDescriptorSets[ binding ], 0, nullptr );
+					Renderer::Get().GetStats().DescriptorWrites++;
 				}
 			}
 		}
@@ -354,6 +362,7 @@ namespace Saturn {
 					descriptorSet.WriteDescriptorSets[ texture.Binding ].dstSet = desSet;
 
 					vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &descriptorSet.WriteDescriptorSets[ texture.Binding ], 0, nullptr );
+					Renderer::Get().GetStats().DescriptorWrites++;
 				}
 			}
 
@@ -366,6 +375,7 @@ namespace Saturn {
 					descriptorSet.WriteDescriptorSets[ texture.Binding ].dstSet = desSet;
 
 					vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &descriptorSet.WriteDescriptorSets[ texture.Binding ], 0, nullptr );
+					Renderer::Get().GetStats().DescriptorWrites++;
 				}
 			}
 		}
@@ -389,6 +399,7 @@ namespace Saturn {
 				descriptorSet.WriteDescriptorSets[ binding ].dstSet = rSet->GetVulkanSet();
 
 				vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &descriptorSet.WriteDescriptorSets[ binding ], 0, nullptr );
+				Renderer::Get().GetStats().DescriptorWrites++;
 			}
 		}
 	}
@@ -409,6 +420,7 @@ namespace Saturn {
 				descriptorSet.WriteDescriptorSets[ binding ].dstSet = Set;
 
 				vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &descriptorSet.WriteDescriptorSets[ binding ], 0, nullptr );
+				Renderer::Get().GetStats().DescriptorWrites++;
 			}
 		}
 	}
@@ -419,6 +431,7 @@ namespace Saturn {
 		m_DescriptorSets[ set ].WriteDescriptorSets[ binding ].dstSet = rSet->GetVulkanSet();
 
 		vkUpdateDescriptorSets( VulkanContext::Get().GetDevice(), 1, &m_DescriptorSets[ set ].WriteDescriptorSets[ binding ], 0, nullptr );
+		Renderer::Get().GetStats().DescriptorWrites++;
 	}
 
 	void* Shader::MapUB( ShaderType Type, uint32_t Set, uint32_t Binding )
@@ -469,6 +482,8 @@ namespace Saturn {
 
 		VK_CHECK( vkAllocateDescriptorSets( VulkanContext::Get().GetDevice(), &AllocateInfo, &Set ) );
 
+		Renderer::Get().GetStats().DescriptorSetAllocations++;
+
 		return Set;
 	}
 
@@ -750,7 +765,10 @@ namespace Saturn {
 			SHADER_INFO( " Binding: {0}", binding );
 			SHADER_INFO( " Set: {0}", set );
 
-			if( arraySizes == 0 )
+			// Unsized arrays (i.e. "sampler2D u_Textures[]") are left as zero, these are our bindless sets.
+			bool RuntimeArray = !RealType.array.empty() && RealType.array[ 0 ] == 0;
+
+			if( arraySizes == 0 && !RuntimeArray )
 				arraySizes = 1;
 
 			m_DescriptorSets[ set ].SampledImages.push_back( { Name, shaderType, set, binding, arraySizes } );
@@ -785,9 +803,24 @@ namespace Saturn {
 
 		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
 
+		m_SetLayouts.clear();
+
 		// Iterate over descriptor sets
 		for( auto& [ set, descriptorSet ] : m_DescriptorSets )
 		{
+			if( m_SetLayouts.size() <= set )
+				m_SetLayouts.resize( set + 1 );
+
+			if( IsBindlessSet( descriptorSet ) )
+			{
+				SAT_CORE_ASSERT( VulkanContext::Get().IsBindlessEnabled(), "Shader uses an unsized texture array but bindless textures are not enabled!" );
+
+				descriptorSet.SetLayout = VulkanContext::Get().GetBindlessResources()->GetSetLayout();
+				m_SetLayouts[ set ] = descriptorSet.SetLayout;
+
+				continue;
+			}
+
 			std::vector< VkDescriptorSetLayoutBinding > Bindings;
 
 			// Iterate over uniform buffers
@@ -919,7 +952,7 @@ namespace Saturn {
 
 			VK_CHECK( vkCreateDescriptorSetLayout( VulkanContext::Get().GetDevice(), &LayoutInfo, nullptr, &descriptorSet.SetLayout ) );
 
-			m_SetLayouts.push_back( descriptorSet.SetLayout );
+			m_SetLayouts[ set ] = descriptorSet.SetLayout;
 		}
 
 		m_SetPool = Ref< DescriptorPool >::Create( PoolSizes, 10000 );
@@ -1051,6 +1084,17 @@ namespace Saturn {
 		return true;
 	}
 
+	bool Shader::IsBindlessSet( const ShaderDescriptorSet& rSet )
+	{
+		for( const auto& rTexture : rSet.SampledImages )
+		{
+			if( rTexture.ArraySize == 0 )
+				return true;
+		}
+
+		return false;
+	}
+
 	size_t Shader::GetShaderHash() const
 	{
 		return m_ShaderHash;
@@ -359,6 +359,9 @@ namespace Saturn {
 
 		size_t GetShaderHash() const;
 
+		// A set that has an unsized sampler array, it uses the layout from BindlessResources.
+		static bool IsBindlessSet( const ShaderDescriptorSet& rSet );
+
 	private:
 
 		void ReadFile();
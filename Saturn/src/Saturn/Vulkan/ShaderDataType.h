@@ -36,7 +36,10 @@ namespace Saturn {
 
 	enum class ShaderDataType
 	{
-		None = 0, Float, Float2, Float3, Float4, Mat3, Mat4, Int, Int2, Int3, Int4, Bool, Sampler2D, SamplerCube
+		None = 0, Float, Float2, Float3, Float4, Mat3, Mat4, Int, Int2, Int3, Int4, Bool, Sampler2D, SamplerCube,
+		
+		// Packed vertex attributes, read as floats in the shader. Names match the glm pack functions.
+		Half2, Snorm2x16, Unorm3x10_1x2
 	};
 	
 	// Vulkan shader type sizes
@@ -55,6 +58,9 @@ namespace Saturn {
 			case ShaderDataType::Int3:		return 4 * 3;
 			case ShaderDataType::Int4:		return 4 * 4;
 			case ShaderDataType::Bool:		return 1;
+			case ShaderDataType::Half2:			return 4;
+			case ShaderDataType::Snorm2x16:		return 4;
+			case ShaderDataType::Unorm3x10_1x2:	return 4;
 		}
 
 		return 0;
@@ -94,6 +100,15 @@ namespace Saturn {
 			case ShaderDataType::Mat3:
 				return VK_FORMAT_R32G32B32_SFLOAT;
 				break;
+			case ShaderDataType::Half2:
+				return VK_FORMAT_R16G16_SFLOAT;
+				break;
+			case ShaderDataType::Snorm2x16:
+				return VK_FORMAT_R16G16_SNORM;
+				break;
+			case ShaderDataType::Unorm3x10_1x2:
+				return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+				break;
 			default:
 				break;
 		}
@@ -132,6 +147,15 @@ namespace Saturn {
 			case VK_FORMAT_R8_UNORM:
 				return ShaderDataType::Bool;
 				break;
+			case VK_FORMAT_R16G16_SFLOAT:
+				return ShaderDataType::Half2;
+				break;
+			case VK_FORMAT_R16G16_SNORM:
+				return ShaderDataType::Snorm2x16;
+				break;
+			case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+				return ShaderDataType::Unorm3x10_1x2;
+				break;
 			default:
 				break;
 		}
@@ -165,6 +189,9 @@ namespace Saturn {
 			case ShaderDataType::Mat3:		return "mat3";
 			case ShaderDataType::Mat4:		return "mat4";
 			case ShaderDataType::Sampler2D:	return "sampler2D";
+			case ShaderDataType::Half2:		return "vec2";
+			case ShaderDataType::Snorm2x16:	return "vec2";
+			case ShaderDataType::Unorm3x10_1x2:	return "vec4";
 			case ShaderDataType::None:
 			default:						return "";
 		}
@@ -39,6 +39,12 @@ namespace Saturn {
 		Create();
 	}
 
+	StorageBuffer::StorageBuffer( uint32_t set, uint32_t binding, VmaMemoryUsage MemoryUsage )
+		: m_Set( set ), m_Binding( binding ), m_MemoryUsage( MemoryUsage )
+	{
+		Create();
+	}
+
 	StorageBuffer::~StorageBuffer()
 	{
 
@@ -53,11 +59,18 @@ namespace Saturn {
 		BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
 		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
-		pAllocator->AllocateBuffer( BufferInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_Buffer );
+		pAllocator->AllocateBuffer( BufferInfo, m_MemoryUsage, &m_Buffer );
+
+		m_BufferInfo.buffer = m_Buffer;
+		m_BufferInfo.range = VK_WHOLE_SIZE;
 	}
 
 	void StorageBuffer::Resize( uint32_t newSize )
 	{
+		// Keep the same VkBuffer when we can, any descriptor sets that point to it can then stay as they are.
+		if( m_Size == newSize && m_Buffer )
+			return;
+
 		m_Size = newSize;
 
 		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
@@ -69,9 +82,37 @@ namespace Saturn {
 		BufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-		pAllocator->AllocateBuffer( BufferCreateInfo, VMA_MEMORY_USAGE_GPU_ONLY, &m_Buffer );
+		pAllocator->AllocateBuffer( BufferCreateInfo, m_MemoryUsage, &m_Buffer );
 
 		m_BufferInfo.buffer = m_Buffer;
 		m_BufferInfo.range = m_Size;
 	}
+
+	void StorageBuffer::SetData( const void* pData, size_t Size, size_t Offset /*= 0 */ )
+	{
+		SAT_CORE_ASSERT( m_MemoryUsage != VMA_MEMORY_USAGE_GPU_ONLY, "Storage buffer is not host visible!" );
+		SAT_CORE_ASSERT( Offset + Size <= m_Size, "Storage buffer write is out of bounds!" );
+
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+		VmaAllocation Allocation = pAllocator->GetAllocationFromBuffer( m_Buffer );
+
+		uint8_t* pDst = pAllocator->MapMemory<uint8_t>( Allocation );
+		memcpy( pDst + Offset, pData, Size );
+		pAllocator->FlushAllocation( Allocation );
+		pAllocator->UnmapMemory( Allocation );
+	}
+
+	void StorageBuffer::GetData( void* pDst, size_t Size, size_t Offset /*= 0 */ )
+	{
+		SAT_CORE_ASSERT( m_MemoryUsage != VMA_MEMORY_USAGE_GPU_ONLY, "Storage buffer is not host visible!" );
+		SAT_CORE_ASSERT( Offset + Size <= m_Size, "Storage buffer read is out of bounds!" );
+
+		auto pAllocator = VulkanContext::Get().GetVulkanAllocator();
+		VmaAllocation Allocation = pAllocator->GetAllocationFromBuffer( m_Buffer );
+
+		pAllocator->InvalidateAllocation( Allocation );
+		uint8_t* pSrc = pAllocator->MapMemory<uint8_t>( Allocation );
+		memcpy( pDst, pSrc + Offset, Size );
+		pAllocator->UnmapMemory( Allocation );
+	}
 }
\ No newline at end of file
@@ -30,6 +30,7 @@
 
 #include "Saturn/Core/Base.h"
 #include <vulkan.h>
+#include <vma/vk_mem_alloc.h>
 
 namespace Saturn {
 
@@ -37,10 +38,18 @@ namespace Saturn {
 	{
 	public:
 		StorageBuffer(uint32_t set, uint32_t binding);
+		// Use VMA_MEMORY_USAGE_CPU_TO_GPU for buffers that are written every frame and VMA_MEMORY_USAGE_GPU_TO_CPU for read back.
+		StorageBuffer( uint32_t set, uint32_t binding, VmaMemoryUsage MemoryUsage );
 		~StorageBuffer();
 
 		void Resize( uint32_t newSize );
 
+		// Only valid for host visible buffers.
+		void SetData( const void* pData, size_t Size, size_t Offset = 0 );
+		void GetData( void* pDst, size_t Size, size_t Offset = 0 );
+
+		size_t GetSize() const { return m_Size; }
+
 		VkBuffer GetBuffer() { return m_Buffer; }
 
 		const VkDescriptorBufferInfo& GetBufferInfo() { return m_BufferInfo; }
@@ -51,9 +60,10 @@ namespace Saturn {
 		void Create();
 	private:
 		VkDescriptorBufferInfo m_BufferInfo{};
-		size_t m_Size;
+		size_t m_Size = 0;
 
 		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VmaMemoryUsage m_MemoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
 
 		uint32_t m_Binding;
 		uint32_t m_Set;
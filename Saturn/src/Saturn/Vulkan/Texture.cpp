@@ -32,6 +32,8 @@
 #include "VulkanContext.h"
 #include "VulkanDebug.h"
 #include "VulkanImageAux.h"
+#include "BindlessResources.h"
+#include "SamplerCache.h"
 
 #include <stb_image.h>
 #include <backends/imgui_impl_vulkan.h>
@@ -100,8 +102,9 @@ namespace Saturn {
 		if( m_ImageView )
 			vkDestroyImageView( VulkanContext::Get().GetDevice(), m_ImageView, nullptr );
 
-		if( m_Sampler )
-			vkDestroySampler( VulkanContext::Get().GetDevice(), m_Sampler, nullptr );
+		// Samplers are shared, this only drops our reference.
+		if( SamplerCache* pSamplerCache = VulkanContext::Get().GetSamplerCache() )
+			pSamplerCache->Release( m_Sampler );
 
 		m_Image = nullptr;
 		m_ImageMemory = nullptr;
@@ -426,6 +429,11 @@ namespace Saturn {
 		if( m_IsRendererTexture && !m_ForceTerminate )
 			return;
 
+		if( m_BindlessIndex != UINT32_MAX && VulkanContext::Get().IsBindlessEnabled() )
+			VulkanContext::Get().GetBindlessResources()->UnregisterTexture( m_BindlessIndex );
+
+		m_BindlessIndex = UINT32_MAX;
+
 		Texture::Terminate();
 	}
 
@@ -435,6 +443,8 @@ namespace Saturn {
 		m_ImageMemory = rOther->m_ImageMemory;
 		m_ImageView = rOther->m_ImageView;
 		m_Sampler = rOther->m_Sampler;
+
+		VulkanContext::Get().GetSamplerCache()->AddReference( m_Sampler );
 		m_DescriptorImageInfo = rOther->m_DescriptorImageInfo;
 		m_ImageFormat = rOther->m_ImageFormat;
 
@@ -445,6 +455,15 @@ namespace Saturn {
 		m_Path = rOther->m_Path;
 
 		m_DescriptorSet = rOther->m_DescriptorSet;
+
+		// Each texture owns its bindless slot (Terminate frees it), so the copy gets its own slot for the same image.
+		if( !m_Storage && VulkanContext::Get().IsBindlessEnabled() )
+		{
+			if( m_BindlessIndex == UINT32_MAX )
+				m_BindlessIndex = VulkanContext::Get().GetBindlessResources()->RegisterTexture( m_DescriptorImageInfo );
+			else
+				m_BindlessIndex = VulkanContext::Get().GetBindlessResources()->UpdateTexture( m_BindlessIndex, m_DescriptorImageInfo );
+		}
 	}
 
 	// Load and create a texture 2D for a file path.
@@ -586,7 +605,6 @@ namespace Saturn {
 	{
 		SetDebugUtilsObjectName( rName.c_str(), (uint64_t)m_Image, VK_OBJECT_TYPE_IMAGE );
 		SetDebugUtilsObjectName( rName.c_str(), (uint64_t)m_ImageView, VK_OBJECT_TYPE_IMAGE_VIEW );
-		SetDebugUtilsObjectName( rName.c_str(), (uint64_t)m_Sampler, VK_OBJECT_TYPE_SAMPLER );
 	}
 
 	void Texture2D::SetData( const void* pData )
@@ -688,12 +706,16 @@ namespace Saturn {
 		SamplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 		SamplerCreateInfo.mipLodBias = 0.0f;
 		SamplerCreateInfo.minLod = 0.0f;
-		SamplerCreateInfo.maxLod = ( float ) MipCount;
+
+		// The image view already limits the mips, so every texture with the same addressing mode can share one sampler.
+		SamplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+		SamplerCache* pSamplerCache = VulkanContext::Get().GetSamplerCache();
 
 		if( m_Sampler )
-			vkDestroySampler( VulkanContext::Get().GetDevice(), m_Sampler, nullptr );
+			pSamplerCache->Release( m_Sampler );
 
-		VK_CHECK( vkCreateSampler( VulkanContext::Get().GetDevice(), &SamplerCreateInfo, nullptr, &m_Sampler ) );
+		m_Sampler = pSamplerCache->Acquire( SamplerCreateInfo );
 
 		m_DescriptorImageInfo = {};
 		m_DescriptorImageInfo.imageLayout = m_Storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -702,6 +724,15 @@ namespace Saturn {
 
 		m_DescriptorSet = ( VkDescriptorSet ) ImGui_ImplVulkan_AddTexture( m_Sampler, m_ImageView, m_Storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
 
+		// Storage images are only used in compute passes, we don't want them in the bindless array.
+		if( !m_Storage && VulkanContext::Get().IsBindlessEnabled() )
+		{
+			if( m_BindlessIndex == UINT32_MAX )
+				m_BindlessIndex = VulkanContext::Get().GetBindlessResources()->RegisterTexture( m_DescriptorImageInfo );
+			else
+				m_BindlessIndex = VulkanContext::Get().GetBindlessResources()->UpdateTexture( m_BindlessIndex, m_DescriptorImageInfo );
+		}
+
 		if( MipCount > 1 )
 			CreateMips();
 	}
@@ -781,11 +812,11 @@ namespace Saturn {
 		SamplerCreateInfo.mipLodBias = 0.0f;
 		SamplerCreateInfo.compareOp = VK_COMPARE_OP_NEVER;
 		SamplerCreateInfo.minLod = 0.0f;
-		SamplerCreateInfo.maxLod = ( float ) GetMipMapLevels();
+		SamplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
 		SamplerCreateInfo.anisotropyEnable = VK_FALSE;
 		SamplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
 
-		VK_CHECK( vkCreateSampler( VulkanContext::Get().GetDevice(), &SamplerCreateInfo, nullptr, &m_Sampler ) );
+		m_Sampler = VulkanContext::Get().GetSamplerCache()->Acquire( SamplerCreateInfo );
 
 		// Create image view
 
@@ -55,6 +55,11 @@ namespace Saturn {
 					VkFormat Format,
 					VkImageAspectFlags AspectFlags );
 
+	extern VkImageView CreateImageView(
+					const VkImageSubresourceRange& rRange,
+					VkImage Image,
+					VkFormat Format );
+
 	extern void TransitionImageLayout( VkImage Image, VkFormat Format, VkImageLayout OldLayout, VkImageLayout NewLayout );
 
 	enum class AddressingMode
@@ -96,6 +101,9 @@ namespace Saturn {
 		VkDescriptorSet GetDescriptorSet()         const { return m_DescriptorSet; }
 		VkDescriptorImageInfo& GetDescriptorInfo()       { return m_DescriptorImageInfo; }
 
+		// Index into the bindless texture array, 0 (the renderer's white texture) when bindless is disabled or the texture is not registered.
+		uint32_t GetBindlessIndex()                const { return m_BindlessIndex == UINT32_MAX ? 0 : m_BindlessIndex; }
+
 		std::filesystem::path GetPath() { return m_Path; }
 		const std::filesystem::path& GetPath() const { return m_Path; }
 
@@ -141,6 +149,8 @@ namespace Saturn {
 		int m_Height = 0;
 
 		bool m_Storage = false;
+
+		uint32_t m_BindlessIndex = UINT32_MAX;
 	};
 	
 	class Texture2D : public Texture
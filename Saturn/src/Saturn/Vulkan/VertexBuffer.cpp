@@ -44,7 +44,7 @@ namespace Saturn {
 		CreateBuffer();
 	}
 
-	VertexBuffer::VertexBuffer( VkDeviceSize Size, VkBufferUsageFlags Usage /*= 0 */ )
+	VertexBuffer::VertexBuffer( VkDeviceSize Size, VkBufferUsageFlags Usage /*= 0 */, VmaMemoryUsage MemoryUsage /*= VMA_MEMORY_USAGE_CPU_TO_GPU */ )
 	{
 		m_Size = Size;
 		m_pData = nullptr;
@@ -54,9 +54,9 @@ namespace Saturn {
 		// Create the vertex buffer.
 		VkBufferCreateInfo VertexBufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
 		VertexBufferCreateInfo.size = Size;
-		VertexBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		VertexBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | Usage;
 
-		m_Allocation = pAllocator->AllocateBuffer( VertexBufferCreateInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, &m_Buffer );
+		m_Allocation = pAllocator->AllocateBuffer( VertexBufferCreateInfo, MemoryUsage, &m_Buffer );
 		SetDebugUtilsObjectName( "Vertex Buffer", ( uint64_t ) m_Buffer, VK_OBJECT_TYPE_BUFFER );
 	}
 
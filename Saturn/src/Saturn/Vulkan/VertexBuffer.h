@@ -77,6 +77,28 @@ namespace Saturn {
 			RawSerialisation::ReadVec2( rObject.Texcoord, rStream );
 		}
 	};
+
+	// How a static vertex is stored in the MeshGeometryPool, 24 bytes instead of the 56 of StaticVertex.
+	// Normal and tangent are octahedral encoded, the binormal is rebuilt in the shader from the sign in the tangent's w.
+	// See VertexCompression for the encoding.
+	struct CompactStaticVertex
+	{
+		glm::vec3 Position;
+		uint32_t Normal;   // Snorm2x16
+		uint32_t Tangent;  // Unorm3x10_1x2, z is unused.
+		uint32_t Texcoord; // Half2
+	};
+
+	// Cooked vertices of meshes imported with "Compact Vertices", 20 bytes.
+	// The position is quantized against the bounding box of the submesh it belongs to.
+	struct QuantizedStaticVertex
+	{
+		uint16_t Position[ 3 ];
+		uint16_t Padding;
+		uint32_t Normal;
+		uint32_t Tangent;
+		uint32_t Texcoord;
+	};
 	
 	struct VertexBufferElement
 	{
@@ -110,6 +132,9 @@ namespace Saturn {
 				case ShaderDataType::Bool:        return 1;
 				case ShaderDataType::Sampler2D:   return 1;
 				case ShaderDataType::SamplerCube: return 1;
+				case ShaderDataType::Half2:       return 2;
+				case ShaderDataType::Snorm2x16:   return 2;
+				case ShaderDataType::Unorm3x10_1x2: return 4;
 			
 				SAT_CORE_ASSERT( false, "Unknown ShaderDataType!" );
 			}
@@ -179,6 +204,17 @@ namespace Saturn {
 		std::vector< VertexBufferElement> m_Elements;
 		uint32_t m_Stride = 0;
 	};
+
+	// Layout of CompactStaticVertex, every pipeline that draws from the MeshGeometryPool must use this.
+	inline VertexBufferLayout GetCompactStaticVertexLayout()
+	{
+		return {
+			{ ShaderDataType::Float3, "a_Position" },
+			{ ShaderDataType::Snorm2x16, "a_Normal" },
+			{ ShaderDataType::Unorm3x10_1x2, "a_Tangent" },
+			{ ShaderDataType::Half2, "a_TexCoord" }
+		};
+	}
 	
 	// A vulkan vertex buffer.
 	class VertexBuffer : public RefTarget
@@ -187,7 +223,8 @@ namespace Saturn {
 		VertexBuffer() : m_pData( nullptr ) { }
 
 		VertexBuffer( void* pData, VkDeviceSize Size, VkBufferUsageFlags Usage = 0 );
-		VertexBuffer( VkDeviceSize Size, VkBufferUsageFlags Usage = 0 );
+		// "Usage" is added to the vertex buffer usage, i.e. VK_BUFFER_USAGE_STORAGE_BUFFER_BIT for buffers written by compute shaders.
+		VertexBuffer( VkDeviceSize Size, VkBufferUsageFlags Usage = 0, VmaMemoryUsage MemoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU );
 		
 		VertexBuffer( const VertexBuffer& ) = delete;
 
@@ -202,6 +239,9 @@ namespace Saturn {
 		void Draw( VkCommandBuffer CommandBuffer );
 		void BindAndDraw( VkCommandBuffer CommandBuffer );
 
+		VkBuffer GetBuffer() { return m_Buffer; }
+		size_t GetSize() const { return m_Size; }
+
 	private:
 		void CreateBuffer();
 	private:
@@ -0,0 +1,160 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#include "sppch.h"
+#include "VertexCompression.h"
+
+#include <glm/gtc/packing.hpp>
+
+namespace Saturn {
+
+	static float SignNotZero( float Value )
+	{
+		return Value >= 0.0f ? 1.0f : -1.0f;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	CompactStaticVertex VertexCompression::Compress( const StaticVertex& rVertex )
+	{
+		float Sign = SignNotZero( glm::dot( glm::cross( rVertex.Normal, rVertex.Tangent ), rVertex.Binormal ) );
+
+		CompactStaticVertex Vertex;
+		Vertex.Position = rVertex.Position;
+		Vertex.Normal = EncodeNormal( rVertex.Normal );
+		Vertex.Tangent = EncodeTangent( rVertex.Tangent, Sign );
+		Vertex.Texcoord = glm::packHalf2x16( rVertex.Texcoord );
+
+		return Vertex;
+	}
+
+	StaticVertex VertexCompression::Decompress( const CompactStaticVertex& rVertex )
+	{
+		float Sign = 1.0f;
+
+		StaticVertex Vertex;
+		Vertex.Position = rVertex.Position;
+		Vertex.Normal = DecodeNormal( rVertex.Normal );
+		Vertex.Tangent = DecodeTangent( rVertex.Tangent, Sign );
+		Vertex.Binormal = glm::cross( Vertex.Normal, Vertex.Tangent ) * Sign;
+		Vertex.Texcoord = glm::unpackHalf2x16( rVertex.Texcoord );
+
+		return Vertex;
+	}
+
+	QuantizedStaticVertex VertexCompression::Quantize( const StaticVertex& rVertex, const AABB& rBounds )
+	{
+		CompactStaticVertex Compact = Compress( rVertex );
+
+		glm::vec3 Extents = glm::max( rBounds.Max - rBounds.Min, glm::vec3( FLT_MIN ) );
+		glm::vec3 Normalized = glm::clamp( ( rVertex.Position - rBounds.Min ) / Extents, 0.0f, 1.0f );
+
+		QuantizedStaticVertex Vertex;
+		Vertex.Position[ 0 ] = ( uint16_t ) glm::round( Normalized.x * 65535.0f );
+		Vertex.Position[ 1 ] = ( uint16_t ) glm::round( Normalized.y * 65535.0f );
+		Vertex.Position[ 2 ] = ( uint16_t ) glm::round( Normalized.z * 65535.0f );
+		Vertex.Padding = 0;
+		Vertex.Normal = Compact.Normal;
+		Vertex.Tangent = Compact.Tangent;
+		Vertex.Texcoord = Compact.Texcoord;
+
+		return Vertex;
+	}
+
+	StaticVertex VertexCompression::Dequantize( const QuantizedStaticVertex& rVertex, const AABB& rBounds )
+	{
+		CompactStaticVertex Compact;
+		Compact.Position = glm::vec3( rVertex.Position[ 0 ], rVertex.Position[ 1 ], rVertex.Position[ 2 ] ) / 65535.0f;
+		Compact.Position = rBounds.Min + Compact.Position * ( rBounds.Max - rBounds.Min );
+		Compact.Normal = rVertex.Normal;
+		Compact.Tangent = rVertex.Tangent;
+		Compact.Texcoord = rVertex.Texcoord;
+
+		return Decompress( Compact );
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	glm::vec2 VertexCompression::OctahedralEncode( const glm::vec3& rVector )
+	{
+		float L1 = glm::abs( rVector.x ) + glm::abs( rVector.y ) + glm::abs( rVector.z );
+
+		// Meshes without tangents have zero vectors, store them as +Z.
+		if( L1 <= FLT_MIN )
+			return glm::vec2( 0.0f );
+
+		glm::vec2 Point = glm::vec2( rVector.x, rVector.y ) / L1;
+
+		// Fold the lower hemisphere over the diagonals.
+		if( rVector.z < 0.0f )
+		{
+			Point = glm::vec2(
+				( 1.0f - glm::abs( Point.y ) ) * SignNotZero( Point.x ),
+				( 1.0f - glm::abs( Point.x ) ) * SignNotZero( Point.y ) );
+		}
+
+		return Point;
+	}
+
+	glm::vec3 VertexCompression::OctahedralDecode( const glm::vec2& rEncoded )
+	{
+		glm::vec3 Vector = glm::vec3( rEncoded.x, rEncoded.y, 1.0f - glm::abs( rEncoded.x ) - glm::abs( rEncoded.y ) );
+
+		float Fold = glm::max( -Vector.z, 0.0f );
+		Vector.x += Vector.x >= 0.0f ? -Fold : Fold;
+		Vector.y += Vector.y >= 0.0f ? -Fold : Fold;
+
+		return glm::normalize( Vector );
+	}
+
+	uint32_t VertexCompression::EncodeNormal( const glm::vec3& rNormal )
+	{
+		return glm::packSnorm2x16( OctahedralEncode( rNormal ) );
+	}
+
+	glm::vec3 VertexCompression::DecodeNormal( uint32_t Normal )
+	{
+		return OctahedralDecode( glm::unpackSnorm2x16( Normal ) );
+	}
+
+	uint32_t VertexCompression::EncodeTangent( const glm::vec3& rTangent, float Sign )
+	{
+		glm::vec2 Encoded = OctahedralEncode( rTangent ) * 0.5f + 0.5f;
+
+		return glm::packUnorm3x10_1x2( glm::vec4( Encoded, 0.0f, Sign > 0.0f ? 1.0f : 0.0f ) );
+	}
+
+	glm::vec3 VertexCompression::DecodeTangent( uint32_t Tangent, float& rSign )
+	{
+		glm::vec4 Unpacked = glm::unpackUnorm3x10_1x2( Tangent );
+
+		rSign = Unpacked.w > 0.5f ? 1.0f : -1.0f;
+
+		return OctahedralDecode( glm::vec2( Unpacked.x, Unpacked.y ) * 2.0f - 1.0f );
+	}
+}
@@ -0,0 +1,63 @@
+/********************************************************************************************
+*                                                                                           *
+*                                                                                           *
+*                                                                                           *
+* MIT License                                                                               *
+*                                                                                           *
+* Copyright (c) 2020 - 2024 BEAST                                                           *
+*                                                                                           *
+* Permission is hereby granted, free of charge, to any person obtaining a copy              *
+* of this software and associated documentation files (the "Software"), to deal             *
+* in the Software without restriction, including without limitation the rights              *
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell                 *
+* copies of the Software, and to permit persons to whom the Software is                     *
+* furnished to do so, subject to the following conditions:                                  *
+*                                                                                           *
+* The above copyright notice and this permission notice shall be included in all            *
+* copies or substantial portions of the Software.                                           *
+*                                                                                           *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR                *
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,                  *
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE               *
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER                    *
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,             *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE             *
+* SOFTWARE.                                                                                 *
+*********************************************************************************************
+*/
+
+#pragma once
+
+#include "VertexBuffer.h"
+
+#include "Saturn/Core/AABB/AABB.h"
+
+#include <glm/glm.hpp>
+
+namespace Saturn {
+
+	// Packs static vertices into CompactStaticVertex (GPU) and QuantizedStaticVertex (cooked mesh data).
+	// Must match with the decode functions in the static mesh shaders.
+	class VertexCompression
+	{
+	public:
+		static CompactStaticVertex Compress( const StaticVertex& rVertex );
+		static StaticVertex Decompress( const CompactStaticVertex& rVertex );
+
+		// "rBounds" must contain the vertex, positions are stored as 16 bits per axis.
+		static QuantizedStaticVertex Quantize( const StaticVertex& rVertex, const AABB& rBounds );
+		static StaticVertex Dequantize( const QuantizedStaticVertex& rVertex, const AABB& rBounds );
+
+	public:
+		// Unit vector to a point on the octahedron, both components are in [-1, 1].
+		static glm::vec2 OctahedralEncode( const glm::vec3& rVector );
+		static glm::vec3 OctahedralDecode( const glm::vec2& rEncoded );
+
+		static uint32_t EncodeNormal( const glm::vec3& rNormal );
+		static glm::vec3 DecodeNormal( uint32_t Normal );
+
+		// The sign is the handedness of the tangent frame, Binormal = cross( Normal, Tangent ) * Sign.
+		static uint32_t EncodeTangent( const glm::vec3& rTangent, float Sign );
+		static glm::vec3 DecodeTangent( uint32_t Tangent, float& rSign );
+	};
+}
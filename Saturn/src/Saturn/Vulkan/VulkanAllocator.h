@@ -66,6 +66,17 @@ namespace Saturn {
 			vmaUnmapMemory( m_Allocator, Allocation );
 		}
 
+		// Only needed for memory that is not host coherent.
+		void FlushAllocation( VmaAllocation Allocation )
+		{
+			vmaFlushAllocation( m_Allocator, Allocation, 0, VK_WHOLE_SIZE );
+		}
+
+		void InvalidateAllocation( VmaAllocation Allocation )
+		{
+			vmaInvalidateAllocation( m_Allocator, Allocation, 0, VK_WHOLE_SIZE );
+		}
+
 		VmaAllocation GetAllocationFromBuffer( VkBuffer Buffer ) { return m_Allocations[ Buffer ]; }
 
 	private:
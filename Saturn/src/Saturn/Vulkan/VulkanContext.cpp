@@ -35,6 +35,10 @@
 
 #include "VulkanDebug.h"
 #include "VulkanAllocator.h"
+#include "BindlessResources.h"
+#include "GPUProfiler.h"
+#include "MeshGeometryPool.h"
+#include "SamplerCache.h"
 
 #include "Saturn/Core/Timer.h"
 #include "SceneRenderer.h"
@@ -68,11 +72,27 @@ namespace Saturn {
 
 		PickPhysicalDevice();
 		CreateLogicalDevice();
-		CreateSwapChain();
+
+		// The depth image needs a sampler.
+		m_pSamplerCache = new SamplerCache();
+
+		// Headless has no surface to present to, the default pass is still created (some pipelines are built against it) so give it a format.
+		if( Application::Get().HasFlag( ApplicationFlag_Headless ) )
+			m_SurfaceFormat = { VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+		else
+			CreateSwapChain();
+
 		CreateDepthResources();
 		CreateCommandPool();
 
 		m_pAllocator = new VulkanAllocator();
+
+		if( m_DescriptorIndexingEnabled )
+			m_pBindlessResources = new BindlessResources();
+
+		m_pGPUProfiler = new GPUProfiler();
+
+		m_pMeshGeometryPool = new MeshGeometryPool();
 	
 		// Create default pass.
 		PassSpecification Specification = {};
@@ -85,7 +105,9 @@ namespace Saturn {
 		Specification.Attachments = { ImageFormat::BGRA8 };
 
 		m_DefaultPass = Ref<Pass>::Create( Specification );
-		m_SwapChain.CreateFramebuffers();
+
+		if( !Application::Get().HasFlag( ApplicationFlag_Headless ) )
+			m_SwapChain.CreateFramebuffers();
 		
 		Renderer* pRenderer = new Renderer();
 		pRenderer->Init();
@@ -108,7 +130,8 @@ namespace Saturn {
 		m_DefaultPass->Terminate();
 		m_DefaultPass = nullptr;
 
-		m_SwapChain.Terminate();
+		if( !Application::Get().HasFlag( ApplicationFlag_Headless ) )
+			m_SwapChain.Terminate();
 		
 		for( auto& rFunc : m_TerminateResourceFuncs )
 			rFunc();
@@ -118,7 +141,20 @@ namespace Saturn {
 
 		ShaderLibrary::Get().Shutdown();
 
+		delete m_pBindlessResources;
+		m_pBindlessResources = nullptr;
+
+		delete m_pGPUProfiler;
+		m_pGPUProfiler = nullptr;
+
+		delete m_pMeshGeometryPool;
+		m_pMeshGeometryPool = nullptr;
+
 		m_DepthImage = nullptr;
+
+		// After everything that could still hold a sampler.
+		delete m_pSamplerCache;
+		m_pSamplerCache = nullptr;
 		
 		delete m_pAllocator;
 
@@ -127,7 +163,9 @@ namespace Saturn {
 		delete m_pDebugMessenger;
 		m_pDebugMessenger = nullptr;
 
-		vkDestroySurfaceKHR( m_Instance, m_Surface, nullptr );
+		if( m_Surface )
+			vkDestroySurfaceKHR( m_Instance, m_Surface, nullptr );
+
 		vkDestroyInstance( m_Instance, nullptr );
 
 		SingletonStorage::RemoveSingleton( this );
@@ -152,7 +190,11 @@ namespace Saturn {
 		AppInfo.engineVersion      = VK_MAKE_VERSION( 0, 0, 1 );
 		AppInfo.apiVersion         = VK_API_VERSION_1_2;
 		
-		auto Extensions = Application::Get().GetWindow()->GetVulkanRequiredExtensions();
+		std::vector<const char*> Extensions;
+
+		if( Application::Get().GetWindow() )
+			Extensions = Application::Get().GetWindow()->GetVulkanRequiredExtensions();
+
 		Extensions.push_back( VK_EXT_DEBUG_UTILS_EXTENSION_NAME );
 
 		VkInstanceCreateInfo InstanceInfo ={ VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
@@ -182,7 +224,8 @@ namespace Saturn {
 
 		VK_CHECK( vkCreateInstance( &InstanceInfo, nullptr, &m_Instance ) );
 
-		CreateSurface();
+		if( Application::Get().GetWindow() )
+			CreateSurface();
 	}
 
 	void VulkanContext::CreateSurface()
@@ -228,9 +271,13 @@ namespace Saturn {
 					m_Indices.ComputeFamily = i;
 				}
 
-				// Check if we can present images to the surface.
+				// Check if we can present images to the surface, when headless we never present so the graphics queue will do.
 				VkBool32 PresentSupport = false;
-				VK_CHECK( vkGetPhysicalDeviceSurfaceSupportKHR( rDevice, i, m_Surface, &PresentSupport ) );
+
+				if( m_Surface )
+					VK_CHECK( vkGetPhysicalDeviceSurfaceSupportKHR( rDevice, i, m_Surface, &PresentSupport ) );
+				else
+					PresentSupport = m_Indices.GraphicsFamily.has_value();
 
 				// Again save the bit as we will need it for presenting.
 				if( PresentSupport )
@@ -275,6 +322,22 @@ namespace Saturn {
 		SAT_CORE_INFO( "======================================== " );
 	}
 
+	bool VulkanContext::IsDeviceExtensionSupported( const char* pName )
+	{
+		uint32_t Count;
+		vkEnumerateDeviceExtensionProperties( m_PhysicalDevice, nullptr, &Count, nullptr );
+		std::vector<VkExtensionProperties> Extensions( Count );
+		vkEnumerateDeviceExtensionProperties( m_PhysicalDevice, nullptr, &Count, Extensions.data() );
+
+		for( const auto& rExtension : Extensions )
+		{
+			if( strcmp( rExtension.extensionName, pName ) == 0 )
+				return true;
+		}
+
+		return false;
+	}
+
 	void VulkanContext::CreateLogicalDevice()
 	{
 		float QueuePriority = 1.0f;
@@ -304,15 +367,40 @@ namespace Saturn {
 
 		Features.samplerAnisotropy = VK_TRUE;
 
+		if( Application::Get().HasFlag( ApplicationFlag_Headless ) )
+			std::erase_if( DeviceExtensions, []( const char* pName ) { return strcmp( pName, VK_KHR_SWAPCHAIN_EXTENSION_NAME ) == 0; } );
+
 #if !defined( SAT_DIST )
 		DeviceExtensions.push_back( VK_EXT_DEBUG_MARKER_EXTENSION_NAME );
 #endif
 
 		DeviceExtensions.push_back( VK_EXT_INLINE_UNIFORM_BLOCK_EXTENSION_NAME );
 
+		// Used to render every shadow cascade in one pass.
+		m_LayeredRenderingSupported = IsDeviceExtensionSupported( VK_EXT_SHADER_VIEWPORT_INDEX_LAYER_EXTENSION_NAME );
+
+		if( m_LayeredRenderingSupported )
+			DeviceExtensions.push_back( VK_EXT_SHADER_VIEWPORT_INDEX_LAYER_EXTENSION_NAME );
+
 		VkPhysicalDeviceInlineUniformBlockFeaturesEXT InlineUniformBlockFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INLINE_UNIFORM_BLOCK_FEATURES_EXT };
 		InlineUniformBlockFeatures.inlineUniformBlock = VK_TRUE;
 
+		// Bindless textures, descriptor indexing is core in 1.2 but we still enable the extension for older drivers.
+		VkPhysicalDeviceDescriptorIndexingFeatures DescriptorIndexingFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES };
+
+		if( Application::Get().HasFlag( ApplicationFlag_BindlessTextures ) )
+		{
+			m_DescriptorIndexingEnabled = BindlessResources::IsSupported( m_PhysicalDevice, DescriptorIndexingFeatures );
+
+			if( m_DescriptorIndexingEnabled )
+			{
+				DeviceExtensions.push_back( VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME );
+				InlineUniformBlockFeatures.pNext = &DescriptorIndexingFeatures;
+			}
+			else
+				SAT_CORE_WARN( "Bindless textures were requested but the GPU does not support descriptor indexing, falling back to bound textures." );
+		}
+
 		VkDeviceCreateInfo DeviceInfo      ={ VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
 		DeviceInfo.enabledExtensionCount   = ( uint32_t ) DeviceExtensions.size();
 		DeviceInfo.ppEnabledExtensionNames = DeviceExtensions.data();
@@ -613,8 +701,8 @@ namespace Saturn {
 			m_DepthImage = nullptr;
 
 		m_DepthImage = Ref<Image2D>::Create( ImageFormat::Depth,
-			Application::Get().GetWindow()->GetWidth(), 
-			Application::Get().GetWindow()->GetHeight(), 1, GetMaxUsableMSAASamples() );
+			Application::Get().GetWidth(), 
+			Application::Get().GetHeight(), 1, GetMaxUsableMSAASamples() );
 	}
 
 }
\ No newline at end of file
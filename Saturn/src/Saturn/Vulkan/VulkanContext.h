@@ -26,6 +26,10 @@ namespace Saturn {
 
 	class VulkanDebugMessenger;
 	class VulkanAllocator;
+	class BindlessResources;
+	class GPUProfiler;
+	class MeshGeometryPool;
+	class SamplerCache;
 	
 	struct QueueFamilyIndices
 	{
@@ -110,6 +114,21 @@ namespace Saturn {
 
 		VulkanAllocator* GetVulkanAllocator() { return m_pAllocator; }
 
+		// Null when bindless textures are disabled or not supported.
+		BindlessResources* GetBindlessResources() { return m_pBindlessResources; }
+		bool IsBindlessEnabled() const { return m_pBindlessResources != nullptr; }
+
+		GPUProfiler* GetGPUProfiler() { return m_pGPUProfiler; }
+
+		// Vertex and index arenas for every static mesh, null once the context has been terminated.
+		MeshGeometryPool* GetMeshGeometryPool() { return m_pMeshGeometryPool; }
+
+		// Shared samplers for textures and images, null once the context has been terminated.
+		SamplerCache* GetSamplerCache() { return m_pSamplerCache; }
+
+		// VK_EXT_shader_viewport_index_layer, the vertex shader can write gl_Layer.
+		bool IsLayeredRenderingSupported() const { return m_LayeredRenderingSupported; }
+
 		// "rrFunction" will be called just before the device is destroyed.
 		void SubmitTerminateResource( std::function<void()>&& rrFunction ) { m_TerminateResourceFuncs.push_back( std::move( rrFunction ) ); }
 
@@ -135,6 +154,7 @@ namespace Saturn {
 		void CreateDepthResources();
 
 		bool CheckValidationLayerSupport();
+		bool IsDeviceExtensionSupported( const char* pName );
 
 		VkInstance m_Instance = nullptr;
 		VkSurfaceKHR m_Surface = nullptr;
@@ -153,6 +173,13 @@ namespace Saturn {
 
 		VulkanDebugMessenger* m_pDebugMessenger;
 		VulkanAllocator* m_pAllocator;
+		BindlessResources* m_pBindlessResources = nullptr;
+		GPUProfiler* m_pGPUProfiler = nullptr;
+		MeshGeometryPool* m_pMeshGeometryPool = nullptr;
+		SamplerCache* m_pSamplerCache = nullptr;
+
+		bool m_DescriptorIndexingEnabled = false;
+		bool m_LayeredRenderingSupported = false;
 
 		VkQueue m_GraphicsQueue, m_PresentQueue, m_ComputeQueue;
 
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "VulkanContext.h"
+#include "GPUProfiler.h"
 
 namespace Saturn {
 
@@ -108,6 +109,10 @@ namespace Saturn {
 		{
 			Function( ComamndBuffer, &Info );
 		}
+
+		// Labels double as GPU profiler scopes.
+		if( GPUProfiler* pProfiler = VulkanContext::Get().GetGPUProfiler() )
+			pProfiler->BeginScope( ComamndBuffer, Name );
 	}
 
 	inline void CmdEndDebugLabel( VkCommandBuffer ComamndBuffer )
@@ -118,6 +123,9 @@ namespace Saturn {
 		{
 			Function( ComamndBuffer );
 		}
+
+		if( GPUProfiler* pProfiler = VulkanContext::Get().GetGPUProfiler() )
+			pProfiler->EndScope( ComamndBuffer );
 	}
 
 	inline void CmdDebugMarkerBegin( VkCommandBuffer CommandBuffer, VkDebugMarkerMarkerInfoEXT* pMarkerInfo )